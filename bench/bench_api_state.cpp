@@ -0,0 +1,243 @@
+// Benchmarks for ReadinessAPIState::update()
+//
+// Cases:
+// - update_uncontended: single writer, no readers
+// - update_contended_<N>_readers: single writer while N threads poll
+//   getCurrentSnapshot()/getHistory() as the REST handlers do
+// - get_history_<N>: copy-out cost of getHistory() at the default depth
+// - history_stats_100k: getHistoryStats() over 100k columnar samples
+// - history_scan_100k_aos: the same aggregates over a copied-out
+//   vector<ReadinessSnapshot> (the pre-columnar approach)
+// - ingest_submit: IngestPipeline::submit() (drop-oldest) with the
+//   evaluator thread evaluating and calling update() behind it
+// - update_batch_256: per-sample cost of ReadinessAPIState::updateBatch()
+// - publish_enqueue: control-thread cost of PublicationStage::publish(),
+//   timed over bursts that fit the queue (the publisher drains between
+//   bursts, outside the timed region, so a single-CPU host measures the
+//   control thread alone)
+// - gate_tree_update_4096: GateAggregationTree::update() round-robin over
+//   4096 channels (one leaf plus 12 ancestor combines per update)
+// - indexed_heap_set_4096 / indexed_heap_top20_4096: re-keying one channel
+//   of the ranking heap behind /api/channels/top, and a K=20 query over it
+// - epoch_snapshot_4096: ChannelRegistry::snapshotEpoch() copying a
+//   consistent cut of 4096 channels (no producer running)
+
+#include "bench_common.hpp"
+#include "hlv/channel_registry.hpp"
+#include "hlv/gate_aggregation.hpp"
+#include "hlv/indexed_heap.hpp"
+#include "hlv/ingest_pipeline.hpp"
+#include "hlv/rest_api_server.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <thread>
+
+using namespace hlv;
+using namespace hlv::bench;
+
+static void runUpdate(ReadinessAPIState& state, uint64_t n, uint64_t base) {
+  PhaseReadinessOutput out;
+  out.readiness = 1.0;
+  out.gate = Gate::ALLOW;
+  out.stability_score = 1.0;
+  for (uint64_t i = 0; i < n; ++i) {
+    state.update(syntheticSignal(base + i), out);
+  }
+}
+
+int main(int argc, char** argv) {
+  Suite suite("api_state", argc, argv);
+
+  {
+    ReadinessAPIState state;
+    uint64_t base = 0;
+    suite.run("update_uncontended", [&](uint64_t n) {
+      runUpdate(state, n, base);
+      base += n;
+    });
+  }
+
+  for (int readers : {1, 4}) {
+    ReadinessAPIState state;
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> reads(0);
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; ++r) {
+      threads.emplace_back([&, r]() {
+        uint64_t local = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+          if (r % 2 == 0) {
+            doNotOptimize(state.getCurrentSnapshot());
+          } else {
+            doNotOptimize(state.getHistory(100).size());
+          }
+          ++local;
+        }
+        reads.fetch_add(local);
+      });
+    }
+
+    uint64_t base = 0;
+    Result& r = suite.run("update_contended_" + std::to_string(readers) + "_readers", [&](uint64_t n) {
+      runUpdate(state, n, base);
+      base += n;
+    });
+    stop.store(true);
+    for (auto& t : threads) t.join();
+    r.extra.emplace_back("reader_ops", static_cast<double>(reads.load()));
+  }
+
+  {
+    ReadinessAPIState state;
+    runUpdate(state, 100, 0);
+    suite.run("get_history_100", [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i) {
+        doNotOptimize(state.getHistory(100).size());
+      }
+    });
+  }
+
+  {
+    ReadinessAPIState state;
+    state.setMaxHistorySize(100000);
+    runUpdate(state, 100000, 0);
+    const double inf = std::numeric_limits<double>::infinity();
+    suite.run("history_stats_100k", [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i) {
+        doNotOptimize(state.getHistoryStats(-inf, inf).readiness.sum);
+      }
+    });
+    suite.run("history_scan_100k_aos", [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i) {
+        const std::vector<ReadinessSnapshot> history = state.getHistory(100000);
+        double lo = inf, hi = -inf, sum = 0.0;
+        uint64_t gates[3] = {0, 0, 0};
+        for (const auto& s : history) {
+          lo = std::min(lo, s.readiness);
+          hi = std::max(hi, s.readiness);
+          sum += s.readiness;
+          ++gates[static_cast<size_t>(s.gate)];
+        }
+        doNotOptimize(lo + hi + sum + static_cast<double>(gates[0]));
+      }
+    });
+  }
+
+  {
+    ReadinessAPIState state;
+    IngestPipeline pipeline(PhaseReadinessConfig{}, &state);
+    pipeline.start();
+    uint64_t base = 0;
+    Result& r = suite.run("ingest_submit", [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i) {
+        pipeline.submit(syntheticSignal(base + i));
+      }
+      base += n;
+    });
+    pipeline.stop();
+    r.extra.emplace_back("dropped", static_cast<double>(pipeline.droppedOldestCount() + pipeline.droppedNewestCount()));
+    r.extra.emplace_back("max_queue_depth", static_cast<double>(pipeline.maxQueueDepth()));
+  }
+
+  {
+    ReadinessAPIState state;
+    PhaseReadinessOutput out;
+    out.readiness = 1.0;
+    out.gate = Gate::ALLOW;
+    out.stability_score = 1.0;
+    std::vector<ReadinessUpdate> batch(256);
+    uint64_t base = 0;
+    suite.run("update_batch_256", [&](uint64_t n) {
+      for (uint64_t done = 0; done < n;) {
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(batch.size(), n - done));
+        for (size_t i = 0; i < count; ++i) {
+          batch[i] = ReadinessUpdate{syntheticSignal(base + done + i), out};
+        }
+        state.updateBatch(batch.data(), count);
+        done += count;
+      }
+      base += n;
+    });
+  }
+
+  {
+    ReadinessAPIState state;
+    PublicationStage stage(state);
+    stage.start();
+    PhaseReadinessOutput out;
+    out.readiness = 1.0;
+    out.gate = Gate::ALLOW;
+    const size_t burst = stage.queueCapacity() / 2;
+    uint64_t iterations = 0;
+    double elapsed_s = 0.0;
+    while (elapsed_s < suite.minTimeSeconds()) {
+      const auto start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < burst; ++i) {
+        stage.publish(syntheticSignal(iterations + i), out);
+      }
+      elapsed_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      iterations += burst;
+      while (stage.queueDepth() > 0) std::this_thread::yield();
+    }
+    stage.stop();
+    Result& r = suite.record("publish_enqueue", iterations, elapsed_s);
+    r.extra.emplace_back("dropped", static_cast<double>(stage.droppedCount()));
+    r.extra.emplace_back("batches", static_cast<double>(stage.batchCount()));
+  }
+
+  {
+    GateAggregationTree tree(4096);
+    uint64_t base = 0;
+    Result& r = suite.run("gate_tree_update_4096", [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i) {
+        const uint64_t k = base + i;
+        tree.update(static_cast<size_t>(k & 4095), (k % 100) * 0.01,
+                    static_cast<Gate>(k % 3), static_cast<uint32_t>(k & 0xff));
+      }
+      base += n;
+    });
+    r.extra.emplace_back("blocked", static_cast<double>(tree.root().count(Gate::BLOCK)));
+  }
+
+  {
+    IndexedMinHeap heap(4096);
+    uint64_t base = 0;
+    suite.run("indexed_heap_set_4096", [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i) {
+        const uint64_t k = base + i;
+        heap.set(static_cast<size_t>(k & 4095), static_cast<double>((k * 2654435761u) % 1000) * 0.001);
+      }
+      base += n;
+    });
+    std::vector<std::pair<size_t, double>> top;
+    suite.run("indexed_heap_top20_4096", [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i) {
+        heap.smallest(20, top);
+      }
+    });
+  }
+
+  {
+    ChannelRegistry channels(4096, 10);
+    PhaseReadinessOutput out;
+    out.readiness = 1.0;
+    out.gate = Gate::ALLOW;
+    channels.beginEpoch();
+    for (size_t id = 0; id < channels.size(); ++id) {
+      channels.update(id, syntheticSignal(id), out);
+    }
+    channels.commitEpoch();
+    EpochSnapshot cut;
+    suite.run("epoch_snapshot_4096", [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i) {
+        channels.snapshotEpoch(cut);
+      }
+    });
+  }
+
+  suite.report();
+  return 0;
+}
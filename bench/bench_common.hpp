@@ -0,0 +1,123 @@
+#pragma once
+
+// Minimal dependency-free benchmark harness for HLV Phase Readiness
+//
+// Each benchmark executable runs a set of named cases and prints one JSON
+// document on stdout, so results from two releases can be diffed directly:
+//
+//   {
+//     "suite": "middleware",
+//     "version": "2.1.0",
+//     "results": [
+//       {"name": "evaluate_steady_state", "iterations": 4194304,
+//        "ns_per_op": 12.3, "ops_per_s": 81300813.0}
+//     ]
+//   }
+//
+// Usage: <bench> [--quick]   (--quick shortens every case for CI smoke runs)
+
+#include "hlv/phase_readiness.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace hlv {
+namespace bench {
+
+// Prevent the optimizer from discarding a computed value
+template <typename T>
+inline void doNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Result {
+  std::string name;
+  uint64_t iterations = 0;
+  double ns_per_op = 0.0;
+  double ops_per_s = 0.0;
+  std::vector<std::pair<std::string, double>> extra; // Case-specific figures
+};
+
+class Suite {
+public:
+  Suite(const char* name, int argc, char** argv)
+      : name_(name), min_time_s_(0.5) {
+    for (int i = 1; i < argc; ++i) {
+      if (std::strcmp(argv[i], "--quick") == 0) min_time_s_ = 0.02;
+    }
+  }
+
+  double minTimeSeconds() const { return min_time_s_; }
+
+  // Run `op(iterations)` with doubling batch sizes until the batch takes at
+  // least the minimum time; `op` must perform exactly `iterations` operations.
+  template <typename Op>
+  Result& run(const std::string& name, Op op) {
+    uint64_t iterations = 1;
+    double elapsed_s = 0.0;
+    for (;;) {
+      const auto start = std::chrono::steady_clock::now();
+      op(iterations);
+      elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      if (elapsed_s >= min_time_s_ || iterations >= (uint64_t(1) << 40)) break;
+      iterations *= 2;
+    }
+    return record(name, iterations, elapsed_s);
+  }
+
+  // Record a case measured by the caller
+  Result& record(const std::string& name, uint64_t iterations, double elapsed_s) {
+    Result r;
+    r.name = name;
+    r.iterations = iterations;
+    r.ns_per_op = iterations ? elapsed_s * 1e9 / static_cast<double>(iterations) : 0.0;
+    r.ops_per_s = elapsed_s > 0.0 ? static_cast<double>(iterations) / elapsed_s : 0.0;
+    results_.push_back(r);
+    std::fprintf(stderr, "%-40s %12.1f ns/op\n", name.c_str(), r.ns_per_op);
+    return results_.back();
+  }
+
+  // Emit the JSON report on stdout
+  void report() const {
+    std::printf("{\n  \"suite\": \"%s\",\n  \"version\": \"%s\",\n  \"results\": [\n",
+                name_.c_str(), HLV_VERSION);
+    for (size_t i = 0; i < results_.size(); ++i) {
+      const Result& r = results_[i];
+      std::printf("    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.3f, \"ops_per_s\": %.1f",
+                  r.name.c_str(), static_cast<unsigned long long>(r.iterations), r.ns_per_op, r.ops_per_s);
+      for (const auto& kv : r.extra) {
+        std::printf(", \"%s\": %.6g", kv.first.c_str(), kv.second);
+      }
+      std::printf("}%s\n", i + 1 < results_.size() ? "," : "");
+    }
+    std::printf("  ]\n}\n");
+  }
+
+private:
+  std::string name_;
+  double min_time_s_;
+  std::vector<Result> results_;
+};
+
+// Deterministic input stream: 1 kHz triangle wave at ±0.1 °C/s, which
+// stays below the default gradient limit and never persists, so it ALLOWs
+inline PhaseSignals syntheticSignal(uint64_t i, double dt_s = 0.001) {
+  const uint64_t k = i % 2000;
+  const double tri = static_cast<double>(k < 1000 ? k : 2000 - k);
+  PhaseSignals s;
+  s.t_s = static_cast<double>(i) * dt_s;
+  s.temp_C = 30.0 + 1e-4 * tri;
+  s.temp_ambient_C = 22.0;
+  s.hysteresis_index = 0.3;
+  s.coherence_index = 0.6;
+  s.valid = true;
+  return s;
+}
+
+} // namespace bench
+} // namespace hlv
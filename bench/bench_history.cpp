@@ -0,0 +1,124 @@
+// Benchmarks for the compressed long-horizon history tier
+//
+// Cases (each reports bytes_per_sample and ratio vs sizeof(ReadinessSnapshot)):
+// - compress_sensor_hold: 1 kHz loop over a 1/128 °C sensor converting at
+//   16 Hz (values held between conversions), 10 Hz coherence updates and
+//   up to 50 µs of loop jitter: the realistic deployment shape
+// - compress_synthetic: bench_common's triangle wave (unquantized ramp)
+// - compress_noisy: full-precision random temperature on every sample,
+//   the worst case for XOR coding
+// - decode_sensor_hold: per-sample cost of decoding whole blocks
+//
+// compress_* timings include generating the sample with evaluate().
+
+#include "bench_common.hpp"
+#include "hlv/history_store.hpp"
+
+#include <cmath>
+
+using namespace hlv;
+using namespace hlv::bench;
+
+namespace {
+
+enum class Trace { SENSOR_HOLD, SYNTHETIC, NOISY };
+
+struct TraceSource {
+  explicit TraceSource(Trace kind) : kind_(kind), mw_(PhaseReadinessConfig{}), lcg_(88172645463325252ull) {}
+
+  ReadinessSnapshot next(uint64_t i) {
+    lcg_ = lcg_ * 6364136223846793005ull + 1442695040888963407ull;
+    PhaseSignals s = syntheticSignal(i);
+    if (kind_ == Trace::SENSOR_HOLD) {
+      const uint64_t conversion = i / 64;
+      s.temp_C = std::round((30.0 + 0.5 * std::sin(conversion * 0.002)) * 128.0) / 128.0;
+      s.coherence_index = 0.6 + 0.01 * static_cast<double>((i / 100) % 5);
+    } else if (kind_ == Trace::NOISY) {
+      s.temp_C = 30.0 + static_cast<double>(lcg_ >> 11) * 0x1.0p-53 * 0.01;
+    }
+    const PhaseReadinessOutput o = mw_.evaluate(s);
+
+    ReadinessSnapshot snap;
+    snap.timestamp = std::chrono::steady_clock::time_point(
+        std::chrono::microseconds(1000 * i + static_cast<int64_t>((lcg_ >> 32) % 50)));
+    snap.t_s = s.t_s;
+    snap.readiness = o.readiness;
+    snap.gate = o.gate;
+    snap.flags = o.flags;
+    snap.temp_C = s.temp_C;
+    snap.temp_ambient_C = s.temp_ambient_C;
+    snap.dTdt_C_per_s = o.dTdt_C_per_s;
+    snap.trend_C = o.trend_C;
+    snap.stability_score = o.stability_score;
+    snap.hysteresis_index = s.hysteresis_index;
+    snap.coherence_index = s.coherence_index;
+    return snap;
+  }
+
+  Trace kind_;
+  PhaseReadinessMiddleware mw_;
+  uint64_t lcg_;
+};
+
+CompressedHistoryConfig benchConfig() {
+  CompressedHistoryConfig cfg;
+  cfg.max_samples = uint64_t(1) << 30;
+  return cfg;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  Suite suite("history", argc, argv);
+
+  const struct { const char* name; Trace kind; } traces[] = {
+    {"compress_sensor_hold", Trace::SENSOR_HOLD},
+    {"compress_synthetic", Trace::SYNTHETIC},
+    {"compress_noisy", Trace::NOISY},
+  };
+
+  for (const auto& t : traces) {
+    CompressedHistory history(benchConfig());
+    TraceSource source(t.kind);
+    uint64_t base = 0;
+    Result& r = suite.run(t.name, [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i) {
+        history.append(source.next(base + i));
+      }
+      base += n;
+    });
+    const CompressedHistoryStats stats = history.stats();
+    r.extra.push_back({"bytes_per_sample", stats.bytes_per_sample});
+    r.extra.push_back({"ratio", stats.bytes_per_sample > 0.0
+                                    ? static_cast<double>(sizeof(ReadinessSnapshot)) / stats.bytes_per_sample
+                                    : 0.0});
+  }
+
+  {
+    CompressedHistory history(benchConfig());
+    TraceSource source(Trace::SENSOR_HOLD);
+    for (uint64_t i = 0; i < 64 * 4096; ++i) {
+      history.append(source.next(i));
+    }
+    const auto blocks = history.blocksInRange(-1e300, 1e300);
+    std::vector<ReadinessSnapshot> out;
+    out.reserve(4096);
+    // Whole blocks per batch, recorded per decoded sample
+    uint64_t decoded = 0;
+    const auto start = std::chrono::steady_clock::now();
+    double elapsed_s = 0.0;
+    while (elapsed_s < suite.minTimeSeconds()) {
+      for (const auto& block : blocks) {
+        out.clear();
+        CompressedHistory::decodeBlock(*block, history.config(), out);
+        decoded += out.size();
+        doNotOptimize(out.data());
+      }
+      elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    suite.record("decode_sensor_hold", decoded, elapsed_s);
+  }
+
+  suite.report();
+  return 0;
+}
@@ -0,0 +1,228 @@
+// Benchmarks for PhaseReadinessMiddleware::evaluate()
+//
+// Cases:
+// - evaluate_steady_state: valid 1 kHz stream, normal (ALLOW) path
+// - evaluate_failsafe_invalid: invalid input, early fail-safe return
+// - evaluate_failsafe_stale: sample gap above max_dt_s
+// - evaluate_bootstrap: reset() + first sample on every iteration
+// - evaluate_4096_channels_3_policies: round-robin sweep over 4096
+//   channels sharing 3 interned policies (ns/op is per channel
+//   evaluation; reports bytes of middleware state per channel)
+// - evaluate_4096_channels_3_policies_embedded: the same sweep with a
+//   policy copy embedded in every channel, the layout before interning
+//   (baseline for the case above)
+// - shadow_1p_4s / separate_5_middlewares: one primary plus 4 shadow
+//   policies (3 threshold-only, 1 with its own EWMA) per sample through
+//   ShadowEvaluator, against 5 independent middlewares counting the same
+//   gate confusion matrices (ns/op per sample)
+// - sweep_240_configs / replay_240_configs: a 240-config grid over one
+//   stream through PolicySweep, against one middleware per config counting
+//   the same gate statistics (ns/op is per sample; reports ns per
+//   config-sample)
+// - tick_10k_channels_<W>w: TickScheduler::runTick() over 10k channels
+//   with W workers (ns/op is per tick; reports deadline misses at 1 ms and
+//   steals per tick)
+
+#include "bench_common.hpp"
+#include "hlv/policy_sweep.hpp"
+#include "hlv/shadow_evaluator.hpp"
+#include "hlv/tick_scheduler.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace hlv;
+using namespace hlv::bench;
+
+namespace {
+
+// Per-channel layout before policies were shared: each channel carries
+// its own compiled config next to its trend state
+struct EmbeddedPolicyChannel {
+  CompiledPolicy policy;
+  TrendState state;
+
+  explicit EmbeddedPolicyChannel(const PhaseReadinessConfig& cfg) : policy(CompiledPolicy::compile(cfg)) {}
+
+  PhaseReadinessOutput evaluate(const PhaseSignals& in) {
+    return PhaseReadinessMiddleware::decide(policy, in, PhaseReadinessMiddleware::advance(policy, state, in));
+  }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+  Suite suite("middleware", argc, argv);
+
+  suite.run("evaluate_steady_state", [](uint64_t n) {
+    PhaseReadinessMiddleware mw(PhaseReadinessConfig{});
+    for (uint64_t i = 0; i < n; ++i) {
+      PhaseReadinessOutput out = mw.evaluate(syntheticSignal(i));
+      doNotOptimize(out);
+    }
+  });
+
+  suite.run("evaluate_failsafe_invalid", [](uint64_t n) {
+    PhaseReadinessMiddleware mw(PhaseReadinessConfig{});
+    for (uint64_t i = 0; i < n; ++i) {
+      PhaseSignals s = syntheticSignal(i);
+      s.valid = false;
+      PhaseReadinessOutput out = mw.evaluate(s);
+      doNotOptimize(out);
+    }
+  });
+
+  suite.run("evaluate_failsafe_stale", [](uint64_t n) {
+    PhaseReadinessMiddleware mw(PhaseReadinessConfig{});
+    mw.evaluate(syntheticSignal(0, 2.0));
+    for (uint64_t i = 1; i <= n; ++i) {
+      PhaseReadinessOutput out = mw.evaluate(syntheticSignal(i, 2.0)); // dt = 2 s > max_dt_s
+      doNotOptimize(out);
+    }
+  });
+
+  suite.run("evaluate_bootstrap", [](uint64_t n) {
+    PhaseReadinessMiddleware mw(PhaseReadinessConfig{});
+    for (uint64_t i = 0; i < n; ++i) {
+      mw.reset();
+      PhaseReadinessOutput out = mw.evaluate(syntheticSignal(i));
+      doNotOptimize(out);
+    }
+  });
+
+  {
+    const size_t channels = 4096;
+    PhaseReadinessConfig policies[3];
+    policies[1].gate_allow_threshold = 0.85;
+    policies[2].max_abs_dTdt_C_per_s = 0.5;
+    std::vector<PhaseReadinessMiddleware> mws;
+    std::vector<EmbeddedPolicyChannel> embedded;
+    mws.reserve(channels);
+    embedded.reserve(channels);
+    for (size_t id = 0; id < channels; ++id) {
+      mws.emplace_back(CompiledPolicy::intern(policies[id % 3]));
+      embedded.emplace_back(policies[id % 3]);
+    }
+    auto sweep = [](auto& chans, uint64_t n) {
+      PhaseSignals s = syntheticSignal(0);
+      for (uint64_t i = 0; i < n; ++i) {
+        const size_t id = i % chans.size();
+        if (id == 0) s = syntheticSignal(i / chans.size());
+        PhaseReadinessOutput out = chans[id].evaluate(s);
+        doNotOptimize(out);
+      }
+    };
+    Result& r = suite.run("evaluate_4096_channels_3_policies", [&](uint64_t n) { sweep(mws, n); });
+    r.extra.emplace_back("bytes_per_channel", static_cast<double>(sizeof(PhaseReadinessMiddleware)));
+    Result& e = suite.run("evaluate_4096_channels_3_policies_embedded", [&](uint64_t n) { sweep(embedded, n); });
+    e.extra.emplace_back("bytes_per_channel", static_cast<double>(sizeof(EmbeddedPolicyChannel)));
+  }
+
+  {
+    PhaseReadinessConfig shadows[4];
+    shadows[0].gate_allow_threshold = 0.75;
+    shadows[1].gate_caution_threshold = 0.5;
+    shadows[2].max_abs_dTdt_C_per_s = 0.2;
+    shadows[3].ewma_alpha = 0.3;
+    suite.run("shadow_1p_4s", [&](uint64_t n) {
+      ShadowEvaluator shadow{PhaseReadinessConfig{}};
+      for (size_t k = 0; k < 4; ++k) shadow.addShadow("s" + std::to_string(k), shadows[k]);
+      for (uint64_t i = 0; i < n; ++i) {
+        PhaseReadinessOutput out = shadow.evaluate(syntheticSignal(i));
+        doNotOptimize(out);
+      }
+    });
+    suite.run("separate_5_middlewares", [&](uint64_t n) {
+      std::vector<PhaseReadinessMiddleware> mws(1, PhaseReadinessMiddleware(PhaseReadinessConfig{}));
+      for (size_t k = 0; k < 4; ++k) mws.emplace_back(shadows[k]);
+      uint64_t confusion[4][3][3] = {};
+      for (uint64_t i = 0; i < n; ++i) {
+        const PhaseSignals s = syntheticSignal(i);
+        const PhaseReadinessOutput primary = mws[0].evaluate(s);
+        for (size_t k = 1; k < mws.size(); ++k) {
+          const PhaseReadinessOutput out = mws[k].evaluate(s);
+          ++confusion[k - 1][static_cast<size_t>(primary.gate)][static_cast<size_t>(out.gate)];
+        }
+        doNotOptimize(primary);
+      }
+      doNotOptimize(confusion);
+    });
+  }
+
+  {
+    SweepAxes axes;
+    axes.max_abs_dTdt_C_per_s = {0.05, 0.1, 0.25, 0.5};
+    axes.persistence_s = {1.0, 3.0, 10.0};
+    axes.ewma_alpha = {0.05, 0.1, 0.2, 0.4, 0.8};
+    axes.gate_allow_threshold = {0.7, 0.8};
+    axes.gate_caution_threshold = {0.3, 0.5};
+    const PhaseReadinessConfig baseline;
+    const std::vector<PhaseReadinessConfig> grid = PolicySweep::grid(baseline, axes);
+    const double configs = static_cast<double>(grid.size());
+    std::vector<PhaseSignals> block(4096);
+    auto fill = [&block](uint64_t first, size_t count) {
+      for (size_t i = 0; i < count; ++i) block[i] = syntheticSignal(first + i);
+    };
+
+    Result& sweep = suite.run("sweep_240_configs", [&](uint64_t n) {
+      PolicySweep ps(baseline, grid);
+      for (uint64_t done = 0; done < n; done += block.size()) {
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(block.size(), n - done));
+        fill(done, count);
+        ps.run(block.data(), count);
+      }
+      doNotOptimize(ps.result(grid.size() - 1).disagreements);
+    });
+    sweep.extra.emplace_back("ns_per_config_sample", sweep.ns_per_op / configs);
+
+    Result& replay = suite.run("replay_240_configs", [&](uint64_t n) {
+      PhaseReadinessMiddleware base(baseline);
+      std::vector<PhaseReadinessMiddleware> mws;
+      for (const PhaseReadinessConfig& cfg : grid) mws.emplace_back(cfg);
+      std::vector<SweepResult> results(grid.size());
+      std::vector<Gate> base_gates(block.size());
+      for (uint64_t done = 0; done < n; done += block.size()) {
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(block.size(), n - done));
+        fill(done, count);
+        for (size_t i = 0; i < count; ++i) base_gates[i] = base.evaluate(block[i]).gate;
+        for (size_t k = 0; k < mws.size(); ++k) {
+          for (size_t i = 0; i < count; ++i) {
+            const Gate g = mws[k].evaluate(block[i]).gate;
+            ++results[k].gate_counts[static_cast<size_t>(g)];
+            results[k].disagreements += g != base_gates[i];
+          }
+        }
+      }
+      doNotOptimize(results.back().disagreements);
+    });
+    replay.extra.emplace_back("ns_per_config_sample", replay.ns_per_op / configs);
+  }
+
+  std::vector<size_t> worker_counts = {1};
+  const size_t pool = std::min<size_t>(4, std::max(1u, std::thread::hardware_concurrency()));
+  if (pool > 1) worker_counts.push_back(pool);
+  for (size_t workers : worker_counts) {
+    const size_t channels = 10000;
+    TickSchedulerConfig tc;
+    tc.workers = workers;
+    TickScheduler scheduler(PhaseReadinessConfig{}, channels, nullptr, tc);
+    scheduler.start();
+    std::vector<PhaseSignals> signals(channels);
+    uint64_t tick = 0;
+    uint64_t steals = 0;
+    Result& r = suite.run("tick_10k_channels_" + std::to_string(workers) + "w", [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i, ++tick) {
+        std::fill(signals.begin(), signals.end(), syntheticSignal(tick));
+        scheduler.runTick(signals);
+        steals += scheduler.lastTick().steals;
+      }
+    });
+    scheduler.stop();
+    r.extra.emplace_back("deadline_misses", static_cast<double>(scheduler.deadlineMissCount()));
+    r.extra.emplace_back("steals_per_tick", static_cast<double>(steals) / static_cast<double>(std::max<uint64_t>(1, tick)));
+  }
+
+  suite.report();
+  return 0;
+}
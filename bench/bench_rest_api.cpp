@@ -0,0 +1,106 @@
+// Benchmarks for the REST API server
+//
+// Cases:
+// - render_<endpoint>: JSON/text body rendering per handler, no socket
+// - http_readiness_loopback: full GET round trip (connect, request,
+//   response, close) over 127.0.0.1
+// - http_readiness_loopback_304: same, revalidated with If-None-Match
+
+#include "bench_common.hpp"
+#include "hlv/rest_api_server.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace hlv;
+using namespace hlv::bench;
+
+static constexpr uint16_t kBenchPort = 18080;
+
+static std::string httpRoundTrip(const std::string& request) {
+  int sock = socket(AF_INET, SOCK_STREAM, 0);
+  if (sock < 0) return std::string();
+  struct sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(kBenchPort);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  std::string response;
+  if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+    send(sock, request.data(), request.size(), 0);
+    char buffer[8192];
+    ssize_t n;
+    while ((n = recv(sock, buffer, sizeof(buffer), 0)) > 0) {
+      response.append(buffer, static_cast<size_t>(n));
+    }
+  }
+  close(sock);
+  return response;
+}
+
+int main(int argc, char** argv) {
+  Suite suite("rest_api", argc, argv);
+
+  ReadinessAPIState state;
+  PhaseReadinessMiddleware mw(PhaseReadinessConfig{});
+  for (uint64_t i = 0; i < 1000; ++i) {
+    const PhaseSignals s = syntheticSignal(i);
+    state.update(s, mw.evaluate(s));
+  }
+
+  RestAPIConfig config;
+  config.port = kBenchPort;
+  config.bind_address = "127.0.0.1";
+  RestAPIServer server(state, config);
+
+  const char* endpoints[] = {
+    "/health", "/api/readiness", "/api/thermal", "/api/history",
+    "/api/phase_context", "/api/diagnostics", "/metrics",
+  };
+  for (const char* target : endpoints) {
+    std::string name = std::string("render") + target;
+    for (char& c : name) {
+      if (c == '/') c = '_';
+    }
+    Result& r = suite.run(name, [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i) {
+        doNotOptimize(server.renderBody(target).size());
+      }
+    });
+    r.extra.emplace_back("body_bytes", static_cast<double>(server.renderBody(target).size()));
+  }
+
+  if (!server.start()) {
+    std::fprintf(stderr, "port %u unavailable; skipping loopback cases\n", kBenchPort);
+    suite.report();
+    return 0;
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  const std::string plain = "GET /api/readiness HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  suite.run("http_readiness_loopback", [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i) {
+      doNotOptimize(httpRoundTrip(plain).size());
+    }
+  });
+
+  const std::string first = httpRoundTrip(plain);
+  const size_t tag_pos = first.find("ETag: ");
+  if (tag_pos != std::string::npos) {
+    const std::string etag = first.substr(tag_pos + 6, first.find("\r\n", tag_pos) - tag_pos - 6);
+    const std::string conditional = "GET /api/readiness HTTP/1.1\r\nHost: localhost\r\nIf-None-Match: " +
+                                    etag + "\r\n\r\n";
+    suite.run("http_readiness_loopback_304", [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; ++i) {
+        doNotOptimize(httpRoundTrip(conditional).size());
+      }
+    });
+  }
+
+  server.stop();
+  suite.report();
+  return 0;
+}
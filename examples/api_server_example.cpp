@@ -1,6 +1,8 @@
 // Example server demonstrating HLV Phase Readiness REST API
 // This example simulates a readiness inference loop and exposes the data via REST API
 
+#include "hlv/audit_log.hpp"
+#include "hlv/ingest_pipeline.hpp"
 #include "hlv/phase_readiness.hpp"
 #include "hlv/rest_api_server.hpp"
 
@@ -16,14 +18,20 @@ int main() {
   std::cout << "HLV Phase Readiness REST API Server Example\n";
   std::cout << "============================================\n\n";
   
-  // Create middleware instance
+  // Middleware configuration
   PhaseReadinessConfig config;
   config.temp_min_C = 15.0;
   config.temp_max_C = 45.0;
   config.max_abs_dTdt_C_per_s = 0.25;
   config.persistence_s = 3.0;
   
-  PhaseReadinessMiddleware middleware(config);
+  // Audit log of every decision (written off-thread to ./hlv_audit_*.trace)
+  AuditLogConfig audit_config;
+  audit_config.readiness_config = config;
+  AuditLogger audit_log(audit_config);
+  if (!audit_log.start()) {
+    std::cerr << "Audit log disabled: " << audit_log.lastError() << "\n";
+  }
   
   // Create API state
   ReadinessAPIState api_state;
@@ -36,6 +44,12 @@ int main() {
   
   RestAPIServer api_server(api_state, api_config);
   
+  // Evaluation and publication run on the ingest pipeline's evaluator
+  // thread; this loop only acquires and submits samples
+  IngestPipeline pipeline(config, &api_state, &audit_log);
+  api_server.setMetricsHook([&pipeline](std::ostream& out) { pipeline.render(out); });
+  pipeline.start();
+  
   std::cout << "Starting REST API server on " << api_config.bind_address 
             << ":" << api_config.port << "...\n";
   
@@ -53,6 +67,7 @@ int main() {
   std::cout << "  GET http://localhost:8080/api/history\n";
   std::cout << "  GET http://localhost:8080/api/phase_context\n";
   std::cout << "  GET http://localhost:8080/api/diagnostics\n";
+  std::cout << "  GET http://localhost:8080/metrics\n";
   std::cout << "\nPress Ctrl+C to stop.\n\n";
   
   // Simulated readiness inference loop
@@ -78,14 +93,12 @@ int main() {
       signals.hysteresis_index = 0.3 + 0.2 * std::sin(time_s * 0.2);
     }
     
-    // Evaluate readiness
-    PhaseReadinessOutput output = middleware.evaluate(signals);
-    
-    // Update API state
-    api_state.update(signals, output);
+    // Queue for evaluation; never blocks or takes a lock
+    pipeline.submit(signals);
     
-    // Log to console every 10 cycles
+    // Log the latest published result to the console every 10 cycles
     if (cycle % 10 == 0) {
+      const ReadinessSnapshot output = api_state.getCurrentSnapshot();
       std::cout << "[t=" << std::fixed << std::setprecision(1) << time_s << "s] ";
       std::cout << "T=" << std::setprecision(2) << temp_C << "°C, ";
       std::cout << "R=" << std::setprecision(3) << output.readiness << ", ";
@@ -109,7 +122,9 @@ int main() {
   }
   
   // Cleanup (unreachable in this example)
+  pipeline.stop();
   api_server.stop();
+  audit_log.stop();
   
   return 0;
 }
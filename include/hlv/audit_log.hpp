@@ -0,0 +1,118 @@
+#pragma once
+
+// Asynchronous append-only audit log for readiness decisions
+//
+// The readiness loop hands every (signals, output) pair to log(), which is
+// a bounded enqueue into a lock-free SPSC ring. A background thread drains
+// the ring into trace-format segments (see trace.hpp), so every segment is
+// a valid, CRC-checked trace that hlv_replay can verify directly.
+//
+// DESIGN:
+// - Hot path: one ring push, no syscalls, no locks, no allocation. If the
+//   disk falls behind and the ring is full, the record is dropped and
+//   counted; the loop is never blocked.
+// - Group commit: the writer seals the pending block and calls
+//   fdatasync() once per commit_interval_ms, so a crash loses at most one
+//   interval of records and never corrupts committed blocks.
+// - Rotation: a new segment is started once the current one reaches
+//   max_segment_bytes. Segments are named <prefix>_<index>.trace.
+//
+// SAFETY:
+// - log() must be called from a single thread (the readiness loop)
+// - Audit logging is observability only; failures are reported through
+//   the counters and lastError(), never back into the decision path
+
+#include "hlv/phase_readiness.hpp"
+#include "hlv/spsc_ring.hpp"
+#include "hlv/trace.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace hlv {
+
+struct AuditLogConfig {
+  std::string directory = ".";
+  std::string prefix = "hlv_audit";
+
+  size_t queue_capacity = 65536;           // Records buffered between loop and writer
+  uint32_t block_records = 1024;           // Maximum records per checksummed block
+  uint32_t commit_interval_ms = 100;       // Group commit (fdatasync) interval
+  uint64_t max_segment_bytes = 64ull << 20; // Rotate once a segment reaches this size
+
+  PhaseReadinessConfig readiness_config;   // Recorded in every segment header
+};
+
+// One queued decision
+struct AuditRecord {
+  PhaseSignals signals;
+  PhaseReadinessOutput output;
+};
+
+class AuditLogger {
+public:
+  explicit AuditLogger(const AuditLogConfig& config = AuditLogConfig{});
+  ~AuditLogger();
+
+  AuditLogger(const AuditLogger&) = delete;
+  AuditLogger& operator=(const AuditLogger&) = delete;
+
+  // Open the first segment and start the writer thread
+  bool start();
+
+  // Drain the queue, commit and close the current segment
+  void stop();
+
+  bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+  // Hot path: enqueue one decision. Returns false (and counts a drop) if
+  // the queue is full.
+  bool log(const PhaseSignals& signals, const PhaseReadinessOutput& output);
+
+  // Counters (safe to read from any thread)
+  uint64_t enqueuedCount() const { return enqueued_.load(std::memory_order_relaxed); }
+  uint64_t droppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+  uint64_t writtenCount() const { return written_.load(std::memory_order_relaxed); }
+  uint64_t writeErrorCount() const { return write_errors_.load(std::memory_order_relaxed); }
+  uint64_t commitCount() const { return commits_.load(std::memory_order_relaxed); }
+  uint64_t segmentCount() const { return segments_.load(std::memory_order_relaxed); }
+  size_t queueDepth() const { return queue_.size(); }
+
+  // Last I/O error reported by the writer thread (empty if none)
+  std::string lastError() const;
+
+  // Path of segment `index` (1-based)
+  std::string segmentPath(uint64_t index) const;
+
+private:
+  void writerLoop();
+  bool openSegment();
+  bool commit();
+  void setError(const std::string& message);
+
+  AuditLogConfig config_;
+  SpscRing<AuditRecord> queue_;
+
+  std::atomic<bool> running_;
+  std::atomic<bool> should_stop_;
+  std::thread writer_thread_;
+
+  TraceWriter writer_;                 // Owned by the writer thread while running
+  uint64_t segment_index_;
+  uint64_t uncommitted_;
+
+  std::atomic<uint64_t> enqueued_;     // Producer-owned
+  std::atomic<uint64_t> dropped_;      // Producer-owned
+  std::atomic<uint64_t> written_;      // Writer-owned
+  std::atomic<uint64_t> write_errors_; // Writer-owned: records lost to I/O errors
+  std::atomic<uint64_t> commits_;
+  std::atomic<uint64_t> segments_;
+
+  mutable std::mutex error_mutex_;
+  std::string error_;
+};
+
+} // namespace hlv
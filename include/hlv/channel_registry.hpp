@@ -0,0 +1,250 @@
+#pragma once
+
+// Registry of independently updated readiness channels
+//
+// Multi-electrode arrays run one PhaseReadinessMiddleware per channel.
+// ChannelRegistry holds one ReadinessAPIState per channel so each channel
+// keeps its own current snapshot, history, rollups and transition log, and
+// RestAPIServer routes /api/channels/{id}/... to it.
+//
+// update() also feeds a GateAggregationTree, so "minimum readiness across
+// the array" and "is any channel in group G blocked?" are answered from
+// maintained summaries (root in O(1), a group in O(log N)) instead of a
+// scan over every channel. Groups are named contiguous channel ranges
+// (e.g. one shank of an electrode array).
+//
+// It also keeps two indexed min-heaps over channels, keyed on readiness
+// and on the t_s at which the current BLOCK run started, so "the K
+// channels with the lowest readiness / longest BLOCK dwell" costs
+// O(K log K) per query and O(log N) per changed channel instead of a sort.
+//
+// The tree and heaps are not touched by update(): it records the
+// channel's latest output in its own slot and sets the channel's dirty
+// bit. Dirty channels are folded into the tree and heaps (O(log N) each)
+// once per tick by commitEpoch(), and by any summary or ranking query
+// before it answers, so queries always reflect every completed update.
+//
+// EPOCHS: channels updated independently can be read mid-tick, mixing
+// samples from different ticks. A producer that wants readers to see
+// whole ticks brackets each tick's updates with beginEpoch() and
+// commitEpoch(); snapshotEpoch() then returns every channel as of the
+// last committed epoch. Each channel keeps two epoch-tagged versions of
+// its latest output in a contiguous table of 64-byte cells; an update in
+// epoch W overwrites the version older than the newest one at or below
+// W - 1, so the version a reader of epoch W - 1 needs stays intact until
+// epoch W + 1 begins. Readers copy without a lock and retry (seqlock
+// style) only if the producer began two epochs past theirs meanwhile.
+//
+// DESIGN:
+// - The channel set is fixed at construction (ids 0..size()-1), so lookup
+//   is a bounds check plus a vector index and needs no registry lock
+// - Each channel lives in its own 64-byte aligned slot whose size is a
+//   whole number of cache lines, so writers of neighbouring channels never
+//   share a line; each channel's mutex guards only that channel
+// - The only shared structures on the update path are the lock-free
+//   dirty bitmap (one bit per channel, set with at most two atomic ORs on
+//   words covering 64 and 4096 channels) and the epoch cells. Writers
+//   never take aggregate_mutex_; folding scans one bitmap word per 4096
+//   channels plus the dirty channels
+// - BLOCK dwell is ranked by BLOCK start time, which orders channels by
+//   dwell exactly when they share a timebase; each reported dwell is the
+//   channel's own latest finite t_s minus its BLOCK start. A BLOCK run
+//   starts at its first finite t_s (invalid inputs may carry NaN), so a
+//   channel blocked only on non-finite timestamps is not ranked by dwell
+//
+// NUMA: each channel's state is its own allocation, so placeChannels()
+// can rebuild an untouched channel range, with its configuration, from the
+// thread that will own it (e.g. a TickScheduler worker pinned to another
+// socket) and first-touch places that state on the owner's node.
+//
+// SAFETY:
+// - placeChannels() replaces channel objects: call it before the registry
+//   is shared with any reader or writer (e.g. before RestAPIServer::start());
+//   disjoint ranges may be placed concurrently
+// - beginEpoch()/commitEpoch() are called by one coordinating thread; the
+//   channel updates of an epoch may run on other threads but must happen
+//   after beginEpoch() returns and before commitEpoch() is called (e.g.
+//   behind a barrier)
+// - Each channel must be updated by a single writer thread at a time
+//   (the same contract as ReadinessAPIState::update()); different channels
+//   may be updated concurrently from different threads
+// - Updates made directly through channel(id) bypass the aggregation tree;
+//   use update() for channels that should appear in summaries
+
+#include "hlv/gate_aggregation.hpp"
+#include "hlv/indexed_heap.hpp"
+#include "hlv/phase_readiness.hpp"
+#include "hlv/rest_api_server.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace hlv {
+
+// Named contiguous channel range [first, first + count)
+struct ChannelGroup {
+  std::string name;
+  size_t first = 0;
+  size_t count = 0;
+};
+
+enum class ChannelRankBy : uint8_t {
+  READINESS = 0,     // Lowest readiness first (non-finite readiness excluded)
+  BLOCK_DWELL = 1    // Longest current BLOCK run first (BLOCK channels only)
+};
+
+const char* channelRankByToString(ChannelRankBy by);
+
+// Latest state of one ranked channel
+struct ChannelRank {
+  size_t id = 0;
+  double readiness = 0.0;
+  Gate gate = Gate::BLOCK;
+  uint32_t flags = 0;
+  double t_s = 0.0;
+  double block_dwell_s = 0.0;   // NaN unless gate == BLOCK
+};
+
+// One channel as of a committed epoch
+struct EpochChannel {
+  double readiness = 0.0;
+  double t_s = 0.0;
+  uint32_t flags = 0;
+  Gate gate = Gate::BLOCK;
+  bool reported = false;   // False if the channel has no update at or before the epoch
+};
+
+// Consistent cut of every channel
+struct EpochSnapshot {
+  uint64_t epoch = 0;   // 0: nothing committed yet
+  std::vector<EpochChannel> channels;
+};
+
+class ChannelRegistry {
+public:
+  // `history_samples`: recent history kept per channel
+  explicit ChannelRegistry(size_t channels, size_t history_samples = 100);
+
+  ChannelRegistry(const ChannelRegistry&) = delete;
+  ChannelRegistry& operator=(const ChannelRegistry&) = delete;
+
+  size_t size() const { return slots_.size(); }
+
+  // O(1); nullptr if `id` is out of range
+  ReadinessAPIState* channel(size_t id) { return id < slots_.size() ? &slots_[id]->state : nullptr; }
+  const ReadinessAPIState* channel(size_t id) const {
+    return id < slots_.size() ? &slots_[id]->state : nullptr;
+  }
+
+  // Reallocate channels [first, first + count) from the calling thread,
+  // keeping each channel's configuration (history size, compressed tier,
+  // rollups, transition log, quantile windows). Returns false (changing
+  // nothing) if the range is out of bounds or a channel in it has been
+  // updated. Pointers from channel() to the range are invalidated.
+  bool placeChannels(size_t first, size_t count);
+
+  // Update one channel; false if `id` is out of range. Lock-free with
+  // respect to other channels.
+  bool update(size_t id, const PhaseSignals& signals, const PhaseReadinessOutput& output);
+
+  // Replace the channel groups. Returns false (keeping the old groups) if a
+  // name is empty or repeated, or a range is empty or out of bounds.
+  // Groups may overlap.
+  bool setGroups(const std::vector<ChannelGroup>& groups);
+  std::vector<ChannelGroup> groups() const;
+
+  // Summary of every channel (O(1))
+  GateSummary summary() const;
+
+  // Summary of channels [first, first + count) (O(log N))
+  GateSummary summary(size_t first, size_t count) const;
+
+  // Summary of a named group; false if there is no such group
+  bool groupSummary(const std::string& name, GateSummary& out) const;
+
+  // Up to `k` worst channels by `by`, worst first (O(K log K))
+  std::vector<ChannelRank> worstChannels(size_t k, ChannelRankBy by) const;
+
+  // Open the next epoch and return its number; update() calls until
+  // commitEpoch() belong to it. Returns the open epoch if one is open.
+  uint64_t beginEpoch();
+
+  // Fold the epoch's channel updates into the summaries, publish the open
+  // epoch to snapshotEpoch() readers and return it (returns
+  // committedEpoch() if no epoch is open)
+  uint64_t commitEpoch();
+
+  uint64_t committedEpoch() const { return committed_epoch_.load(std::memory_order_acquire); }
+
+  // Copy every channel as of the last committed epoch, without blocking
+  // the producer. Returns false if the producer advanced two epochs during
+  // each of `max_attempts` copies (`out` is then unspecified).
+  bool snapshotEpoch(EpochSnapshot& out, int max_attempts = 8) const;
+
+private:
+  // Latest output per channel, as ranked
+  struct Latest {
+    double readiness = 0.0;
+    double t_s = 0.0;
+    double block_since_s = 0.0;   // First finite t_s of the BLOCK run (NaN until seen)
+    double block_last_s = 0.0;    // Latest finite t_s of the BLOCK run
+    uint32_t flags = 0;
+    Gate gate = Gate::ALLOW;
+    bool reported = false;
+  };
+
+  struct alignas(64) Slot {
+    ReadinessAPIState state;
+    std::mutex latest_mutex;   // Guards latest: the writer vs. a folding reader
+    Latest latest;
+  };
+
+  std::vector<std::unique_ptr<Slot>> slots_;
+
+  void markDirty(size_t id);
+
+  // Apply every dirty channel's latest output to the tree and heaps;
+  // caller holds aggregate_mutex_
+  void foldDirty() const;
+
+  // Dirty bitmap: bit (id % 64) of dirty_words_[id / 64] marks channel id,
+  // bit (w % 64) of dirty_groups_[w / 64] marks a non-zero dirty_words_[w]
+  std::unique_ptr<std::atomic<uint64_t>[]> dirty_words_;
+  std::unique_ptr<std::atomic<uint64_t>[]> dirty_groups_;
+  size_t dirty_group_count_;
+
+  // Two epoch-tagged versions of one channel's latest output; fields are
+  // relaxed atomics so lock-free readers never race with the writer
+  struct alignas(64) EpochCell {
+    struct Version {
+      std::atomic<uint64_t> epoch{0};        // 0: never written
+      std::atomic<uint64_t> readiness{0};    // Bit pattern of the double
+      std::atomic<uint64_t> t_s{0};          // Bit pattern of the double
+      std::atomic<uint64_t> gate_flags{0};   // Gate << 32 | flags
+    };
+    Version versions[2];
+  };
+
+  void writeEpochCell(size_t id, uint64_t epoch, double t_s, const PhaseReadinessOutput& output);
+
+  std::unique_ptr<EpochCell[]> cells_;
+  std::atomic<uint64_t> open_epoch_;        // 0 while no epoch is open
+  std::atomic<uint64_t> begun_epoch_;       // Latest epoch opened (seqlock counter for readers)
+  std::atomic<uint64_t> committed_epoch_;
+
+  // Guards everything below. The summaries are folded in lazily, so
+  // const queries update them too.
+  mutable std::mutex aggregate_mutex_;
+  mutable GateAggregationTree tree_;
+  std::vector<ChannelGroup> groups_;
+  mutable std::vector<Latest> latest_;   // As folded into the heaps
+  mutable IndexedMinHeap by_readiness_;
+  mutable IndexedMinHeap by_block_since_;
+};
+
+} // namespace hlv
@@ -0,0 +1,139 @@
+#pragma once
+
+// Columnar in-memory history with vectorized aggregate queries
+//
+// Recent history is kept as one ring of struct-of-arrays columns instead
+// of a deque of ReadinessSnapshot, so an aggregate over one field streams
+// through a single dense array instead of striding over ~100-byte records.
+//
+// DESIGN:
+// - One 64-byte aligned array per field; gate is a uint8 column and flags
+//   a uint32 column
+// - The ring is split into fixed chunks, each with conservative t_s bounds.
+//   A range query skips chunks outside [from_t, to_t], runs the SIMD
+//   kernels over chunks entirely inside it and a masked scalar loop over
+//   the (at most two) boundary chunks. Correct for non-monotonic t_s.
+// - Kernels: SSE2 on x86-64 (baseline ISA, no runtime dispatch), scalar
+//   elsewhere. min/max skip NaN; sums propagate it.
+//
+// Not thread-safe; ReadinessAPIState serializes access under its mutex.
+
+#include "hlv/history_store.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace hlv {
+
+// min/max/sum of one field over a range
+struct FieldStats {
+  double min = std::numeric_limits<double>::infinity();
+  double max = -std::numeric_limits<double>::infinity();
+  double sum = 0.0;
+  double max_abs = 0.0;
+
+  double mean(uint64_t count) const { return count ? sum / static_cast<double>(count) : 0.0; }
+};
+
+// Aggregates over the samples with from_t <= t_s <= to_t
+struct HistoryStats {
+  uint64_t count = 0;
+  double first_t_s = std::numeric_limits<double>::infinity();   // Earliest t_s included
+  double last_t_s = -std::numeric_limits<double>::infinity();   // Latest t_s included
+  FieldStats readiness;
+  FieldStats dTdt_C_per_s;
+  FieldStats trend_C;
+  uint64_t gate_samples[3] = {0, 0, 0};   // Indexed by Gate
+  uint64_t flag_samples[32] = {};         // Samples with each PhaseFlags bit set
+};
+
+// 64-byte aligned, fixed-size array
+template <typename T>
+class AlignedColumn {
+public:
+  AlignedColumn() = default;
+  explicit AlignedColumn(size_t n)
+      : data_(static_cast<T*>(std::aligned_alloc(64, roundUp(n * sizeof(T))))) {}
+
+  T* data() { return data_.get(); }
+  const T* data() const { return data_.get(); }
+  T& operator[](size_t i) { return data_.get()[i]; }
+  const T& operator[](size_t i) const { return data_.get()[i]; }
+
+private:
+  struct Free {
+    void operator()(T* p) const { std::free(p); }
+  };
+  static size_t roundUp(size_t bytes) { return bytes == 0 ? 64 : (bytes + 63) / 64 * 64; }
+
+  std::unique_ptr<T, Free> data_;
+};
+
+class ColumnarHistory {
+public:
+  static constexpr size_t kChunkSamples = 1024;
+
+  explicit ColumnarHistory(size_t capacity = 100);
+
+  // Resize, keeping the newest min(size(), capacity) samples
+  void setCapacity(size_t capacity);
+  size_t capacity() const { return capacity_; }
+  size_t size() const { return size_; }
+
+  void append(const ReadinessSnapshot& snapshot);
+  void clear();
+
+  // i = 0 is the oldest retained sample
+  ReadinessSnapshot at(size_t i) const;
+
+  // Newest `max_count` samples, oldest first
+  void latest(size_t max_count, std::vector<ReadinessSnapshot>& out) const;
+
+  // Newest `max_count` samples with from_t <= t_s <= to_t that match
+  // `filter`, oldest first
+  void range(double from_t, double to_t, size_t max_count, std::vector<ReadinessSnapshot>& out,
+             const HistoryFilter& filter = HistoryFilter()) const;
+
+  HistoryStats stats(double from_t, double to_t) const;
+
+private:
+  struct ChunkBounds {
+    double min_t = std::numeric_limits<double>::infinity();
+    double max_t = -std::numeric_limits<double>::infinity();
+    void add(double t) {
+      if (t < min_t) min_t = t;
+      if (t > max_t) max_t = t;
+    }
+  };
+
+  size_t physical(size_t logical) const { return (head_ + logical) % capacity_; }
+  void allocate(size_t capacity);
+
+  size_t capacity_;
+  size_t size_;
+  size_t head_;        // Physical index of the oldest sample
+  size_t next_;        // Physical index written next
+
+  AlignedColumn<int64_t> timestamp_ns_;
+  AlignedColumn<double> t_s_;
+  AlignedColumn<double> readiness_;
+  AlignedColumn<double> temp_C_;
+  AlignedColumn<double> temp_ambient_C_;
+  AlignedColumn<double> dTdt_C_per_s_;
+  AlignedColumn<double> trend_C_;
+  AlignedColumn<double> stability_score_;
+  AlignedColumn<double> hysteresis_index_;
+  AlignedColumn<double> coherence_index_;
+  AlignedColumn<uint8_t> gate_;
+  AlignedColumn<uint32_t> flags_;
+
+  // Bounds of the samples written in each chunk's current pass, and of its
+  // previous pass (still partly live while the chunk is being overwritten)
+  std::vector<ChunkBounds> chunk_bounds_;
+  std::vector<ChunkBounds> prev_chunk_bounds_;
+};
+
+} // namespace hlv
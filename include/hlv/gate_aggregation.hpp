@@ -0,0 +1,77 @@
+#pragma once
+
+// Hierarchical gate aggregation over channels
+//
+// GateAggregationTree keeps, for every channel range of a segment tree,
+// the minimum readiness (and which channel holds it), the worst gate, the
+// OR of all flags and the number of channels in each gate. A channel
+// update rewrites one leaf and recombines its ancestors (O(log N)); the
+// whole array is the root (O(1)) and any contiguous channel range, such
+// as an electrode group, is at most 2 log N nodes.
+//
+// DESIGN:
+// - The tree is an implicit binary heap over a power-of-two leaf count;
+//   padding leaves and channels that have not reported yet are empty
+//   summaries and do not affect the result
+// - combine() is associative and commutative (ties on readiness go to the
+//   lower channel id), so range queries can fold nodes in any order; the
+//   empty summary is its identity, so it needs no emptiness branches
+// - A summary is 40 bytes, so a node pair spans at most two cache lines
+// - Non-finite readiness never becomes the minimum
+//
+// SAFETY:
+// - Not thread-safe; ChannelRegistry serializes access
+
+#include "hlv/phase_readiness.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace hlv {
+
+struct GateSummary {
+  static constexpr uint32_t kNoChannel = UINT32_MAX;
+
+  // Empty summaries are the identity of combine(): +inf readiness, ALLOW
+  double min_readiness = std::numeric_limits<double>::infinity();
+  uint32_t min_channel = kNoChannel;    // Channel holding min_readiness
+  uint32_t channels = 0;                // Channels that have reported
+  uint32_t flags = 0;                   // OR of every channel's flags
+  uint32_t gate_counts[3] = {0, 0, 0};  // Indexed by Gate
+  Gate worst_gate = Gate::ALLOW;        // Meaningful only if channels > 0
+
+  bool hasMin() const { return min_channel != kNoChannel; }
+  uint32_t count(Gate g) const { return gate_counts[static_cast<size_t>(g)]; }
+  bool anyBlocked() const { return count(Gate::BLOCK) > 0; }
+
+  // Summary of a single channel's latest output
+  static GateSummary channel(size_t id, double readiness, Gate gate, uint32_t flags);
+
+  // Summary of the union of two disjoint channel sets
+  static GateSummary combine(const GateSummary& a, const GateSummary& b);
+};
+
+class GateAggregationTree {
+public:
+  explicit GateAggregationTree(size_t channels = 0);
+
+  size_t size() const { return channels_; }
+
+  // O(log N). Ignored if `id` is out of range.
+  void update(size_t id, double readiness, Gate gate, uint32_t flags);
+
+  // O(1): every channel
+  const GateSummary& root() const { return nodes_[1]; }
+
+  // O(log N): channels [first, first + count), clamped to size()
+  GateSummary range(size_t first, size_t count) const;
+
+private:
+  size_t channels_;
+  size_t leaves_;                   // Power of two >= channels_
+  std::vector<GateSummary> nodes_;  // nodes_[1] is the root; leaves at [leaves_, 2 * leaves_)
+};
+
+} // namespace hlv
@@ -0,0 +1,329 @@
+#pragma once
+
+// Readiness history snapshots and the long-horizon history tiers
+//
+// The recent-history ring in ReadinessAPIState (ColumnarHistory) holds the
+// most recent samples verbatim. CompressedHistory keeps hours of samples
+// (24 h at 1 kHz is ~86M snapshots) in Gorilla-style bit-packed blocks, and
+// RollupHistory keeps per-bucket aggregates at coarser resolutions.
+//
+// COMPRESSED HISTORY
+// ENCODING (per sample, all fields lossless except `timestamp`):
+// - timestamp: steady clock quantized to timestamp_resolution_ns, integer
+//   delta-of-delta with variable-length buckets
+// - t_s: distance in ULPs from the linear prediction t[n-1] + (t[n-1] -
+//   t[n-2]), i.e. delta-of-delta carried out in the floating-point domain
+// - gate + flags: one bit when unchanged, otherwise packed in 34 bits
+// - temperatures, indices: XOR against the previous value (Gorilla
+//   leading/trailing-zero windows)
+// - readiness, stability_score, dTdt_C_per_s, trend_C: XOR against the
+//   value evaluate() would have produced from the fields already decoded
+//   (readiness via PhaseReadinessMiddleware::readinessFromFlags(), trend
+//   with `policy`'s alpha). Predictions that miss (custom pipelines) cost
+//   bits, never accuracy.
+//
+// Blocks are sealed every block_samples samples and decode independently.
+// Each block carries its t_s range, so range queries only decode blocks
+// that overlap the requested window.
+//
+// FLAG INDEX
+//
+// Each block also indexes, per flag bit that occurs in it and per gate
+// value, the positions of the samples carrying it (roaring-style: run
+// containers while the positions are clustered, a bitset once that is
+// smaller). A filtered query (HistoryFilter) evaluates flags_all /
+// flags_none / gate as AND / ANDNOT / OR over these sets and decodes only
+// blocks with matches, stopping at the last matching position.
+//
+// ROLLUPS
+//
+// Each level aggregates fixed t_s buckets (default 1 s / 10 s / 1 min)
+// into min/max/mean readiness, per-gate sample counts and the union of
+// flags. Samples only touch the finest level; a closed bucket is merged
+// into the next level, so the cost is O(1) per level per sample. Closed
+// buckets live in a fixed-capacity ring per level.
+//
+// TRANSITION LOG
+//
+// Runs of constant (gate, flags) as (start_t, end_t, gate, flags), so
+// memory grows with the number of transitions rather than samples. Dwell
+// and time-since-gate answers are O(1) from running state; counting the
+// transitions in a window is a binary search over run start times.
+//
+// SAFETY:
+// - None of the tiers is thread-safe; ReadinessAPIState serializes them under
+//   its mutex. Sealed compressed blocks are immutable and shared by
+//   pointer, so readers decode outside the lock.
+
+#include "hlv/phase_readiness.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace hlv {
+
+// Timestamped snapshot for history tracking
+struct ReadinessSnapshot {
+  std::chrono::steady_clock::time_point timestamp{};
+  double t_s = 0.0;
+  double readiness = 0.0;
+  Gate gate = Gate::BLOCK;
+  uint32_t flags = 0;
+  double temp_C = std::numeric_limits<double>::quiet_NaN();
+  double temp_ambient_C = std::numeric_limits<double>::quiet_NaN();
+  double dTdt_C_per_s = 0.0;
+  double trend_C = 0.0;
+  double stability_score = 0.0;
+  double hysteresis_index = std::numeric_limits<double>::quiet_NaN();
+  double coherence_index = std::numeric_limits<double>::quiet_NaN();
+};
+
+// Sample predicate for filtered history queries
+struct HistoryFilter {
+  uint32_t flags_all = 0;    // Every one of these flags set
+  uint32_t flags_none = 0;   // None of these flags set
+  uint8_t gate_mask = 0x7;   // Accepted gates, bit (1 << Gate)
+
+  bool active() const { return flags_all != 0 || flags_none != 0 || (gate_mask & 0x7) != 0x7; }
+  bool matches(uint32_t flags, Gate gate) const {
+    return (flags & flags_all) == flags_all && (flags & flags_none) == 0 &&
+           ((gate_mask >> static_cast<unsigned>(gate)) & 1u) != 0;
+  }
+};
+
+// Positions (< 65536) of the samples in one block that carry a flag or
+// gate. Positions are added in increasing order.
+class PositionSet {
+public:
+  void add(uint32_t pos, uint32_t universe);
+
+  uint32_t cardinality() const { return cardinality_; }
+  bool isBitset() const { return !bits_.empty(); }
+  size_t bytes() const { return runs_.size() * sizeof(Run) + bits_.size() * sizeof(uint64_t); }
+
+  // words |= this set, as a bitmap of ceil(universe / 64) words
+  void orInto(std::vector<uint64_t>& words) const;
+
+private:
+  struct Run {
+    uint16_t start;
+    uint16_t last;
+  };
+
+  std::vector<Run> runs_;
+  std::vector<uint64_t> bits_;
+  uint32_t cardinality_ = 0;
+};
+
+struct CompressedHistoryConfig {
+  size_t max_samples = 0;                  // Retention; 0 disables the tier
+  uint32_t block_samples = 4096;           // Samples per sealed block (<= 65536)
+  uint64_t timestamp_resolution_ns = 1000; // Steady-clock quantum kept per sample
+  // Policy of the middleware feeding this history; the trend predictor
+  // uses its EWMA alpha. Null means the default config. Must outlive the
+  // history (interned policies do).
+  const CompiledPolicy* policy = nullptr;
+};
+
+// One bit-packed block of consecutive samples
+struct CompressedHistoryBlock {
+  uint32_t count = 0;
+  double min_t_s = std::numeric_limits<double>::infinity();
+  double max_t_s = -std::numeric_limits<double>::infinity();
+  std::vector<uint64_t> words;   // MSB-first bit stream
+  uint64_t bit_count = 0;
+
+  uint32_t flags_present = 0;            // Union of the samples' flags
+  std::vector<PositionSet> flag_index;   // One per bit of flags_present, ascending
+  PositionSet gate_index[3];             // Indexed by Gate
+
+  size_t bytes() const { return words.size() * sizeof(uint64_t); }
+  size_t indexBytes() const;
+  bool overlaps(double from_t, double to_t) const { return count > 0 && max_t_s >= from_t && min_t_s <= to_t; }
+
+  void indexSample(const ReadinessSnapshot& snapshot, uint32_t universe);
+
+  // Bitmap (bit i = sample i) of the samples matching `filter`'s flag and
+  // gate predicates; false if none match
+  bool matchMask(const HistoryFilter& filter, std::vector<uint64_t>& mask) const;
+};
+
+using CompressedHistoryBlockPtr = std::shared_ptr<const CompressedHistoryBlock>;
+
+struct CompressedHistoryStats {
+  uint64_t samples = 0;
+  uint64_t blocks = 0;
+  uint64_t bytes = 0;
+  uint64_t index_bytes = 0;   // Flag/gate position sets (not in bytes_per_sample)
+  double bytes_per_sample = 0.0;
+};
+
+class CompressedHistory {
+public:
+  explicit CompressedHistory(const CompressedHistoryConfig& config = CompressedHistoryConfig{});
+  ~CompressedHistory();
+
+  CompressedHistory(CompressedHistory&&) noexcept;
+  CompressedHistory& operator=(CompressedHistory&&) noexcept;
+
+  bool enabled() const { return config_.max_samples > 0; }
+  const CompressedHistoryConfig& config() const { return config_; }
+
+  void append(const ReadinessSnapshot& snapshot);
+  void clear();
+
+  size_t size() const { return samples_; }
+  CompressedHistoryStats stats() const;
+
+  // Blocks overlapping [from_t, to_t], oldest first. Sealed blocks are
+  // shared; the open block is copied, so the result stays valid after
+  // further appends.
+  std::vector<CompressedHistoryBlockPtr> blocksInRange(double from_t, double to_t) const;
+
+  // Decode a whole block, appending to `out`
+  static void decodeBlock(const CompressedHistoryBlock& block, const CompressedHistoryConfig& config,
+                          std::vector<ReadinessSnapshot>& out);
+
+  // Decode the newest `max_count` samples with from_t <= t_s <= to_t that
+  // match `filter` from the given blocks (as returned by blocksInRange)
+  static std::vector<ReadinessSnapshot> decodeRange(const std::vector<CompressedHistoryBlockPtr>& blocks,
+                                                    const CompressedHistoryConfig& config,
+                                                    double from_t, double to_t, size_t max_count,
+                                                    const HistoryFilter& filter = HistoryFilter());
+
+private:
+  struct Encoder;
+
+  void sealBlock();
+
+  CompressedHistoryConfig config_;
+  std::deque<CompressedHistoryBlockPtr> sealed_;
+  std::shared_ptr<CompressedHistoryBlock> open_;
+  std::unique_ptr<Encoder> encoder_;
+  size_t samples_;
+};
+
+// Aggregate of the samples whose t_s falls in [start_t_s, end_t_s)
+struct RollupBucket {
+  double start_t_s = 0.0;
+  double end_t_s = 0.0;
+  uint64_t samples = 0;
+  double readiness_min = std::numeric_limits<double>::infinity();
+  double readiness_max = -std::numeric_limits<double>::infinity();
+  double readiness_sum = 0.0;
+  uint64_t gate_samples[3] = {0, 0, 0};   // Indexed by Gate
+  uint32_t flags_union = 0;
+  bool partial = false;                   // Still accumulating (newest bucket)
+
+  void add(const ReadinessSnapshot& snapshot);
+  void merge(const RollupBucket& other);
+
+  double readinessMean() const { return samples ? readiness_sum / static_cast<double>(samples) : 0.0; }
+  double dwellFraction(Gate g) const {
+    return samples ? static_cast<double>(gate_samples[static_cast<size_t>(g) % 3]) / static_cast<double>(samples) : 0.0;
+  }
+};
+
+struct RollupLevelConfig {
+  double resolution_s;   // Bucket width; a multiple of the previous level's
+  size_t capacity;       // Closed buckets retained
+};
+
+// 1 s for an hour, 10 s and 1 min for a day
+std::vector<RollupLevelConfig> defaultRollupLevels();
+
+class RollupHistory {
+public:
+  explicit RollupHistory(std::vector<RollupLevelConfig> levels = defaultRollupLevels());
+
+  void append(const ReadinessSnapshot& snapshot);
+  void clear();
+
+  size_t levelCount() const { return levels_.size(); }
+  double resolution(size_t level) const { return levels_[level].config.resolution_s; }
+
+  // Level with exactly this resolution, or -1
+  int findLevel(double resolution_s) const;
+
+  // Buckets of `level` overlapping [from_t, to_t], oldest first. The
+  // newest bucket (including samples not yet cascaded from finer levels)
+  // is reported with partial = true.
+  void query(size_t level, double from_t, double to_t, std::vector<RollupBucket>& out) const;
+
+private:
+  struct Level {
+    RollupLevelConfig config;
+    std::vector<RollupBucket> ring;   // Grows to config.capacity, then wraps
+    size_t head = 0;                  // Oldest closed bucket once full
+    RollupBucket open;
+    int64_t open_index = 0;
+    bool has_open = false;
+  };
+
+  int64_t bucketIndex(size_t level, double t_s) const;
+  void accumulate(size_t level, int64_t index, const RollupBucket* child, const ReadinessSnapshot* sample);
+  void pendingBuckets(size_t level, std::vector<RollupBucket>& out) const;
+
+  std::vector<Level> levels_;
+};
+
+// One run of consecutive samples with the same gate and flags
+struct GateRun {
+  double start_t_s = 0.0;   // t_s of the first sample
+  double end_t_s = 0.0;     // t_s of the latest sample
+  Gate gate = Gate::BLOCK;
+  uint32_t flags = 0;
+  uint64_t samples = 0;
+};
+
+// Current dwell state, as of the latest sample
+struct DwellState {
+  bool valid = false;                      // At least one sample seen
+  double now_t_s = 0.0;                    // Latest t_s
+  Gate gate = Gate::BLOCK;
+  uint32_t flags = 0;
+  double gate_since_t_s = 0.0;             // Start of the current gate state
+  double run_since_t_s = 0.0;              // Start of the current (gate, flags) run
+  double gate_left_t_s[3] = {std::numeric_limits<double>::quiet_NaN(),
+                             std::numeric_limits<double>::quiet_NaN(),
+                             std::numeric_limits<double>::quiet_NaN()};   // Indexed by Gate
+  uint64_t transitions = 0;                // Runs started after the first
+
+  double gateDwell() const { return now_t_s - gate_since_t_s; }
+  double runDwell() const { return now_t_s - run_since_t_s; }
+
+  // 0 while in `g`; NaN if `g` has never been left
+  double timeSince(Gate g) const {
+    return g == gate ? 0.0 : now_t_s - gate_left_t_s[static_cast<size_t>(g) % 3];
+  }
+};
+
+class TransitionLog {
+public:
+  explicit TransitionLog(size_t max_runs = 4096);
+
+  // Samples with non-finite t_s are ignored
+  void append(const ReadinessSnapshot& snapshot);
+  void clear();
+
+  size_t size() const { return runs_.size(); }
+  const DwellState& dwell() const { return dwell_; }
+
+  // Runs started at t_s > since_t_s (exact for non-decreasing t_s)
+  uint64_t transitionsSince(double since_t_s) const;
+
+  // Newest `max_count` runs overlapping [from_t, to_t], oldest first; the
+  // last one is the current run
+  void runs(double from_t, double to_t, size_t max_count, std::vector<GateRun>& out) const;
+
+private:
+  size_t max_runs_;
+  std::deque<GateRun> runs_;   // Retained runs; back() is the current one
+  DwellState dwell_;
+};
+
+} // namespace hlv
@@ -0,0 +1,162 @@
+#pragma once
+
+// Indexed binary min-heap over dense ids
+//
+// Each id 0..capacity-1 is either absent or present with a double key.
+// set() inserts or re-keys an id in O(log N) (a position table makes the
+// id's heap slot known without a search), erase() removes it in O(log N),
+// and smallest(k) returns the k lowest keys in O(k log k) without touching
+// the rest of the heap: it walks the heap from the root with a frontier of
+// at most k + 1 candidates.
+//
+// - Ties are broken by the lower id, so the order is total and stable;
+//   NaN keys are rejected since they compare false both ways
+// - No allocation after construction except in smallest()'s output
+// - Not thread-safe
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace hlv {
+
+class IndexedMinHeap {
+public:
+  explicit IndexedMinHeap(size_t capacity)
+      : pos_(capacity, kAbsent)
+  {
+    heap_.reserve(capacity);
+    frontier_.reserve(64);
+  }
+
+  size_t size() const { return heap_.size(); }
+  bool contains(size_t id) const { return id < pos_.size() && pos_[id] != kAbsent; }
+
+  // Insert `id` or change its key. Returns false (changing nothing) if
+  // `id` is out of range or `key` is NaN.
+  bool set(size_t id, double key) {
+    if (id >= pos_.size() || key != key) return false;
+    const uint32_t i = pos_[id];
+    if (i == kAbsent) {
+      heap_.push_back(Entry{key, static_cast<uint32_t>(id)});
+      pos_[id] = static_cast<uint32_t>(heap_.size() - 1);
+      siftUp(heap_.size() - 1);
+      return true;
+    }
+    const Entry old = heap_[i];
+    heap_[i].key = key;
+    if (less(heap_[i], old)) {
+      siftUp(i);
+    } else {
+      siftDown(i);
+    }
+    return true;
+  }
+
+  void erase(size_t id) {
+    if (!contains(id)) return;
+    const size_t i = pos_[id];
+    pos_[id] = kAbsent;
+    const Entry last = heap_.back();
+    heap_.pop_back();
+    if (i == heap_.size()) return;
+    heap_[i] = last;
+    pos_[last.id] = static_cast<uint32_t>(i);
+    siftUp(i);
+    siftDown(pos_[last.id]);
+  }
+
+  // Up to `k` (id, key) pairs with the lowest keys, lowest first
+  void smallest(size_t k, std::vector<std::pair<size_t, double>>& out) const {
+    out.clear();
+    if (heap_.empty() || k == 0) return;
+    // Frontier of heap slots, itself a min-heap ordered by the slot's entry
+    frontier_.clear();
+    pushFrontier(0);
+    while (!frontier_.empty() && out.size() < k) {
+      const uint32_t slot = popFrontier();
+      out.emplace_back(heap_[slot].id, heap_[slot].key);
+      const size_t child = 2 * static_cast<size_t>(slot) + 1;
+      if (child < heap_.size()) pushFrontier(child);
+      if (child + 1 < heap_.size()) pushFrontier(child + 1);
+    }
+  }
+
+private:
+  static constexpr uint32_t kAbsent = UINT32_MAX;
+
+  struct Entry {
+    double key;
+    uint32_t id;
+  };
+
+  static bool less(const Entry& a, const Entry& b) {
+    return a.key < b.key || (a.key == b.key && a.id < b.id);
+  }
+
+  void place(size_t i, const Entry& e) {
+    heap_[i] = e;
+    pos_[e.id] = static_cast<uint32_t>(i);
+  }
+
+  void siftUp(size_t i) {
+    const Entry e = heap_[i];
+    while (i > 0) {
+      const size_t parent = (i - 1) / 2;
+      if (!less(e, heap_[parent])) break;
+      place(i, heap_[parent]);
+      i = parent;
+    }
+    place(i, e);
+  }
+
+  void siftDown(size_t i) {
+    const Entry e = heap_[i];
+    const size_t n = heap_.size();
+    for (;;) {
+      size_t child = 2 * i + 1;
+      if (child >= n) break;
+      if (child + 1 < n && less(heap_[child + 1], heap_[child])) ++child;
+      if (!less(heap_[child], e)) break;
+      place(i, heap_[child]);
+      i = child;
+    }
+    place(i, e);
+  }
+
+  // Frontier helpers: binary heap of heap_ slots keyed by heap_[slot]
+  void pushFrontier(size_t slot) const {
+    frontier_.push_back(static_cast<uint32_t>(slot));
+    size_t i = frontier_.size() - 1;
+    while (i > 0) {
+      const size_t parent = (i - 1) / 2;
+      if (!less(heap_[frontier_[i]], heap_[frontier_[parent]])) break;
+      std::swap(frontier_[i], frontier_[parent]);
+      i = parent;
+    }
+  }
+
+  uint32_t popFrontier() const {
+    const uint32_t top = frontier_[0];
+    frontier_[0] = frontier_.back();
+    frontier_.pop_back();
+    size_t i = 0;
+    const size_t n = frontier_.size();
+    for (;;) {
+      size_t child = 2 * i + 1;
+      if (child >= n) break;
+      if (child + 1 < n && less(heap_[frontier_[child + 1]], heap_[frontier_[child]])) ++child;
+      if (!less(heap_[frontier_[child]], heap_[frontier_[i]])) break;
+      std::swap(frontier_[i], frontier_[child]);
+      i = child;
+    }
+    return top;
+  }
+
+  std::vector<Entry> heap_;
+  std::vector<uint32_t> pos_;                // id -> slot in heap_, or kAbsent
+  mutable std::vector<uint32_t> frontier_;   // Scratch for smallest()
+};
+
+} // namespace hlv
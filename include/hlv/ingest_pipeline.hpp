@@ -0,0 +1,212 @@
+#pragma once
+
+// Lock-free ingest queue, dedicated evaluator thread and publication stage
+//
+// The acquisition thread hands each PhaseSignals sample to submit(), a
+// bounded enqueue into a lock-free SPSC ring. A dedicated (optionally
+// CPU-pinned) evaluator thread drains the ring in batches, runs
+// PhaseReadinessMiddleware::evaluate() and publishes each result to
+// ReadinessAPIState and the AuditLogger, so mutex jitter or history
+// trimming in update() no longer stalls acquisition.
+//
+// PublicationStage moves that publication work off whichever thread
+// evaluates (the evaluator above, or a control loop calling evaluate()
+// itself). publish() copies the (signals, output) pair into a second SPSC
+// ring; a publisher thread applies it with ReadinessAPIState::updateBatch()
+// (one lock, one clock read and one sequence bump, which is what
+// invalidates cached REST bodies, per batch) and forwards it to the
+// AuditLogger. A full ring drops the update and counts it; the evaluating
+// thread is never blocked.
+//
+// OVERFLOW POLICIES (queue full):
+// - BLOCK: submit() spins (yielding) until the evaluator frees a slot or
+//   the pipeline stops; no sample is lost
+// - DROP_OLDEST: the oldest queued sample is discarded for the new one
+// - DROP_NEWEST: the new sample is discarded
+// Every submitted sample gets a sequence number, so the evaluator sees any
+// gap left by either drop policy and sets FLAG_INGEST_OVERFLOW on the
+// first output after it. The flag is informational: it is ORed in after
+// evaluate() and does not change readiness or the gate (evaluate() already
+// flags the enlarged dt as stale when the gap exceeds max_dt_s).
+//
+// SAFETY:
+// - submit() must be called from a single thread (the acquisition loop);
+//   it never takes a lock, allocates or makes a syscall (BLOCK yields)
+// - The evaluator thread is the only caller of evaluate(),
+//   ReadinessAPIState::update() and AuditLogger::log() while running
+// - publish() must be called from a single thread; while a stage is
+//   running, its publisher thread is the only AuditLogger::log() caller
+
+#include "hlv/audit_log.hpp"
+#include "hlv/phase_readiness.hpp"
+#include "hlv/rest_api_server.hpp"
+#include "hlv/spsc_ring.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <thread>
+
+namespace hlv {
+
+enum class OverflowPolicy : uint8_t {
+  BLOCK = 0,
+  DROP_OLDEST = 1,
+  DROP_NEWEST = 2
+};
+
+const char* overflowPolicyToString(OverflowPolicy p);
+
+// Pin the calling thread to one CPU (Linux); false if unsupported or refused
+bool pinCurrentThread(int cpu);
+
+struct IngestConfig {
+  size_t queue_capacity = 4096;                     // Rounded up to a power of two
+  OverflowPolicy overflow = OverflowPolicy::DROP_OLDEST;
+  int evaluator_cpu = -1;                           // Pin the evaluator to this CPU (-1 = no pinning)
+  size_t batch_size = 64;                           // Samples drained per ring access
+};
+
+struct PublicationConfig {
+  size_t queue_capacity = 8192;   // Rounded up to a power of two
+  size_t batch_size = 256;        // Updates applied per updateBatch()
+  int publisher_cpu = -1;         // Pin the publisher to this CPU (-1 = no pinning)
+};
+
+class PublicationStage {
+public:
+  // `audit` may be null; `state` and `audit` must outlive the stage
+  explicit PublicationStage(ReadinessAPIState& state, AuditLogger* audit = nullptr,
+                            const PublicationConfig& config = PublicationConfig{});
+  ~PublicationStage();
+
+  PublicationStage(const PublicationStage&) = delete;
+  PublicationStage& operator=(const PublicationStage&) = delete;
+
+  // Start the publisher thread. Returns false if already running.
+  bool start();
+
+  // Apply everything still queued, then join the publisher thread
+  void stop();
+
+  bool isRunning() const { return running_.load(std::memory_order_acquire); }
+  bool isPinned() const { return pinned_.load(std::memory_order_acquire); }
+
+  ReadinessAPIState& state() { return state_; }
+
+  // Hot path: queue one evaluated sample. Returns false (and counts a
+  // drop) if the queue is full.
+  bool publish(const PhaseSignals& signals, const PhaseReadinessOutput& output);
+
+  // Counters (safe to read from any thread)
+  uint64_t publishedCount() const { return published_.load(std::memory_order_relaxed); }
+  uint64_t droppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+  uint64_t appliedCount() const { return applied_.load(std::memory_order_relaxed); }
+  uint64_t batchCount() const { return batches_.load(std::memory_order_relaxed); }
+  size_t queueDepth() const { return queue_.size(); }
+  size_t maxQueueDepth() const { return max_depth_.load(std::memory_order_relaxed); }
+  size_t queueCapacity() const { return queue_.capacity(); }
+
+  // Prometheus text exposition of the counters above (hlv_publish_*)
+  void render(std::ostream& out) const;
+
+private:
+  void publisherLoop();
+
+  PublicationConfig config_;
+  ReadinessAPIState& state_;
+  AuditLogger* audit_;
+  SpscRing<ReadinessUpdate> queue_;
+
+  std::atomic<bool> running_;
+  std::atomic<bool> should_stop_;
+  std::atomic<bool> pinned_;
+  std::thread publisher_thread_;
+
+  std::atomic<uint64_t> published_;   // Producer-owned
+  std::atomic<uint64_t> dropped_;     // Producer-owned
+  std::atomic<uint64_t> applied_;     // Publisher-owned
+  std::atomic<uint64_t> batches_;     // Publisher-owned
+  std::atomic<size_t> max_depth_;     // Publisher-owned: high-water mark seen per drain
+};
+
+// One queued sample
+struct IngestRecord {
+  PhaseSignals signals;
+  uint64_t sequence;   // Submission order, including dropped samples
+};
+
+class IngestPipeline {
+public:
+  // `state` and `audit` may be null; they must outlive the pipeline
+  IngestPipeline(const PhaseReadinessConfig& readiness_config, ReadinessAPIState* state,
+                 AuditLogger* audit = nullptr, const IngestConfig& config = IngestConfig{});
+
+  // Evaluate only, handing each output to `publication` (which must
+  // outlive the pipeline and be started separately)
+  IngestPipeline(const PhaseReadinessConfig& readiness_config, PublicationStage& publication,
+                 const IngestConfig& config = IngestConfig{});
+  ~IngestPipeline();
+
+  IngestPipeline(const IngestPipeline&) = delete;
+  IngestPipeline& operator=(const IngestPipeline&) = delete;
+
+  // Start the evaluator thread. Returns false if already running.
+  bool start();
+
+  // Evaluate everything still queued, then join the evaluator thread
+  void stop();
+
+  bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+  // True if the evaluator thread was pinned to config.evaluator_cpu
+  bool isPinned() const { return pinned_.load(std::memory_order_acquire); }
+
+  // Hot path: queue one sample. Returns false if this sample was dropped
+  // (DROP_NEWEST, or BLOCK after stop()).
+  bool submit(const PhaseSignals& signals);
+
+  // Counters (safe to read from any thread)
+  uint64_t submittedCount() const { return submitted_.load(std::memory_order_relaxed); }
+  uint64_t droppedOldestCount() const { return dropped_oldest_.load(std::memory_order_relaxed); }
+  uint64_t droppedNewestCount() const { return dropped_newest_.load(std::memory_order_relaxed); }
+  uint64_t blockedCount() const { return blocked_.load(std::memory_order_relaxed); }
+  uint64_t evaluatedCount() const { return evaluated_.load(std::memory_order_relaxed); }
+  uint64_t overflowGapCount() const { return overflow_gaps_.load(std::memory_order_relaxed); }
+  size_t queueDepth() const { return queue_.size(); }
+  size_t maxQueueDepth() const { return max_depth_.load(std::memory_order_relaxed); }
+  size_t queueCapacity() const { return queue_.capacity(); }
+  const IngestConfig& config() const { return config_; }
+
+  // Prometheus text exposition of the counters above (hlv_ingest_*)
+  void render(std::ostream& out) const;
+
+private:
+  void evaluatorLoop();
+  void process(const IngestRecord& record);
+
+  IngestConfig config_;
+  PhaseReadinessMiddleware middleware_;   // Owned by the evaluator thread while running
+  ReadinessAPIState* state_;
+  AuditLogger* audit_;
+  PublicationStage* publication_;
+  SpscEvictingRing<IngestRecord> queue_;
+
+  std::atomic<bool> running_;
+  std::atomic<bool> should_stop_;
+  std::atomic<bool> pinned_;
+  std::thread evaluator_thread_;
+
+  uint64_t next_sequence_;                 // Producer-owned
+  uint64_t expected_sequence_;             // Evaluator-owned
+
+  std::atomic<uint64_t> submitted_;        // Producer-owned
+  std::atomic<uint64_t> dropped_oldest_;   // Producer-owned
+  std::atomic<uint64_t> dropped_newest_;   // Producer-owned
+  std::atomic<uint64_t> blocked_;          // Producer-owned: submits that had to wait
+  std::atomic<uint64_t> evaluated_;        // Evaluator-owned
+  std::atomic<uint64_t> overflow_gaps_;    // Evaluator-owned: outputs flagged FLAG_INGEST_OVERFLOW
+  std::atomic<size_t> max_depth_;          // Evaluator-owned: high-water mark seen per drain
+};
+
+} // namespace hlv
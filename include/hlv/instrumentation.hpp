@@ -0,0 +1,107 @@
+#pragma once
+
+// Optional latency instrumentation for the readiness hot path
+//
+// Build with -DHLV_ENABLE_INSTRUMENTATION to time every
+// PhaseReadinessMiddleware::evaluate(), ReadinessAPIState::update() and
+// ReadinessAPIState::updateBatch() call. Without the flag the probes
+// expand to nothing and the hot path is unchanged; the query API below
+// still links and reports disabled.
+//
+// DESIGN:
+// - Clock: TSC on x86-64 (converted to ns at query time, never in the
+//   loop), CLOCK_MONOTONIC_RAW elsewhere
+// - Histograms: log-linear (HDR-style), 32 linear sub-buckets per power
+//   of two, so any recorded value is reported within ~3% of its true value
+// - Recording is a relaxed atomic increment; max uses a CAS loop that
+//   only runs when a new maximum is seen. No locks, no allocation.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace hlv {
+
+// Instrumented call sites
+enum class LatencyProbe : uint8_t {
+  EVALUATE = 0,          // PhaseReadinessMiddleware::evaluate()
+  API_UPDATE = 1,        // ReadinessAPIState::update(), one sample
+  API_UPDATE_BATCH = 2   // ReadinessAPIState::updateBatch(), one whole batch
+};
+
+constexpr size_t kLatencyProbeCount = 3;
+
+// Lock-free log-linear histogram over raw clock ticks
+class LogLinearHistogram {
+public:
+  static constexpr unsigned kSubBucketBits = 5;
+  static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+  static constexpr size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  LogLinearHistogram();
+
+  void record(uint64_t value);
+  void reset();
+
+  uint64_t count() const;
+  uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+  // Highest value equivalent to the bucket holding quantile q ∈ [0,1]
+  uint64_t valueAtQuantile(double q) const;
+
+  static size_t bucketIndex(uint64_t value);
+  static uint64_t bucketUpperBound(size_t index);
+
+private:
+  std::array<std::atomic<uint64_t>, kBucketCount> counts_;
+  std::atomic<uint64_t> max_;
+};
+
+// Percentile summary of one probe, in nanoseconds
+struct LatencySummary {
+  uint64_t count = 0;
+  double p50_ns = 0.0;
+  double p99_ns = 0.0;
+  double p999_ns = 0.0;
+  double max_ns = 0.0;
+};
+
+// True iff the library was built with HLV_ENABLE_INSTRUMENTATION
+bool instrumentationEnabled();
+
+// Current summary for a probe (all zeros when disabled or idle)
+LatencySummary latencySummary(LatencyProbe probe);
+
+// Clear all probe histograms
+void resetInstrumentation();
+
+// Raw clock read (TSC ticks or nanoseconds) and its conversion to ns
+uint64_t instrumentationClock();
+double instrumentationTicksToNs(uint64_t ticks);
+
+// Record a raw tick interval against a probe
+void recordLatencyTicks(LatencyProbe probe, uint64_t ticks);
+
+// RAII timer used by HLV_INSTRUMENT_SCOPE
+class ScopedLatencyTimer {
+public:
+  explicit ScopedLatencyTimer(LatencyProbe probe)
+      : probe_(probe), start_(instrumentationClock()) {}
+  ~ScopedLatencyTimer() { recordLatencyTicks(probe_, instrumentationClock() - start_); }
+
+  ScopedLatencyTimer(const ScopedLatencyTimer&) = delete;
+  ScopedLatencyTimer& operator=(const ScopedLatencyTimer&) = delete;
+
+private:
+  LatencyProbe probe_;
+  uint64_t start_;
+};
+
+} // namespace hlv
+
+#ifdef HLV_ENABLE_INSTRUMENTATION
+#define HLV_INSTRUMENT_SCOPE(probe) ::hlv::ScopedLatencyTimer hlv_instrument_scope_timer_(probe)
+#else
+#define HLV_INSTRUMENT_SCOPE(probe) ((void)0)
+#endif
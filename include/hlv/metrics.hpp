@@ -0,0 +1,137 @@
+#pragma once
+
+// Prometheus-style metrics for HLV Phase Readiness Middleware
+//
+// DESIGN:
+// - Counters and histograms are sharded per thread: each writer thread
+//   increments its own cache line with a relaxed atomic add, so the
+//   readiness loop pays a few nanoseconds and never contends with the
+//   server thread
+// - Readers (the /metrics scrape) sum shards; totals are eventually
+//   consistent, never torn
+// - Text exposition format 0.0.4 rendering lives in metrics.cpp
+
+#include "hlv/phase_readiness.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace hlv {
+
+// Number of per-thread shards; threads beyond this share shards (still correct)
+constexpr size_t kMetricShards = 8;
+
+// Index of the calling thread's shard in [0, kMetricShards)
+size_t metricShardIndex();
+
+// Monotonic counter with per-thread relaxed shards
+class MetricCounter {
+public:
+  void add(uint64_t n = 1) {
+    shards_[metricShardIndex()].value.fetch_add(n, std::memory_order_relaxed);
+  }
+  uint64_t value() const;
+
+private:
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> value{0};
+  };
+  std::array<Shard, kMetricShards> shards_;
+};
+
+// Fixed-bucket latency histogram (nanosecond observations, seconds on export)
+class MetricHistogram {
+public:
+  // Upper bounds in nanoseconds, strictly increasing; +Inf is implicit
+  explicit MetricHistogram(std::vector<uint64_t> upper_bounds_ns);
+
+  void observe(uint64_t ns);
+
+  // Cumulative-free per-bucket counts (last entry is the +Inf bucket)
+  std::vector<uint64_t> bucketCounts() const;
+  uint64_t sumNs() const;
+  const std::vector<uint64_t>& upperBoundsNs() const { return bounds_; }
+
+  // Emit _bucket/_sum/_count series; `labels` is either empty or `k="v",`
+  void render(std::ostream& out, const char* name, const std::string& labels = "") const;
+
+private:
+  // Frees the 64-byte-aligned slot array
+  struct AlignedSlotsDeleter {
+    void operator()(std::atomic<uint64_t>* slots) const;
+  };
+
+  // Per shard: one slot per bucket plus the sum, padded to whole cache
+  // lines; the array starts on a line boundary, so no line spans shards
+  std::vector<uint64_t> bounds_;
+  size_t stride_;
+  std::unique_ptr<std::atomic<uint64_t>[], AlignedSlotsDeleter> slots_;
+};
+
+// Readiness-loop metrics, owned by ReadinessAPIState
+class ReadinessMetrics {
+public:
+  ReadinessMetrics();
+
+  // Called from ReadinessAPIState::update() with the update timestamp
+  void recordUpdate(const PhaseReadinessOutput& output, std::chrono::steady_clock::time_point now);
+
+  // Called by the readiness loop around PhaseReadinessMiddleware::evaluate()
+  void recordEvaluateLatency(uint64_t ns) { evaluate_latency_.observe(ns); }
+
+  uint64_t updatesTotal() const;
+  uint64_t gateTotal(Gate g) const;
+  uint64_t flagTotal(unsigned bit) const;
+  uint64_t failsafeTotal() const;
+  // Rate over the last completed one-second window, evaluated at call
+  // time: 0 once the newest update is more than a window old, so a
+  // stalled loop reads as stalled instead of at its last rate
+  double updateRateHz() const;
+
+  void render(std::ostream& out) const;
+
+private:
+  // All per-sample counters of one writer thread share one block, so a
+  // single update touches a handful of lines owned by that thread alone
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> updates{0};
+    std::atomic<uint64_t> failsafe{0};
+    std::atomic<uint64_t> gate[3] = {};
+    std::atomic<uint64_t> flags[32] = {};
+  };
+  std::array<Shard, kMetricShards> shards_;
+  MetricHistogram evaluate_latency_;
+
+  // Update rate over the last completed one-second window (single writer:
+  // update() holds the state mutex while calling recordUpdate)
+  std::chrono::steady_clock::time_point rate_window_start_;
+  uint64_t rate_window_count_;
+  std::atomic<double> update_rate_hz_;
+  std::atomic<int64_t> last_update_ns_;   // steady_clock, 0 before the first update
+};
+
+// REST server metrics: request counts and latency per endpoint
+class ServerMetrics {
+public:
+  // Endpoint label table; requests to other paths are labelled "other"
+  explicit ServerMetrics(std::vector<std::string> endpoints);
+
+  size_t endpointIndex(const std::string& path) const;
+  void recordRequest(size_t endpoint_index, int status_code, uint64_t latency_ns);
+  uint64_t requestsTotal(size_t endpoint_index, int status_class) const;
+
+  void render(std::ostream& out) const;
+
+private:
+  std::vector<std::string> endpoints_;          // Last entry is "other"
+  std::unique_ptr<std::array<MetricCounter, 6>[]> requests_; // Indexed by status_code / 100
+  std::vector<MetricHistogram> latency_;
+};
+
+} // namespace hlv
@@ -0,0 +1,97 @@
+#pragma once
+
+// NUMA topology and topology-aware channel shards
+//
+// On a multi-socket machine, memory is placed on the node of the thread
+// that first writes it (first-touch). State built by the main thread and
+// evaluated by a worker on another socket pays a remote access on every
+// tick. NumaTopology maps CPUs to nodes; ChannelShardMap cuts the channels
+// into one contiguous share per worker so that each node's workers own one
+// contiguous block of channels, and orders each worker's steal victims
+// nearest-first (its own node before the others).
+//
+// - Detection reads /sys/devices/system/node (Linux). Anything else, or a
+//   sysfs without node directories, yields a single node, on which every
+//   node query returns 0 and shard maps match plain contiguous shares
+// - No libnuma dependency: placement relies on first-touch by the owning
+//   (pinned) thread, not on mbind()
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace hlv {
+
+// Parse a sysfs CPU list ("0-3,8,10-11"); false on malformed input
+bool parseCpuList(const std::string& text, std::vector<int>& cpus);
+
+class NumaTopology {
+public:
+  // Single node, CPUs unknown
+  NumaTopology();
+
+  // Topology of this machine
+  static NumaTopology detect();
+
+  // Explicit topology: `node_cpus[n]` lists the CPUs of node n
+  static NumaTopology fromNodeCpus(const std::vector<std::vector<int>>& node_cpus);
+
+  size_t nodes() const { return node_cpus_.size(); }
+
+  // More than one node has CPUs (memory-only nodes do not count)
+  bool isMultiNode() const { return cpu_nodes_ > 1; }
+
+  // Node of `cpu`; 0 on a single node, -1 if `cpu` is on no known node
+  int nodeOfCpu(int cpu) const;
+
+  // CPUs of `node` (empty if out of range or unknown)
+  const std::vector<int>& cpusOfNode(size_t node) const;
+
+  // Node of the CPU the calling thread runs on (0 on a single node or if
+  // the CPU cannot be determined)
+  int currentNode() const;
+
+private:
+  std::vector<std::vector<int>> node_cpus_;
+  std::vector<int> cpu_node_;   // Indexed by CPU; -1 for CPUs on no node
+  size_t cpu_nodes_;            // Nodes with at least one CPU
+};
+
+// One worker's contiguous share of the channels, in whole chunks
+struct ChannelShard {
+  int node = 0;               // NUMA node of the owning worker (-1: unknown)
+  size_t first_chunk = 0;
+  size_t end_chunk = 0;       // One past the last chunk
+  size_t first_channel = 0;
+  size_t channels = 0;
+};
+
+class ChannelShardMap {
+public:
+  ChannelShardMap() = default;
+
+  // `worker_nodes[w]`: node of worker w (-1 if unknown). Shares are cut in
+  // node order (workers of a node keep their relative order), so each
+  // node owns one contiguous channel range; with every worker on one node
+  // worker w owns chunks [w * C / W, (w + 1) * C / W).
+  ChannelShardMap(size_t channels, size_t chunk_size, const std::vector<int>& worker_nodes);
+
+  size_t workers() const { return shards_.size(); }
+  size_t channels() const { return channels_; }
+  size_t chunks() const { return chunks_; }
+
+  const ChannelShard& shard(size_t worker) const { return shards_[worker]; }
+
+  // Workers to claim chunks from, starting with `worker` itself, then the
+  // other workers of its node, then the rest (each group round-robin from
+  // `worker`)
+  const std::vector<size_t>& stealOrder(size_t worker) const { return steal_order_[worker]; }
+
+private:
+  size_t channels_ = 0;
+  size_t chunks_ = 0;
+  std::vector<ChannelShard> shards_;                // Indexed by worker
+  std::vector<std::vector<size_t>> steal_order_;    // Indexed by worker
+};
+
+} // namespace hlv
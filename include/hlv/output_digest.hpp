@@ -0,0 +1,140 @@
+#pragma once
+
+// Output stream digests for determinism and equivalence checks
+//
+// OutputDigest folds every PhaseReadinessOutput of a stream into one 64-bit
+// value, so two runs of any length (old vs new build, two machines, scalar
+// vs vectorized) are compared by a single number. DigestLog additionally
+// records the digest at every block boundary; since each checkpoint covers
+// the whole prefix, the first divergent block of two logs is found by
+// binary search in O(log n) comparisons.
+//
+// CANONICAL FORM (version 1): per sample, four 64-bit words in this order
+//   bits(readiness), uint64(gate) << 32 | flags, bits(dTdt_C_per_s),
+//   bits(trend_C)
+// where bits() is the IEEE-754 bit pattern (so -0.0 != 0.0 and NaN
+// payloads count). Each word goes through an XXH64 round; value() mixes in
+// the sample count and applies the XXH64 avalanche. Integer arithmetic
+// only, so the value does not depend on platform or byte order.
+// stability_score is excluded (it always equals readiness).
+
+#include "hlv/phase_readiness.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace hlv {
+
+class OutputDigest {
+public:
+  static constexpr uint64_t kSeed = 0x484C5644494731ULL;   // "HLVDIG1"
+
+  OutputDigest() : acc_(kSeed), count_(0) {}
+
+  void add(const PhaseReadinessOutput& out) {
+    acc_ = round(acc_, bits(out.readiness));
+    acc_ = round(acc_, (static_cast<uint64_t>(out.gate) << 32) | out.flags);
+    acc_ = round(acc_, bits(out.dTdt_C_per_s));
+    acc_ = round(acc_, bits(out.trend_C));
+    ++count_;
+  }
+
+  // Digest of every output added so far
+  uint64_t value() const {
+    uint64_t h = acc_ ^ (count_ * kPrime3);
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+  }
+
+  uint64_t count() const { return count_; }
+
+  void reset() {
+    acc_ = kSeed;
+    count_ = 0;
+  }
+
+  bool operator==(const OutputDigest& other) const { return acc_ == other.acc_ && count_ == other.count_; }
+  bool operator!=(const OutputDigest& other) const { return !(*this == other); }
+
+private:
+  static constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+  static constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+  static constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+
+  static uint64_t bits(double x) {
+    uint64_t u;
+    std::memcpy(&u, &x, sizeof(u));
+    return u;
+  }
+
+  static uint64_t round(uint64_t acc, uint64_t word) {
+    acc += word * kPrime2;
+    acc = (acc << 31) | (acc >> 33);
+    return acc * kPrime1;
+  }
+
+  uint64_t acc_;
+  uint64_t count_;
+};
+
+// Running digest plus a checkpoint every block_samples outputs
+class DigestLog {
+public:
+  static constexpr uint64_t kDefaultBlockSamples = 4096;
+
+  explicit DigestLog(uint64_t block_samples = kDefaultBlockSamples);
+
+  void add(const PhaseReadinessOutput& out) {
+    if (from_file_) reset();
+    digest_.add(out);
+    if (digest_.count() % block_samples_ == 0) {
+      checkpoints_.push_back(digest_.value());
+    }
+  }
+
+  uint64_t blockSamples() const { return block_samples_; }
+  uint64_t count() const { return from_file_ ? file_count_ : digest_.count(); }
+  uint64_t value() const { return from_file_ ? file_value_ : digest_.value(); }
+
+  // checkpoints()[k]: digest of the first (k + 1) * blockSamples() outputs
+  const std::vector<uint64_t>& checkpoints() const { return checkpoints_; }
+
+  void reset();
+
+  // Text format: a header line, then one checkpoint per line in hex:
+  //   hlvdigest 1 block=<block_samples> samples=<count> digest=<value>
+  // A log that was read is for comparison only: add() restarts it
+  bool write(const std::string& path) const;
+  bool read(const std::string& path, std::string* error = nullptr);
+
+private:
+  uint64_t block_samples_;
+  OutputDigest digest_;
+  bool from_file_;
+  uint64_t file_count_;
+  uint64_t file_value_;
+  std::vector<uint64_t> checkpoints_;
+};
+
+// Where two output streams first differ, located from their digest logs
+struct DigestDivergence {
+  bool comparable = false;     // Same block size
+  bool equal = false;          // Same length and final digest
+  uint64_t first_sample = 0;   // Divergent samples lie in [first_sample, end_sample)
+  uint64_t end_sample = 0;
+  size_t comparisons = 0;      // Checkpoint comparisons made
+};
+
+// Binary search for the first checkpoint that differs. If all common
+// checkpoints match, the divergence lies after them (different lengths or
+// a differing final partial block).
+DigestDivergence findDivergence(const DigestLog& a, const DigestLog& b);
+
+} // namespace hlv
@@ -16,8 +16,10 @@
 // - Does NOT introduce autonomous decision-making
 // All time values are seconds; temperatures are degrees Celsius
 
+#include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <memory>
 
 namespace hlv {
 
@@ -68,9 +70,34 @@ enum PhaseFlags : uint32_t {
   FLAG_PERSISTENT_COOLING   = 1u << 5,
   FLAG_HYSTERESIS_HIGH      = 1u << 6,
   FLAG_COHERENCE_LOW        = 1u << 7,
+  FLAG_INGEST_OVERFLOW      = 1u << 8,   // Set by IngestPipeline, never by evaluate()
   FLAG_FAILSAFE_DEFAULT     = 1u << 31
 };
 
+// Lower-case name of every PhaseFlags bit, in bit order. The /metrics flag
+// labels, /api/diagnostics flag_meanings, /api/stats flag_samples and the
+// /api/history flag filter all use this one table; a new flag bit is added
+// here once.
+struct PhaseFlagName {
+  PhaseFlags flag;
+  const char* name;
+};
+
+inline constexpr PhaseFlagName kPhaseFlagNames[] = {
+  {FLAG_INPUT_INVALID,      "input_invalid"},
+  {FLAG_STALE_OR_NONMONO,   "stale_or_nonmono"},
+  {FLAG_TEMP_OUT_OF_RANGE,  "temp_out_of_range"},
+  {FLAG_GRADIENT_TOO_HIGH,  "gradient_too_high"},
+  {FLAG_PERSISTENT_HEATING, "persistent_heating"},
+  {FLAG_PERSISTENT_COOLING, "persistent_cooling"},
+  {FLAG_HYSTERESIS_HIGH,    "hysteresis_high"},
+  {FLAG_COHERENCE_LOW,      "coherence_low"},
+  {FLAG_INGEST_OVERFLOW,    "ingest_overflow"},
+  {FLAG_FAILSAFE_DEFAULT,   "failsafe_default"},
+};
+
+inline constexpr size_t kPhaseFlagCount = sizeof(kPhaseFlagNames) / sizeof(kPhaseFlagNames[0]);
+
 // Configuration: explicit policy parameters (IEC 62304 compliance)
 struct PhaseReadinessConfig final {
   double temp_min_C = -20.0;
@@ -86,34 +113,155 @@ struct PhaseReadinessConfig final {
   double gate_caution_threshold = 0.40;
 };
 
+// Immutable, interned evaluation policy
+// A config is sanitized once (invalid fields replaced by the safe defaults)
+// and the constants evaluate() derives from it are precomputed. intern()
+// returns one shared instance per distinct config (compared bitwise), so
+// channels that use the same config share one policy instead of carrying
+// a copy each.
+//
+// LIFETIME: interned policies live for the rest of the process, and the
+// table is never trimmed: it grows by one entry (~250 bytes) per distinct
+// config ever interned, and every intern() takes one process-wide mutex.
+// Intern only long-lived shared configs (TickScheduler channels, callers
+// of the `const CompiledPolicy*` middleware constructor); a middleware
+// built from a config, ShadowEvaluator and PolicySweep compile into
+// storage they own instead.
+struct CompiledPolicy final {
+  PhaseReadinessConfig config;      // Sanitized
+  bool valid = true;                // The requested config passed validate()
+  double alpha = 0.2;               // ewma_alpha clamped to [0, 1]
+  double glitch_dt_s = 0.5;         // Sample gap at which the jump guard applies
+  double max_trend_age_s = 6.0;     // Trend age clamp (2 * persistence_s)
+
+  static CompiledPolicy compile(const PhaseReadinessConfig& cfg);
+
+  // Thread-safe (serialized on the table's mutex); the pointer stays valid
+  // until exit. Not for per-sample or per-request use: see LIFETIME above.
+  static const CompiledPolicy* intern(const PhaseReadinessConfig& cfg);
+
+  // Distinct policies interned so far
+  static size_t internedCount();
+
+  // True if both policies evolve a TrendState identically (same max_dt_s,
+  // max_abs_temp_jump_C, ewma_alpha and persistence_s); they may then
+  // differ only in thresholds and share one advance() per sample
+  bool sameDynamics(const CompiledPolicy& other) const;
+
+  // True if both policies produce the same readiness and flags for every
+  // sample (all fields but gate_allow_threshold and gate_caution_threshold
+  // equal); their outputs then differ at most in the gate
+  bool sameReadiness(const CompiledPolicy& other) const;
+};
+
+// Evolving per-channel state of the derivative/trend estimator
+struct TrendState final {
+  double prev_t_s = 0.0;
+  double prev_temp_C = std::numeric_limits<double>::quiet_NaN();
+  double trend_dTdt = 0.0;
+  double trend_age_s = 0.0;
+  bool has_prev = false;
+};
+
+// How PhaseReadinessMiddleware::advance() disposed of a sample
+enum class TrendOutcome : uint8_t {
+  INVALID = 0,     // Missing or non-finite input; state unchanged
+  BOOTSTRAP = 1,   // First sample; state seeded
+  STALE = 2,       // dt <= 0 or dt > max_dt_s; state unchanged
+  GLITCH = 3,      // Temperature jump over a long gap; state unchanged
+  UPDATED = 4      // Derivative computed, trend and state updated
+};
+
+// Policy-dynamics half of one evaluation
+struct TrendStep final {
+  TrendOutcome outcome = TrendOutcome::INVALID;
+  double dTdt_C_per_s = 0.0;   // Valid when UPDATED
+  double trend_C = 0.0;        // Valid when UPDATED
+  double trend_age_s = 0.0;    // Valid when UPDATED
+};
+
 // Phase Readiness Middleware (paper Section 5, Figure 1)
 // Safety-critical, deterministic eligibility gate.
 // Stateless w.r.t. actuation; stateful only for short-term history.
-class PhaseReadinessMiddleware final {
+//
+// The middleware holds a pointer to its policy and the evolving trend
+// state, aligned to one cache line, so many channels sharing a few
+// interned policies keep only their own hot state per channel. A
+// middleware built from a config compiles it into a policy it owns
+// (shared with its copies), so varying configs never touch the intern
+// table.
+class alignas(64) PhaseReadinessMiddleware final {
 public:
+  // Compile `cfg` into a policy owned by this middleware and its copies
   explicit PhaseReadinessMiddleware(PhaseReadinessConfig cfg);
+
+  // Share an interned policy (must not be null)
+  explicit PhaseReadinessMiddleware(const CompiledPolicy* policy);
   
   void reset();
   PhaseReadinessOutput evaluate(const PhaseSignals& in);
 
+  // The two halves of evaluate(), which is decide(policy, in, advance(
+  // policy, state, in)): advance() validates the sample and updates the
+  // derivative and trend (depends only on the policy's dynamics), decide()
+  // applies the eligibility thresholds, penalties and gate
+  static TrendStep advance(const CompiledPolicy& policy, TrendState& state, const PhaseSignals& in);
+  static PhaseReadinessOutput decide(const CompiledPolicy& policy, const PhaseSignals& in,
+                                     const TrendStep& step);
+
+  // Readiness decide() assigns to an output carrying `flags` (Steps 8 and
+  // 10): the product of the per-flag penalties, zeroed for fail-safe and
+  // safety-overridden outputs. The compressed history predicts readiness
+  // with it, so the penalties are defined here only.
+  static double readinessFromFlags(uint32_t flags) {
+    const uint32_t forced_zero =
+        FLAG_FAILSAFE_DEFAULT | FLAG_TEMP_OUT_OF_RANGE | FLAG_GRADIENT_TOO_HIGH | FLAG_HYSTERESIS_HIGH;
+    if (flags & forced_zero) {
+      return 0.0;
+    }
+    double readiness = 1.0;
+    if (flags & FLAG_COHERENCE_LOW)      readiness *= 0.70;
+    if (flags & FLAG_PERSISTENT_HEATING) readiness *= 0.80;
+    if (flags & FLAG_PERSISTENT_COOLING) readiness *= 0.90;
+    return readiness;
+  }
+
+  // Write to `out` the output `from`, produced by decide() with a policy
+  // for which policy.sameReadiness() holds, with its gate re-mapped to
+  // `policy`'s gate thresholds: equal to decide() with `policy` on the same
+  // input and step (fail-safe and safety-overridden outputs stay BLOCK).
+  // Inline: it runs once per threshold-only shadow per sample.
+  static void regate(const CompiledPolicy& policy, const PhaseReadinessOutput& from,
+                     PhaseReadinessOutput& out) {
+    const uint32_t forced_block =
+        FLAG_FAILSAFE_DEFAULT | FLAG_TEMP_OUT_OF_RANGE | FLAG_GRADIENT_TOO_HIGH | FLAG_HYSTERESIS_HIGH;
+    out = from;
+    if (from.flags & forced_block) {
+      out.gate = Gate::BLOCK;
+    } else if (from.readiness >= policy.config.gate_allow_threshold) {
+      out.gate = Gate::ALLOW;
+    } else if (from.readiness >= policy.config.gate_caution_threshold) {
+      out.gate = Gate::CAUTION;
+    } else {
+      out.gate = Gate::BLOCK;
+    }
+  }
+
   // Config validation: returns true iff all fields are in valid ranges
   static bool validate(const PhaseReadinessConfig& cfg);
 
   // Returns false if the config passed at construction was invalid
   bool configValid() const;
 
+  const CompiledPolicy& policy() const { return *policy_; }
+
 private:
-  PhaseReadinessConfig cfg_;
-  bool   has_prev_;
-  double prev_t_s_;
-  double prev_temp_C_;
-  double trend_dTdt_;
-  double trend_age_s_;
-  bool   config_valid_;
+  const CompiledPolicy* policy_;
+  std::shared_ptr<const CompiledPolicy> owned_;   // Null when shared
+  TrendState state_;
   
   static bool is_finite(double x);
-  static double clamp01(double x);
-  Gate gate_from_readiness(double r) const;
+  static Gate gate_from_readiness(const PhaseReadinessConfig& cfg, double r);
 };
 
 // General-purpose gate string conversion (free function in hlv namespace)
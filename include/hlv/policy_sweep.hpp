@@ -0,0 +1,122 @@
+#pragma once
+
+// Vectorized policy sweep over recorded traces
+//
+// Tuning a PhaseReadinessConfig used to mean one full replay per candidate.
+// PolicySweep evaluates K configs over one sample stream in a single pass
+// and reports, per config, gate occupancy, gate transitions and the number
+// of samples whose gate differs from a baseline config. Every config's
+// gate sequence is identical to a PhaseReadinessMiddleware with that
+// config on the same stream (configs are sanitized the same way).
+//
+// DESIGN:
+// - Configs are lanes: parameters and trend state are struct-of-arrays
+//   columns, and the kernel advances two lanes per SSE2 vector (baseline
+//   ISA on x86-64, no runtime dispatch; scalar elsewhere). Outcomes that
+//   do not depend on the config (invalid input, bootstrap) are decided once
+//   per sample for all lanes.
+// - The stream is cut into blocks (trace blocks, or block_samples samples
+//   of an array). Each block is converted once into dense t/temp/
+//   hysteresis/coherence columns; each lane pair then runs over the whole
+//   block with its policy, state and counters in registers while the
+//   columns stream from L2. The trace itself is read once per worker.
+// - The baseline is evaluated once per block with the scalar middleware
+//   code and its gates compared lane-wise.
+// - With threads > 1 the lanes are split into contiguous ranges, one per
+//   worker; each worker streams the blocks itself.
+// - Gates match the scalar middleware bit for bit as long as both are
+//   built without floating-point contraction (no FMA: the default on
+//   x86-64 without -march/-mfma).
+//
+// Results accumulate across run() calls, which continue the stream.
+// Not thread-safe: one caller at a time.
+
+#include "hlv/phase_readiness.hpp"
+#include "hlv/trace.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace hlv {
+
+// Statistics of one swept config
+struct SweepResult {
+  uint64_t gate_counts[3] = {0, 0, 0};   // Indexed by Gate
+  uint64_t transitions = 0;              // Gate changes between consecutive samples (from BLOCK)
+  uint64_t disagreements = 0;            // Samples whose gate differs from the baseline's
+
+  // Fraction of samples with gate `g`
+  double occupancy(Gate g, uint64_t samples) const {
+    return samples ? static_cast<double>(gate_counts[static_cast<size_t>(g)]) / static_cast<double>(samples)
+                   : 0.0;
+  }
+};
+
+// Values swept per parameter; an empty axis keeps the base config's value
+struct SweepAxes {
+  std::vector<double> max_abs_dTdt_C_per_s;
+  std::vector<double> persistence_s;
+  std::vector<double> ewma_alpha;
+  std::vector<double> gate_allow_threshold;
+  std::vector<double> gate_caution_threshold;
+};
+
+struct PolicySweepOptions {
+  size_t threads = 1;
+  size_t block_samples = 4096;    // Block size for array input
+};
+
+class PolicySweep {
+public:
+  PolicySweep(const PhaseReadinessConfig& baseline, const std::vector<PhaseReadinessConfig>& configs,
+              const PolicySweepOptions& options = PolicySweepOptions());
+  ~PolicySweep();
+
+  PolicySweep(const PolicySweep&) = delete;
+  PolicySweep& operator=(const PolicySweep&) = delete;
+
+  // Cartesian product of `axes` over `base`, the last axis varying fastest
+  static std::vector<PhaseReadinessConfig> grid(const PhaseReadinessConfig& base, const SweepAxes& axes);
+
+  // Evaluate `count` more samples
+  void run(const PhaseSignals* samples, size_t count);
+
+  // Evaluate every block of an open trace (its recorded config is not used)
+  void run(const TraceReader& trace);
+
+  size_t size() const { return configs_.size(); }
+  uint64_t samples() const { return samples_; }
+
+  // Config `i` as evaluated (sanitized)
+  const PhaseReadinessConfig& config(size_t i) const { return configs_[i]; }
+  const PhaseReadinessConfig& baseline() const { return baseline_.config; }
+
+  SweepResult result(size_t i) const;
+
+  // Return every lane and the baseline to the bootstrap state and zero
+  // the results
+  void reset();
+
+private:
+  struct Lanes;
+  struct Columns;
+
+  // Load block `b` into `cols`
+  using BlockLoader = std::function<void(size_t b, Columns& cols)>;
+
+  void runBlocks(size_t blocks, const BlockLoader& load);
+  void runRange(size_t first_lane, size_t end_lane, size_t blocks, const BlockLoader& load,
+                TrendState& baseline_state);
+
+  std::vector<PhaseReadinessConfig> configs_;
+  CompiledPolicy baseline_;   // Compiled, not interned: private to this sweep
+  PolicySweepOptions options_;
+  std::unique_ptr<Lanes> lanes_;
+  TrendState baseline_state_;
+  uint64_t samples_;
+};
+
+} // namespace hlv
@@ -8,32 +8,42 @@
 // - Runs in dedicated thread, non-blocking to readiness loop
 // - Lightweight POSIX sockets implementation
 // - No control surfaces, observability only
+//
+// Optional gzip/deflate response compression is compiled in when the
+// build defines HLV_WITH_ZLIB (and links -lz); otherwise bodies are
+// always sent uncompressed.
 
+#include "hlv/columnar_history.hpp"
+#include "hlv/history_store.hpp"
+#include "hlv/metrics.hpp"
 #include "hlv/phase_readiness.hpp"
+#include "hlv/quantile_sketch.hpp"
 #include <atomic>
 #include <chrono>
-#include <deque>
+#include <functional>
 #include <mutex>
+#include <ostream>
 #include <string>
 #include <thread>
 #include <vector>
 
 namespace hlv {
 
-// Timestamped snapshot for history tracking
-struct ReadinessSnapshot {
-  std::chrono::steady_clock::time_point timestamp{};
-  double t_s = 0.0;
-  double readiness = 0.0;
-  Gate gate = Gate::BLOCK;
-  uint32_t flags = 0;
-  double temp_C = std::numeric_limits<double>::quiet_NaN();
-  double temp_ambient_C = std::numeric_limits<double>::quiet_NaN();
-  double dTdt_C_per_s = 0.0;
-  double trend_C = 0.0;
-  double stability_score = 0.0;
-  double hysteresis_index = std::numeric_limits<double>::quiet_NaN();
-  double coherence_index = std::numeric_limits<double>::quiet_NaN();
+class ChannelRegistry;
+
+// One evaluated sample, as queued for publication
+struct ReadinessUpdate {
+  PhaseSignals signals;
+  PhaseReadinessOutput output;
+};
+
+// Everything set through ReadinessAPIState's configuration setters
+struct ReadinessStateConfig {
+  size_t max_history_size = 100;
+  CompressedHistoryConfig compressed_history;
+  std::vector<RollupLevelConfig> rollup_levels = defaultRollupLevels();
+  size_t transition_log_size = 4096;
+  std::vector<QuantileWindowConfig> quantile_windows = defaultQuantileWindows();
 };
 
 // Thread-safe shared state for API server
@@ -44,18 +54,90 @@ public:
   // Update current state (called by readiness inference loop)
   void update(const PhaseSignals& signals, const PhaseReadinessOutput& output);
   
+  // Apply `count` updates in order under one lock acquisition and one
+  // clock read; the sequence advances once for the whole batch
+  void updateBatch(const ReadinessUpdate* updates, size_t count);
+  
   // Read-only access methods (called by API endpoints)
   ReadinessSnapshot getCurrentSnapshot() const;
   std::vector<ReadinessSnapshot> getHistory(size_t max_count) const;
   
+  // Newest `max_count` samples with from_t <= t_s <= to_t that match
+  // `filter`. Served from the compressed tier when enabled (blocks are
+  // decoded outside the lock), otherwise from the recent history.
+  std::vector<ReadinessSnapshot> getHistoryRange(double from_t, double to_t, size_t max_count,
+                                                 const HistoryFilter& filter = HistoryFilter()) const;
+  CompressedHistoryStats getCompressedHistoryStats() const;
+  
+  // Aggregates over the recent history (setMaxHistorySize() samples) with
+  // from_t <= t_s <= to_t, computed by the columnar SIMD kernels
+  HistoryStats getHistoryStats(double from_t, double to_t) const;
+  
+  // Sliding-window quantile sketches of readiness, dTdt_C_per_s and
+  // trend_C (fields in that order), updated per sample. Copied under the
+  // lock; merge and query the copy.
+  WindowedQuantiles getQuantiles() const;
+  
+  // Rollup buckets at `resolution_s` overlapping [from_t, to_t]; false if
+  // no rollup level has that resolution
+  bool getRollup(double resolution_s, double from_t, double to_t, std::vector<RollupBucket>& out) const;
+  std::vector<double> getRollupResolutions() const;
+  
+  // Gate/flag transition log: O(1) dwell state, transitions within the
+  // last `window_s` seconds of t_s, and the newest `max_count` runs
+  // overlapping [from_t, to_t]
+  DwellState getDwellState() const;
+  uint64_t getTransitionCount(double window_s) const;
+  std::vector<GateRun> getTransitions(double from_t, double to_t, size_t max_count) const;
+  
+  // State version: increments once per update() or updateBatch(), so a
+  // response rendered at sequence N is valid until N changes.
+  uint64_t getSequence() const;
+  
+  // Prometheus counters maintained by update(); the readiness loop may also
+  // report evaluate() latency through metrics().recordEvaluateLatency()
+  ReadinessMetrics& metrics();
+  const ReadinessMetrics& metrics() const;
+  
   // Configuration
   void setMaxHistorySize(size_t size);
   
+  // Enable (max_samples > 0) or disable the compressed long-horizon tier;
+  // discards any samples it already holds
+  void setCompressedHistory(const CompressedHistoryConfig& config);
+  
+  // Replace the rollup levels (default: defaultRollupLevels()); discards
+  // existing buckets
+  void setRollupLevels(const std::vector<RollupLevelConfig>& levels);
+  
+  // Runs retained by the transition log (default 4096); discards the log
+  void setTransitionLogSize(size_t max_runs);
+  
+  // Replace the quantile windows (default: defaultQuantileWindows());
+  // discards existing sketches
+  void setQuantileWindows(const std::vector<QuantileWindowConfig>& windows);
+  
+  // The configuration as set so far (defaults for anything never set)
+  ReadinessStateConfig configuration() const;
+  
+  // Apply every setting of `config`, as the individual setters do
+  void configure(const ReadinessStateConfig& config);
+  
 private:
+  // Apply one sample; caller holds mutex_
+  void applyLocked(const PhaseSignals& signals, const PhaseReadinessOutput& output,
+                   std::chrono::steady_clock::time_point now);
+  
   mutable std::mutex mutex_;
   ReadinessSnapshot current_;
-  std::deque<ReadinessSnapshot> history_;
-  size_t max_history_size_;
+  ColumnarHistory history_;
+  CompressedHistory compressed_history_;
+  RollupHistory rollups_;
+  TransitionLog transitions_;
+  WindowedQuantiles quantiles_;
+  ReadinessStateConfig config_;
+  std::atomic<uint64_t> sequence_;
+  ReadinessMetrics metrics_;
 };
 
 // Configuration for REST API server
@@ -64,6 +146,10 @@ struct RestAPIConfig {
   uint16_t port = 8080;
   int listen_backlog = 10;
   int socket_timeout_ms = 5000;
+  size_t history_max_samples = 100;      // Samples returned by /api/history, runs by /api/transitions
+  double transition_window_s = 60.0;     // Window for transition counts in /api/phase_context
+  bool enable_compression = true;        // Honor Accept-Encoding (needs HLV_WITH_ZLIB)
+  size_t compression_min_bytes = 1024;   // Bodies smaller than this are sent as-is
 };
 
 // REST API Server
@@ -82,6 +168,19 @@ public:
   // Check if server is running
   bool isRunning() const;
   
+  // Render an endpoint body for `target` ("/path?query") without a socket,
+  // exactly as a GET would (used by benchmarks and diagnostics tooling)
+  std::string renderBody(const std::string& target, int* status_code = nullptr);
+  
+  // Extra Prometheus text appended to /metrics, e.g. IngestPipeline::render.
+  // Set before start(); the hook runs on the server thread.
+  void setMetricsHook(std::function<void(std::ostream&)> hook);
+  
+  // Serve /api/channels, /api/channels/top, /api/channels/{id}/readiness|
+  // thermal|history|diagnostics and /api/summary from `registry` (must
+  // outlive the server). Set before start().
+  void setChannelRegistry(const ChannelRegistry* registry);
+  
 private:
   ReadinessAPIState& state_;
   RestAPIConfig config_;
@@ -100,26 +199,79 @@ private:
   struct HttpRequest {
     std::string method;
     std::string path;
+    std::string query;
     std::string version;
+    std::string accept_encoding;
+    std::string if_none_match;
   };
   
   bool parseRequest(const std::string& request, HttpRequest& parsed);
   
+  // Content-coding negotiation (Accept-Encoding)
+  enum class ContentEncoding : uint8_t { IDENTITY = 0, GZIP = 1, DEFLATE = 2 };
+  static ContentEncoding negotiateEncoding(const std::string& accept_encoding);
+  static bool compressBody(const std::string& body, ContentEncoding encoding, std::string& out);
+  
+  // Compressed bodies keyed by request target, encoding and state sequence.
+  // Only touched from the server thread, so no locking is required.
+  struct CompressedBody {
+    std::string target;
+    ContentEncoding encoding = ContentEncoding::IDENTITY;
+    uint64_t sequence = 0;
+    std::string body;
+  };
+  std::vector<CompressedBody> compressed_cache_;
+  
+  // Entity tags: weak validator over (server instance, state sequence, target)
+  uint64_t etag_salt_;
+  std::string makeETag(const std::string& target, uint64_t sequence) const;
+  static bool etagMatches(const std::string& if_none_match, const std::string& etag);
+  static const std::vector<std::string>& endpointPaths();
+  bool isSequenceVersioned(const std::string& path) const;
+  
+  // State a request path reads: the channel for /api/channels/{id}/..., the
+  // server's own state otherwise; nullptr for an unknown channel
+  const ReadinessAPIState* stateForPath(const std::string& path) const;
+  
+  // Request counts and latency per endpoint, rendered by /metrics
+  ServerMetrics metrics_;
+  std::function<void(std::ostream&)> metrics_hook_;
+  const ChannelRegistry* channels_;
+  
+  // Parse, negotiate and render one request into a complete HTTP response
+  std::string buildResponse(const std::string& request, HttpRequest& parsed, int& status_code);
+  
+  // Route to endpoint handler; sets status on error
+  std::string renderEndpoint(const HttpRequest& request, int& status_code, std::string& status_text,
+                             std::string& content_type);
+  
   // Endpoint handlers
   std::string handleHealth();
-  std::string handleReadiness();
-  std::string handleThermal();
-  std::string handleHistory();
+  std::string handleReadiness(const ReadinessAPIState& state);
+  std::string handleThermal(const ReadinessAPIState& state);
+  std::string handleHistory(const ReadinessAPIState& state, const std::string& query, int& status_code,
+                            std::string& status_text);
+  std::string handleHistoryRollup(const std::string& query, int& status_code, std::string& status_text);
+  std::string handleStats(const std::string& query, int& status_code, std::string& status_text);
+  std::string handleTransitions(const std::string& query, int& status_code, std::string& status_text);
   std::string handlePhaseContext();
-  std::string handleDiagnostics();
+  std::string handleDiagnostics(const ReadinessAPIState& state);
+  std::string handleChannels();
+  std::string handleChannelsTop(const std::string& query, int& status_code, std::string& status_text);
+  std::string handleSummary(const std::string& query, int& status_code, std::string& status_text);
+  std::string handleChannelEndpoint(const HttpRequest& request, int& status_code, std::string& status_text);
+  std::string handleMetrics();
   
   // Response generation
   std::string makeHttpResponse(int status_code, const std::string& status_text,
-                               const std::string& body, const std::string& content_type = "application/json");
+                               const std::string& body, const std::string& content_type = "application/json",
+                               const std::string& extra_headers = "",
+                               const std::string& etag = "");
   std::string makeJsonError(int code, const std::string& message);
   
   // Utility
   static std::string jsonEscape(const std::string& s);
+  static bool queryParam(const std::string& query, const char* key, std::string& value);
   static void writeJsonDouble(std::ostringstream& json, const char* key, double value, bool comma = true);
   static std::string formatTimestamp(const std::chrono::steady_clock::time_point& tp);
   bool sendAll(int sock, const std::string& data);
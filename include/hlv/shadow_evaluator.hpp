@@ -0,0 +1,133 @@
+#pragma once
+
+// Shadow evaluation of candidate policies on live data
+//
+// ShadowEvaluator runs one primary PhaseReadinessConfig plus up to
+// kMaxShadows candidate ("shadow") configs over the same sample stream.
+// evaluate() returns the primary output exactly as a PhaseReadinessMiddleware
+// with the primary config would; every shadow output is likewise identical
+// to a standalone middleware with that config. Per shadow it accumulates
+// a confusion matrix of (primary gate, shadow gate), the number of
+// disagreeing samples, the t_s of the first and latest disagreement and
+// the largest readiness difference.
+//
+// SHARED WORK:
+// - evaluate() is split into advance() (input validation, dt, dT/dt, EWMA
+//   trend and trend age) and decide() (thresholds, penalties, gate). The
+//   former depends only on a policy's dynamics (max_dt_s,
+//   max_abs_temp_jump_C, ewma_alpha, persistence_s)
+// - Policies with equal dynamics share one trend track, so candidates that
+//   only move thresholds (the usual rollout) cost one decide() each and
+//   no extra derivative or EWMA work; each distinct dynamics adds one
+//   advance() per sample
+// - A shadow that differs from the primary or an earlier shadow only in
+//   gate_allow_threshold / gate_caution_threshold reuses that output and
+//   re-maps its gate (regate()) instead of running decide()
+//
+// COST BOUND: per sample at most kMaxShadows + 1 advance() calls and
+// kMaxShadows + 1 decide() or regate() calls, with no allocation, lock or
+// syscall.
+// Statistics are relaxed atomics written by the evaluating thread only.
+//
+// SAFETY:
+// - evaluate(), addShadow(), reset() and resetStats() must be called from
+//   one thread (the readiness loop); stats(), shadowCount() and render()
+//   may be called from any thread
+// - A shadow added mid-stream joins an existing track (already warmed up)
+//   if its dynamics match, otherwise it starts from the bootstrap state;
+//   add shadows before the first sample to compare from the start
+// - Shadow outputs never feed back into the primary
+
+#include "hlv/phase_readiness.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+
+namespace hlv {
+
+// Agreement of one shadow with the primary
+struct ShadowStats {
+  std::string name;
+  uint64_t samples = 0;
+  uint64_t disagreements = 0;               // Samples whose gates differ
+  uint64_t confusion[3][3] = {};            // [primary gate][shadow gate], indexed by Gate
+  double first_divergence_t_s = std::numeric_limits<double>::quiet_NaN();   // NaN: never
+  double last_divergence_t_s = std::numeric_limits<double>::quiet_NaN();
+  double max_abs_readiness_delta = 0.0;
+};
+
+class ShadowEvaluator {
+public:
+  static constexpr size_t kMaxShadows = 16;
+
+  explicit ShadowEvaluator(const PhaseReadinessConfig& primary);
+
+  ShadowEvaluator(const ShadowEvaluator&) = delete;
+  ShadowEvaluator& operator=(const ShadowEvaluator&) = delete;
+
+  // Add a candidate. Returns false if `name` is empty, repeated or not
+  // [A-Za-z0-9_.-], or kMaxShadows shadows already exist.
+  bool addShadow(const std::string& name, const PhaseReadinessConfig& config);
+
+  size_t shadowCount() const { return shadow_count_.load(std::memory_order_acquire); }
+
+  // Distinct trend tracks (the primary's included)
+  size_t trackCount() const { return track_count_; }
+
+  // Shadows evaluated with their own decide() rather than a regate()
+  size_t decideCount() const;
+
+  // Evaluate the primary and every shadow; returns the primary output
+  PhaseReadinessOutput evaluate(const PhaseSignals& in);
+
+  // Output of shadow `i` for the last sample (evaluating thread)
+  const PhaseReadinessOutput& shadowOutput(size_t i) const { return shadows_[i].output; }
+
+  const CompiledPolicy& primaryPolicy() const { return primary_; }
+
+  // Statistics of shadow `i` (empty if out of range)
+  ShadowStats stats(size_t i) const;
+
+  // Return the primary and every shadow to the bootstrap state
+  void reset();
+
+  // Zero all statistics
+  void resetStats();
+
+  // Prometheus text exposition (hlv_shadow_*), one series set per shadow
+  void render(std::ostream& out) const;
+
+private:
+  struct Shadow {
+    std::string name;
+    CompiledPolicy policy;
+    size_t track = 0;
+    const PhaseReadinessOutput* regate_from = nullptr;   // Null: own decide()
+    PhaseReadinessOutput output;
+    std::atomic<uint64_t> confusion[3][3];   // Zeroed by resetStats()
+    std::atomic<uint64_t> disagreements{0};
+    std::atomic<double> first_divergence_t_s{0.0};
+    std::atomic<double> last_divergence_t_s{0.0};
+    std::atomic<double> max_abs_readiness_delta{0.0};
+    std::atomic<bool> diverged{false};
+  };
+
+  void record(Shadow& shadow, const PhaseReadinessOutput& primary, double t_s);
+
+  // Compiled, not interned: ad-hoc candidates must not grow the
+  // process-wide intern table
+  CompiledPolicy primary_;
+  PhaseReadinessOutput primary_output_;                   // Last primary output
+  TrendState tracks_[kMaxShadows + 1];                    // Track 0: primary
+  const CompiledPolicy* track_policies_[kMaxShadows + 1];
+  size_t track_count_;
+  TrendStep steps_[kMaxShadows + 1];                      // Per-track scratch for evaluate()
+  std::unique_ptr<Shadow[]> shadows_;                     // kMaxShadows slots
+  std::atomic<size_t> shadow_count_;
+};
+
+} // namespace hlv
@@ -0,0 +1,209 @@
+#pragma once
+
+// Bounded lock-free single-producer/single-consumer ring
+//
+// - Exactly one producer thread calls tryPush(); exactly one consumer
+//   thread calls tryPop()/popBatch()
+// - Producer and consumer indices live on separate cache lines, and each
+//   side caches the other's index, so the common case touches no shared
+//   line at all
+// - Capacity is rounded up to a power of two; no allocation after
+//   construction
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace hlv {
+
+template <typename T>
+class SpscRing {
+public:
+  explicit SpscRing(size_t capacity)
+      : mask_(roundUpPow2(capacity < 2 ? 2 : capacity) - 1)
+      , slots_(new T[mask_ + 1])
+      , head_(0)
+      , tail_cache_(0)
+      , tail_(0)
+      , head_cache_(0)
+  {}
+
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+  size_t capacity() const { return mask_ + 1; }
+
+  // Approximate occupancy (exact when called from either endpoint thread)
+  size_t size() const {
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+  }
+
+  // Producer: returns false if the ring is full
+  bool tryPush(const T& item) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_cache_ > mask_) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (tail - head_cache_ > mask_) {
+        return false;
+      }
+    }
+    slots_[tail & mask_] = item;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer: returns false if the ring is empty
+  bool tryPop(T& item) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_cache_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (head == tail_cache_) {
+        return false;
+      }
+    }
+    item = slots_[head & mask_];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer: pop up to max_items into out, returns the number popped
+  size_t popBatch(T* out, size_t max_items) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    tail_cache_ = tail_.load(std::memory_order_acquire);
+    size_t n = tail_cache_ - head;
+    if (n > max_items) n = max_items;
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = slots_[(head + i) & mask_];
+    }
+    head_.store(head + n, std::memory_order_release);
+    return n;
+  }
+
+private:
+  static size_t roundUpPow2(size_t v) {
+    size_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+  }
+
+  const size_t mask_;
+  const std::unique_ptr<T[]> slots_;
+
+  alignas(64) std::atomic<size_t> head_;   // Written by consumer
+  size_t tail_cache_;                      // Consumer's view of tail_
+  alignas(64) std::atomic<size_t> tail_;   // Written by producer
+  size_t head_cache_;                      // Producer's view of head_
+};
+
+// Bounded SPSC ring whose producer may also discard the oldest item
+//
+// Every slot carries a sequence number (slot.seq == pos: free for the
+// producer writing position pos; pos + 1: holds item pos), and head_ is
+// claimed with a CAS, so the producer can take the oldest item away from
+// the consumer when the ring is full (tryPushEvict) without either side
+// taking a lock. An item is copied out only after its position has been
+// claimed, so no slot is ever read and written concurrently.
+template <typename T>
+class SpscEvictingRing {
+public:
+  explicit SpscEvictingRing(size_t capacity)
+      : mask_(roundUpPow2(capacity < 2 ? 2 : capacity) - 1)
+      , slots_(new Slot[mask_ + 1])
+      , head_(0)
+      , tail_(0)
+  {
+    for (size_t i = 0; i <= mask_; ++i) {
+      slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  SpscEvictingRing(const SpscEvictingRing&) = delete;
+  SpscEvictingRing& operator=(const SpscEvictingRing&) = delete;
+
+  size_t capacity() const { return mask_ + 1; }
+
+  // Approximate occupancy (exact when called from either endpoint thread)
+  size_t size() const {
+    const size_t head = head_.load(std::memory_order_acquire);
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+
+  // Producer: returns false if the ring is full
+  bool tryPush(const T& item) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[tail & mask_];
+    if (slot.seq.load(std::memory_order_acquire) != tail) {
+      return false;
+    }
+    slot.item = item;
+    slot.seq.store(tail + 1, std::memory_order_release);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Producer: push, discarding the oldest item if the ring is full.
+  // Returns false (nothing evicted, item not queued) only if the consumer
+  // is copying out that very slot at this instant.
+  bool tryPushEvict(const T& item, bool& evicted) {
+    evicted = false;
+    if (tryPush(item)) {
+      return true;
+    }
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = tail - mask_ - 1;   // The oldest item shares the tail slot
+    if (!head_.compare_exchange_strong(head, head + 1, std::memory_order_acq_rel)) {
+      return false;
+    }
+    Slot& slot = slots_[tail & mask_];
+    slot.item = item;
+    slot.seq.store(tail + 1, std::memory_order_release);
+    tail_.store(tail + 1, std::memory_order_release);
+    evicted = true;
+    return true;
+  }
+
+  // Consumer: pop up to max_items into out, returns the number popped
+  size_t popBatch(T* out, size_t max_items) {
+    size_t head = head_.load(std::memory_order_acquire);
+    while (true) {
+      size_t n = 0;
+      while (n < max_items &&
+             slots_[(head + n) & mask_].seq.load(std::memory_order_acquire) == head + n + 1) {
+        ++n;
+      }
+      if (n == 0) {
+        return 0;
+      }
+      // Fails only if the producer evicted `head` meanwhile; head is reloaded
+      if (head_.compare_exchange_weak(head, head + n, std::memory_order_acq_rel)) {
+        for (size_t i = 0; i < n; ++i) {
+          Slot& slot = slots_[(head + i) & mask_];
+          out[i] = slot.item;
+          slot.seq.store(head + i + mask_ + 1, std::memory_order_release);
+        }
+        return n;
+      }
+    }
+  }
+
+private:
+  struct Slot {
+    std::atomic<size_t> seq;
+    T item;
+  };
+
+  static size_t roundUpPow2(size_t v) {
+    size_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+  }
+
+  const size_t mask_;
+  const std::unique_ptr<Slot[]> slots_;
+
+  alignas(64) std::atomic<size_t> head_;   // Claimed by the consumer, or by an evicting producer
+  alignas(64) std::atomic<size_t> tail_;   // Written by producer
+};
+
+} // namespace hlv
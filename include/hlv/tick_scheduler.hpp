@@ -0,0 +1,214 @@
+#pragma once
+
+// Deadline-driven evaluation of many channels per tick
+//
+// TickScheduler owns one PhaseReadinessMiddleware per channel and a pool
+// of (optionally CPU-pinned) worker threads. Channels may use different
+// configs; identical configs share one interned CompiledPolicy. runTick() hands the tick's
+// PhaseSignals to the pool, which evaluates every channel exactly once,
+// optionally publishes each output to a ChannelRegistry, and returns when
+// the last channel is done (the completion barrier).
+//
+// SCHEDULING:
+// - Channels are cut into fixed chunks of `chunk_size`; each worker starts
+//   on its own contiguous share of the chunks, so in the common case a
+//   worker walks one region of memory
+// - A worker that runs out steals chunks from the others. Every worker's
+//   share is an atomic cursor that owner and thieves both advance with
+//   fetch_add, so each chunk is claimed exactly once without a lock
+// - Idle workers sleep on a condition variable between ticks
+//
+// DETERMINISM:
+// - A channel's output depends only on its own middleware and its own
+//   signals, never on which worker evaluated it or in what order; the
+//   barrier orders one tick's evaluation before the next, so results are
+//   bit-identical for any worker count or steal pattern
+// - With a registry, each tick is one ChannelRegistry epoch, so readers
+//   never see a partially evaluated tick
+//
+// NUMA PLACEMENT:
+// - Shares come from a ChannelShardMap over the workers' nodes (from
+//   `worker_cpus` and the detected NumaTopology), so each node owns one
+//   contiguous channel range and thieves try workers of their own node
+//   before crossing to another
+// - Each worker allocates and constructs its own share of the middlewares
+//   on its first start(), after pinning, so first-touch puts that state on
+//   the worker's node. On a multi-node machine it also rebuilds its share
+//   of an untouched registry's channels (ChannelRegistry::placeChannels()),
+//   which places their history rings and snapshot slots the same way
+// - A channel evaluated by a worker running on another node than the one
+//   its state was built on counts as a remote access
+// - On a single node the shard map reduces to plain contiguous shares, the
+//   registry is left alone and the remote ratio stays 0
+//
+// METRICS: per-tick makespan (release to barrier), deadline misses and,
+// per worker, channels evaluated, chunks stolen, remote channels and
+// utilization (busy time over the sum of makespans), and the overall
+// remote access ratio. render() exports them as hlv_tick_*.
+//
+// SAFETY:
+// - runTick() and lastTick() must be called from one coordinating thread
+// - While a tick runs, only the workers touch the middlewares
+// - With registry placement in effect, start() replaces registry channel
+//   objects on its first call: start the scheduler before the registry is
+//   served (e.g. before RestAPIServer::start())
+
+#include "hlv/channel_registry.hpp"
+#include "hlv/metrics.hpp"
+#include "hlv/numa_topology.hpp"
+#include "hlv/phase_readiness.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace hlv {
+
+struct TickSchedulerConfig {
+  size_t workers = 4;              // Worker threads (at least 1)
+  std::vector<int> worker_cpus;    // CPU per worker; missing entries or -1 = no pinning
+  size_t chunk_size = 64;          // Channels per unit of work (and of stealing)
+  double deadline_s = 0.001;       // Makespan above this counts as a miss
+  bool place_registry = true;      // Multi-node: re-place untouched registry channels on first start()
+  std::shared_ptr<const NumaTopology> topology;   // Null: NumaTopology::detect()
+};
+
+// Outcome of the most recent tick
+struct TickStats {
+  uint64_t tick = 0;         // 1-based tick number
+  double makespan_s = 0.0;   // runTick() release to completion barrier
+  bool missed = false;       // makespan_s > deadline_s
+  uint64_t steals = 0;       // Chunks evaluated by a worker that did not own them
+};
+
+class TickScheduler {
+public:
+  // `registry` may be null; otherwise it must hold `channels` channels and
+  // outlive the scheduler
+  TickScheduler(const PhaseReadinessConfig& readiness_config, size_t channels,
+                ChannelRegistry* registry = nullptr,
+                const TickSchedulerConfig& config = TickSchedulerConfig{});
+
+  // Channel i evaluates with `channel_configs[i]`
+  TickScheduler(const std::vector<PhaseReadinessConfig>& channel_configs,
+                ChannelRegistry* registry = nullptr,
+                const TickSchedulerConfig& config = TickSchedulerConfig{});
+  ~TickScheduler();
+
+  TickScheduler(const TickScheduler&) = delete;
+  TickScheduler& operator=(const TickScheduler&) = delete;
+
+  // Start the worker pool. Returns false if already running or if the
+  // registry does not match the channel count.
+  bool start();
+
+  // Join the workers (waits for a tick in progress)
+  void stop();
+
+  bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+  size_t channels() const { return channels_; }
+  size_t workers() const { return config_.workers; }
+
+  // Number of workers that were pinned to their configured CPU
+  size_t pinnedWorkers() const { return pinned_.load(std::memory_order_acquire); }
+
+  const NumaTopology& topology() const { return topology_; }
+  const ChannelShardMap& shardMap() const { return shard_map_; }
+
+  // Node worker `worker` built its share on (valid after start())
+  int workerNode(size_t worker) const;
+
+  // Registry channels rebuilt by the workers (0 unless placement applied)
+  size_t registryChannelsPlaced() const { return registry_placed_.load(std::memory_order_acquire); }
+
+  // Evaluate every channel for one tick (`signals[i]` feeds channel i) and
+  // wait for the barrier. Returns false if not running or if the signal
+  // count does not match channels().
+  bool runTick(const std::vector<PhaseSignals>& signals);
+
+  // Outputs of the last tick, indexed by channel (coordinating thread)
+  const std::vector<PhaseReadinessOutput>& outputs() const { return outputs_; }
+  const TickStats& lastTick() const { return last_; }
+
+  // Counters (safe to read from any thread)
+  uint64_t tickCount() const { return ticks_.load(std::memory_order_relaxed); }
+  uint64_t deadlineMissCount() const { return misses_.load(std::memory_order_relaxed); }
+  uint64_t workerChannels(size_t worker) const;
+  uint64_t workerSteals(size_t worker) const;
+  uint64_t workerRemoteChannels(size_t worker) const;
+  double remoteAccessRatio() const;                // Remote over all evaluated channels
+  double workerUtilization(size_t worker) const;   // 0 before the first tick
+
+  // Prometheus text exposition of the counters above (hlv_tick_*)
+  void render(std::ostream& out) const;
+
+private:
+  // One worker's share of the chunks for the current tick
+  struct alignas(64) WorkQueue {
+    std::atomic<size_t> next{0};   // Next chunk to claim (may overshoot end)
+    size_t end = 0;                // One past the last owned chunk
+  };
+
+  struct alignas(64) WorkerStats {
+    std::atomic<uint64_t> channels{0};
+    std::atomic<uint64_t> steals{0};
+    std::atomic<uint64_t> remote{0};
+    std::atomic<uint64_t> busy_ns{0};
+  };
+
+  // One worker's channels, allocated by that worker; middlewares[i] is
+  // channel first_channel + i of the shard map
+  struct alignas(64) Shard {
+    std::vector<PhaseReadinessMiddleware> middlewares;
+    std::atomic<int> node{0};   // Node the middlewares were built on
+  };
+
+  // `seen`: generation at start(), so a tick released before the thread
+  // first waits is not missed
+  TickScheduler(std::vector<const CompiledPolicy*> policies, ChannelRegistry* registry,
+                const TickSchedulerConfig& config);
+
+  void workerLoop(size_t worker, uint64_t seen);
+  void buildShard(size_t worker);
+  void runChunk(size_t queue, size_t chunk);
+  bool claimChunk(size_t queue, size_t& chunk);
+
+  TickSchedulerConfig config_;
+  std::vector<const CompiledPolicy*> policies_;          // Per channel, interned
+  ChannelRegistry* registry_;
+  size_t channels_;
+  NumaTopology topology_;
+  ChannelShardMap shard_map_;
+  std::vector<PhaseReadinessOutput> outputs_;
+  const PhaseSignals* signals_;                          // Current tick's inputs
+  bool built_;                                           // Shards built (first start())
+
+  std::unique_ptr<Shard[]> shards_;                      // Owned by the workers during a tick
+  std::unique_ptr<WorkQueue[]> queues_;
+  std::unique_ptr<WorkerStats[]> stats_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable start_cv_;   // Workers wait for a new generation
+  std::condition_variable done_cv_;    // Coordinator waits for the barrier
+  uint64_t generation_;                // Guarded by mutex_
+  size_t remaining_;                   // Workers still in the tick (or start()); guarded by mutex_
+  bool should_stop_;                   // Guarded by mutex_
+
+  std::atomic<bool> running_;
+  std::atomic<size_t> pinned_;
+  std::atomic<size_t> registry_placed_;
+  std::atomic<uint64_t> ticks_;
+  std::atomic<uint64_t> misses_;
+  std::atomic<uint64_t> makespan_ns_total_;
+  MetricHistogram makespan_;
+  TickStats last_;
+};
+
+} // namespace hlv
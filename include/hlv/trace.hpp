@@ -0,0 +1,211 @@
+#pragma once
+
+// Binary trace format and zero-copy replay reader
+//
+// A trace is a recorded PhaseSignals stream (optionally with the
+// PhaseReadinessOutput produced for each sample) plus the
+// PhaseReadinessConfig that was in effect. It replaces CSV recordings:
+// records are fixed-stride and little-endian, so a memory-mapped file is
+// read in place without parsing.
+//
+// FILE LAYOUT (version 1, all integers/doubles little-endian):
+//
+//   TraceFileHeader            128 bytes, CRC-32 over its first 112 bytes
+//   { TraceBlockHeader          16 bytes, CRC-32 over the block's records
+//     record[record_count]      record_stride bytes each } ...
+//
+//   record = TraceSignalsRecord (48 bytes)
+//            [+ TraceOutputRecord (40 bytes) if TRACE_HAS_OUTPUTS]
+//
+// A block holds at most block_records records; writers that commit on a
+// timer (AuditLogger) emit shorter blocks. A file cut short mid-block (e.g.
+// power loss while recording) is readable up to its last complete block.
+
+#include "hlv/phase_readiness.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace hlv {
+
+constexpr uint16_t kTraceVersion = 1;
+constexpr uint32_t kTraceDefaultBlockRecords = 4096;
+
+// TraceFileHeader::flags
+enum TraceFlags : uint16_t {
+  TRACE_HAS_OUTPUTS = 1u << 0
+};
+
+struct TraceFileHeader {
+  char magic[8];                // "HLVTRACE"
+  uint16_t version;
+  uint16_t flags;               // TraceFlags
+  uint32_t record_stride;       // 48, or 88 with outputs
+  uint32_t block_records;       // Maximum records per block
+  uint32_t reserved0;
+  double config[11];            // PhaseReadinessConfig, declaration order
+  uint32_t header_crc;          // CRC-32 of the preceding 112 bytes
+  uint8_t reserved1[12];
+};
+
+struct TraceBlockHeader {
+  uint32_t magic;               // kTraceBlockMagic
+  uint32_t record_count;
+  uint32_t crc;                 // CRC-32 of record_count * record_stride bytes
+  uint32_t reserved;
+};
+
+constexpr uint32_t kTraceBlockMagic = 0x42564C48u; // "HLVB" in file byte order
+
+struct TraceSignalsRecord {
+  double t_s;
+  double temp_C;
+  double temp_ambient_C;
+  double hysteresis_index;
+  double coherence_index;
+  uint8_t valid;
+  uint8_t reserved[7];
+};
+
+struct TraceOutputRecord {
+  double readiness;
+  double dTdt_C_per_s;
+  double trend_C;
+  double stability_score;
+  uint32_t flags;
+  uint8_t gate;
+  uint8_t reserved[3];
+};
+
+static_assert(sizeof(TraceFileHeader) == 128, "trace header layout");
+static_assert(sizeof(TraceBlockHeader) == 16, "trace block header layout");
+static_assert(sizeof(TraceSignalsRecord) == 48, "trace signals record layout");
+static_assert(sizeof(TraceOutputRecord) == 40, "trace output record layout");
+
+// CRC-32 (IEEE 802.3, same polynomial and result as zlib's crc32())
+uint32_t crc32(const void* data, size_t length, uint32_t crc = 0);
+
+// Conversions between in-memory types and on-disk records
+TraceSignalsRecord toTraceRecord(const PhaseSignals& in);
+TraceOutputRecord toTraceRecord(const PhaseReadinessOutput& out);
+PhaseSignals fromTraceRecord(const TraceSignalsRecord& rec);
+PhaseReadinessOutput fromTraceRecord(const TraceOutputRecord& rec);
+
+// Buffered, block-at-a-time trace writer
+class TraceWriter {
+public:
+  TraceWriter();
+  ~TraceWriter();
+
+  TraceWriter(const TraceWriter&) = delete;
+  TraceWriter& operator=(const TraceWriter&) = delete;
+
+  bool open(const std::string& path, const PhaseReadinessConfig& config,
+            bool with_outputs, uint32_t block_records = kTraceDefaultBlockRecords);
+
+  // Output is ignored when the trace was opened without outputs
+  bool append(const PhaseSignals& signals, const PhaseReadinessOutput& output = PhaseReadinessOutput{});
+
+  // Write the pending (possibly partial) block; the file stays open
+  bool flushBlock();
+
+  // Flush and close; returns false if any write failed
+  bool close();
+
+  bool isOpen() const { return file_ != nullptr; }
+  uint64_t recordsWritten() const { return records_written_; }
+  uint64_t bytesWritten() const { return bytes_written_; }
+
+  // Underlying stream (for fsync-style durability by callers)
+  std::FILE* file() const { return file_; }
+
+private:
+  std::FILE* file_;
+  bool with_outputs_;
+  bool ok_;
+  uint32_t block_records_;
+  uint32_t stride_;
+  uint32_t pending_;
+  std::vector<unsigned char> block_;
+  uint64_t records_written_;
+  uint64_t bytes_written_;
+};
+
+// Zero-copy view of one block in a mapped trace
+class TraceBlockView {
+public:
+  TraceBlockView() : data_(nullptr), count_(0), stride_(0), has_outputs_(false) {}
+  TraceBlockView(const unsigned char* data, size_t count, size_t stride, bool has_outputs)
+      : data_(data), count_(count), stride_(stride), has_outputs_(has_outputs) {}
+
+  size_t size() const { return count_; }
+  size_t stride() const { return stride_; }
+  bool hasOutputs() const { return has_outputs_; }
+
+  const TraceSignalsRecord& signals(size_t i) const {
+    return *reinterpret_cast<const TraceSignalsRecord*>(data_ + i * stride_);
+  }
+  // Only valid when hasOutputs()
+  const TraceOutputRecord& output(size_t i) const {
+    return *reinterpret_cast<const TraceOutputRecord*>(data_ + i * stride_ + sizeof(TraceSignalsRecord));
+  }
+
+  const unsigned char* data() const { return data_; }
+
+private:
+  const unsigned char* data_;
+  size_t count_;
+  size_t stride_;
+  bool has_outputs_;
+};
+
+// Read-only mmap-backed trace reader
+class TraceReader {
+public:
+  TraceReader();
+  ~TraceReader();
+
+  TraceReader(const TraceReader&) = delete;
+  TraceReader& operator=(const TraceReader&) = delete;
+
+  // Map and index the file. With verify_crc, every block checksum is
+  // checked up front and the first corrupt block ends the readable range.
+  bool open(const std::string& path, bool verify_crc = true);
+  void close();
+
+  const std::string& lastError() const { return error_; }
+
+  const PhaseReadinessConfig& config() const { return config_; }
+  bool hasOutputs() const { return has_outputs_; }
+  uint32_t blockRecords() const { return block_records_; }
+  uint64_t recordCount() const { return record_count_; }
+
+  size_t blockCount() const { return blocks_.size(); }
+  TraceBlockView block(size_t i) const;
+  bool verifyBlock(size_t i) const;
+
+  // True if trailing bytes (a partial or corrupt block) were ignored
+  bool truncated() const { return truncated_; }
+
+private:
+  struct BlockIndex {
+    size_t offset;     // Offset of the first record
+    uint32_t count;
+    uint32_t crc;
+  };
+
+  void* map_;
+  size_t map_size_;
+  std::string error_;
+  PhaseReadinessConfig config_;
+  bool has_outputs_;
+  uint32_t stride_;
+  uint32_t block_records_;
+  uint64_t record_count_;
+  bool truncated_;
+  std::vector<BlockIndex> blocks_;
+};
+
+} // namespace hlv
@@ -0,0 +1,177 @@
+#include "hlv/audit_log.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <unistd.h>
+
+namespace hlv {
+
+namespace {
+
+// Writer thread poll period while the queue is empty
+constexpr auto kIdlePoll = std::chrono::milliseconds(1);
+
+int syncData(int fd) {
+#if defined(__APPLE__)
+  return fsync(fd);
+#else
+  return fdatasync(fd);
+#endif
+}
+
+} // namespace
+
+AuditLogger::AuditLogger(const AuditLogConfig& config)
+    : config_(config)
+    , queue_(config.queue_capacity)
+    , running_(false)
+    , should_stop_(false)
+    , segment_index_(0)
+    , uncommitted_(0)
+    , enqueued_(0)
+    , dropped_(0)
+    , written_(0)
+    , write_errors_(0)
+    , commits_(0)
+    , segments_(0)
+{
+  if (config_.block_records == 0) {
+    config_.block_records = 1;
+  }
+}
+
+AuditLogger::~AuditLogger() {
+  stop();
+}
+
+std::string AuditLogger::segmentPath(uint64_t index) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "_%06llu.trace", static_cast<unsigned long long>(index));
+  return config_.directory + "/" + config_.prefix + name;
+}
+
+bool AuditLogger::start() {
+  if (running_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  // Open the first segment synchronously so configuration errors surface here
+  if (!openSegment()) {
+    return false;
+  }
+  should_stop_.store(false, std::memory_order_release);
+  running_.store(true, std::memory_order_release);
+  writer_thread_ = std::thread(&AuditLogger::writerLoop, this);
+  return true;
+}
+
+void AuditLogger::stop() {
+  if (!running_.load(std::memory_order_acquire)) {
+    return;
+  }
+  should_stop_.store(true, std::memory_order_release);
+  if (writer_thread_.joinable()) {
+    writer_thread_.join();
+  }
+  running_.store(false, std::memory_order_release);
+}
+
+bool AuditLogger::log(const PhaseSignals& signals, const PhaseReadinessOutput& output) {
+  // Counters are only written by the single producer: plain load/store
+  // keeps the hot path free of locked read-modify-write instructions
+  if (!queue_.tryPush(AuditRecord{signals, output})) {
+    dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return false;
+  }
+  enqueued_.store(enqueued_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  return true;
+}
+
+std::string AuditLogger::lastError() const {
+  std::lock_guard<std::mutex> lock(error_mutex_);
+  return error_;
+}
+
+void AuditLogger::setError(const std::string& message) {
+  std::lock_guard<std::mutex> lock(error_mutex_);
+  error_ = message;
+}
+
+bool AuditLogger::openSegment() {
+  ++segment_index_;
+  const std::string path = segmentPath(segment_index_);
+  if (!writer_.open(path, config_.readiness_config, true, config_.block_records)) {
+    setError("cannot open audit segment: " + path);
+    return false;
+  }
+  segments_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool AuditLogger::commit() {
+  if (!writer_.isOpen()) {
+    return false;
+  }
+  bool ok = writer_.flushBlock();
+  ok = ok && std::fflush(writer_.file()) == 0;
+  ok = ok && syncData(fileno(writer_.file())) == 0;
+  if (!ok) {
+    setError("audit segment write failed: " + segmentPath(segment_index_));
+  }
+  uncommitted_ = 0;
+  commits_.fetch_add(1, std::memory_order_relaxed);
+  return ok;
+}
+
+void AuditLogger::writerLoop() {
+  std::vector<AuditRecord> batch(config_.block_records);
+  const auto interval = std::chrono::milliseconds(config_.commit_interval_ms);
+  auto last_commit = std::chrono::steady_clock::now();
+
+  while (true) {
+    // Sample the stop flag before draining so records pushed before
+    // stop() are always written
+    const bool stopping = should_stop_.load(std::memory_order_acquire);
+    const size_t n = queue_.popBatch(batch.data(), batch.size());
+
+    for (size_t i = 0; i < n; ++i) {
+      if (!writer_.isOpen() || !writer_.append(batch[i].signals, batch[i].output)) {
+        write_errors_.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      ++uncommitted_;
+      written_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (uncommitted_ > 0 && (now - last_commit >= interval || stopping)) {
+      commit();
+      last_commit = now;
+    }
+
+    if (writer_.isOpen() && writer_.bytesWritten() >= config_.max_segment_bytes) {
+      if (uncommitted_ > 0) {
+        commit();
+        last_commit = now;
+      }
+      writer_.close();
+      openSegment();
+    }
+
+    if (n == 0) {
+      if (stopping) {
+        break;
+      }
+      std::this_thread::sleep_for(kIdlePoll);
+    }
+  }
+
+  if (uncommitted_ > 0) {
+    commit();
+  }
+  if (writer_.isOpen() && !writer_.close()) {
+    setError("audit segment close failed: " + segmentPath(segment_index_));
+  }
+}
+
+} // namespace hlv
@@ -0,0 +1,287 @@
+#include "hlv/channel_registry.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <set>
+
+namespace hlv {
+
+const char* channelRankByToString(ChannelRankBy by) {
+  switch (by) {
+    case ChannelRankBy::READINESS:   return "readiness";
+    case ChannelRankBy::BLOCK_DWELL: return "block_dwell";
+  }
+  return "unknown";
+}
+
+ChannelRegistry::ChannelRegistry(size_t channels, size_t history_samples)
+    : dirty_words_(new std::atomic<uint64_t>[(channels + 63) / 64])
+    , dirty_groups_(new std::atomic<uint64_t>[(channels + 4095) / 4096])
+    , dirty_group_count_((channels + 4095) / 4096)
+    , cells_(new EpochCell[channels])
+    , open_epoch_(0)
+    , begun_epoch_(0)
+    , committed_epoch_(0)
+    , tree_(channels)
+    , latest_(channels)
+    , by_readiness_(channels)
+    , by_block_since_(channels) {
+  slots_.reserve(channels);
+  for (size_t i = 0; i < channels; ++i) {
+    slots_.emplace_back(new Slot());
+    slots_.back()->state.setMaxHistorySize(history_samples);
+  }
+  for (size_t w = 0; w < (channels + 63) / 64; ++w) dirty_words_[w].store(0, std::memory_order_relaxed);
+  for (size_t g = 0; g < dirty_group_count_; ++g) dirty_groups_[g].store(0, std::memory_order_relaxed);
+}
+
+bool ChannelRegistry::placeChannels(size_t first, size_t count) {
+  if (first > slots_.size() || count > slots_.size() - first) {
+    return false;
+  }
+  for (size_t id = first; id < first + count; ++id) {
+    if (slots_[id]->state.getSequence() != 0) {
+      return false;
+    }
+  }
+  for (size_t id = first; id < first + count; ++id) {
+    std::unique_ptr<Slot> slot(new Slot());
+    slot->state.configure(slots_[id]->state.configuration());
+    slots_[id] = std::move(slot);
+  }
+  return true;
+}
+
+bool ChannelRegistry::update(size_t id, const PhaseSignals& signals, const PhaseReadinessOutput& output) {
+  if (id >= slots_.size()) {
+    return false;
+  }
+  Slot& slot = *slots_[id];
+  slot.state.update(signals, output);
+  const uint64_t epoch = open_epoch_.load(std::memory_order_acquire);
+  if (epoch != 0) {
+    writeEpochCell(id, epoch, signals.t_s, output);
+  }
+  {
+    std::lock_guard<std::mutex> lock(slot.latest_mutex);
+    Latest& latest = slot.latest;
+    if (output.gate == Gate::BLOCK) {
+      if (!latest.reported || latest.gate != Gate::BLOCK) {
+        latest.block_since_s = std::numeric_limits<double>::quiet_NaN();
+      }
+      if (std::isfinite(signals.t_s)) {
+        if (!std::isfinite(latest.block_since_s)) latest.block_since_s = signals.t_s;
+        latest.block_last_s = signals.t_s;
+      }
+    }
+    latest.readiness = output.readiness;
+    latest.t_s = signals.t_s;
+    latest.flags = output.flags;
+    latest.gate = output.gate;
+    latest.reported = true;
+  }
+  markDirty(id);
+  return true;
+}
+
+void ChannelRegistry::markDirty(size_t id) {
+  const size_t w = id / 64;
+  const uint64_t bit = uint64_t(1) << (id % 64);
+  // Already set: the next fold has not taken the word yet, and it reads
+  // `latest` under the slot mutex, so it sees this update
+  if (dirty_words_[w].load(std::memory_order_relaxed) & bit) {
+    return;
+  }
+  if (dirty_words_[w].fetch_or(bit, std::memory_order_release) == 0) {
+    dirty_groups_[w / 64].fetch_or(uint64_t(1) << (w % 64), std::memory_order_release);
+  }
+}
+
+void ChannelRegistry::foldDirty() const {
+  for (size_t g = 0; g < dirty_group_count_; ++g) {
+    uint64_t words = dirty_groups_[g].exchange(0, std::memory_order_acquire);
+    while (words != 0) {
+      const size_t w = g * 64 + static_cast<size_t>(__builtin_ctzll(words));
+      words &= words - 1;
+      uint64_t bits = dirty_words_[w].exchange(0, std::memory_order_acquire);
+      while (bits != 0) {
+        const size_t id = w * 64 + static_cast<size_t>(__builtin_ctzll(bits));
+        bits &= bits - 1;
+        Latest latest;
+        {
+          Slot& slot = *slots_[id];
+          std::lock_guard<std::mutex> lock(slot.latest_mutex);
+          latest = slot.latest;
+        }
+        tree_.update(id, latest.readiness, latest.gate, latest.flags);
+        if (std::isfinite(latest.readiness)) {
+          by_readiness_.set(id, latest.readiness);
+        } else {
+          by_readiness_.erase(id);
+        }
+        if (latest.gate == Gate::BLOCK && std::isfinite(latest.block_since_s)) {
+          by_block_since_.set(id, latest.block_since_s);
+        } else {
+          by_block_since_.erase(id);
+        }
+        latest_[id] = latest;
+      }
+    }
+  }
+}
+
+bool ChannelRegistry::setGroups(const std::vector<ChannelGroup>& groups) {
+  std::set<std::string> names;
+  for (const ChannelGroup& g : groups) {
+    if (g.name.empty() || !names.insert(g.name).second) return false;
+    if (g.count == 0 || g.first >= slots_.size() || g.count > slots_.size() - g.first) return false;
+  }
+  std::lock_guard<std::mutex> lock(aggregate_mutex_);
+  groups_ = groups;
+  return true;
+}
+
+std::vector<ChannelGroup> ChannelRegistry::groups() const {
+  std::lock_guard<std::mutex> lock(aggregate_mutex_);
+  return groups_;
+}
+
+GateSummary ChannelRegistry::summary() const {
+  std::lock_guard<std::mutex> lock(aggregate_mutex_);
+  foldDirty();
+  return tree_.root();
+}
+
+GateSummary ChannelRegistry::summary(size_t first, size_t count) const {
+  std::lock_guard<std::mutex> lock(aggregate_mutex_);
+  foldDirty();
+  return tree_.range(first, count);
+}
+
+bool ChannelRegistry::groupSummary(const std::string& name, GateSummary& out) const {
+  std::lock_guard<std::mutex> lock(aggregate_mutex_);
+  foldDirty();
+  for (const ChannelGroup& g : groups_) {
+    if (g.name == name) {
+      out = tree_.range(g.first, g.count);
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<ChannelRank> ChannelRegistry::worstChannels(size_t k, ChannelRankBy by) const {
+  std::vector<std::pair<size_t, double>> ids;
+  std::vector<ChannelRank> result;
+  std::lock_guard<std::mutex> lock(aggregate_mutex_);
+  foldDirty();
+  (by == ChannelRankBy::READINESS ? by_readiness_ : by_block_since_).smallest(k, ids);
+  result.reserve(ids.size());
+  for (const auto& entry : ids) {
+    const Latest& latest = latest_[entry.first];
+    ChannelRank rank;
+    rank.id = entry.first;
+    rank.readiness = latest.readiness;
+    rank.gate = latest.gate;
+    rank.flags = latest.flags;
+    rank.t_s = latest.t_s;
+    rank.block_dwell_s = latest.gate == Gate::BLOCK ? latest.block_last_s - latest.block_since_s
+                                                    : std::numeric_limits<double>::quiet_NaN();
+    result.push_back(rank);
+  }
+  return result;
+}
+
+namespace {
+
+uint64_t doubleBits(double v) {
+  uint64_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  return bits;
+}
+
+double bitsDouble(uint64_t bits) {
+  double v;
+  std::memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+} // namespace
+
+void ChannelRegistry::writeEpochCell(size_t id, uint64_t epoch, double t_s, const PhaseReadinessOutput& output) {
+  // Pairs with the acquire fence in snapshotEpoch(): a reader that sees any
+  // store below also sees begun_epoch_ >= epoch, which this thread acquired
+  // through open_epoch_ in update(), so it cannot validate a torn copy
+  std::atomic_thread_fence(std::memory_order_release);
+  EpochCell& cell = cells_[id];
+  // Rewrite this epoch's version if there is one, else the older version;
+  // the newer one is what readers of epoch - 1 select
+  const uint64_t e0 = cell.versions[0].epoch.load(std::memory_order_relaxed);
+  const uint64_t e1 = cell.versions[1].epoch.load(std::memory_order_relaxed);
+  EpochCell::Version& v = (e0 == epoch || (e1 != epoch && e0 < e1)) ? cell.versions[0] : cell.versions[1];
+  v.epoch.store(epoch, std::memory_order_relaxed);
+  v.readiness.store(doubleBits(output.readiness), std::memory_order_relaxed);
+  v.t_s.store(doubleBits(t_s), std::memory_order_relaxed);
+  v.gate_flags.store(static_cast<uint64_t>(output.gate) << 32 | output.flags, std::memory_order_relaxed);
+}
+
+uint64_t ChannelRegistry::beginEpoch() {
+  const uint64_t open = open_epoch_.load(std::memory_order_relaxed);
+  if (open != 0) return open;
+  const uint64_t epoch = committed_epoch_.load(std::memory_order_relaxed) + 1;
+  // Readers validate against begun_epoch_, so it must be visible before
+  // any version of this epoch is written
+  begun_epoch_.store(epoch, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  open_epoch_.store(epoch, std::memory_order_release);
+  return epoch;
+}
+
+uint64_t ChannelRegistry::commitEpoch() {
+  const uint64_t open = open_epoch_.load(std::memory_order_relaxed);
+  if (open == 0) return committed_epoch_.load(std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(aggregate_mutex_);
+    foldDirty();
+  }
+  open_epoch_.store(0, std::memory_order_relaxed);
+  committed_epoch_.store(open, std::memory_order_release);
+  return open;
+}
+
+bool ChannelRegistry::snapshotEpoch(EpochSnapshot& out, int max_attempts) const {
+  out.channels.resize(slots_.size());
+  for (int attempt = 0; attempt < max_attempts; ++attempt) {
+    const uint64_t epoch = committed_epoch_.load(std::memory_order_acquire);
+    out.epoch = epoch;
+    for (size_t id = 0; id < slots_.size(); ++id) {
+      const EpochCell& cell = cells_[id];
+      const uint64_t e0 = cell.versions[0].epoch.load(std::memory_order_relaxed);
+      const uint64_t e1 = cell.versions[1].epoch.load(std::memory_order_relaxed);
+      // Newest version at or before `epoch`
+      const bool ok0 = e0 != 0 && e0 <= epoch;
+      const bool ok1 = e1 != 0 && e1 <= epoch;
+      EpochChannel& ch = out.channels[id];
+      if (!ok0 && !ok1) {
+        ch = EpochChannel{};
+        continue;
+      }
+      const EpochCell::Version& v = (ok0 && (!ok1 || e0 > e1)) ? cell.versions[0] : cell.versions[1];
+      const uint64_t gate_flags = v.gate_flags.load(std::memory_order_relaxed);
+      ch.readiness = bitsDouble(v.readiness.load(std::memory_order_relaxed));
+      ch.t_s = bitsDouble(v.t_s.load(std::memory_order_relaxed));
+      ch.flags = static_cast<uint32_t>(gate_flags);
+      ch.gate = static_cast<Gate>(gate_flags >> 32);
+      ch.reported = true;
+    }
+    // The versions of `epoch` are only overwritten once epoch + 2 begins
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (begun_epoch_.load(std::memory_order_relaxed) <= epoch + 1) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace hlv
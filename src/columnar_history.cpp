@@ -0,0 +1,295 @@
+#include "hlv/columnar_history.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define HLV_COLUMNAR_SSE2 1
+#endif
+
+namespace hlv {
+
+namespace {
+
+// Scalar steps with the same NaN semantics as MINPD/MAXPD(x, acc):
+// a NaN x leaves the accumulator unchanged
+inline void scalarField(double x, FieldStats& s) {
+  s.min = x < s.min ? x : s.min;
+  s.max = x > s.max ? x : s.max;
+  s.sum += x;
+  const double a = std::fabs(x);
+  s.max_abs = a > s.max_abs ? a : s.max_abs;
+}
+
+// Unmasked min/max/sum/max|x| over n values
+void fieldKernel(const double* x, size_t n, FieldStats& s) {
+  size_t i = 0;
+#ifdef HLV_COLUMNAR_SSE2
+  __m128d vmin = _mm_set1_pd(s.min);
+  __m128d vmax = _mm_set1_pd(s.max);
+  __m128d vabs = _mm_set1_pd(s.max_abs);
+  __m128d vsum0 = _mm_setzero_pd();
+  __m128d vsum1 = _mm_setzero_pd();
+  const __m128d sign = _mm_set1_pd(-0.0);
+  for (; i + 4 <= n; i += 4) {
+    const __m128d a = _mm_loadu_pd(x + i);
+    const __m128d b = _mm_loadu_pd(x + i + 2);
+    vmin = _mm_min_pd(a, _mm_min_pd(b, vmin));
+    vmax = _mm_max_pd(a, _mm_max_pd(b, vmax));
+    vabs = _mm_max_pd(_mm_andnot_pd(sign, a), _mm_max_pd(_mm_andnot_pd(sign, b), vabs));
+    vsum0 = _mm_add_pd(vsum0, a);
+    vsum1 = _mm_add_pd(vsum1, b);
+  }
+  double lanes[2];
+  _mm_storeu_pd(lanes, vmin);
+  s.min = std::min(lanes[0], lanes[1]);
+  _mm_storeu_pd(lanes, vmax);
+  s.max = std::max(lanes[0], lanes[1]);
+  _mm_storeu_pd(lanes, vabs);
+  s.max_abs = std::max(lanes[0], lanes[1]);
+  _mm_storeu_pd(lanes, _mm_add_pd(vsum0, vsum1));
+  s.sum += lanes[0] + lanes[1];
+#endif
+  for (; i < n; ++i) {
+    scalarField(x[i], s);
+  }
+}
+
+void gateKernel(const uint8_t* g, size_t n, uint64_t counts[3]) {
+  size_t i = 0;
+#ifdef HLV_COLUMNAR_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i one = _mm_set1_epi8(1);
+  const __m128i two = _mm_set1_epi8(2);
+  for (; i + 16 <= n; i += 16) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(g + i));
+    counts[0] += static_cast<uint64_t>(__builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero))));
+    counts[1] += static_cast<uint64_t>(__builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(v, one))));
+    counts[2] += static_cast<uint64_t>(__builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(v, two))));
+  }
+#endif
+  for (; i < n; ++i) {
+    ++counts[g[i] % 3];
+  }
+}
+
+void flagKernel(const uint32_t* f, size_t n, uint64_t counts[32]) {
+  // Only bits that occur in the chunk are counted
+  uint32_t any = 0;
+  for (size_t i = 0; i < n; ++i) {
+    any |= f[i];
+  }
+  for (uint32_t bits = any; bits != 0; bits &= bits - 1) {
+    const unsigned b = static_cast<unsigned>(__builtin_ctz(bits));
+    const uint32_t mask = 1u << b;
+    size_t i = 0;
+    uint64_t count = 0;
+#ifdef HLV_COLUMNAR_SSE2
+    const __m128i vmask = _mm_set1_epi32(static_cast<int>(mask));
+    for (; i + 4 <= n; i += 4) {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(f + i));
+      const __m128i hit = _mm_cmpeq_epi32(_mm_and_si128(v, vmask), vmask);
+      count += static_cast<uint64_t>(__builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(hit))));
+    }
+#endif
+    for (; i < n; ++i) {
+      count += (f[i] & mask) ? 1 : 0;
+    }
+    counts[b] += count;
+  }
+}
+
+int64_t toNs(std::chrono::steady_clock::time_point tp) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+}
+
+} // namespace
+
+ColumnarHistory::ColumnarHistory(size_t capacity)
+    : capacity_(0)
+    , size_(0)
+    , head_(0)
+    , next_(0)
+{
+  allocate(std::max(capacity, size_t(1)));
+}
+
+void ColumnarHistory::allocate(size_t capacity) {
+  capacity_ = capacity;
+  size_ = 0;
+  head_ = 0;
+  next_ = 0;
+  timestamp_ns_ = AlignedColumn<int64_t>(capacity);
+  t_s_ = AlignedColumn<double>(capacity);
+  readiness_ = AlignedColumn<double>(capacity);
+  temp_C_ = AlignedColumn<double>(capacity);
+  temp_ambient_C_ = AlignedColumn<double>(capacity);
+  dTdt_C_per_s_ = AlignedColumn<double>(capacity);
+  trend_C_ = AlignedColumn<double>(capacity);
+  stability_score_ = AlignedColumn<double>(capacity);
+  hysteresis_index_ = AlignedColumn<double>(capacity);
+  coherence_index_ = AlignedColumn<double>(capacity);
+  gate_ = AlignedColumn<uint8_t>(capacity);
+  flags_ = AlignedColumn<uint32_t>(capacity);
+  const size_t chunks = (capacity + kChunkSamples - 1) / kChunkSamples;
+  chunk_bounds_.assign(chunks, ChunkBounds());
+  prev_chunk_bounds_.assign(chunks, ChunkBounds());
+}
+
+void ColumnarHistory::setCapacity(size_t capacity) {
+  capacity = std::max(capacity, size_t(1));
+  if (capacity == capacity_) {
+    return;
+  }
+  std::vector<ReadinessSnapshot> keep;
+  latest(capacity, keep);
+  allocate(capacity);
+  for (const auto& s : keep) {
+    append(s);
+  }
+}
+
+void ColumnarHistory::clear() {
+  size_ = 0;
+  head_ = 0;
+  next_ = 0;
+  std::fill(chunk_bounds_.begin(), chunk_bounds_.end(), ChunkBounds());
+  std::fill(prev_chunk_bounds_.begin(), prev_chunk_bounds_.end(), ChunkBounds());
+}
+
+void ColumnarHistory::append(const ReadinessSnapshot& s) {
+  const size_t i = next_;
+  const size_t chunk = i / kChunkSamples;
+  if (i % kChunkSamples == 0) {
+    // Starting a new pass over this chunk: its old samples stay live
+    // until overwritten
+    prev_chunk_bounds_[chunk] = chunk_bounds_[chunk];
+    chunk_bounds_[chunk] = ChunkBounds();
+  }
+
+  timestamp_ns_[i] = toNs(s.timestamp);
+  t_s_[i] = s.t_s;
+  readiness_[i] = s.readiness;
+  temp_C_[i] = s.temp_C;
+  temp_ambient_C_[i] = s.temp_ambient_C;
+  dTdt_C_per_s_[i] = s.dTdt_C_per_s;
+  trend_C_[i] = s.trend_C;
+  stability_score_[i] = s.stability_score;
+  hysteresis_index_[i] = s.hysteresis_index;
+  coherence_index_[i] = s.coherence_index;
+  gate_[i] = static_cast<uint8_t>(s.gate);
+  flags_[i] = s.flags;
+
+  if (std::isnan(s.t_s)) {
+    // Forces the masked path, which excludes NaN times
+    chunk_bounds_[chunk].min_t = -std::numeric_limits<double>::infinity();
+    chunk_bounds_[chunk].max_t = std::numeric_limits<double>::infinity();
+  } else {
+    chunk_bounds_[chunk].add(s.t_s);
+  }
+  if (i + 1 == capacity_ || (i + 1) % kChunkSamples == 0) {
+    prev_chunk_bounds_[chunk] = ChunkBounds();
+  }
+
+  next_ = (i + 1) % capacity_;
+  if (size_ < capacity_) {
+    ++size_;
+  } else {
+    head_ = next_;
+  }
+}
+
+ReadinessSnapshot ColumnarHistory::at(size_t logical) const {
+  const size_t i = physical(logical);
+  ReadinessSnapshot s;
+  s.timestamp = std::chrono::steady_clock::time_point(
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(timestamp_ns_[i])));
+  s.t_s = t_s_[i];
+  s.readiness = readiness_[i];
+  s.gate = static_cast<Gate>(gate_[i]);
+  s.flags = flags_[i];
+  s.temp_C = temp_C_[i];
+  s.temp_ambient_C = temp_ambient_C_[i];
+  s.dTdt_C_per_s = dTdt_C_per_s_[i];
+  s.trend_C = trend_C_[i];
+  s.stability_score = stability_score_[i];
+  s.hysteresis_index = hysteresis_index_[i];
+  s.coherence_index = coherence_index_[i];
+  return s;
+}
+
+void ColumnarHistory::latest(size_t max_count, std::vector<ReadinessSnapshot>& out) const {
+  const size_t count = std::min(max_count, size_);
+  out.reserve(out.size() + count);
+  for (size_t k = size_ - count; k < size_; ++k) {
+    out.push_back(at(k));
+  }
+}
+
+void ColumnarHistory::range(double from_t, double to_t, size_t max_count,
+                            std::vector<ReadinessSnapshot>& out, const HistoryFilter& filter) const {
+  // The flags and gate columns are scanned directly; no index is needed
+  // at recent-history depths
+  std::vector<size_t> hits;
+  for (size_t k = size_; k > 0 && hits.size() < max_count; --k) {
+    const size_t i = physical(k - 1);
+    const double t = t_s_[i];
+    if (t >= from_t && t <= to_t && filter.matches(flags_[i], static_cast<Gate>(gate_[i]))) {
+      hits.push_back(k - 1);
+    }
+  }
+  out.reserve(out.size() + hits.size());
+  for (auto it = hits.rbegin(); it != hits.rend(); ++it) {
+    out.push_back(at(*it));
+  }
+}
+
+HistoryStats ColumnarHistory::stats(double from_t, double to_t) const {
+  HistoryStats st;
+  // Aggregates do not depend on order, so walk physical slots directly
+  const size_t valid_end = size_ < capacity_ ? size_ : capacity_;
+  FieldStats t_bounds;
+  for (size_t lo = 0; lo < valid_end; lo += kChunkSamples) {
+    const size_t hi = std::min(lo + kChunkSamples, valid_end);
+    const size_t chunk = lo / kChunkSamples;
+    const ChunkBounds& cur = chunk_bounds_[chunk];
+    const ChunkBounds& prev = prev_chunk_bounds_[chunk];
+    const double min_t = std::min(cur.min_t, prev.min_t);
+    const double max_t = std::max(cur.max_t, prev.max_t);
+    if (max_t < from_t || min_t > to_t) {
+      continue;
+    }
+    if (min_t >= from_t && max_t <= to_t && std::isfinite(min_t) && std::isfinite(max_t)) {
+      const size_t n = hi - lo;
+      st.count += n;
+      fieldKernel(t_s_.data() + lo, n, t_bounds);
+      fieldKernel(readiness_.data() + lo, n, st.readiness);
+      fieldKernel(dTdt_C_per_s_.data() + lo, n, st.dTdt_C_per_s);
+      fieldKernel(trend_C_.data() + lo, n, st.trend_C);
+      gateKernel(gate_.data() + lo, n, st.gate_samples);
+      flagKernel(flags_.data() + lo, n, st.flag_samples);
+      continue;
+    }
+    // Boundary chunk
+    for (size_t i = lo; i < hi; ++i) {
+      const double t = t_s_[i];
+      if (!(t >= from_t && t <= to_t)) continue;
+      ++st.count;
+      scalarField(t, t_bounds);
+      scalarField(readiness_[i], st.readiness);
+      scalarField(dTdt_C_per_s_[i], st.dTdt_C_per_s);
+      scalarField(trend_C_[i], st.trend_C);
+      ++st.gate_samples[gate_[i] % 3];
+      for (uint32_t bits = flags_[i]; bits != 0; bits &= bits - 1) {
+        ++st.flag_samples[__builtin_ctz(bits)];
+      }
+    }
+  }
+  st.first_t_s = t_bounds.min;
+  st.last_t_s = t_bounds.max;
+  return st;
+}
+
+} // namespace hlv
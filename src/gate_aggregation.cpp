@@ -0,0 +1,83 @@
+#include "hlv/gate_aggregation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace hlv {
+
+GateSummary GateSummary::channel(size_t id, double readiness, Gate gate, uint32_t flags) {
+  GateSummary s;
+  s.channels = 1;
+  if (std::isfinite(readiness)) {
+    s.min_readiness = readiness;
+    s.min_channel = static_cast<uint32_t>(id);
+  }
+  s.worst_gate = gate;
+  s.flags = flags;
+  s.gate_counts[static_cast<size_t>(gate)] = 1;
+  return s;
+}
+
+namespace {
+
+// Field-by-field into `out` (which may alias neither input): building a
+// temporary and copying it out costs a store-forwarding stall per node
+inline void combineInto(GateSummary& out, const GateSummary& a, const GateSummary& b) {
+  const bool take_b = b.min_readiness < a.min_readiness ||
+      (b.min_readiness == a.min_readiness && b.min_channel < a.min_channel);
+  out.min_readiness = take_b ? b.min_readiness : a.min_readiness;
+  out.min_channel = take_b ? b.min_channel : a.min_channel;
+  out.channels = a.channels + b.channels;
+  out.flags = a.flags | b.flags;
+  out.gate_counts[0] = a.gate_counts[0] + b.gate_counts[0];
+  out.gate_counts[1] = a.gate_counts[1] + b.gate_counts[1];
+  out.gate_counts[2] = a.gate_counts[2] + b.gate_counts[2];
+  // Gate values are ordered BLOCK < CAUTION < ALLOW
+  out.worst_gate = std::min(a.worst_gate, b.worst_gate);
+}
+
+} // namespace
+
+GateSummary GateSummary::combine(const GateSummary& a, const GateSummary& b) {
+  GateSummary s;
+  combineInto(s, a, b);
+  return s;
+}
+
+GateAggregationTree::GateAggregationTree(size_t channels)
+    : channels_(channels), leaves_(1) {
+  while (leaves_ < channels_) leaves_ <<= 1;
+  nodes_.resize(2 * leaves_);
+}
+
+void GateAggregationTree::update(size_t id, double readiness, Gate gate, uint32_t flags) {
+  if (id >= channels_) return;
+  size_t node = leaves_ + id;
+  GateSummary& leaf = nodes_[node];
+  const bool finite = std::isfinite(readiness);
+  leaf.min_readiness = finite ? readiness : std::numeric_limits<double>::infinity();
+  leaf.min_channel = finite ? static_cast<uint32_t>(id) : GateSummary::kNoChannel;
+  leaf.channels = 1;
+  leaf.flags = flags;
+  leaf.gate_counts[0] = gate == Gate::BLOCK;
+  leaf.gate_counts[1] = gate == Gate::CAUTION;
+  leaf.gate_counts[2] = gate == Gate::ALLOW;
+  leaf.worst_gate = gate;
+  for (node >>= 1; node >= 1; node >>= 1) {
+    combineInto(nodes_[node], nodes_[2 * node], nodes_[2 * node + 1]);
+  }
+}
+
+GateSummary GateAggregationTree::range(size_t first, size_t count) const {
+  GateSummary result;
+  if (first >= channels_) return result;
+  const size_t last = first + std::min(count, channels_ - first);   // Exclusive
+  for (size_t lo = first + leaves_, hi = last + leaves_; lo < hi; lo >>= 1, hi >>= 1) {
+    if (lo & 1) result = GateSummary::combine(result, nodes_[lo++]);
+    if (hi & 1) result = GateSummary::combine(result, nodes_[--hi]);
+  }
+  return result;
+}
+
+} // namespace hlv
@@ -0,0 +1,865 @@
+#include "hlv/history_store.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+namespace hlv {
+
+namespace {
+
+uint64_t toBits(double v) {
+  uint64_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  return bits;
+}
+
+double fromBits(uint64_t bits) {
+  double v;
+  std::memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+// MSB-first bit stream appended to a block
+class BitWriter {
+public:
+  explicit BitWriter(CompressedHistoryBlock& block) : block_(block) {}
+
+  // Write the low `n` bits of `value` (1 <= n <= 64)
+  void write(uint64_t value, unsigned n) {
+    if (n < 64) value &= (uint64_t(1) << n) - 1;
+    const unsigned used = static_cast<unsigned>(block_.bit_count & 63);
+    if (used == 0) block_.words.push_back(0);
+    const unsigned room = 64 - used;
+    if (n <= room) {
+      block_.words.back() |= (room == n) ? value : value << (room - n);
+    } else {
+      block_.words.back() |= value >> (n - room);
+      block_.words.push_back(value << (64 - (n - room)));
+    }
+    block_.bit_count += n;
+  }
+
+  void writeBit(bool bit) { write(bit ? 1u : 0u, 1); }
+
+private:
+  CompressedHistoryBlock& block_;
+};
+
+class BitReader {
+public:
+  explicit BitReader(const CompressedHistoryBlock& block) : words_(block.words.data()), pos_(0) {}
+
+  uint64_t read(unsigned n) {
+    const size_t word = static_cast<size_t>(pos_ >> 6);
+    const unsigned offset = static_cast<unsigned>(pos_ & 63);
+    uint64_t bits = words_[word] << offset;
+    if (n > 64 - offset) {
+      bits |= words_[word + 1] >> (64 - offset);
+    }
+    pos_ += n;
+    return n == 64 ? bits : bits >> (64 - n);
+  }
+
+  bool readBit() { return read(1) != 0; }
+
+private:
+  const uint64_t* words_;
+  uint64_t pos_;
+};
+
+// Gorilla XOR window state for one float field
+struct FieldState {
+  unsigned leading = 0;
+  unsigned trailing = 0;
+  bool has_window = false;
+};
+
+enum Field : size_t {
+  F_TEMP = 0, F_AMBIENT, F_HYSTERESIS, F_COHERENCE,
+  F_READINESS, F_STABILITY, F_DTDT, F_TREND, kFieldCount
+};
+
+// Predictor and window state shared by encoder and decoder. Reset at
+// every block boundary so blocks decode independently.
+struct CodecState {
+  uint32_t n = 0;                 // Samples coded in this block
+  int64_t prev_ts = 0;
+  int64_t prev_delta = 0;
+  double prev_t_s = 0.0;
+  double prev_prev_t_s = 0.0;
+  Gate prev_gate = Gate::BLOCK;
+  uint32_t prev_flags = 0;
+  double prev[kFieldCount] = {};
+  FieldState fields[kFieldCount];
+
+  // Mirror of the PhaseReadinessMiddleware state that evaluate() keeps
+  bool have_ok = false;
+  double ok_t_s = 0.0;
+  double ok_temp_C = 0.0;
+  double ok_trend = 0.0;
+};
+
+// EWMA alpha of the policy feeding the history (already clamped to [0, 1])
+double predictorAlpha(const CompressedHistoryConfig& cfg) {
+  static const double default_alpha = CompiledPolicy::compile(PhaseReadinessConfig{}).alpha;
+  return cfg.policy != nullptr ? cfg.policy->alpha : default_alpha;
+}
+
+double predictDTdt(const CodecState& st, uint32_t flags, double t_s, double temp_C) {
+  if ((flags & FLAG_FAILSAFE_DEFAULT) || !st.have_ok) return 0.0;
+  return (temp_C - st.ok_temp_C) / (t_s - st.ok_t_s);
+}
+
+double predictTrend(const CodecState& st, uint32_t flags, double dTdt, double alpha) {
+  if (flags & FLAG_FAILSAFE_DEFAULT) return 0.0;
+  return alpha * dTdt + (1.0 - alpha) * st.ok_trend;
+}
+
+double predictTs(const CodecState& st) {
+  if (st.n == 0) return 0.0;
+  if (st.n == 1) return st.prev_t_s;
+  return st.prev_t_s + (st.prev_t_s - st.prev_prev_t_s);
+}
+
+void advanceMirror(CodecState& st, uint32_t flags, double t_s, double temp_C, double trend) {
+  if (!(flags & FLAG_FAILSAFE_DEFAULT)) {
+    st.have_ok = true;
+    st.ok_t_s = t_s;
+    st.ok_temp_C = temp_C;
+    st.ok_trend = trend;
+  } else if (!st.have_ok && std::isfinite(t_s) && std::isfinite(temp_C)) {
+    // Bootstrap sample: evaluate() records it as the previous sample
+    st.have_ok = true;
+    st.ok_t_s = t_s;
+    st.ok_temp_C = temp_C;
+  }
+}
+
+// '0' = equals prediction, '10' = equals previous value,
+// '11' + Gorilla XOR against the prediction otherwise
+void encodeField(BitWriter& w, CodecState& st, Field f, double value, double predicted) {
+  const uint64_t v = toBits(value);
+  const uint64_t p = toBits(predicted);
+  const uint64_t q = toBits(st.prev[f]);
+  st.prev[f] = value;
+  if (v == p) {
+    w.writeBit(false);
+    return;
+  }
+  if (q != p && v == q) {
+    w.write(0x2, 2);
+    return;
+  }
+  w.write(0x3, 2);
+
+  const uint64_t x = v ^ p;
+  const unsigned leading = std::min(static_cast<unsigned>(__builtin_clzll(x)), 63u);
+  const unsigned trailing = static_cast<unsigned>(__builtin_ctzll(x));
+  FieldState& fs = st.fields[f];
+  if (fs.has_window && leading >= fs.leading && trailing >= fs.trailing) {
+    w.writeBit(false);
+    w.write(x >> fs.trailing, 64 - fs.leading - fs.trailing);
+    return;
+  }
+  const unsigned length = 64 - leading - trailing;
+  w.writeBit(true);
+  w.write(leading, 6);
+  w.write(length - 1, 6);
+  w.write(x >> trailing, length);
+  fs.leading = leading;
+  fs.trailing = trailing;
+  fs.has_window = true;
+}
+
+double decodeField(BitReader& r, CodecState& st, Field f, double predicted) {
+  double value;
+  if (!r.readBit()) {
+    value = predicted;
+  } else if (!r.readBit()) {
+    value = st.prev[f];
+  } else {
+    FieldState& fs = st.fields[f];
+    uint64_t x;
+    if (!r.readBit()) {
+      x = r.read(64 - fs.leading - fs.trailing) << fs.trailing;
+    } else {
+      const unsigned leading = static_cast<unsigned>(r.read(6));
+      const unsigned length = static_cast<unsigned>(r.read(6)) + 1;
+      const unsigned trailing = 64 - leading - length;
+      x = r.read(length) << trailing;
+      fs.leading = leading;
+      fs.trailing = trailing;
+      fs.has_window = true;
+    }
+    value = fromBits(toBits(predicted) ^ x);
+  }
+  st.prev[f] = value;
+  return value;
+}
+
+// Monotone bijection from IEEE-754 bit patterns to integers, so nearby
+// doubles map to nearby integers (-0.0 and +0.0 stay distinct)
+int64_t orderedFromBits(uint64_t bits) {
+  const uint64_t sign = uint64_t(1) << 63;
+  return (bits & sign) ? -static_cast<int64_t>(bits & ~sign) - 1 : static_cast<int64_t>(bits);
+}
+
+uint64_t bitsFromOrdered(int64_t o) {
+  const uint64_t sign = uint64_t(1) << 63;
+  return o < 0 ? sign | static_cast<uint64_t>(-(o + 1)) : static_cast<uint64_t>(o);
+}
+
+// Distance from the prediction in ULPs, zigzag coded:
+// '0' | '10'+4 | '110'+16 | '1110'+32 | '1111'+64
+void encodeUlps(BitWriter& w, double value, double predicted) {
+  const int64_t d = static_cast<int64_t>(static_cast<uint64_t>(orderedFromBits(toBits(value))) -
+                                         static_cast<uint64_t>(orderedFromBits(toBits(predicted))));
+  const uint64_t z = (static_cast<uint64_t>(d) << 1) ^ static_cast<uint64_t>(d >> 63);
+  if (z == 0) {
+    w.writeBit(false);
+  } else if (z < (uint64_t(1) << 4)) {
+    w.write(0x2, 2);
+    w.write(z, 4);
+  } else if (z < (uint64_t(1) << 16)) {
+    w.write(0x6, 3);
+    w.write(z, 16);
+  } else if (z < (uint64_t(1) << 32)) {
+    w.write(0xE, 4);
+    w.write(z, 32);
+  } else {
+    w.write(0xF, 4);
+    w.write(z, 64);
+  }
+}
+
+double decodeUlps(BitReader& r, double predicted) {
+  uint64_t z;
+  if (!r.readBit()) {
+    return predicted;
+  } else if (!r.readBit()) {
+    z = r.read(4);
+  } else if (!r.readBit()) {
+    z = r.read(16);
+  } else if (!r.readBit()) {
+    z = r.read(32);
+  } else {
+    z = r.read(64);
+  }
+  const int64_t d = static_cast<int64_t>(z >> 1) ^ -static_cast<int64_t>(z & 1);
+  const uint64_t o = static_cast<uint64_t>(orderedFromBits(toBits(predicted))) + static_cast<uint64_t>(d);
+  return fromBits(bitsFromOrdered(static_cast<int64_t>(o)));
+}
+
+int64_t quantizeTimestamp(std::chrono::steady_clock::time_point tp, uint64_t resolution_ns) {
+  const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+  const int64_t res = static_cast<int64_t>(resolution_ns);
+  return ns >= 0 ? ns / res : -((-ns + res - 1) / res);
+}
+
+std::chrono::steady_clock::time_point restoreTimestamp(int64_t q, uint64_t resolution_ns) {
+  return std::chrono::steady_clock::time_point(
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::nanoseconds(q * static_cast<int64_t>(resolution_ns))));
+}
+
+// Zigzag-coded delta-of-delta: '0' | '10'+7 | '110'+12 | '1110'+20 | '1111'+64
+void encodeTimestamp(BitWriter& w, CodecState& st, int64_t ts) {
+  if (st.n == 0) {
+    w.write(static_cast<uint64_t>(ts), 64);
+  } else {
+    const int64_t delta = ts - st.prev_ts;
+    const int64_t dod = delta - st.prev_delta;
+    const uint64_t z = (static_cast<uint64_t>(dod) << 1) ^ static_cast<uint64_t>(dod >> 63);
+    if (z == 0) {
+      w.writeBit(false);
+    } else if (z < (uint64_t(1) << 7)) {
+      w.write(0x2, 2);
+      w.write(z, 7);
+    } else if (z < (uint64_t(1) << 12)) {
+      w.write(0x6, 3);
+      w.write(z, 12);
+    } else if (z < (uint64_t(1) << 20)) {
+      w.write(0xE, 4);
+      w.write(z, 20);
+    } else {
+      w.write(0xF, 4);
+      w.write(z, 64);
+    }
+    st.prev_delta = delta;
+  }
+  st.prev_ts = ts;
+}
+
+int64_t decodeTimestamp(BitReader& r, CodecState& st) {
+  int64_t ts;
+  if (st.n == 0) {
+    ts = static_cast<int64_t>(r.read(64));
+  } else {
+    uint64_t z = 0;
+    if (!r.readBit()) {
+      z = 0;
+    } else if (!r.readBit()) {
+      z = r.read(7);
+    } else if (!r.readBit()) {
+      z = r.read(12);
+    } else if (!r.readBit()) {
+      z = r.read(20);
+    } else {
+      z = r.read(64);
+    }
+    const int64_t dod = static_cast<int64_t>(z >> 1) ^ -static_cast<int64_t>(z & 1);
+    const int64_t delta = st.prev_delta + dod;
+    ts = st.prev_ts + delta;
+    st.prev_delta = delta;
+  }
+  st.prev_ts = ts;
+  return ts;
+}
+
+void encodeSample(BitWriter& w, CodecState& st, const ReadinessSnapshot& s, const CompressedHistoryConfig& cfg) {
+  encodeTimestamp(w, st, quantizeTimestamp(s.timestamp, cfg.timestamp_resolution_ns));
+
+  encodeUlps(w, s.t_s, predictTs(st));
+  st.prev_prev_t_s = st.prev_t_s;
+  st.prev_t_s = s.t_s;
+
+  if (st.n > 0 && s.gate == st.prev_gate && s.flags == st.prev_flags) {
+    w.writeBit(false);
+  } else {
+    w.writeBit(true);
+    w.write(static_cast<uint64_t>(s.gate), 2);
+    w.write(s.flags, 32);
+  }
+  st.prev_gate = s.gate;
+  st.prev_flags = s.flags;
+
+  encodeField(w, st, F_TEMP, s.temp_C, st.prev[F_TEMP]);
+  encodeField(w, st, F_AMBIENT, s.temp_ambient_C, st.prev[F_AMBIENT]);
+  encodeField(w, st, F_HYSTERESIS, s.hysteresis_index, st.prev[F_HYSTERESIS]);
+  encodeField(w, st, F_COHERENCE, s.coherence_index, st.prev[F_COHERENCE]);
+  encodeField(w, st, F_READINESS, s.readiness, PhaseReadinessMiddleware::readinessFromFlags(s.flags));
+  encodeField(w, st, F_STABILITY, s.stability_score, s.readiness);
+  encodeField(w, st, F_DTDT, s.dTdt_C_per_s, predictDTdt(st, s.flags, s.t_s, s.temp_C));
+  encodeField(w, st, F_TREND, s.trend_C, predictTrend(st, s.flags, s.dTdt_C_per_s, predictorAlpha(cfg)));
+
+  advanceMirror(st, s.flags, s.t_s, s.temp_C, s.trend_C);
+  ++st.n;
+}
+
+ReadinessSnapshot decodeSample(BitReader& r, CodecState& st, const CompressedHistoryConfig& cfg) {
+  ReadinessSnapshot s;
+  s.timestamp = restoreTimestamp(decodeTimestamp(r, st), cfg.timestamp_resolution_ns);
+
+  s.t_s = decodeUlps(r, predictTs(st));
+  st.prev_prev_t_s = st.prev_t_s;
+  st.prev_t_s = s.t_s;
+
+  if (r.readBit()) {
+    st.prev_gate = static_cast<Gate>(r.read(2));
+    st.prev_flags = static_cast<uint32_t>(r.read(32));
+  }
+  s.gate = st.prev_gate;
+  s.flags = st.prev_flags;
+
+  s.temp_C = decodeField(r, st, F_TEMP, st.prev[F_TEMP]);
+  s.temp_ambient_C = decodeField(r, st, F_AMBIENT, st.prev[F_AMBIENT]);
+  s.hysteresis_index = decodeField(r, st, F_HYSTERESIS, st.prev[F_HYSTERESIS]);
+  s.coherence_index = decodeField(r, st, F_COHERENCE, st.prev[F_COHERENCE]);
+  s.readiness = decodeField(r, st, F_READINESS, PhaseReadinessMiddleware::readinessFromFlags(s.flags));
+  s.stability_score = decodeField(r, st, F_STABILITY, s.readiness);
+  s.dTdt_C_per_s = decodeField(r, st, F_DTDT, predictDTdt(st, s.flags, s.t_s, s.temp_C));
+  s.trend_C = decodeField(r, st, F_TREND, predictTrend(st, s.flags, s.dTdt_C_per_s, predictorAlpha(cfg)));
+
+  advanceMirror(st, s.flags, s.t_s, s.temp_C, s.trend_C);
+  ++st.n;
+  return s;
+}
+
+} // namespace
+
+struct CompressedHistory::Encoder {
+  CodecState state;
+};
+
+// -----------------------------------------------------------------------------
+// Flag index
+// -----------------------------------------------------------------------------
+
+namespace {
+
+size_t wordCount(uint32_t universe) {
+  return (static_cast<size_t>(universe) + 63) / 64;
+}
+
+// Set bits [first, last] of a bitmap
+void setBits(std::vector<uint64_t>& words, uint32_t first, uint32_t last) {
+  for (uint32_t w = first / 64; w <= last / 64; ++w) {
+    const uint32_t lo = (w == first / 64) ? first % 64 : 0;
+    const uint32_t hi = (w == last / 64) ? last % 64 : 63;
+    const uint64_t span = (hi - lo == 63) ? ~0ull : ((1ull << (hi - lo + 1)) - 1);
+    words[w] |= span << lo;
+  }
+}
+
+// flag_index slot of flag bit `b`
+size_t flagSlot(uint32_t flags_present, unsigned b) {
+  return static_cast<size_t>(__builtin_popcount(flags_present & ((1u << b) - 1)));
+}
+
+} // namespace
+
+void PositionSet::add(uint32_t pos, uint32_t universe) {
+  ++cardinality_;
+  if (!bits_.empty()) {
+    bits_[pos / 64] |= 1ull << (pos % 64);
+    return;
+  }
+  if (!runs_.empty() && runs_.back().last + 1u == pos) {
+    runs_.back().last = static_cast<uint16_t>(pos);
+    return;
+  }
+  runs_.push_back(Run{static_cast<uint16_t>(pos), static_cast<uint16_t>(pos)});
+
+  // Switch to a bitset once the runs would outgrow it
+  const size_t words = wordCount(universe);
+  if (runs_.size() * sizeof(Run) > words * sizeof(uint64_t)) {
+    bits_.assign(words, 0);
+    for (const Run& r : runs_) {
+      setBits(bits_, r.start, r.last);
+    }
+    runs_.clear();
+    runs_.shrink_to_fit();
+  }
+}
+
+void PositionSet::orInto(std::vector<uint64_t>& words) const {
+  if (!bits_.empty()) {
+    const size_t n = std::min(words.size(), bits_.size());
+    for (size_t i = 0; i < n; ++i) {
+      words[i] |= bits_[i];
+    }
+    return;
+  }
+  for (const Run& r : runs_) {
+    setBits(words, r.start, r.last);
+  }
+}
+
+size_t CompressedHistoryBlock::indexBytes() const {
+  size_t total = 0;
+  for (const auto& set : flag_index) total += set.bytes();
+  for (const auto& set : gate_index) total += set.bytes();
+  return total;
+}
+
+void CompressedHistoryBlock::indexSample(const ReadinessSnapshot& snapshot, uint32_t universe) {
+  // The sample becomes position `count` (called before count is advanced)
+  const uint32_t pos = count;
+  for (uint32_t bits = snapshot.flags; bits != 0; bits &= bits - 1) {
+    const unsigned b = static_cast<unsigned>(__builtin_ctz(bits));
+    const size_t slot = flagSlot(flags_present, b);
+    if ((flags_present & (1u << b)) == 0) {
+      flag_index.insert(flag_index.begin() + static_cast<std::ptrdiff_t>(slot), PositionSet());
+      flags_present |= 1u << b;
+    }
+    flag_index[slot].add(pos, universe);
+  }
+  gate_index[static_cast<size_t>(snapshot.gate) % 3].add(pos, universe);
+}
+
+bool CompressedHistoryBlock::matchMask(const HistoryFilter& filter, std::vector<uint64_t>& mask) const {
+  if (count == 0 || (filter.flags_all & ~flags_present) != 0) {
+    return false;
+  }
+  const size_t words = wordCount(count);
+  mask.assign(words, ~0ull);
+  if (count % 64 != 0) {
+    mask.back() = (1ull << (count % 64)) - 1;
+  }
+
+  std::vector<uint64_t> scratch;
+  for (uint32_t bits = filter.flags_all; bits != 0; bits &= bits - 1) {
+    scratch.assign(words, 0);
+    flag_index[flagSlot(flags_present, static_cast<unsigned>(__builtin_ctz(bits)))].orInto(scratch);
+    for (size_t i = 0; i < words; ++i) mask[i] &= scratch[i];
+  }
+  for (uint32_t bits = filter.flags_none & flags_present; bits != 0; bits &= bits - 1) {
+    scratch.assign(words, 0);
+    flag_index[flagSlot(flags_present, static_cast<unsigned>(__builtin_ctz(bits)))].orInto(scratch);
+    for (size_t i = 0; i < words; ++i) mask[i] &= ~scratch[i];
+  }
+  if ((filter.gate_mask & 0x7) != 0x7) {
+    scratch.assign(words, 0);
+    for (size_t g = 0; g < 3; ++g) {
+      if ((filter.gate_mask >> g) & 1u) gate_index[g].orInto(scratch);
+    }
+    for (size_t i = 0; i < words; ++i) mask[i] &= scratch[i];
+  }
+
+  for (uint64_t w : mask) {
+    if (w != 0) return true;
+  }
+  return false;
+}
+
+// -----------------------------------------------------------------------------
+// CompressedHistory
+// -----------------------------------------------------------------------------
+
+CompressedHistory::CompressedHistory(const CompressedHistoryConfig& config)
+    : config_(config)
+    , open_(std::make_shared<CompressedHistoryBlock>())
+    , encoder_(new Encoder())
+    , samples_(0)
+{
+  if (config_.block_samples == 0) config_.block_samples = 1;
+  if (config_.block_samples > 65536) config_.block_samples = 65536;   // PositionSet range
+  if (config_.timestamp_resolution_ns == 0) config_.timestamp_resolution_ns = 1;
+}
+
+CompressedHistory::~CompressedHistory() = default;
+CompressedHistory::CompressedHistory(CompressedHistory&&) noexcept = default;
+CompressedHistory& CompressedHistory::operator=(CompressedHistory&&) noexcept = default;
+
+void CompressedHistory::append(const ReadinessSnapshot& snapshot) {
+  if (!enabled()) {
+    return;
+  }
+  BitWriter writer(*open_);
+  encodeSample(writer, encoder_->state, snapshot, config_);
+  open_->indexSample(snapshot, config_.block_samples);
+  ++open_->count;
+  open_->min_t_s = std::min(open_->min_t_s, snapshot.t_s);
+  open_->max_t_s = std::max(open_->max_t_s, snapshot.t_s);
+  ++samples_;
+
+  if (open_->count >= config_.block_samples) {
+    sealBlock();
+  }
+}
+
+void CompressedHistory::sealBlock() {
+  open_->words.shrink_to_fit();
+  sealed_.push_back(open_);
+  open_ = std::make_shared<CompressedHistoryBlock>();
+  encoder_->state = CodecState();
+
+  // Retain at least max_samples, dropping whole blocks
+  while (!sealed_.empty() && samples_ - sealed_.front()->count >= config_.max_samples) {
+    samples_ -= sealed_.front()->count;
+    sealed_.pop_front();
+  }
+}
+
+void CompressedHistory::clear() {
+  sealed_.clear();
+  open_ = std::make_shared<CompressedHistoryBlock>();
+  encoder_->state = CodecState();
+  samples_ = 0;
+}
+
+CompressedHistoryStats CompressedHistory::stats() const {
+  CompressedHistoryStats stats;
+  stats.samples = samples_;
+  stats.blocks = sealed_.size() + (open_->count > 0 ? 1 : 0);
+  for (const auto& block : sealed_) {
+    stats.bytes += block->bytes();
+    stats.index_bytes += block->indexBytes();
+  }
+  stats.bytes += (open_->bit_count + 7) / 8;
+  stats.index_bytes += open_->indexBytes();
+  stats.bytes_per_sample = samples_ ? static_cast<double>(stats.bytes) / static_cast<double>(samples_) : 0.0;
+  return stats;
+}
+
+std::vector<CompressedHistoryBlockPtr> CompressedHistory::blocksInRange(double from_t, double to_t) const {
+  std::vector<CompressedHistoryBlockPtr> blocks;
+  for (const auto& block : sealed_) {
+    if (block->overlaps(from_t, to_t)) {
+      blocks.push_back(block);
+    }
+  }
+  if (open_->overlaps(from_t, to_t)) {
+    blocks.push_back(std::make_shared<const CompressedHistoryBlock>(*open_));
+  }
+  return blocks;
+}
+
+namespace {
+
+// Decode the first `n` samples of a block
+void decodePrefix(const CompressedHistoryBlock& block, const CompressedHistoryConfig& config, uint32_t n,
+                  std::vector<ReadinessSnapshot>& out) {
+  BitReader reader(block);
+  CodecState state;
+  out.reserve(out.size() + n);
+  for (uint32_t i = 0; i < n; ++i) {
+    out.push_back(decodeSample(reader, state, config));
+  }
+}
+
+} // namespace
+
+void CompressedHistory::decodeBlock(const CompressedHistoryBlock& block, const CompressedHistoryConfig& config,
+                                    std::vector<ReadinessSnapshot>& out) {
+  decodePrefix(block, config, block.count, out);
+}
+
+std::vector<ReadinessSnapshot> CompressedHistory::decodeRange(const std::vector<CompressedHistoryBlockPtr>& blocks,
+                                                              const CompressedHistoryConfig& config,
+                                                              double from_t, double to_t, size_t max_count,
+                                                              const HistoryFilter& filter) {
+  // Walk newest block first so only the blocks needed for max_count are
+  // decoded. With a filter, blocks without matches are not decoded at all
+  // and the rest only up to their last match.
+  const bool filtered = filter.active();
+  std::vector<ReadinessSnapshot> result;
+  std::vector<ReadinessSnapshot> decoded;
+  std::vector<uint64_t> mask;
+  for (auto it = blocks.rbegin(); it != blocks.rend() && result.size() < max_count; ++it) {
+    const CompressedHistoryBlock& block = **it;
+    uint32_t limit = block.count;
+    if (filtered) {
+      if (!block.matchMask(filter, mask)) {
+        continue;
+      }
+      size_t w = mask.size();
+      while (mask[w - 1] == 0) --w;
+      limit = static_cast<uint32_t>((w - 1) * 64 + (63 - __builtin_clzll(mask[w - 1])) + 1);
+    }
+    decoded.clear();
+    decodePrefix(block, config, limit, decoded);
+    for (size_t i = decoded.size(); i > 0 && result.size() < max_count; --i) {
+      const ReadinessSnapshot& s = decoded[i - 1];
+      if (filtered && ((mask[(i - 1) / 64] >> ((i - 1) % 64)) & 1u) == 0) {
+        continue;
+      }
+      if (s.t_s >= from_t && s.t_s <= to_t) {
+        result.push_back(s);
+      }
+    }
+  }
+  std::reverse(result.begin(), result.end());
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// Rollups
+// -----------------------------------------------------------------------------
+
+void RollupBucket::add(const ReadinessSnapshot& snapshot) {
+  ++samples;
+  readiness_min = std::min(readiness_min, snapshot.readiness);
+  readiness_max = std::max(readiness_max, snapshot.readiness);
+  readiness_sum += snapshot.readiness;
+  ++gate_samples[static_cast<size_t>(snapshot.gate) % 3];
+  flags_union |= snapshot.flags;
+}
+
+void RollupBucket::merge(const RollupBucket& other) {
+  samples += other.samples;
+  readiness_min = std::min(readiness_min, other.readiness_min);
+  readiness_max = std::max(readiness_max, other.readiness_max);
+  readiness_sum += other.readiness_sum;
+  for (size_t g = 0; g < 3; ++g) {
+    gate_samples[g] += other.gate_samples[g];
+  }
+  flags_union |= other.flags_union;
+}
+
+std::vector<RollupLevelConfig> defaultRollupLevels() {
+  return {{1.0, 3600}, {10.0, 8640}, {60.0, 1440}};
+}
+
+RollupHistory::RollupHistory(std::vector<RollupLevelConfig> levels) {
+  std::sort(levels.begin(), levels.end(),
+            [](const RollupLevelConfig& a, const RollupLevelConfig& b) { return a.resolution_s < b.resolution_s; });
+  for (const auto& cfg : levels) {
+    if (!(cfg.resolution_s > 0.0) || !std::isfinite(cfg.resolution_s)) continue;
+    Level level;
+    level.config = cfg;
+    level.config.capacity = std::max(cfg.capacity, size_t(1));
+    levels_.push_back(level);
+  }
+}
+
+void RollupHistory::clear() {
+  for (auto& level : levels_) {
+    level.ring.clear();
+    level.head = 0;
+    level.has_open = false;
+  }
+}
+
+int RollupHistory::findLevel(double resolution_s) const {
+  for (size_t i = 0; i < levels_.size(); ++i) {
+    if (levels_[i].config.resolution_s == resolution_s) return static_cast<int>(i);
+  }
+  return -1;
+}
+
+int64_t RollupHistory::bucketIndex(size_t level, double t_s) const {
+  return static_cast<int64_t>(std::floor(t_s / levels_[level].config.resolution_s));
+}
+
+void RollupHistory::append(const ReadinessSnapshot& snapshot) {
+  if (levels_.empty() || !std::isfinite(snapshot.t_s)) {
+    return;
+  }
+  accumulate(0, bucketIndex(0, snapshot.t_s), nullptr, &snapshot);
+}
+
+// Add a sample (level 0) or a closed child bucket to `level`. A later
+// bucket index closes the open bucket, which cascades upward; samples that
+// step back in time stay in the open bucket.
+void RollupHistory::accumulate(size_t level, int64_t index, const RollupBucket* child,
+                               const ReadinessSnapshot* sample) {
+  Level& lv = levels_[level];
+  if (lv.has_open && index > lv.open_index) {
+    const RollupBucket closed = lv.open;
+    if (lv.ring.size() < lv.config.capacity) {
+      lv.ring.push_back(closed);
+    } else {
+      lv.ring[lv.head] = closed;
+      lv.head = (lv.head + 1) % lv.ring.size();
+    }
+    lv.has_open = false;
+    if (level + 1 < levels_.size()) {
+      accumulate(level + 1, bucketIndex(level + 1, closed.start_t_s), &closed, nullptr);
+    }
+  }
+  if (!lv.has_open) {
+    lv.open = RollupBucket();
+    lv.open_index = index;
+    lv.open.start_t_s = static_cast<double>(index) * lv.config.resolution_s;
+    lv.open.end_t_s = static_cast<double>(index + 1) * lv.config.resolution_s;
+    lv.has_open = true;
+  }
+  if (sample) {
+    lv.open.add(*sample);
+  } else {
+    lv.open.merge(*child);
+  }
+}
+
+// Open buckets of `level` with everything finer levels have not cascaded
+// yet; at most level + 1 buckets, oldest first
+void RollupHistory::pendingBuckets(size_t level, std::vector<RollupBucket>& out) const {
+  const Level& lv = levels_[level];
+  std::vector<RollupBucket> pending;
+  if (lv.has_open) {
+    pending.push_back(lv.open);
+  }
+  if (level > 0) {
+    std::vector<RollupBucket> finer;
+    pendingBuckets(level - 1, finer);
+    for (const auto& child : finer) {
+      const int64_t index = bucketIndex(level, child.start_t_s);
+      if (pending.empty() || index > static_cast<int64_t>(std::floor(pending.back().start_t_s / lv.config.resolution_s))) {
+        RollupBucket bucket;
+        bucket.start_t_s = static_cast<double>(index) * lv.config.resolution_s;
+        bucket.end_t_s = static_cast<double>(index + 1) * lv.config.resolution_s;
+        pending.push_back(bucket);
+      }
+      pending.back().merge(child);
+    }
+  }
+  out.insert(out.end(), pending.begin(), pending.end());
+}
+
+void RollupHistory::query(size_t level, double from_t, double to_t, std::vector<RollupBucket>& out) const {
+  if (level >= levels_.size()) {
+    return;
+  }
+  const Level& lv = levels_[level];
+  for (size_t i = 0; i < lv.ring.size(); ++i) {
+    const RollupBucket& bucket = lv.ring[(lv.head + i) % lv.ring.size()];
+    if (bucket.end_t_s > from_t && bucket.start_t_s <= to_t) {
+      out.push_back(bucket);
+    }
+  }
+  std::vector<RollupBucket> pending;
+  pendingBuckets(level, pending);
+  for (size_t i = 0; i < pending.size(); ++i) {
+    if (pending[i].end_t_s > from_t && pending[i].start_t_s <= to_t) {
+      out.push_back(pending[i]);
+      out.back().partial = (i + 1 == pending.size());
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Transition log
+// -----------------------------------------------------------------------------
+
+TransitionLog::TransitionLog(size_t max_runs)
+    : max_runs_(std::max(max_runs, size_t(1)))
+{
+}
+
+void TransitionLog::append(const ReadinessSnapshot& snapshot) {
+  if (!std::isfinite(snapshot.t_s)) {
+    return;
+  }
+  dwell_.now_t_s = snapshot.t_s;
+  if (!runs_.empty() && runs_.back().gate == snapshot.gate && runs_.back().flags == snapshot.flags) {
+    runs_.back().end_t_s = snapshot.t_s;
+    ++runs_.back().samples;
+    return;
+  }
+
+  if (!dwell_.valid) {
+    dwell_.valid = true;
+    dwell_.gate_since_t_s = snapshot.t_s;
+  } else {
+    ++dwell_.transitions;
+    if (snapshot.gate != dwell_.gate) {
+      dwell_.gate_left_t_s[static_cast<size_t>(dwell_.gate) % 3] = snapshot.t_s;
+      dwell_.gate_since_t_s = snapshot.t_s;
+    }
+  }
+  dwell_.gate = snapshot.gate;
+  dwell_.flags = snapshot.flags;
+  dwell_.run_since_t_s = snapshot.t_s;
+
+  GateRun run;
+  run.start_t_s = snapshot.t_s;
+  run.end_t_s = snapshot.t_s;
+  run.gate = snapshot.gate;
+  run.flags = snapshot.flags;
+  run.samples = 1;
+  runs_.push_back(run);
+  while (runs_.size() > max_runs_) {
+    runs_.pop_front();
+  }
+}
+
+void TransitionLog::clear() {
+  runs_.clear();
+  dwell_ = DwellState();
+}
+
+uint64_t TransitionLog::transitionsSince(double since_t_s) const {
+  const auto first = std::upper_bound(runs_.begin(), runs_.end(), since_t_s,
+                                      [](double t, const GateRun& run) { return t < run.start_t_s; });
+  uint64_t count = static_cast<uint64_t>(runs_.end() - first);
+  // The very first run is not a transition
+  if (count > 0 && first == runs_.begin() && runs_.size() == dwell_.transitions + 1) {
+    --count;
+  }
+  return count;
+}
+
+void TransitionLog::runs(double from_t, double to_t, size_t max_count, std::vector<GateRun>& out) const {
+  const size_t begin = out.size();
+  for (auto it = runs_.rbegin(); it != runs_.rend() && out.size() - begin < max_count; ++it) {
+    if (it->end_t_s >= from_t && it->start_t_s <= to_t) {
+      out.push_back(*it);
+    }
+  }
+  std::reverse(out.begin() + static_cast<std::ptrdiff_t>(begin), out.end());
+}
+
+} // namespace hlv
@@ -0,0 +1,343 @@
+#include "hlv/ingest_pipeline.hpp"
+
+#include <chrono>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace hlv {
+
+namespace {
+
+// Evaluator/publisher poll period while its queue is empty
+constexpr auto kIdlePoll = std::chrono::microseconds(50);
+
+// Single-writer counter increment: plain load/store keeps the hot path
+// free of locked read-modify-write instructions
+inline void bump(std::atomic<uint64_t>& counter) {
+  counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+bool pinCurrentThread(int cpu) {
+#if defined(__linux__)
+  if (cpu < 0 || cpu >= CPU_SETSIZE) {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  (void)cpu;
+  return false;
+#endif
+}
+
+const char* overflowPolicyToString(OverflowPolicy p) {
+  switch (p) {
+    case OverflowPolicy::BLOCK:       return "block";
+    case OverflowPolicy::DROP_OLDEST: return "drop_oldest";
+    case OverflowPolicy::DROP_NEWEST: return "drop_newest";
+  }
+  return "unknown";
+}
+
+// -----------------------------------------------------------------------------
+// PublicationStage
+// -----------------------------------------------------------------------------
+
+PublicationStage::PublicationStage(ReadinessAPIState& state, AuditLogger* audit, const PublicationConfig& config)
+    : config_(config)
+    , state_(state)
+    , audit_(audit)
+    , queue_(config.queue_capacity)
+    , running_(false)
+    , should_stop_(false)
+    , pinned_(false)
+    , published_(0)
+    , dropped_(0)
+    , applied_(0)
+    , batches_(0)
+    , max_depth_(0)
+{
+  if (config_.batch_size == 0) {
+    config_.batch_size = 1;
+  }
+}
+
+PublicationStage::~PublicationStage() {
+  stop();
+}
+
+bool PublicationStage::start() {
+  if (running_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  should_stop_.store(false, std::memory_order_release);
+  running_.store(true, std::memory_order_release);
+  publisher_thread_ = std::thread(&PublicationStage::publisherLoop, this);
+  return true;
+}
+
+void PublicationStage::stop() {
+  if (!running_.load(std::memory_order_acquire)) {
+    return;
+  }
+  should_stop_.store(true, std::memory_order_release);
+  if (publisher_thread_.joinable()) {
+    publisher_thread_.join();
+  }
+  running_.store(false, std::memory_order_release);
+}
+
+bool PublicationStage::publish(const PhaseSignals& signals, const PhaseReadinessOutput& output) {
+  if (!queue_.tryPush(ReadinessUpdate{signals, output})) {
+    bump(dropped_);
+    return false;
+  }
+  bump(published_);
+  return true;
+}
+
+void PublicationStage::publisherLoop() {
+  if (config_.publisher_cpu >= 0) {
+    pinned_.store(pinCurrentThread(config_.publisher_cpu), std::memory_order_release);
+  }
+  std::vector<ReadinessUpdate> batch(config_.batch_size);
+
+  while (true) {
+    // Sample the stop flag before draining so updates published before
+    // stop() are always applied
+    const bool stopping = should_stop_.load(std::memory_order_acquire);
+    const size_t depth = queue_.size();
+    if (depth > max_depth_.load(std::memory_order_relaxed)) {
+      max_depth_.store(depth, std::memory_order_relaxed);
+    }
+
+    const size_t n = queue_.popBatch(batch.data(), batch.size());
+    if (n > 0) {
+      state_.updateBatch(batch.data(), n);
+      if (audit_) {
+        for (size_t i = 0; i < n; ++i) {
+          audit_->log(batch[i].signals, batch[i].output);
+        }
+      }
+      applied_.store(applied_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+      bump(batches_);
+    } else {
+      if (stopping) {
+        break;
+      }
+      std::this_thread::sleep_for(kIdlePoll);
+    }
+  }
+}
+
+void PublicationStage::render(std::ostream& out) const {
+  out << "# HELP hlv_publish_published_total Updates queued for the publisher thread.\n";
+  out << "# TYPE hlv_publish_published_total counter\n";
+  out << "hlv_publish_published_total " << publishedCount() << "\n";
+  out << "# HELP hlv_publish_dropped_total Updates dropped because the publication queue was full.\n";
+  out << "# TYPE hlv_publish_dropped_total counter\n";
+  out << "hlv_publish_dropped_total " << droppedCount() << "\n";
+  out << "# HELP hlv_publish_applied_total Updates applied to ReadinessAPIState.\n";
+  out << "# TYPE hlv_publish_applied_total counter\n";
+  out << "hlv_publish_applied_total " << appliedCount() << "\n";
+  out << "# HELP hlv_publish_batches_total updateBatch() calls made by the publisher thread.\n";
+  out << "# TYPE hlv_publish_batches_total counter\n";
+  out << "hlv_publish_batches_total " << batchCount() << "\n";
+  out << "# HELP hlv_publish_queue_depth Updates waiting in the publication queue.\n";
+  out << "# TYPE hlv_publish_queue_depth gauge\n";
+  out << "hlv_publish_queue_depth " << queueDepth() << "\n";
+  out << "# HELP hlv_publish_queue_depth_max Highest publication queue depth seen by the publisher.\n";
+  out << "# TYPE hlv_publish_queue_depth_max gauge\n";
+  out << "hlv_publish_queue_depth_max " << maxQueueDepth() << "\n";
+}
+
+// -----------------------------------------------------------------------------
+// IngestPipeline
+// -----------------------------------------------------------------------------
+
+IngestPipeline::IngestPipeline(const PhaseReadinessConfig& readiness_config, ReadinessAPIState* state,
+                               AuditLogger* audit, const IngestConfig& config)
+    : config_(config)
+    , middleware_(readiness_config)
+    , state_(state)
+    , audit_(audit)
+    , publication_(nullptr)
+    , queue_(config.queue_capacity)
+    , running_(false)
+    , should_stop_(false)
+    , pinned_(false)
+    , next_sequence_(0)
+    , expected_sequence_(0)
+    , submitted_(0)
+    , dropped_oldest_(0)
+    , dropped_newest_(0)
+    , blocked_(0)
+    , evaluated_(0)
+    , overflow_gaps_(0)
+    , max_depth_(0)
+{
+  if (config_.batch_size == 0) {
+    config_.batch_size = 1;
+  }
+}
+
+IngestPipeline::IngestPipeline(const PhaseReadinessConfig& readiness_config, PublicationStage& publication,
+                               const IngestConfig& config)
+    : IngestPipeline(readiness_config, nullptr, nullptr, config)
+{
+  publication_ = &publication;
+}
+
+IngestPipeline::~IngestPipeline() {
+  stop();
+}
+
+bool IngestPipeline::start() {
+  if (running_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  should_stop_.store(false, std::memory_order_release);
+  running_.store(true, std::memory_order_release);
+  evaluator_thread_ = std::thread(&IngestPipeline::evaluatorLoop, this);
+  return true;
+}
+
+void IngestPipeline::stop() {
+  if (!running_.load(std::memory_order_acquire)) {
+    return;
+  }
+  should_stop_.store(true, std::memory_order_release);
+  if (evaluator_thread_.joinable()) {
+    evaluator_thread_.join();
+  }
+  running_.store(false, std::memory_order_release);
+}
+
+bool IngestPipeline::submit(const PhaseSignals& signals) {
+  const IngestRecord record{signals, next_sequence_++};
+  bump(submitted_);
+
+  switch (config_.overflow) {
+    case OverflowPolicy::BLOCK:
+      if (queue_.tryPush(record)) {
+        return true;
+      }
+      bump(blocked_);
+      while (!queue_.tryPush(record)) {
+        // Nothing will drain the queue before start() or after stop()
+        if (!running_.load(std::memory_order_acquire) || should_stop_.load(std::memory_order_acquire)) {
+          bump(dropped_newest_);
+          return false;
+        }
+        std::this_thread::yield();
+      }
+      return true;
+
+    case OverflowPolicy::DROP_OLDEST: {
+      bool evicted = false;
+      if (queue_.tryPushEvict(record, evicted)) {
+        if (evicted) bump(dropped_oldest_);
+        return true;
+      }
+      // The evaluator was copying out the oldest slot: it is about to free
+      // it, but waiting would block, so this sample is dropped instead
+      bump(dropped_newest_);
+      return false;
+    }
+
+    case OverflowPolicy::DROP_NEWEST:
+      if (queue_.tryPush(record)) {
+        return true;
+      }
+      bump(dropped_newest_);
+      return false;
+  }
+  return false;
+}
+
+void IngestPipeline::process(const IngestRecord& record) {
+  // Timed by the EVALUATE probe in HLV_ENABLE_INSTRUMENTATION builds; no
+  // clock reads here otherwise
+  PhaseReadinessOutput output = middleware_.evaluate(record.signals);
+
+  // A sequence gap means samples were dropped just before this one
+  if (record.sequence != expected_sequence_) {
+    output.flags |= FLAG_INGEST_OVERFLOW;
+    bump(overflow_gaps_);
+  }
+  expected_sequence_ = record.sequence + 1;
+
+  if (publication_) {
+    publication_->publish(record.signals, output);
+  } else if (state_) {
+    state_->update(record.signals, output);
+  }
+  if (audit_) {
+    audit_->log(record.signals, output);
+  }
+  bump(evaluated_);
+}
+
+void IngestPipeline::evaluatorLoop() {
+  if (config_.evaluator_cpu >= 0) {
+    pinned_.store(pinCurrentThread(config_.evaluator_cpu), std::memory_order_release);
+  }
+  std::vector<IngestRecord> batch(config_.batch_size);
+
+  while (true) {
+    // Sample the stop flag before draining so samples submitted before
+    // stop() are always evaluated
+    const bool stopping = should_stop_.load(std::memory_order_acquire);
+    const size_t depth = queue_.size();
+    if (depth > max_depth_.load(std::memory_order_relaxed)) {
+      max_depth_.store(depth, std::memory_order_relaxed);
+    }
+
+    const size_t n = queue_.popBatch(batch.data(), batch.size());
+    for (size_t i = 0; i < n; ++i) {
+      process(batch[i]);
+    }
+
+    if (n == 0) {
+      if (stopping) {
+        break;
+      }
+      std::this_thread::sleep_for(kIdlePoll);
+    }
+  }
+}
+
+void IngestPipeline::render(std::ostream& out) const {
+  out << "# HELP hlv_ingest_submitted_total Samples submitted to the ingest queue.\n";
+  out << "# TYPE hlv_ingest_submitted_total counter\n";
+  out << "hlv_ingest_submitted_total " << submittedCount() << "\n";
+  out << "# HELP hlv_ingest_dropped_total Samples dropped because the ingest queue was full.\n";
+  out << "# TYPE hlv_ingest_dropped_total counter\n";
+  out << "hlv_ingest_dropped_total{policy=\"drop_oldest\"} " << droppedOldestCount() << "\n";
+  out << "hlv_ingest_dropped_total{policy=\"drop_newest\"} " << droppedNewestCount() << "\n";
+  out << "# HELP hlv_ingest_blocked_total Submits that waited for queue space (block policy).\n";
+  out << "# TYPE hlv_ingest_blocked_total counter\n";
+  out << "hlv_ingest_blocked_total " << blockedCount() << "\n";
+  out << "# HELP hlv_ingest_evaluated_total Samples evaluated by the ingest evaluator thread.\n";
+  out << "# TYPE hlv_ingest_evaluated_total counter\n";
+  out << "hlv_ingest_evaluated_total " << evaluatedCount() << "\n";
+  out << "# HELP hlv_ingest_queue_depth Samples waiting in the ingest queue.\n";
+  out << "# TYPE hlv_ingest_queue_depth gauge\n";
+  out << "hlv_ingest_queue_depth " << queueDepth() << "\n";
+  out << "# HELP hlv_ingest_queue_depth_max Highest ingest queue depth seen by the evaluator.\n";
+  out << "# TYPE hlv_ingest_queue_depth_max gauge\n";
+  out << "hlv_ingest_queue_depth_max " << maxQueueDepth() << "\n";
+  out << "# HELP hlv_ingest_queue_capacity Ingest queue capacity.\n";
+  out << "# TYPE hlv_ingest_queue_capacity gauge\n";
+  out << "hlv_ingest_queue_capacity " << queueCapacity() << "\n";
+}
+
+} // namespace hlv
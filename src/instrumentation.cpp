@@ -0,0 +1,181 @@
+#include "hlv/instrumentation.hpp"
+
+#include <chrono>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HLV_INSTRUMENTATION_TSC 1
+#endif
+
+namespace hlv {
+
+namespace {
+
+std::array<LogLinearHistogram, kLatencyProbeCount>& probeHistograms() {
+  static std::array<LogLinearHistogram, kLatencyProbeCount> histograms;
+  return histograms;
+}
+
+uint64_t monotonicRawNs() {
+  struct timespec ts;
+#ifdef CLOCK_MONOTONIC_RAW
+  clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+#else
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// Clock ticks per nanosecond, measured once on first query (server thread)
+double ticksPerNs() {
+#ifdef HLV_INSTRUMENTATION_TSC
+  static std::once_flag once;
+  static double ratio = 1.0;
+  std::call_once(once, [] {
+    const uint64_t ns0 = monotonicRawNs();
+    const uint64_t tsc0 = __rdtsc();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const uint64_t ns1 = monotonicRawNs();
+    const uint64_t tsc1 = __rdtsc();
+    if (ns1 > ns0 && tsc1 > tsc0) {
+      ratio = static_cast<double>(tsc1 - tsc0) / static_cast<double>(ns1 - ns0);
+    }
+  });
+  return ratio;
+#else
+  return 1.0;
+#endif
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// LogLinearHistogram
+// -----------------------------------------------------------------------------
+
+LogLinearHistogram::LogLinearHistogram() {
+  reset();
+}
+
+void LogLinearHistogram::reset() {
+  for (auto& c : counts_) {
+    c.store(0, std::memory_order_relaxed);
+  }
+  max_.store(0, std::memory_order_relaxed);
+}
+
+size_t LogLinearHistogram::bucketIndex(uint64_t value) {
+  if (value < kSubBuckets) {
+    return static_cast<size_t>(value);
+  }
+  const unsigned exponent = 63u - static_cast<unsigned>(__builtin_clzll(value));
+  const uint64_t mantissa = (value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+  return (exponent - kSubBucketBits + 1) * kSubBuckets + static_cast<size_t>(mantissa);
+}
+
+uint64_t LogLinearHistogram::bucketUpperBound(size_t index) {
+  if (index < kSubBuckets) {
+    return index;
+  }
+  const unsigned exponent = static_cast<unsigned>(index / kSubBuckets) + kSubBucketBits - 1;
+  const uint64_t mantissa = index % kSubBuckets;
+  const unsigned shift = exponent - kSubBucketBits;
+  const uint64_t lower = (kSubBuckets + mantissa) << shift;
+  return lower + ((uint64_t(1) << shift) - 1);
+}
+
+void LogLinearHistogram::record(uint64_t value) {
+  counts_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  uint64_t prev = max_.load(std::memory_order_relaxed);
+  while (value > prev &&
+         !max_.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {
+  }
+}
+
+uint64_t LogLinearHistogram::count() const {
+  uint64_t total = 0;
+  for (const auto& c : counts_) {
+    total += c.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+uint64_t LogLinearHistogram::valueAtQuantile(double q) const {
+  std::array<uint64_t, kBucketCount> snapshot;
+  uint64_t total = 0;
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    snapshot[i] = counts_[i].load(std::memory_order_relaxed);
+    total += snapshot[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  q = q < 0.0 ? 0.0 : (q > 1.0 ? 1.0 : q);
+  uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total) + 0.999999999);
+  if (rank == 0) rank = 1;
+
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    cumulative += snapshot[i];
+    if (cumulative >= rank) {
+      const uint64_t upper = bucketUpperBound(i);
+      const uint64_t highest = max();
+      return (highest != 0 && upper > highest) ? highest : upper;
+    }
+  }
+  return max();
+}
+
+// -----------------------------------------------------------------------------
+// Probe registry
+// -----------------------------------------------------------------------------
+
+bool instrumentationEnabled() {
+#ifdef HLV_ENABLE_INSTRUMENTATION
+  return true;
+#else
+  return false;
+#endif
+}
+
+uint64_t instrumentationClock() {
+#ifdef HLV_INSTRUMENTATION_TSC
+  return __rdtsc();
+#else
+  return monotonicRawNs();
+#endif
+}
+
+double instrumentationTicksToNs(uint64_t ticks) {
+  return static_cast<double>(ticks) / ticksPerNs();
+}
+
+void recordLatencyTicks(LatencyProbe probe, uint64_t ticks) {
+  probeHistograms()[static_cast<size_t>(probe)].record(ticks);
+}
+
+LatencySummary latencySummary(LatencyProbe probe) {
+  const LogLinearHistogram& h = probeHistograms()[static_cast<size_t>(probe)];
+  LatencySummary summary;
+  summary.count = h.count();
+  if (summary.count == 0) {
+    return summary;
+  }
+  summary.p50_ns = instrumentationTicksToNs(h.valueAtQuantile(0.50));
+  summary.p99_ns = instrumentationTicksToNs(h.valueAtQuantile(0.99));
+  summary.p999_ns = instrumentationTicksToNs(h.valueAtQuantile(0.999));
+  summary.max_ns = instrumentationTicksToNs(h.max());
+  return summary;
+}
+
+void resetInstrumentation() {
+  for (auto& h : probeHistograms()) {
+    h.reset();
+  }
+}
+
+} // namespace hlv
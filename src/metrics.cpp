@@ -0,0 +1,275 @@
+#include "hlv/metrics.hpp"
+
+#include <cstdio>
+#include <new>
+#include <utility>
+
+namespace hlv {
+
+namespace {
+
+// Plain new[] only guarantees 16-byte alignment; the per-shard histogram
+// stride keeps shards on separate lines only if the array starts on one
+constexpr size_t kCacheLineBytes = 64;
+
+// Bucket bounds for PhaseReadinessMiddleware::evaluate() (sub-microsecond work)
+std::vector<uint64_t> evaluateBucketsNs() {
+  return {50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 1000000};
+}
+
+// Bucket bounds for HTTP request handling
+std::vector<uint64_t> requestBucketsNs() {
+  return {50000, 100000, 250000, 500000, 1000000, 2500000, 5000000,
+          10000000, 25000000, 50000000, 100000000, 250000000, 1000000000};
+}
+
+void writeSeconds(std::ostream& out, uint64_t ns) {
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%.9g", static_cast<double>(ns) * 1e-9);
+  out << buf;
+}
+
+void writeHeader(std::ostream& out, const char* name, const char* type, const char* help) {
+  out << "# HELP " << name << " " << help << "\n";
+  out << "# TYPE " << name << " " << type << "\n";
+}
+
+} // namespace
+
+size_t metricShardIndex() {
+  static std::atomic<size_t> next_shard{0};
+  thread_local const size_t index = next_shard.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+  return index;
+}
+
+// -----------------------------------------------------------------------------
+// MetricCounter / MetricHistogram
+// -----------------------------------------------------------------------------
+
+uint64_t MetricCounter::value() const {
+  uint64_t total = 0;
+  for (const auto& shard : shards_) {
+    total += shard.value.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+MetricHistogram::MetricHistogram(std::vector<uint64_t> upper_bounds_ns)
+    : bounds_(std::move(upper_bounds_ns))
+    , stride_(((bounds_.size() + 2) + 7) / 8 * 8)
+    , slots_(static_cast<std::atomic<uint64_t>*>(
+          ::operator new(stride_ * kMetricShards * sizeof(std::atomic<uint64_t>),
+                         std::align_val_t(kCacheLineBytes))))
+{
+  for (size_t i = 0; i < stride_ * kMetricShards; ++i) {
+    new (&slots_[i]) std::atomic<uint64_t>(0);
+  }
+}
+
+void MetricHistogram::AlignedSlotsDeleter::operator()(std::atomic<uint64_t>* slots) const {
+  ::operator delete(slots, std::align_val_t(kCacheLineBytes));
+}
+
+void MetricHistogram::observe(uint64_t ns) {
+  size_t bucket = 0;
+  while (bucket < bounds_.size() && ns > bounds_[bucket]) {
+    ++bucket;
+  }
+  std::atomic<uint64_t>* shard = &slots_[metricShardIndex() * stride_];
+  shard[bucket].fetch_add(1, std::memory_order_relaxed);
+  shard[bounds_.size() + 1].fetch_add(ns, std::memory_order_relaxed);
+}
+
+std::vector<uint64_t> MetricHistogram::bucketCounts() const {
+  std::vector<uint64_t> counts(bounds_.size() + 1, 0);
+  for (size_t s = 0; s < kMetricShards; ++s) {
+    for (size_t b = 0; b < counts.size(); ++b) {
+      counts[b] += slots_[s * stride_ + b].load(std::memory_order_relaxed);
+    }
+  }
+  return counts;
+}
+
+uint64_t MetricHistogram::sumNs() const {
+  uint64_t total = 0;
+  for (size_t s = 0; s < kMetricShards; ++s) {
+    total += slots_[s * stride_ + bounds_.size() + 1].load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+void MetricHistogram::render(std::ostream& out, const char* name, const std::string& labels) const {
+  const std::vector<uint64_t> counts = bucketCounts();
+  uint64_t cumulative = 0;
+  for (size_t b = 0; b < counts.size(); ++b) {
+    cumulative += counts[b];
+    out << name << "_bucket{" << labels << "le=\"";
+    if (b < bounds_.size()) {
+      writeSeconds(out, bounds_[b]);
+    } else {
+      out << "+Inf";
+    }
+    out << "\"} " << cumulative << "\n";
+  }
+  const std::string suffix_labels = labels.empty() ? std::string()
+      : "{" + labels.substr(0, labels.size() - 1) + "}";
+  out << name << "_sum" << suffix_labels << " ";
+  writeSeconds(out, sumNs());
+  out << "\n";
+  out << name << "_count" << suffix_labels << " " << cumulative << "\n";
+}
+
+// -----------------------------------------------------------------------------
+// ReadinessMetrics
+// -----------------------------------------------------------------------------
+
+ReadinessMetrics::ReadinessMetrics()
+    : evaluate_latency_(evaluateBucketsNs())
+    , rate_window_start_()
+    , rate_window_count_(0)
+    , update_rate_hz_(0.0)
+    , last_update_ns_(0)
+{}
+
+void ReadinessMetrics::recordUpdate(const PhaseReadinessOutput& output,
+                                    std::chrono::steady_clock::time_point now) {
+  Shard& shard = shards_[metricShardIndex()];
+  shard.updates.fetch_add(1, std::memory_order_relaxed);
+  shard.gate[static_cast<size_t>(output.gate) % 3].fetch_add(1, std::memory_order_relaxed);
+  if (output.flags & FLAG_FAILSAFE_DEFAULT) {
+    shard.failsafe.fetch_add(1, std::memory_order_relaxed);
+  }
+  for (uint32_t f = output.flags; f != 0; f &= f - 1) {
+    shard.flags[__builtin_ctz(f)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  last_update_ns_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count(),
+                        std::memory_order_relaxed);
+
+  // Publish the rate once per completed one-second window
+  if (rate_window_count_ == 0 && rate_window_start_.time_since_epoch().count() == 0) {
+    rate_window_start_ = now;
+  }
+  ++rate_window_count_;
+  const double elapsed_s = std::chrono::duration<double>(now - rate_window_start_).count();
+  if (elapsed_s >= 1.0) {
+    update_rate_hz_.store(static_cast<double>(rate_window_count_) / elapsed_s, std::memory_order_relaxed);
+    rate_window_start_ = now;
+    rate_window_count_ = 0;
+  }
+}
+
+double ReadinessMetrics::updateRateHz() const {
+  const int64_t last_ns = last_update_ns_.load(std::memory_order_relaxed);
+  const int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  if (last_ns == 0 || now_ns - last_ns > 1000000000) {
+    return 0.0;
+  }
+  return update_rate_hz_.load(std::memory_order_relaxed);
+}
+
+uint64_t ReadinessMetrics::updatesTotal() const {
+  uint64_t total = 0;
+  for (const auto& shard : shards_) total += shard.updates.load(std::memory_order_relaxed);
+  return total;
+}
+
+uint64_t ReadinessMetrics::gateTotal(Gate g) const {
+  uint64_t total = 0;
+  for (const auto& shard : shards_) {
+    total += shard.gate[static_cast<size_t>(g) % 3].load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+uint64_t ReadinessMetrics::flagTotal(unsigned bit) const {
+  uint64_t total = 0;
+  for (const auto& shard : shards_) total += shard.flags[bit % 32].load(std::memory_order_relaxed);
+  return total;
+}
+
+uint64_t ReadinessMetrics::failsafeTotal() const {
+  uint64_t total = 0;
+  for (const auto& shard : shards_) total += shard.failsafe.load(std::memory_order_relaxed);
+  return total;
+}
+
+void ReadinessMetrics::render(std::ostream& out) const {
+  writeHeader(out, "hlv_updates_total", "counter", "Readiness updates applied to the API state.");
+  out << "hlv_updates_total " << updatesTotal() << "\n";
+
+  writeHeader(out, "hlv_update_rate_hz", "gauge",
+              "Update rate over the last completed one-second window; 0 once updates stop for a window.");
+  out << "hlv_update_rate_hz " << updateRateHz() << "\n";
+
+  writeHeader(out, "hlv_gate_samples_total", "counter", "Samples observed in each gate state.");
+  for (Gate g : {Gate::BLOCK, Gate::CAUTION, Gate::ALLOW}) {
+    out << "hlv_gate_samples_total{gate=\"" << gateToString(g) << "\"} " << gateTotal(g) << "\n";
+  }
+
+  writeHeader(out, "hlv_flag_samples_total", "counter", "Samples with each PhaseFlags bit set.");
+  for (const PhaseFlagName& f : kPhaseFlagNames) {
+    out << "hlv_flag_samples_total{flag=\"" << f.name << "\"} "
+        << flagTotal(static_cast<unsigned>(__builtin_ctz(f.flag))) << "\n";
+  }
+
+  writeHeader(out, "hlv_failsafe_total", "counter", "Samples that took a fail-safe path.");
+  out << "hlv_failsafe_total " << failsafeTotal() << "\n";
+
+  writeHeader(out, "hlv_evaluate_latency_seconds", "histogram",
+              "PhaseReadinessMiddleware::evaluate() latency reported by the readiness loop.");
+  evaluate_latency_.render(out, "hlv_evaluate_latency_seconds");
+}
+
+// -----------------------------------------------------------------------------
+// ServerMetrics
+// -----------------------------------------------------------------------------
+
+ServerMetrics::ServerMetrics(std::vector<std::string> endpoints)
+    : endpoints_(std::move(endpoints))
+{
+  endpoints_.push_back("other");
+  requests_.reset(new std::array<MetricCounter, 6>[endpoints_.size()]);
+  latency_.reserve(endpoints_.size());
+  for (size_t i = 0; i < endpoints_.size(); ++i) {
+    latency_.emplace_back(requestBucketsNs());
+  }
+}
+
+size_t ServerMetrics::endpointIndex(const std::string& path) const {
+  for (size_t i = 0; i + 1 < endpoints_.size(); ++i) {
+    if (endpoints_[i] == path) return i;
+  }
+  return endpoints_.size() - 1;
+}
+
+void ServerMetrics::recordRequest(size_t endpoint_index, int status_code, uint64_t latency_ns) {
+  const size_t status_class = (status_code >= 100 && status_code < 600) ? status_code / 100 : 5;
+  requests_[endpoint_index][status_class].add();
+  latency_[endpoint_index].observe(latency_ns);
+}
+
+uint64_t ServerMetrics::requestsTotal(size_t endpoint_index, int status_class) const {
+  return requests_[endpoint_index][static_cast<size_t>(status_class) % 6].value();
+}
+
+void ServerMetrics::render(std::ostream& out) const {
+  writeHeader(out, "hlv_http_requests_total", "counter", "HTTP requests by endpoint and status class.");
+  for (size_t i = 0; i < endpoints_.size(); ++i) {
+    for (int status_class = 1; status_class <= 5; ++status_class) {
+      const uint64_t n = requestsTotal(i, status_class);
+      if (n == 0) continue;
+      out << "hlv_http_requests_total{endpoint=\"" << endpoints_[i]
+          << "\",code=\"" << status_class << "xx\"} " << n << "\n";
+    }
+  }
+
+  writeHeader(out, "hlv_http_request_duration_seconds", "histogram",
+              "HTTP request handling latency by endpoint.");
+  for (size_t i = 0; i < endpoints_.size(); ++i) {
+    latency_[i].render(out, "hlv_http_request_duration_seconds", "endpoint=\"" + endpoints_[i] + "\",");
+  }
+}
+
+} // namespace hlv
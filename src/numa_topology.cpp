@@ -0,0 +1,155 @@
+#include "hlv/numa_topology.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace hlv {
+
+namespace {
+
+const char* const kNodeRoot = "/sys/devices/system/node/";
+
+bool readFirstLine(const std::string& path, std::string& line) {
+  std::ifstream in(path);
+  return in && std::getline(in, line);
+}
+
+bool parseInt(const std::string& text, int& value) {
+  if (text.empty()) return false;
+  char* end = nullptr;
+  const long v = std::strtol(text.c_str(), &end, 10);
+  if (*end != '\0' || v < 0 || v > 1 << 20) return false;
+  value = static_cast<int>(v);
+  return true;
+}
+
+} // namespace
+
+bool parseCpuList(const std::string& text, std::vector<int>& cpus) {
+  cpus.clear();
+  std::string trimmed = text;
+  while (!trimmed.empty() && (trimmed.back() == '\n' || trimmed.back() == ' ')) trimmed.pop_back();
+  if (trimmed.empty()) return true;   // An empty list is valid (e.g. a memory-only node)
+  std::stringstream ss(trimmed);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    const size_t dash = item.find('-');
+    int lo = 0;
+    int hi = 0;
+    if (dash == std::string::npos) {
+      if (!parseInt(item, lo)) return false;
+      hi = lo;
+    } else if (!parseInt(item.substr(0, dash), lo) || !parseInt(item.substr(dash + 1), hi) || hi < lo) {
+      return false;
+    }
+    for (int cpu = lo; cpu <= hi; ++cpu) cpus.push_back(cpu);
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return true;
+}
+
+NumaTopology::NumaTopology()
+    : node_cpus_(1)
+    , cpu_nodes_(1) {}
+
+NumaTopology NumaTopology::detect() {
+  std::string line;
+  std::vector<int> nodes;
+  if (!readFirstLine(std::string(kNodeRoot) + "online", line) || !parseCpuList(line, nodes) || nodes.empty()) {
+    return NumaTopology();
+  }
+  std::vector<std::vector<int>> node_cpus(static_cast<size_t>(nodes.back()) + 1);
+  for (int node : nodes) {
+    std::vector<int> cpus;
+    if (readFirstLine(std::string(kNodeRoot) + "node" + std::to_string(node) + "/cpulist", line) &&
+        parseCpuList(line, cpus)) {
+      node_cpus[static_cast<size_t>(node)] = cpus;
+    }
+  }
+  return fromNodeCpus(node_cpus);
+}
+
+NumaTopology NumaTopology::fromNodeCpus(const std::vector<std::vector<int>>& node_cpus) {
+  NumaTopology topology;
+  if (node_cpus.empty()) return topology;
+  topology.node_cpus_ = node_cpus;
+  topology.cpu_nodes_ = 0;
+  for (size_t node = 0; node < node_cpus.size(); ++node) {
+    if (!node_cpus[node].empty()) ++topology.cpu_nodes_;
+    for (int cpu : node_cpus[node]) {
+      if (cpu < 0) continue;
+      if (static_cast<size_t>(cpu) >= topology.cpu_node_.size()) {
+        topology.cpu_node_.resize(static_cast<size_t>(cpu) + 1, -1);
+      }
+      topology.cpu_node_[static_cast<size_t>(cpu)] = static_cast<int>(node);
+    }
+  }
+  return topology;
+}
+
+int NumaTopology::nodeOfCpu(int cpu) const {
+  if (!isMultiNode()) return 0;
+  if (cpu < 0 || static_cast<size_t>(cpu) >= cpu_node_.size()) return -1;
+  return cpu_node_[static_cast<size_t>(cpu)];
+}
+
+const std::vector<int>& NumaTopology::cpusOfNode(size_t node) const {
+  static const std::vector<int> kNone;
+  return node < node_cpus_.size() ? node_cpus_[node] : kNone;
+}
+
+int NumaTopology::currentNode() const {
+  if (!isMultiNode()) return 0;
+#if defined(__linux__)
+  const int node = nodeOfCpu(sched_getcpu());
+  return node < 0 ? 0 : node;
+#else
+  return 0;
+#endif
+}
+
+ChannelShardMap::ChannelShardMap(size_t channels, size_t chunk_size, const std::vector<int>& worker_nodes)
+    : channels_(channels) {
+  const size_t workers = worker_nodes.size();
+  if (workers == 0) return;
+  if (chunk_size == 0) chunk_size = 1;
+  chunks_ = (channels + chunk_size - 1) / chunk_size;
+
+  // Position of each worker in node order
+  std::vector<size_t> order(workers);
+  for (size_t w = 0; w < workers; ++w) order[w] = w;
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return worker_nodes[a] < worker_nodes[b]; });
+
+  shards_.resize(workers);
+  for (size_t p = 0; p < workers; ++p) {
+    ChannelShard& s = shards_[order[p]];
+    s.node = worker_nodes[order[p]];
+    s.first_chunk = p * chunks_ / workers;
+    s.end_chunk = (p + 1) * chunks_ / workers;
+    s.first_channel = std::min(s.first_chunk * chunk_size, channels);
+    s.channels = std::min(s.end_chunk * chunk_size, channels) - s.first_channel;
+  }
+
+  steal_order_.resize(workers);
+  for (size_t w = 0; w < workers; ++w) {
+    std::vector<size_t>& victims = steal_order_[w];
+    victims.reserve(workers);
+    for (int pass = 0; pass < 2; ++pass) {
+      for (size_t k = 0; k < workers; ++k) {
+        const size_t v = (w + k) % workers;
+        const bool local = worker_nodes[v] == worker_nodes[w];
+        if (local == (pass == 0)) victims.push_back(v);
+      }
+    }
+  }
+}
+
+} // namespace hlv
@@ -0,0 +1,147 @@
+#include "hlv/output_digest.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace hlv {
+
+namespace {
+
+bool fail(std::string* error, const std::string& message) {
+  if (error) *error = message;
+  return false;
+}
+
+bool parseHex(const std::string& text, uint64_t& value) {
+  if (text.empty() || text.size() > 16) return false;
+  value = 0;
+  for (char c : text) {
+    uint64_t nibble;
+    if (c >= '0' && c <= '9') nibble = static_cast<uint64_t>(c - '0');
+    else if (c >= 'a' && c <= 'f') nibble = static_cast<uint64_t>(c - 'a' + 10);
+    else return false;
+    value = value << 4 | nibble;
+  }
+  return true;
+}
+
+// "key=value" with a decimal or hex value
+bool parseField(const std::string& field, const char* key, uint64_t& value, bool hex) {
+  const std::string prefix = std::string(key) + "=";
+  if (field.compare(0, prefix.size(), prefix) != 0) return false;
+  const std::string text = field.substr(prefix.size());
+  if (hex) return parseHex(text, value);
+  if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos) return false;
+  value = std::strtoull(text.c_str(), nullptr, 10);
+  return true;
+}
+
+} // namespace
+
+DigestLog::DigestLog(uint64_t block_samples)
+    : block_samples_(block_samples == 0 ? 1 : block_samples)
+    , from_file_(false)
+    , file_count_(0)
+    , file_value_(0) {}
+
+void DigestLog::reset() {
+  digest_.reset();
+  checkpoints_.clear();
+  from_file_ = false;
+  file_count_ = 0;
+  file_value_ = 0;
+}
+
+bool DigestLog::write(const std::string& path) const {
+  std::FILE* f = std::fopen(path.c_str(), "w");
+  if (!f) return false;
+  bool ok = std::fprintf(f, "hlvdigest 1 block=%" PRIu64 " samples=%" PRIu64 " digest=%016" PRIx64 "\n",
+                         block_samples_, count(), value()) > 0;
+  for (uint64_t c : checkpoints_) {
+    ok = ok && std::fprintf(f, "%016" PRIx64 "\n", c) > 0;
+  }
+  return std::fclose(f) == 0 && ok;
+}
+
+bool DigestLog::read(const std::string& path, std::string* error) {
+  std::ifstream in(path);
+  if (!in) return fail(error, "cannot open " + path);
+  std::string line;
+  if (!std::getline(in, line)) return fail(error, "empty digest log");
+
+  std::istringstream header(line);
+  std::string magic, version, block, samples, digest;
+  uint64_t block_samples = 0, count = 0, value = 0;
+  if (!(header >> magic >> version >> block >> samples >> digest) || magic != "hlvdigest" ||
+      version != "1" || !parseField(block, "block", block_samples, false) || block_samples == 0 ||
+      !parseField(samples, "samples", count, false) || !parseField(digest, "digest", value, true)) {
+    return fail(error, "not a version 1 digest log");
+  }
+
+  std::vector<uint64_t> checkpoints;
+  checkpoints.reserve(static_cast<size_t>(count / block_samples));
+  while (std::getline(in, line)) {
+    uint64_t c = 0;
+    if (!parseHex(line, c)) return fail(error, "malformed checkpoint at line " +
+                                               std::to_string(checkpoints.size() + 2));
+    checkpoints.push_back(c);
+  }
+  if (checkpoints.size() != count / block_samples) {
+    return fail(error, "checkpoint count does not match samples / block");
+  }
+
+  block_samples_ = block_samples;
+  digest_.reset();
+  checkpoints_.swap(checkpoints);
+  from_file_ = true;
+  file_count_ = count;
+  file_value_ = value;
+  return true;
+}
+
+DigestDivergence findDivergence(const DigestLog& a, const DigestLog& b) {
+  DigestDivergence d;
+  if (a.blockSamples() != b.blockSamples()) {
+    return d;
+  }
+  d.comparable = true;
+  const uint64_t block = a.blockSamples();
+
+  // Checkpoints cover whole prefixes: once two differ, all later ones do
+  size_t lo = 0;
+  size_t hi = std::min(a.checkpoints().size(), b.checkpoints().size());
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    ++d.comparisons;
+    if (a.checkpoints()[mid] == b.checkpoints()[mid]) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  const uint64_t common = std::min(a.checkpoints().size(), b.checkpoints().size());
+  if (lo < common) {
+    d.first_sample = lo * block;
+    d.end_sample = (lo + 1) * block;
+    return d;
+  }
+  ++d.comparisons;
+  if (a.count() == b.count() && a.value() == b.value()) {
+    d.equal = true;
+    d.first_sample = d.end_sample = a.count();
+    return d;
+  }
+  // Past the last common checkpoint, within the shorter stream or at its
+  // end when the other one continues
+  const uint64_t shorter = std::min(a.count(), b.count());
+  d.first_sample = common * block;
+  d.end_sample = std::min(a.count() == b.count() ? shorter : shorter + 1, (common + 1) * block);
+  return d;
+}
+
+} // namespace hlv
@@ -1,7 +1,12 @@
 #include "hlv/phase_readiness.hpp"
+#include "hlv/instrumentation.hpp"
 
+#include <array>
 #include <cmath>
+#include <cstring>
 #include <limits>
+#include <map>
+#include <mutex>
 
 namespace hlv {
 
@@ -25,16 +30,12 @@ bool PhaseReadinessMiddleware::validate(const PhaseReadinessConfig& cfg) {
   return true;
 }
 
-// Constructor
-PhaseReadinessMiddleware::PhaseReadinessMiddleware(PhaseReadinessConfig cfg)
-    : has_prev_(false)
-    , prev_t_s_(0.0)
-    , prev_temp_C_(std::numeric_limits<double>::quiet_NaN())
-    , trend_dTdt_(0.0)
-    , trend_age_s_(0.0)
-    , config_valid_(validate(cfg))
-{
-  if (!config_valid_) {
+// Sanitize once and precompute the derived constants
+CompiledPolicy CompiledPolicy::compile(const PhaseReadinessConfig& requested) {
+  CompiledPolicy policy;
+  PhaseReadinessConfig cfg = requested;
+  policy.valid = PhaseReadinessMiddleware::validate(cfg);
+  if (!policy.valid) {
     // Clamp/correct to safe defaults to ensure deterministic behavior
     if (!std::isfinite(cfg.temp_min_C)) cfg.temp_min_C = -20.0;
     if (!std::isfinite(cfg.temp_max_C)) cfg.temp_max_C = 60.0;
@@ -60,20 +61,87 @@ PhaseReadinessMiddleware::PhaseReadinessMiddleware(PhaseReadinessConfig cfg)
         cfg.gate_caution_threshold >= cfg.gate_allow_threshold)
       cfg.gate_caution_threshold = 0.40;
   }
-  cfg_ = cfg;
+  policy.config = cfg;
+  policy.alpha = cfg.ewma_alpha < 0.0 ? 0.0 : (cfg.ewma_alpha > 1.0 ? 1.0 : cfg.ewma_alpha);
+  policy.glitch_dt_s = cfg.max_dt_s * 0.5;
+  policy.max_trend_age_s = 2.0 * cfg.persistence_s;
+  return policy;
+}
+
+namespace {
+
+// Interned policies keyed by the requested config's bit pattern (so NaN
+// fields compare equal to themselves). Never destroyed: middlewares with
+// static storage may outlive any destruction order.
+using PolicyKey = std::array<uint64_t, sizeof(PhaseReadinessConfig) / sizeof(uint64_t)>;
+static_assert(sizeof(PhaseReadinessConfig) == sizeof(PolicyKey), "config must be plain doubles");
+
+struct PolicyTable {
+  std::mutex mutex;
+  std::map<PolicyKey, CompiledPolicy> policies;
+};
+
+PolicyTable& policyTable() {
+  static PolicyTable* table = new PolicyTable();
+  return *table;
+}
+
+} // namespace
+
+const CompiledPolicy* CompiledPolicy::intern(const PhaseReadinessConfig& cfg) {
+  PolicyKey key;
+  std::memcpy(key.data(), &cfg, sizeof(key));
+  PolicyTable& table = policyTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  auto it = table.policies.find(key);
+  if (it == table.policies.end()) {
+    it = table.policies.emplace(key, compile(cfg)).first;
+  }
+  return &it->second;
+}
+
+size_t CompiledPolicy::internedCount() {
+  PolicyTable& table = policyTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  return table.policies.size();
+}
+
+bool CompiledPolicy::sameDynamics(const CompiledPolicy& other) const {
+  return config.max_dt_s == other.config.max_dt_s &&
+         config.max_abs_temp_jump_C == other.config.max_abs_temp_jump_C &&
+         config.ewma_alpha == other.config.ewma_alpha &&
+         config.persistence_s == other.config.persistence_s;
+}
+
+bool CompiledPolicy::sameReadiness(const CompiledPolicy& other) const {
+  return sameDynamics(other) &&
+         config.temp_min_C == other.config.temp_min_C &&
+         config.temp_max_C == other.config.temp_max_C &&
+         config.max_abs_dTdt_C_per_s == other.config.max_abs_dTdt_C_per_s &&
+         config.hysteresis_block_threshold == other.config.hysteresis_block_threshold &&
+         config.coherence_allow_threshold == other.config.coherence_allow_threshold;
+}
+
+// Constructors
+PhaseReadinessMiddleware::PhaseReadinessMiddleware(PhaseReadinessConfig cfg)
+    : policy_(nullptr)
+    , owned_(std::make_shared<const CompiledPolicy>(CompiledPolicy::compile(cfg)))
+    , state_() {
+  policy_ = owned_.get();
 }
 
+PhaseReadinessMiddleware::PhaseReadinessMiddleware(const CompiledPolicy* policy)
+    : policy_(policy)
+    , owned_()
+    , state_() {}
+
 bool PhaseReadinessMiddleware::configValid() const {
-  return config_valid_;
+  return policy_->valid;
 }
 
 // Reset to initial fail-safe state
 void PhaseReadinessMiddleware::reset() {
-  has_prev_ = false;
-  prev_t_s_ = 0.0;
-  prev_temp_C_ = std::numeric_limits<double>::quiet_NaN();
-  trend_dTdt_ = 0.0;
-  trend_age_s_ = 0.0;
+  state_ = TrendState();
 }
 
 // Helper: check if value is finite
@@ -81,15 +149,10 @@ bool PhaseReadinessMiddleware::is_finite(double x) {
   return std::isfinite(x);
 }
 
-// Helper: clamp value to [0, 1]
-double PhaseReadinessMiddleware::clamp01(double x) {
-  return x < 0.0 ? 0.0 : (x > 1.0 ? 1.0 : x);
-}
-
 // Deterministic mapping: readiness → gate (uses configurable thresholds)
-Gate PhaseReadinessMiddleware::gate_from_readiness(double r) const {
-  if (r >= cfg_.gate_allow_threshold) return Gate::ALLOW;
-  if (r >= cfg_.gate_caution_threshold) return Gate::CAUTION;
+Gate PhaseReadinessMiddleware::gate_from_readiness(const PhaseReadinessConfig& cfg, double r) {
+  if (r >= cfg.gate_allow_threshold) return Gate::ALLOW;
+  if (r >= cfg.gate_caution_threshold) return Gate::CAUTION;
   return Gate::BLOCK;
 }
 
@@ -105,129 +168,144 @@ const char* gateToString(Gate g) {
 
 // Core evaluation: deterministic readiness inference
 PhaseReadinessOutput PhaseReadinessMiddleware::evaluate(const PhaseSignals& in) {
-  PhaseReadinessOutput out{};
-  out.flags = FLAG_NONE;
+  HLV_INSTRUMENT_SCOPE(LatencyProbe::EVALUATE);
+  const CompiledPolicy& policy = *policy_;
+  return decide(policy, in, advance(policy, state_, in));
+}
 
-  // Fail-safe helper
-  auto fail_safe = [&](uint32_t reason_flag) -> PhaseReadinessOutput {
-    out.readiness = 0.0;
-    out.gate = Gate::BLOCK;
-    out.flags |= reason_flag;
-    out.flags |= FLAG_FAILSAFE_DEFAULT;
-    out.dTdt_C_per_s = 0.0;
-    out.trend_C = 0.0;
-    out.stability_score = 0.0;
-    return out;
-  };
+// Steps 1-6: validation, derivative, trend and state update
+TrendStep PhaseReadinessMiddleware::advance(const CompiledPolicy& policy, TrendState& state,
+                                            const PhaseSignals& in) {
+  const PhaseReadinessConfig& cfg = policy.config;
+  TrendStep step;
 
   // Step 1: Validate required inputs
   if (!in.valid || !is_finite(in.t_s) || !is_finite(in.temp_C)) {
-    return fail_safe(FLAG_INPUT_INVALID);
+    step.outcome = TrendOutcome::INVALID;
+    return step;
   }
 
   // Step 2: Bootstrap - first sample
-  if (!has_prev_) {
-    has_prev_ = true;
-    prev_t_s_ = in.t_s;
-    prev_temp_C_ = in.temp_C;
-    out.readiness = 0.0;
-    out.gate = Gate::BLOCK;
-    out.flags |= FLAG_STALE_OR_NONMONO;
-    out.flags |= FLAG_FAILSAFE_DEFAULT;
-    out.dTdt_C_per_s = 0.0;
-    out.trend_C = 0.0;
-    out.stability_score = 0.0;
-    return out;
+  if (!state.has_prev) {
+    state.has_prev = true;
+    state.prev_t_s = in.t_s;
+    state.prev_temp_C = in.temp_C;
+    step.outcome = TrendOutcome::BOOTSTRAP;
+    return step;
   }
 
   // Step 3: Temporal validation
-  const double dt = in.t_s - prev_t_s_;
+  const double dt = in.t_s - state.prev_t_s;
   
-  if (dt <= 0.0) {
-    return fail_safe(FLAG_STALE_OR_NONMONO);
-  }
-  
-  if (dt > cfg_.max_dt_s) {
-    return fail_safe(FLAG_STALE_OR_NONMONO);
-  }
-
-  const bool temp_out_of_range =
-      (in.temp_C < cfg_.temp_min_C || in.temp_C > cfg_.temp_max_C);
-  if (temp_out_of_range) {
-    out.flags |= FLAG_TEMP_OUT_OF_RANGE;
+  if (dt <= 0.0 || dt > cfg.max_dt_s) {
+    step.outcome = TrendOutcome::STALE;
+    return step;
   }
 
   // Step 3b: Sensor glitch guard (only for larger sample intervals)
-  const double glitch_dt_threshold = cfg_.max_dt_s * 0.5;
-  if (dt >= glitch_dt_threshold &&
-      std::fabs(in.temp_C - prev_temp_C_) > cfg_.max_abs_temp_jump_C) {
-    return fail_safe(FLAG_INPUT_INVALID);
+  if (dt >= policy.glitch_dt_s &&
+      std::fabs(in.temp_C - state.prev_temp_C) > cfg.max_abs_temp_jump_C) {
+    step.outcome = TrendOutcome::GLITCH;
+    return step;
   }
 
   // Step 4: Compute instantaneous derivative
-  out.dTdt_C_per_s = (in.temp_C - prev_temp_C_) / dt;
+  step.dTdt_C_per_s = (in.temp_C - state.prev_temp_C) / dt;
 
   // Step 5: Update trend estimate (bounded EWMA)
-  const double alpha = clamp01(cfg_.ewma_alpha);
-  trend_dTdt_ = alpha * out.dTdt_C_per_s + (1.0 - alpha) * trend_dTdt_;
+  const double alpha = policy.alpha;
+  state.trend_dTdt = alpha * step.dTdt_C_per_s + (1.0 - alpha) * state.trend_dTdt;
 
   const bool sign_consistent =
-      (trend_dTdt_ > 0.0 && out.dTdt_C_per_s > 0.0) ||
-      (trend_dTdt_ < 0.0 && out.dTdt_C_per_s < 0.0) ||
-      (std::fabs(trend_dTdt_) < 1e-9 && std::fabs(out.dTdt_C_per_s) < 1e-9);
+      (state.trend_dTdt > 0.0 && step.dTdt_C_per_s > 0.0) ||
+      (state.trend_dTdt < 0.0 && step.dTdt_C_per_s < 0.0) ||
+      (std::fabs(state.trend_dTdt) < 1e-9 && std::fabs(step.dTdt_C_per_s) < 1e-9);
 
   if (sign_consistent) {
-    trend_age_s_ += dt;
+    state.trend_age_s += dt;
     // Clamp to prevent precision loss in very long-running systems
-    const double max_trend_age = 2.0 * cfg_.persistence_s;
-    if (trend_age_s_ > max_trend_age) trend_age_s_ = max_trend_age;
+    if (state.trend_age_s > policy.max_trend_age_s) state.trend_age_s = policy.max_trend_age_s;
   } else {
-    trend_age_s_ = 0.0;
+    state.trend_age_s = 0.0;
   }
 
-  out.trend_C = trend_dTdt_;
+  step.trend_C = state.trend_dTdt;
+  step.trend_age_s = state.trend_age_s;
 
   // Step 6: Update previous state
-  prev_t_s_ = in.t_s;
-  prev_temp_C_ = in.temp_C;
+  state.prev_t_s = in.t_s;
+  state.prev_temp_C = in.temp_C;
+  step.outcome = TrendOutcome::UPDATED;
+  return step;
+}
+
+// Steps 7-10: eligibility constraints, readiness, gate and safety override
+PhaseReadinessOutput PhaseReadinessMiddleware::decide(const CompiledPolicy& policy, const PhaseSignals& in,
+                                                      const TrendStep& step) {
+  const PhaseReadinessConfig& cfg = policy.config;
+  PhaseReadinessOutput out{};
+  out.flags = FLAG_NONE;
+
+  // Fail-safe outputs carry zero readiness, BLOCK and the reason
+  auto fail_safe = [&](uint32_t reason_flag) -> PhaseReadinessOutput {
+    out.readiness = 0.0;
+    out.gate = Gate::BLOCK;
+    out.flags |= reason_flag;
+    out.flags |= FLAG_FAILSAFE_DEFAULT;
+    out.dTdt_C_per_s = 0.0;
+    out.trend_C = 0.0;
+    out.stability_score = 0.0;
+    return out;
+  };
+
+  switch (step.outcome) {
+    case TrendOutcome::INVALID:   return fail_safe(FLAG_INPUT_INVALID);
+    case TrendOutcome::BOOTSTRAP: return fail_safe(FLAG_STALE_OR_NONMONO);
+    case TrendOutcome::STALE:     return fail_safe(FLAG_STALE_OR_NONMONO);
+    case TrendOutcome::GLITCH:
+    case TrendOutcome::UPDATED:   break;
+  }
+
+  // Range is checked before the glitch guard, so a glitch output carries it
+  if (in.temp_C < cfg.temp_min_C || in.temp_C > cfg.temp_max_C) {
+    out.flags |= FLAG_TEMP_OUT_OF_RANGE;
+  }
+  if (step.outcome == TrendOutcome::GLITCH) {
+    return fail_safe(FLAG_INPUT_INVALID);
+  }
+
+  out.dTdt_C_per_s = step.dTdt_C_per_s;
+  out.trend_C = step.trend_C;
 
   // Step 7: Apply eligibility constraints
-  if (std::fabs(out.dTdt_C_per_s) > cfg_.max_abs_dTdt_C_per_s) {
+  if (std::fabs(out.dTdt_C_per_s) > cfg.max_abs_dTdt_C_per_s) {
     out.flags |= FLAG_GRADIENT_TOO_HIGH;
   }
 
-  if (trend_age_s_ >= cfg_.persistence_s) {
-    if (trend_dTdt_ > 0.0) {
+  if (step.trend_age_s >= cfg.persistence_s) {
+    if (step.trend_C > 0.0) {
       out.flags |= FLAG_PERSISTENT_HEATING;
-    } else if (trend_dTdt_ < 0.0) {
+    } else if (step.trend_C < 0.0) {
       out.flags |= FLAG_PERSISTENT_COOLING;
     }
   }
 
   if (is_finite(in.hysteresis_index) &&
-      in.hysteresis_index >= cfg_.hysteresis_block_threshold) {
+      in.hysteresis_index >= cfg.hysteresis_block_threshold) {
     out.flags |= FLAG_HYSTERESIS_HIGH;
   }
 
   if (is_finite(in.coherence_index) &&
-      in.coherence_index < cfg_.coherence_allow_threshold) {
+      in.coherence_index < cfg.coherence_allow_threshold) {
     out.flags |= FLAG_COHERENCE_LOW;
   }
 
-  // Step 8: Compute readiness score (deterministic penalties)
-  double readiness = 1.0;
-
-  if (out.flags & FLAG_TEMP_OUT_OF_RANGE)  readiness *= 0.40;
-  if (out.flags & FLAG_GRADIENT_TOO_HIGH)  readiness *= 0.40;
-  if (out.flags & FLAG_HYSTERESIS_HIGH)    readiness *= 0.30;
-  if (out.flags & FLAG_COHERENCE_LOW)      readiness *= 0.70;
-  if (out.flags & FLAG_PERSISTENT_HEATING) readiness *= 0.80;
-  if (out.flags & FLAG_PERSISTENT_COOLING) readiness *= 0.90;
-
-  out.readiness = clamp01(readiness);
+  // Step 8: Compute readiness score (deterministic penalties; critical
+  // violations score zero, as Step 10 overrides them)
+  out.readiness = readinessFromFlags(out.flags);
 
   // Step 9: Map to discrete gate
-  out.gate = gate_from_readiness(out.readiness);
+  out.gate = gate_from_readiness(cfg, out.readiness);
 
   // Step 10: Safety override
   const bool critical_violation =
@@ -236,7 +314,6 @@ PhaseReadinessOutput PhaseReadinessMiddleware::evaluate(const PhaseSignals& in)
       (out.flags & FLAG_HYSTERESIS_HIGH);
 
   if (critical_violation) {
-    out.readiness = 0.0;
     out.gate = Gate::BLOCK;
   }
 
@@ -0,0 +1,425 @@
+#include "hlv/policy_sweep.hpp"
+
+#include "hlv/columnar_history.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define HLV_SWEEP_SSE2 1
+#endif
+
+namespace hlv {
+
+namespace {
+
+// Per-sample outcome shared by every lane
+enum SampleKind : uint8_t {
+  SAMPLE_EVALUATED = 0,   // Each lane runs its own stale/glitch checks
+  SAMPLE_INVALID = 1,     // Fail-safe BLOCK, state unchanged
+  SAMPLE_BOOTSTRAP = 2    // Fail-safe BLOCK, every lane seeded
+};
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+} // namespace
+
+// Struct-of-arrays lane state, padded to an even lane count
+struct PolicySweep::Lanes {
+  explicit Lanes(size_t n)
+      : count(n)
+      , max_dt(n), glitch_dt(n), max_jump(n), alpha(n), one_minus_alpha(n), max_age(n)
+      , temp_min(n), temp_max(n), max_dTdt(n), persistence(n), hysteresis(n), coherence(n)
+      , allow(n), caution(n)
+      , prev_t(n), prev_temp(n), trend(n), age(n), prev_gate(n)
+      , caution_count(n), allow_count(n), transitions(n), disagreements(n) {}
+
+  size_t count;
+  // Policy
+  AlignedColumn<double> max_dt, glitch_dt, max_jump, alpha, one_minus_alpha, max_age;
+  AlignedColumn<double> temp_min, temp_max, max_dTdt, persistence, hysteresis, coherence;
+  AlignedColumn<double> allow, caution;
+  // Trend state (has_prev is the baseline's: every lane bootstraps on the same sample)
+  AlignedColumn<double> prev_t, prev_temp, trend, age;
+  AlignedColumn<double> prev_gate;   // Gate as 0.0 / 1.0 / 2.0
+  // Statistics (BLOCK count is derived from the sample count)
+  AlignedColumn<uint64_t> caution_count, allow_count, transitions, disagreements;
+};
+
+// One block as loaded, plus the columns derived from it
+struct PolicySweep::Columns {
+  std::vector<PhaseSignals> in;
+  std::vector<double> t, temp, hysteresis, coherence;   // Non-finite indices are NaN
+  std::vector<uint8_t> kind;                            // SampleKind
+  std::vector<double> baseline_gate;
+
+  void derive(const CompiledPolicy& baseline, TrendState& state) {
+    const size_t n = in.size();
+    t.resize(n);
+    temp.resize(n);
+    hysteresis.resize(n);
+    coherence.resize(n);
+    kind.resize(n);
+    baseline_gate.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+      const PhaseSignals& s = in[i];
+      const TrendStep step = PhaseReadinessMiddleware::advance(baseline, state, s);
+      baseline_gate[i] = static_cast<double>(PhaseReadinessMiddleware::decide(baseline, s, step).gate);
+      kind[i] = step.outcome == TrendOutcome::INVALID     ? SAMPLE_INVALID
+                : step.outcome == TrendOutcome::BOOTSTRAP ? SAMPLE_BOOTSTRAP
+                                                          : SAMPLE_EVALUATED;
+      t[i] = s.t_s;
+      temp[i] = s.temp_C;
+      hysteresis[i] = std::isfinite(s.hysteresis_index) ? s.hysteresis_index : kNaN;
+      coherence[i] = std::isfinite(s.coherence_index) ? s.coherence_index : kNaN;
+    }
+  }
+};
+
+PolicySweep::PolicySweep(const PhaseReadinessConfig& baseline, const std::vector<PhaseReadinessConfig>& configs,
+                         const PolicySweepOptions& options)
+    : baseline_(CompiledPolicy::compile(baseline))
+    , options_(options)
+    , lanes_(new Lanes((configs.size() + 1) / 2 * 2))
+    , baseline_state_()
+    , samples_(0)
+{
+  if (options_.threads == 0) options_.threads = 1;
+  if (options_.block_samples == 0) options_.block_samples = 1;
+
+  configs_.reserve(configs.size());
+  Lanes& l = *lanes_;
+  for (size_t i = 0; i < l.count; ++i) {
+    // The padding lane repeats the last config; its results are never read
+    const CompiledPolicy policy = CompiledPolicy::compile(configs[std::min(i, configs.size() - 1)]);
+    if (i < configs.size()) configs_.push_back(policy.config);
+    const PhaseReadinessConfig& cfg = policy.config;
+    l.max_dt[i] = cfg.max_dt_s;
+    l.glitch_dt[i] = policy.glitch_dt_s;
+    l.max_jump[i] = cfg.max_abs_temp_jump_C;
+    l.alpha[i] = policy.alpha;
+    l.one_minus_alpha[i] = 1.0 - policy.alpha;
+    l.max_age[i] = policy.max_trend_age_s;
+    l.temp_min[i] = cfg.temp_min_C;
+    l.temp_max[i] = cfg.temp_max_C;
+    l.max_dTdt[i] = cfg.max_abs_dTdt_C_per_s;
+    l.persistence[i] = cfg.persistence_s;
+    l.hysteresis[i] = cfg.hysteresis_block_threshold;
+    l.coherence[i] = cfg.coherence_allow_threshold;
+    l.allow[i] = cfg.gate_allow_threshold;
+    l.caution[i] = cfg.gate_caution_threshold;
+  }
+  reset();
+}
+
+PolicySweep::~PolicySweep() = default;
+
+std::vector<PhaseReadinessConfig> PolicySweep::grid(const PhaseReadinessConfig& base, const SweepAxes& axes) {
+  std::vector<PhaseReadinessConfig> out(1, base);
+  auto expand = [&out](const std::vector<double>& values, double PhaseReadinessConfig::*field) {
+    if (values.empty()) return;
+    std::vector<PhaseReadinessConfig> next;
+    next.reserve(out.size() * values.size());
+    for (const PhaseReadinessConfig& cfg : out) {
+      for (double v : values) {
+        next.push_back(cfg);
+        next.back().*field = v;
+      }
+    }
+    out.swap(next);
+  };
+  expand(axes.max_abs_dTdt_C_per_s, &PhaseReadinessConfig::max_abs_dTdt_C_per_s);
+  expand(axes.persistence_s, &PhaseReadinessConfig::persistence_s);
+  expand(axes.ewma_alpha, &PhaseReadinessConfig::ewma_alpha);
+  expand(axes.gate_allow_threshold, &PhaseReadinessConfig::gate_allow_threshold);
+  expand(axes.gate_caution_threshold, &PhaseReadinessConfig::gate_caution_threshold);
+  return out;
+}
+
+void PolicySweep::reset() {
+  Lanes& l = *lanes_;
+  for (size_t i = 0; i < l.count; ++i) {
+    l.prev_t[i] = 0.0;
+    l.prev_temp[i] = kNaN;
+    l.trend[i] = 0.0;
+    l.age[i] = 0.0;
+    l.prev_gate[i] = static_cast<double>(Gate::BLOCK);
+    l.caution_count[i] = 0;
+    l.allow_count[i] = 0;
+    l.transitions[i] = 0;
+    l.disagreements[i] = 0;
+  }
+  baseline_state_ = TrendState();
+  samples_ = 0;
+}
+
+SweepResult PolicySweep::result(size_t i) const {
+  const Lanes& l = *lanes_;
+  SweepResult r;
+  r.gate_counts[static_cast<size_t>(Gate::CAUTION)] = l.caution_count[i];
+  r.gate_counts[static_cast<size_t>(Gate::ALLOW)] = l.allow_count[i];
+  r.gate_counts[static_cast<size_t>(Gate::BLOCK)] = samples_ - l.caution_count[i] - l.allow_count[i];
+  r.transitions = l.transitions[i];
+  r.disagreements = l.disagreements[i];
+  return r;
+}
+
+void PolicySweep::run(const PhaseSignals* samples, size_t count) {
+  const size_t block = options_.block_samples;
+  runBlocks((count + block - 1) / block, [samples, count, block](size_t b, Columns& cols) {
+    const size_t first = b * block;
+    cols.in.assign(samples + first, samples + std::min(first + block, count));
+  });
+  samples_ += count;
+}
+
+void PolicySweep::run(const TraceReader& trace) {
+  uint64_t count = 0;
+  for (size_t b = 0; b < trace.blockCount(); ++b) {
+    count += trace.block(b).size();
+  }
+  runBlocks(trace.blockCount(), [&trace](size_t b, Columns& cols) {
+    const TraceBlockView view = trace.block(b);
+    cols.in.resize(view.size());
+    for (size_t i = 0; i < view.size(); ++i) {
+      cols.in[i] = fromTraceRecord(view.signals(i));
+    }
+  });
+  samples_ += count;
+}
+
+void PolicySweep::runBlocks(size_t blocks, const BlockLoader& load) {
+  Lanes& l = *lanes_;
+  const size_t pairs = l.count / 2;
+  const size_t workers = std::max<size_t>(1, std::min(options_.threads, pairs));
+  if (workers == 1) {
+    runRange(0, l.count, blocks, load, baseline_state_);
+    return;
+  }
+
+  // Contiguous lane ranges of whole pairs; each worker advances its own
+  // copy of the baseline and worker 0's copy is kept
+  std::vector<TrendState> states(workers, baseline_state_);
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  auto range = [&](size_t w) {
+    runRange(w * pairs / workers * 2, (w + 1) * pairs / workers * 2, blocks, load, states[w]);
+  };
+  for (size_t w = 1; w < workers; ++w) {
+    threads.emplace_back(range, w);
+  }
+  range(0);
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  baseline_state_ = states[0];
+}
+
+namespace {
+
+// Lanes [first, end) over one block, scalar: each lane through
+// advance()/decide() with a TrendState rebuilt from its columns
+template <typename LanesT, typename ColumnsT>
+void lanesScalar(LanesT& l, size_t first, size_t end, const ColumnsT& cols, bool has_prev,
+                const std::vector<PhaseReadinessConfig>& configs) {
+  const size_t n = cols.in.size();
+  for (size_t j = first; j < end; ++j) {
+    const CompiledPolicy policy = CompiledPolicy::compile(configs[std::min(j, configs.size() - 1)]);
+    TrendState state;
+    state.prev_t_s = l.prev_t[j];
+    state.prev_temp_C = l.prev_temp[j];
+    state.trend_dTdt = l.trend[j];
+    state.trend_age_s = l.age[j];
+    state.has_prev = has_prev;
+    double prev_gate = l.prev_gate[j];
+    for (size_t i = 0; i < n; ++i) {
+      const TrendStep step = PhaseReadinessMiddleware::advance(policy, state, cols.in[i]);
+      const double gate = static_cast<double>(PhaseReadinessMiddleware::decide(policy, cols.in[i], step).gate);
+      l.caution_count[j] += gate == 1.0;
+      l.allow_count[j] += gate == 2.0;
+      l.transitions[j] += gate != prev_gate;
+      l.disagreements[j] += gate != cols.baseline_gate[i];
+      prev_gate = gate;
+    }
+    l.prev_t[j] = state.prev_t_s;
+    l.prev_temp[j] = state.prev_temp_C;
+    l.trend[j] = state.trend_dTdt;
+    l.age[j] = state.trend_age_s;
+    l.prev_gate[j] = prev_gate;
+  }
+}
+
+#ifdef HLV_SWEEP_SSE2
+
+inline __m128d select(__m128d mask, __m128d a, __m128d b) {
+  return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+// Add mask lanes (all ones = -1) to 64-bit counters
+inline __m128i countMask(__m128i counter, __m128d mask) {
+  return _mm_sub_epi64(counter, _mm_castpd_si128(mask));
+}
+
+// One pair of lanes: policy, trend state and counters as vectors
+struct LanePair {
+  __m128d max_dt, glitch_dt, max_jump, alpha, one_minus_alpha, max_age;
+  __m128d temp_min, temp_max, max_dTdt, persistence, hysteresis_th, coherence_th, allow, caution;
+  __m128d prev_t, prev_temp, trend, age, prev_gate;
+  __m128i caution_count, allow_count, transitions, disagreements;
+
+  template <typename LanesT>
+  void load(const LanesT& l, size_t j) {
+    max_dt = _mm_load_pd(&l.max_dt[j]);
+    glitch_dt = _mm_load_pd(&l.glitch_dt[j]);
+    max_jump = _mm_load_pd(&l.max_jump[j]);
+    alpha = _mm_load_pd(&l.alpha[j]);
+    one_minus_alpha = _mm_load_pd(&l.one_minus_alpha[j]);
+    max_age = _mm_load_pd(&l.max_age[j]);
+    temp_min = _mm_load_pd(&l.temp_min[j]);
+    temp_max = _mm_load_pd(&l.temp_max[j]);
+    max_dTdt = _mm_load_pd(&l.max_dTdt[j]);
+    persistence = _mm_load_pd(&l.persistence[j]);
+    hysteresis_th = _mm_load_pd(&l.hysteresis[j]);
+    coherence_th = _mm_load_pd(&l.coherence[j]);
+    allow = _mm_load_pd(&l.allow[j]);
+    caution = _mm_load_pd(&l.caution[j]);
+    prev_t = _mm_load_pd(&l.prev_t[j]);
+    prev_temp = _mm_load_pd(&l.prev_temp[j]);
+    trend = _mm_load_pd(&l.trend[j]);
+    age = _mm_load_pd(&l.age[j]);
+    prev_gate = _mm_load_pd(&l.prev_gate[j]);
+    caution_count = allow_count = transitions = disagreements = _mm_setzero_si128();
+  }
+
+  template <typename LanesT>
+  void store(LanesT& l, size_t j) const {
+    _mm_store_pd(&l.prev_t[j], prev_t);
+    _mm_store_pd(&l.prev_temp[j], prev_temp);
+    _mm_store_pd(&l.trend[j], trend);
+    _mm_store_pd(&l.age[j], age);
+    _mm_store_pd(&l.prev_gate[j], prev_gate);
+    add(&l.caution_count[j], caution_count);
+    add(&l.allow_count[j], allow_count);
+    add(&l.transitions[j], transitions);
+    add(&l.disagreements[j], disagreements);
+  }
+
+  static void add(uint64_t* counter, __m128i v) {
+    _mm_store_si128(reinterpret_cast<__m128i*>(counter),
+                    _mm_add_epi64(_mm_load_si128(reinterpret_cast<const __m128i*>(counter)), v));
+  }
+
+  // One SAMPLE_EVALUATED sample. Mirrors advance()/decide() operation for
+  // operation, so the gate is bit-identical to the scalar middleware's.
+  __m128d evaluate(__m128d t, __m128d temp, __m128d hyst, __m128d coh) {
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128d eps = _mm_set1_pd(1e-9);
+
+    // Steps 3-3b: stale sample and glitch guard
+    const __m128d dt = _mm_sub_pd(t, prev_t);
+    const __m128d stale = _mm_or_pd(_mm_cmple_pd(dt, zero), _mm_cmpgt_pd(dt, max_dt));
+    const __m128d jump = _mm_sub_pd(temp, prev_temp);
+    const __m128d glitch = _mm_and_pd(_mm_cmpge_pd(dt, glitch_dt),
+                                      _mm_cmpgt_pd(_mm_andnot_pd(sign, jump), max_jump));
+    const __m128d skip = _mm_or_pd(stale, glitch);
+
+    // Steps 4-5: derivative, EWMA trend and trend age
+    const __m128d d = _mm_div_pd(jump, dt);
+    const __m128d next_trend = _mm_add_pd(_mm_mul_pd(alpha, d), _mm_mul_pd(one_minus_alpha, trend));
+    const __m128d consistent = _mm_or_pd(
+        _mm_or_pd(_mm_and_pd(_mm_cmpgt_pd(next_trend, zero), _mm_cmpgt_pd(d, zero)),
+                  _mm_and_pd(_mm_cmplt_pd(next_trend, zero), _mm_cmplt_pd(d, zero))),
+        _mm_and_pd(_mm_cmplt_pd(_mm_andnot_pd(sign, next_trend), eps),
+                   _mm_cmplt_pd(_mm_andnot_pd(sign, d), eps)));
+    __m128d grown = _mm_add_pd(age, dt);
+    grown = select(_mm_cmpgt_pd(grown, max_age), max_age, grown);
+    const __m128d next_age = _mm_and_pd(consistent, grown);
+
+    // Step 6: update lanes that took the sample
+    prev_t = select(skip, prev_t, t);
+    prev_temp = select(skip, prev_temp, temp);
+    trend = select(skip, trend, next_trend);
+    age = select(skip, age, next_age);
+
+    // Step 7: eligibility; range, gradient and hysteresis force BLOCK
+    const __m128d range = _mm_or_pd(_mm_cmplt_pd(temp, temp_min), _mm_cmpgt_pd(temp, temp_max));
+    const __m128d gradient = _mm_cmpgt_pd(_mm_andnot_pd(sign, d), max_dTdt);
+    const __m128d persistent = _mm_cmpge_pd(next_age, persistence);
+    const __m128d heating = _mm_and_pd(persistent, _mm_cmpgt_pd(next_trend, zero));
+    const __m128d cooling = _mm_and_pd(persistent, _mm_cmplt_pd(next_trend, zero));
+    const __m128d hysteresis = _mm_cmpge_pd(hyst, hysteresis_th);   // NaN (non-finite index): false
+    const __m128d coherence = _mm_cmplt_pd(coh, coherence_th);      // NaN: false
+    const __m128d block = _mm_or_pd(_mm_or_pd(skip, range), _mm_or_pd(gradient, hysteresis));
+
+    // Steps 8-9: remaining penalties in decide()'s order, then the gate
+    __m128d readiness = one;
+    readiness = select(coherence, _mm_mul_pd(readiness, _mm_set1_pd(0.70)), readiness);
+    readiness = select(heating, _mm_mul_pd(readiness, _mm_set1_pd(0.80)), readiness);
+    readiness = select(cooling, _mm_mul_pd(readiness, _mm_set1_pd(0.90)), readiness);
+    const __m128d gate = select(_mm_cmpge_pd(readiness, allow), _mm_set1_pd(2.0),
+                                select(_mm_cmpge_pd(readiness, caution), one, zero));
+    return _mm_andnot_pd(block, gate);
+  }
+
+  void count(__m128d gate, __m128d baseline_gate) {
+    caution_count = countMask(caution_count, _mm_cmpeq_pd(gate, _mm_set1_pd(1.0)));
+    allow_count = countMask(allow_count, _mm_cmpeq_pd(gate, _mm_set1_pd(2.0)));
+    transitions = countMask(transitions, _mm_cmpneq_pd(gate, prev_gate));
+    disagreements = countMask(disagreements, _mm_cmpneq_pd(gate, baseline_gate));
+    prev_gate = gate;
+  }
+};
+
+// Lanes [first, end) (even bounds) over one block. Each lane pair runs
+// the whole block with its policy, state and counters in registers; the
+// block columns stream from L2.
+template <typename LanesT, typename ColumnsT>
+void lanesSse2(LanesT& l, size_t first, size_t end, const ColumnsT& cols) {
+  const size_t n = cols.in.size();
+  for (size_t j = first; j < end; j += 2) {
+    LanePair pair;
+    pair.load(l, j);
+    for (size_t i = 0; i < n; ++i) {
+      const uint8_t kind = cols.kind[i];
+      const __m128d t = _mm_set1_pd(cols.t[i]);
+      const __m128d temp = _mm_set1_pd(cols.temp[i]);
+      __m128d gate = _mm_setzero_pd();
+      if (kind == SAMPLE_EVALUATED) {
+        gate = pair.evaluate(t, temp, _mm_set1_pd(cols.hysteresis[i]), _mm_set1_pd(cols.coherence[i]));
+      } else if (kind == SAMPLE_BOOTSTRAP) {
+        pair.prev_t = t;
+        pair.prev_temp = temp;
+      }
+      pair.count(gate, _mm_set1_pd(cols.baseline_gate[i]));
+    }
+    pair.store(l, j);
+  }
+}
+
+#endif
+
+} // namespace
+
+void PolicySweep::runRange(size_t first_lane, size_t end_lane, size_t blocks, const BlockLoader& load,
+                           TrendState& baseline_state) {
+  Lanes& l = *lanes_;
+  Columns cols;
+  for (size_t b = 0; b < blocks; ++b) {
+    load(b, cols);
+    const bool has_prev = baseline_state.has_prev;
+    cols.derive(baseline_, baseline_state);
+#ifdef HLV_SWEEP_SSE2
+    (void)has_prev;
+    lanesSse2(l, first_lane, end_lane, cols);
+#else
+    lanesScalar(l, first_lane, end_lane, cols, has_prev, configs_);
+#endif
+  }
+}
+
+} // namespace hlv
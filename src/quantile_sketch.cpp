@@ -0,0 +1,295 @@
+#include "hlv/quantile_sketch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace hlv {
+
+namespace {
+
+constexpr uint64_t kSketchSeed = 0x9E3779B97F4A7C15ull;
+
+// Smallest compactor (as in DataSketches KLL); keeps the low levels from
+// compacting on nearly every add
+constexpr uint32_t kMinCapacity = 8;
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// KllSketch
+// -----------------------------------------------------------------------------
+
+KllSketch::KllSketch(uint32_t k)
+    : k_(std::max(k, uint32_t(8)))
+    , n_(0)
+    , min_(std::numeric_limits<double>::quiet_NaN())
+    , max_(std::numeric_limits<double>::quiet_NaN())
+    , rng_(kSketchSeed)
+    , levels_(1)
+    , retained_(0)
+    , total_capacity_(0)
+{
+  updateCapacities();
+}
+
+void KllSketch::add(double value) {
+  if (std::isnan(value)) {
+    return;
+  }
+  if (n_ == 0) {
+    min_ = value;
+    max_ = value;
+  } else {
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+  }
+  ++n_;
+  levels_[0].push_back(value);
+  if (++retained_ >= total_capacity_) {
+    compress();
+  }
+}
+
+void KllSketch::merge(const KllSketch& other) {
+  if (other.n_ == 0) {
+    return;
+  }
+  if (n_ == 0) {
+    min_ = other.min_;
+    max_ = other.max_;
+  } else {
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+  }
+  n_ += other.n_;
+  if (levels_.size() < other.levels_.size()) {
+    levels_.resize(other.levels_.size());
+    updateCapacities();
+  }
+  for (size_t h = 0; h < other.levels_.size(); ++h) {
+    std::vector<double>& level = levels_[h];
+    const size_t mid = level.size();
+    level.insert(level.end(), other.levels_[h].begin(), other.levels_[h].end());
+    if (h > 0) {
+      mergeRuns(level, mid);
+    }
+  }
+  retained_ += other.retained_;
+  compress();
+}
+
+void KllSketch::clear() {
+  n_ = 0;
+  min_ = std::numeric_limits<double>::quiet_NaN();
+  max_ = std::numeric_limits<double>::quiet_NaN();
+  rng_ = kSketchSeed;
+  // Keep the level-0 buffer; pane sketches are cleared on every rotation
+  levels_.resize(1);
+  levels_[0].clear();
+  retained_ = 0;
+  updateCapacities();
+}
+
+void KllSketch::updateCapacities() {
+  // k at the top level, shrinking by 2/3 per level below it
+  capacities_.resize(levels_.size());
+  total_capacity_ = 0;
+  double cap = static_cast<double>(k_);
+  for (size_t h = levels_.size(); h-- > 0;) {
+    capacities_[h] = std::max(kMinCapacity, static_cast<uint32_t>(cap));
+    total_capacity_ += capacities_[h];
+    cap *= 2.0 / 3.0;
+  }
+}
+
+void KllSketch::mergeRuns(std::vector<double>& level, size_t mid) {
+  // std::inplace_merge would allocate a temporary buffer on every call
+  if (mid == 0 || mid == level.size() || level[mid - 1] <= level[mid]) {
+    return;
+  }
+  scratch_.resize(level.size());
+  std::merge(level.begin(), level.begin() + mid, level.begin() + mid, level.end(), scratch_.begin());
+  level.swap(scratch_);
+}
+
+bool KllSketch::nextBit() {
+  // xorshift64
+  rng_ ^= rng_ << 13;
+  rng_ ^= rng_ >> 7;
+  rng_ ^= rng_ << 17;
+  return (rng_ >> 32) & 1u;
+}
+
+void KllSketch::compress() {
+  while (retained_ >= total_capacity_) {
+    // Compact the lowest level at or over capacity
+    size_t h = 0;
+    while (h < levels_.size() && levels_[h].size() < capacities_[h]) ++h;
+    if (h == levels_.size()) {
+      return;
+    }
+    if (h + 1 == levels_.size()) {
+      levels_.emplace_back();   // Capacities below shift down by one step
+      updateCapacities();
+    }
+    // Levels above 0 are kept sorted, so only level 0 needs a sort
+    std::vector<double>& level = levels_[h];
+    if (h == 0) {
+      std::sort(level.begin(), level.end());
+    }
+
+    // An odd item stays behind at this level
+    const size_t keep = level.size() % 2;
+    const size_t offset = keep + (nextBit() ? 1 : 0);
+    std::vector<double>& up = levels_[h + 1];
+    const size_t mid = up.size();
+    for (size_t i = offset; i < level.size(); i += 2) {
+      up.push_back(level[i]);
+    }
+    mergeRuns(up, mid);
+    retained_ -= (level.size() - keep) / 2;
+    level.resize(keep);
+  }
+}
+
+double KllSketch::quantile(double q) const {
+  if (n_ == 0) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  if (q <= 0.0) return min_;
+  if (q >= 1.0) return max_;
+
+  std::vector<std::pair<double, uint64_t>> items;
+  items.reserve(retained_);
+  for (size_t h = 0; h < levels_.size(); ++h) {
+    for (double v : levels_[h]) items.emplace_back(v, uint64_t(1) << h);
+  }
+  std::sort(items.begin(), items.end());
+
+  const double target = q * static_cast<double>(n_);
+  uint64_t cumulative = 0;
+  for (const auto& item : items) {
+    cumulative += item.second;
+    if (static_cast<double>(cumulative) >= target) {
+      return item.first;
+    }
+  }
+  return max_;
+}
+
+double KllSketch::rankError(uint32_t k) {
+  return 2.296 / std::pow(static_cast<double>(std::max(k, uint32_t(8))), 0.9723);
+}
+
+// -----------------------------------------------------------------------------
+// WindowedQuantiles
+// -----------------------------------------------------------------------------
+
+std::vector<QuantileWindowConfig> defaultQuantileWindows() {
+  return {{10.0, 6}, {60.0, 6}, {600.0, 6}};
+}
+
+WindowedQuantiles::WindowedQuantiles(size_t fields, std::vector<QuantileWindowConfig> windows, uint32_t k)
+    : fields_(std::max(fields, size_t(1)))
+    , k_(k)
+    , staging_pane_s_(std::numeric_limits<double>::infinity())
+    , staging_(fields_, KllSketch(k))
+    , staging_index_(0)
+    , staging_started_(false)
+{
+  for (const auto& config : windows) {
+    if (!(config.window_s > 0.0) || config.panes == 0) continue;
+    Window w;
+    w.config = config;
+    w.pane_s = config.window_s / config.panes;
+    w.panes.assign(static_cast<size_t>(config.panes) * fields_, KllSketch(k));
+    staging_pane_s_ = std::min(staging_pane_s_, w.pane_s);
+    windows_.push_back(std::move(w));
+  }
+}
+
+void WindowedQuantiles::rotate(Window& w, double t_s) {
+  const int64_t index = static_cast<int64_t>(std::floor(t_s / w.pane_s));
+  if (!w.started) {
+    w.started = true;
+    w.current_index = index;
+    return;
+  }
+  if (index <= w.current_index) {
+    return;
+  }
+  // Clear every pane skipped over
+  const size_t panes = w.config.panes;
+  const int64_t steps = std::min<int64_t>(index - w.current_index, static_cast<int64_t>(panes));
+  for (int64_t s = 0; s < steps; ++s) {
+    w.current = (w.current + 1) % panes;
+    for (size_t f = 0; f < fields_; ++f) {
+      w.panes[w.current * fields_ + f].clear();
+    }
+  }
+  w.current_index = index;
+}
+
+void WindowedQuantiles::flushStaging() {
+  const double start_t = static_cast<double>(staging_index_) * staging_pane_s_;
+  for (Window& w : windows_) {
+    rotate(w, start_t);
+    for (size_t f = 0; f < fields_; ++f) {
+      w.panes[w.current * fields_ + f].merge(staging_[f]);
+    }
+  }
+  for (auto& sketch : staging_) sketch.clear();
+}
+
+void WindowedQuantiles::add(double t_s, const double* values) {
+  if (!std::isfinite(t_s) || windows_.empty()) {
+    return;
+  }
+  const int64_t index = static_cast<int64_t>(std::floor(t_s / staging_pane_s_));
+  if (!staging_started_) {
+    staging_started_ = true;
+    staging_index_ = index;
+    for (Window& w : windows_) rotate(w, t_s);
+  } else if (index > staging_index_) {
+    // The staged pane is complete; expire panes up to the new one too
+    flushStaging();
+    staging_index_ = index;
+    for (Window& w : windows_) rotate(w, t_s);
+  }
+  for (size_t f = 0; f < fields_; ++f) {
+    staging_[f].add(values[f]);
+  }
+}
+
+void WindowedQuantiles::clear() {
+  for (Window& w : windows_) {
+    for (auto& pane : w.panes) pane.clear();
+    w.current = 0;
+    w.current_index = 0;
+    w.started = false;
+  }
+  for (auto& sketch : staging_) sketch.clear();
+  staging_index_ = 0;
+  staging_started_ = false;
+}
+
+KllSketch WindowedQuantiles::sketch(size_t window, size_t field) const {
+  const Window& w = windows_[window];
+  KllSketch merged(k_);
+  for (size_t p = 0; p < w.config.panes; ++p) {
+    merged.merge(w.panes[p * fields_ + field]);
+  }
+  merged.merge(staging_[field]);
+  return merged;
+}
+
+int WindowedQuantiles::findWindow(double window_s) const {
+  for (size_t i = 0; i < windows_.size(); ++i) {
+    if (windows_[i].config.window_s == window_s) return static_cast<int>(i);
+  }
+  return -1;
+}
+
+} // namespace hlv
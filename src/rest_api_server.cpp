@@ -1,8 +1,12 @@
 #include "hlv/rest_api_server.hpp"
+#include "hlv/channel_registry.hpp"
+#include "hlv/instrumentation.hpp"
 
+#include <algorithm>
 #include <arpa/inet.h>
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <errno.h>
 #include <iomanip>
@@ -10,15 +14,162 @@
 #include <sstream>
 #include <sys/socket.h>
 #include <unistd.h>
+#include <utility>
+
+#ifdef HLV_WITH_ZLIB
+#include <zlib.h>
+#endif
 
 namespace hlv {
 
+namespace {
+
+// Upper bound on distinct (target, encoding) pairs kept compressed
+constexpr size_t kMaxCompressedCacheEntries = 16;
+
+std::string toLower(std::string s) {
+  for (char& c : s) {
+    if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+  }
+  return s;
+}
+
+// Strict decimal parse of a query value (whole string, finite)
+bool parseDouble(const std::string& s, double& out) {
+  if (s.empty()) return false;
+  char* end = nullptr;
+  const double v = std::strtod(s.c_str(), &end);
+  if (end != s.c_str() + s.size() || !std::isfinite(v)) return false;
+  out = v;
+  return true;
+}
+
+// Duration with optional unit suffix: "10", "10s", "1min", "1m", "2h"
+bool parseDuration(const std::string& s, double& seconds) {
+  size_t unit = s.find_first_not_of("0123456789.");
+  double scale = 1.0;
+  if (unit != std::string::npos) {
+    const std::string suffix = s.substr(unit);
+    if (suffix == "s") scale = 1.0;
+    else if (suffix == "m" || suffix == "min") scale = 60.0;
+    else if (suffix == "h") scale = 3600.0;
+    else return false;
+  } else {
+    unit = s.size();
+  }
+  double value = 0.0;
+  if (!parseDouble(s.substr(0, unit), value) || value <= 0.0) return false;
+  seconds = value * scale;
+  return true;
+}
+
+// Comma-separated flag names (case-insensitive, optional FLAG_ prefix) or
+// a single integer mask ("64", "0x40")
+bool parseFlags(const std::string& s, uint32_t& flags) {
+  if (s.empty()) return false;
+  if (s[0] >= '0' && s[0] <= '9') {
+    char* end = nullptr;
+    const unsigned long long v = std::strtoull(s.c_str(), &end, 0);
+    if (end != s.c_str() + s.size() || v > 0xFFFFFFFFull) return false;
+    flags = static_cast<uint32_t>(v);
+    return true;
+  }
+  uint32_t result = 0;
+  std::istringstream iss(s);
+  std::string item;
+  while (std::getline(iss, item, ',')) {
+    item = toLower(item);
+    if (item.compare(0, 5, "flag_") == 0) item = item.substr(5);
+    bool found = false;
+    for (const PhaseFlagName& f : kPhaseFlagNames) {
+      if (item == f.name) {
+        result |= f.flag;
+        found = true;
+        break;
+      }
+    }
+    if (!found) return false;
+  }
+  flags = result;
+  return true;
+}
+
+// Comma-separated gate names (case-insensitive) as a HistoryFilter::gate_mask
+bool parseGates(const std::string& s, uint8_t& mask) {
+  uint8_t result = 0;
+  std::istringstream iss(s);
+  std::string item;
+  while (std::getline(iss, item, ',')) {
+    item = toLower(item);
+    if (item == "allow") result |= 1u << static_cast<unsigned>(Gate::ALLOW);
+    else if (item == "caution") result |= 1u << static_cast<unsigned>(Gate::CAUTION);
+    else if (item == "block") result |= 1u << static_cast<unsigned>(Gate::BLOCK);
+    else return false;
+  }
+  if (result == 0) return false;
+  mask = result;
+  return true;
+}
+
+std::string trim(const std::string& s) {
+  const size_t begin = s.find_first_not_of(" \t");
+  if (begin == std::string::npos) return std::string();
+  const size_t end = s.find_last_not_of(" \t");
+  return s.substr(begin, end - begin + 1);
+}
+
+// Per-channel endpoints served under /api/channels/{id}/
+const char* const kChannelEndpoints[] = {"readiness", "thermal", "history", "diagnostics"};
+
+// "/api/channels/{id}/<endpoint>" -> id and endpoint (endpoint not validated)
+bool parseChannelPath(const std::string& path, size_t& id, std::string& endpoint) {
+  static const std::string prefix = "/api/channels/";
+  if (path.compare(0, prefix.size(), prefix) != 0) return false;
+  size_t pos = prefix.size();
+  size_t value = 0;
+  size_t digits = 0;
+  while (pos < path.size() && path[pos] >= '0' && path[pos] <= '9' && digits < 9) {
+    value = value * 10 + static_cast<size_t>(path[pos] - '0');
+    ++pos;
+    ++digits;
+  }
+  if (digits == 0 || pos >= path.size() || path[pos] != '/') return false;
+  endpoint = path.substr(pos + 1);
+  id = value;
+  return endpoint.find('/') == std::string::npos;
+}
+
+// Channel-range summary fields, written inline into a one-line JSON object
+void writeGateSummary(std::ostringstream& json, const GateSummary& summary) {
+  json << "\"channels\": " << summary.channels << ", \"min_readiness\": ";
+  if (summary.hasMin()) {
+    json << summary.min_readiness << ", \"min_channel\": " << summary.min_channel;
+  } else {
+    json << "null, \"min_channel\": null";
+  }
+  json << ", \"worst_gate\": ";
+  if (summary.channels > 0) {
+    json << "\"" << gateToString(summary.worst_gate) << "\"";
+  } else {
+    json << "null";
+  }
+  json << ", \"any_blocked\": " << (summary.anyBlocked() ? "true" : "false")
+       << ", \"flags\": " << summary.flags
+       << ", \"gate_counts\": {\"ALLOW\": " << summary.count(Gate::ALLOW)
+       << ", \"CAUTION\": " << summary.count(Gate::CAUTION)
+       << ", \"BLOCK\": " << summary.count(Gate::BLOCK) << "}";
+}
+
+} // namespace
+
 // -----------------------------------------------------------------------------
 // ReadinessAPIState Implementation
 // -----------------------------------------------------------------------------
 
 ReadinessAPIState::ReadinessAPIState()
-    : max_history_size_(100)
+    : history_(100)
+    , quantiles_(3)
+    , sequence_(0)
 {
   current_.timestamp = std::chrono::steady_clock::now();
   current_.t_s = 0.0;
@@ -35,9 +186,31 @@ ReadinessAPIState::ReadinessAPIState()
 }
 
 void ReadinessAPIState::update(const PhaseSignals& signals, const PhaseReadinessOutput& output) {
+  HLV_INSTRUMENT_SCOPE(LatencyProbe::API_UPDATE);
   std::lock_guard<std::mutex> lock(mutex_);
-  
-  current_.timestamp = std::chrono::steady_clock::now();
+  applyLocked(signals, output, std::chrono::steady_clock::now());
+  sequence_.fetch_add(1, std::memory_order_release);
+}
+
+void ReadinessAPIState::updateBatch(const ReadinessUpdate* updates, size_t count) {
+  if (count == 0) {
+    return;
+  }
+  // Batches have their own probe: one sample per batch would drag the
+  // per-update percentiles toward the batch cost
+  HLV_INSTRUMENT_SCOPE(LatencyProbe::API_UPDATE_BATCH);
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto now = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < count; ++i) {
+    applyLocked(updates[i].signals, updates[i].output, now);
+  }
+  sequence_.fetch_add(1, std::memory_order_release);
+}
+
+void ReadinessAPIState::applyLocked(const PhaseSignals& signals, const PhaseReadinessOutput& output,
+                                    std::chrono::steady_clock::time_point now) {
+  current_.timestamp = now;
+  metrics_.recordUpdate(output, current_.timestamp);
   current_.t_s = signals.t_s;
   current_.readiness = output.readiness;
   current_.gate = output.gate;
@@ -50,13 +223,14 @@ void ReadinessAPIState::update(const PhaseSignals& signals, const PhaseReadiness
   current_.hysteresis_index = signals.hysteresis_index;
   current_.coherence_index = signals.coherence_index;
   
-  // Add to history
-  history_.push_back(current_);
+  // Add to history (fixed-capacity ring, oldest sample overwritten)
+  history_.append(current_);
   
-  // Trim history if needed
-  while (history_.size() > max_history_size_) {
-    history_.pop_front();
-  }
+  compressed_history_.append(current_);
+  rollups_.append(current_);
+  transitions_.append(current_);
+  const double quantile_values[3] = {current_.readiness, current_.dTdt_C_per_s, current_.trend_C};
+  quantiles_.add(current_.t_s, quantile_values);
 }
 
 ReadinessSnapshot ReadinessAPIState::getCurrentSnapshot() const {
@@ -67,27 +241,135 @@ ReadinessSnapshot ReadinessAPIState::getCurrentSnapshot() const {
 std::vector<ReadinessSnapshot> ReadinessAPIState::getHistory(size_t max_count) const {
   std::lock_guard<std::mutex> lock(mutex_);
   
-  size_t count = std::min(max_count, history_.size());
-  std::vector<ReadinessSnapshot> result;
-  result.reserve(count);
-  
   // Get last N samples
-  auto it = history_.end() - count;
-  for (; it != history_.end(); ++it) {
-    result.push_back(*it);
-  }
-  
+  std::vector<ReadinessSnapshot> result;
+  history_.latest(max_count, result);
   return result;
 }
 
-void ReadinessAPIState::setMaxHistorySize(size_t size) {
+std::vector<ReadinessSnapshot> ReadinessAPIState::getHistoryRange(double from_t, double to_t, size_t max_count,
+                                                                  const HistoryFilter& filter) const {
+  std::vector<CompressedHistoryBlockPtr> blocks;
+  CompressedHistoryConfig config;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!compressed_history_.enabled()) {
+      std::vector<ReadinessSnapshot> result;
+      history_.range(from_t, to_t, max_count, result, filter);
+      return result;
+    }
+    blocks = compressed_history_.blocksInRange(from_t, to_t);
+    config = compressed_history_.config();
+  }
+  return CompressedHistory::decodeRange(blocks, config, from_t, to_t, max_count, filter);
+}
+
+HistoryStats ReadinessAPIState::getHistoryStats(double from_t, double to_t) const {
   std::lock_guard<std::mutex> lock(mutex_);
-  max_history_size_ = std::max(size, size_t(1));
-  
-  // Trim if needed
-  while (history_.size() > max_history_size_) {
-    history_.pop_front();
+  return history_.stats(from_t, to_t);
+}
+
+WindowedQuantiles ReadinessAPIState::getQuantiles() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return quantiles_;
+}
+
+CompressedHistoryStats ReadinessAPIState::getCompressedHistoryStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return compressed_history_.stats();
+}
+
+bool ReadinessAPIState::getRollup(double resolution_s, double from_t, double to_t,
+                                  std::vector<RollupBucket>& out) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const int level = rollups_.findLevel(resolution_s);
+  if (level < 0) {
+    return false;
   }
+  rollups_.query(static_cast<size_t>(level), from_t, to_t, out);
+  return true;
+}
+
+std::vector<double> ReadinessAPIState::getRollupResolutions() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<double> resolutions;
+  for (size_t i = 0; i < rollups_.levelCount(); ++i) {
+    resolutions.push_back(rollups_.resolution(i));
+  }
+  return resolutions;
+}
+
+DwellState ReadinessAPIState::getDwellState() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return transitions_.dwell();
+}
+
+uint64_t ReadinessAPIState::getTransitionCount(double window_s) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return transitions_.transitionsSince(transitions_.dwell().now_t_s - window_s);
+}
+
+std::vector<GateRun> ReadinessAPIState::getTransitions(double from_t, double to_t, size_t max_count) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<GateRun> runs;
+  transitions_.runs(from_t, to_t, max_count, runs);
+  return runs;
+}
+
+ReadinessMetrics& ReadinessAPIState::metrics() {
+  return metrics_;
+}
+
+const ReadinessMetrics& ReadinessAPIState::metrics() const {
+  return metrics_;
+}
+
+uint64_t ReadinessAPIState::getSequence() const {
+  return sequence_.load(std::memory_order_acquire);
+}
+
+void ReadinessAPIState::setMaxHistorySize(size_t size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Keeps the newest samples that still fit
+  config_.max_history_size = std::max(size, size_t(1));
+  history_.setCapacity(config_.max_history_size);
+}
+
+void ReadinessAPIState::setCompressedHistory(const CompressedHistoryConfig& config) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  config_.compressed_history = config;
+  compressed_history_ = CompressedHistory(config);
+}
+
+void ReadinessAPIState::setRollupLevels(const std::vector<RollupLevelConfig>& levels) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  config_.rollup_levels = levels;
+  rollups_ = RollupHistory(levels);
+}
+
+void ReadinessAPIState::setTransitionLogSize(size_t max_runs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  config_.transition_log_size = max_runs;
+  transitions_ = TransitionLog(max_runs);
+}
+
+void ReadinessAPIState::setQuantileWindows(const std::vector<QuantileWindowConfig>& windows) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  config_.quantile_windows = windows;
+  quantiles_ = WindowedQuantiles(3, windows);
+}
+
+ReadinessStateConfig ReadinessAPIState::configuration() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return config_;
+}
+
+void ReadinessAPIState::configure(const ReadinessStateConfig& config) {
+  setMaxHistorySize(config.max_history_size);
+  setCompressedHistory(config.compressed_history);
+  setRollupLevels(config.rollup_levels);
+  setTransitionLogSize(config.transition_log_size);
+  setQuantileWindows(config.quantile_windows);
 }
 
 // -----------------------------------------------------------------------------
@@ -100,6 +382,9 @@ RestAPIServer::RestAPIServer(ReadinessAPIState& state, RestAPIConfig config)
     , running_(false)
     , should_stop_(false)
     , server_socket_(-1)
+    , etag_salt_(static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()))
+    , metrics_(endpointPaths())
+    , channels_(nullptr)
 {}
 
 RestAPIServer::~RestAPIServer() {
@@ -188,6 +473,24 @@ bool RestAPIServer::isRunning() const {
   return running_.load();
 }
 
+std::string RestAPIServer::renderBody(const std::string& target, int* status_code) {
+  HttpRequest request;
+  request.method = "GET";
+  request.version = "HTTP/1.1";
+  const size_t query_pos = target.find('?');
+  request.path = target.substr(0, query_pos);
+  if (query_pos != std::string::npos) {
+    request.query = target.substr(query_pos + 1);
+  }
+  
+  int status = 200;
+  std::string status_text = "OK";
+  std::string content_type = "application/json";
+  std::string body = renderEndpoint(request, status, status_text, content_type);
+  if (status_code) *status_code = status;
+  return body;
+}
+
 void RestAPIServer::serverLoop() {
   running_.store(true);
   
@@ -225,65 +528,242 @@ void RestAPIServer::handleClient(int client_socket) {
   buffer[bytes_read] = '\0';
   std::string request(buffer);
   
-  // Parse HTTP request
+  const auto start = std::chrono::steady_clock::now();
   HttpRequest parsed;
+  int status_code = 200;
+  std::string response = buildResponse(request, parsed, status_code);
+  sendAll(client_socket, response);
+  
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  // Channel routes share one label per endpoint: /api/channels/{id}/<endpoint>
+  size_t channel_id = 0;
+  std::string channel_endpoint;
+  const std::string label = parseChannelPath(parsed.path, channel_id, channel_endpoint)
+      ? "/api/channels/{id}/" + channel_endpoint : parsed.path;
+  metrics_.recordRequest(metrics_.endpointIndex(label), status_code,
+                         static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+}
+
+std::string RestAPIServer::buildResponse(const std::string& request, HttpRequest& parsed, int& status_code) {
+  // Parse HTTP request
   if (!parseRequest(request, parsed)) {
-    std::string response = makeHttpResponse(400, "Bad Request", 
-                                           makeJsonError(400, "Invalid HTTP request"),
-                                           "application/json");
-    sendAll(client_socket, response);
-    return;
+    status_code = 400;
+    return makeHttpResponse(400, "Bad Request",
+                            makeJsonError(400, "Invalid HTTP request"),
+                            "application/json");
   }
   
   // Enforce max path length (414 URI Too Long)
   if (parsed.path.length() > 256) {
-    std::string response = makeHttpResponse(414, "URI Too Long",
-                                           makeJsonError(414, "URI too long"),
-                                           "application/json");
-    sendAll(client_socket, response);
-    return;
+    status_code = 414;
+    return makeHttpResponse(414, "URI Too Long",
+                            makeJsonError(414, "URI too long"),
+                            "application/json");
   }
   
   // Only allow GET requests
   if (parsed.method != "GET") {
-    std::string response = makeHttpResponse(405, "Method Not Allowed",
-                                           makeJsonError(405, "Only GET requests are allowed"),
-                                           "application/json");
-    sendAll(client_socket, response);
-    return;
+    status_code = 405;
+    return makeHttpResponse(405, "Method Not Allowed",
+                            makeJsonError(405, "Only GET requests are allowed"),
+                            "application/json");
+  }
+  
+  const std::string target = parsed.query.empty() ? parsed.path : parsed.path + "?" + parsed.query;
+  const ContentEncoding encoding = config_.enable_compression
+      ? negotiateEncoding(parsed.accept_encoding) : ContentEncoding::IDENTITY;
+  const char* encoding_name = encoding == ContentEncoding::GZIP ? "gzip" : "deflate";
+  std::string extra_headers = config_.enable_compression ? "Vary: Accept-Encoding\r\n" : "";
+  
+  // The sequence is sampled before rendering, so a body may be newer than its
+  // tag but never older; a stale tag only costs the client one extra 200.
+  const ReadinessAPIState* versioned_state = stateForPath(parsed.path);
+  const bool versioned = versioned_state && isSequenceVersioned(parsed.path);
+  const uint64_t sequence = versioned_state ? versioned_state->getSequence() : 0;
+  const std::string etag = versioned ? makeETag(target, sequence) : std::string();
+  
+  // Conditional request: nothing changed since the client's copy, skip rendering
+  if (versioned && !parsed.if_none_match.empty() && etagMatches(parsed.if_none_match, etag)) {
+    status_code = 304;
+    return makeHttpResponse(304, "Not Modified", "", "application/json", extra_headers, etag);
+  }
+  
+  // Serve a cached compressed body if the state has not changed since it was built
+  if (versioned && encoding != ContentEncoding::IDENTITY) {
+    for (const auto& cached : compressed_cache_) {
+      if (cached.sequence == sequence && cached.encoding == encoding && cached.target == target) {
+        extra_headers += std::string("Content-Encoding: ") + encoding_name + "\r\n";
+        return makeHttpResponse(200, "OK", cached.body, "application/json", extra_headers, etag);
+      }
+    }
   }
   
-  // Route to appropriate handler
-  std::string body;
-  int status_code = 200;
   std::string status_text = "OK";
+  std::string content_type = "application/json";
+  std::string body = renderEndpoint(parsed, status_code, status_text, content_type);
+  
+  // Compress on this (server) thread only; the readiness loop never pays for it
+  if (encoding != ContentEncoding::IDENTITY && status_code == 200 &&
+      body.size() >= config_.compression_min_bytes) {
+    std::string compressed;
+    if (compressBody(body, encoding, compressed)) {
+      // Cache only if no update raced with rendering, so the key matches the body
+      if (versioned && versioned_state->getSequence() == sequence) {
+        auto it = compressed_cache_.begin();
+        for (; it != compressed_cache_.end(); ++it) {
+          if (it->encoding == encoding && it->target == target) break;
+        }
+        if (it == compressed_cache_.end()) {
+          if (compressed_cache_.size() >= kMaxCompressedCacheEntries) {
+            compressed_cache_.erase(compressed_cache_.begin());
+          }
+          compressed_cache_.push_back(CompressedBody{target, encoding, sequence, compressed});
+        } else {
+          it->sequence = sequence;
+          it->body = compressed;
+        }
+      }
+      body.swap(compressed);
+      extra_headers += std::string("Content-Encoding: ") + encoding_name + "\r\n";
+    }
+  }
+  
+  return makeHttpResponse(status_code, status_text, body, content_type, extra_headers,
+                          status_code == 200 ? etag : std::string());
+}
+
+const std::vector<std::string>& RestAPIServer::endpointPaths() {
+  static const std::vector<std::string> paths = {
+    "/health",
+    "/api/readiness",
+    "/api/thermal",
+    "/api/history",
+    "/api/history/rollup",
+    "/api/stats",
+    "/api/transitions",
+    "/api/phase_context",
+    "/api/diagnostics",
+    "/api/channels",
+    "/api/channels/top",
+    "/api/channels/{id}/readiness",
+    "/api/channels/{id}/thermal",
+    "/api/channels/{id}/history",
+    "/api/channels/{id}/diagnostics",
+    "/api/summary",
+    "/metrics",
+  };
+  return paths;
+}
+
+bool RestAPIServer::isSequenceVersioned(const std::string& path) const {
+  // /metrics also counts server activity, so it changes between state
+  // updates; the /api/channels listings and /api/summary span every
+  // channel, which share no sequence. With instrumentation, diagnostics
+  // embed the process-wide latency percentiles, which move with every
+  // evaluate() and every channel's update(), not with this sequence.
+  if (path == "/metrics" || path == "/api/channels" || path == "/api/channels/top" ||
+      path == "/api/summary" || (path == "/api/diagnostics" && instrumentationEnabled())) {
+    return false;
+  }
+  size_t id = 0;
+  std::string endpoint;
+  if (parseChannelPath(path, id, endpoint)) {
+    if (endpoint == "diagnostics" && instrumentationEnabled()) return false;
+    for (const char* e : kChannelEndpoints) {
+      if (endpoint == e) return true;
+    }
+    return false;
+  }
+  for (const auto& p : endpointPaths()) {
+    if (p == path) return true;
+  }
+  return false;
+}
+
+const ReadinessAPIState* RestAPIServer::stateForPath(const std::string& path) const {
+  size_t id = 0;
+  std::string endpoint;
+  if (parseChannelPath(path, id, endpoint)) {
+    return channels_ ? channels_->channel(id) : nullptr;
+  }
+  return &state_;
+}
+
+std::string RestAPIServer::makeETag(const std::string& target, uint64_t sequence) const {
+  // FNV-1a over the request target distinguishes endpoints and projections
+  uint64_t hash = 1469598103934665603ull ^ etag_salt_;
+  for (unsigned char c : target) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  char buf[64];
+  std::snprintf(buf, sizeof(buf), "W/\"%llx-%016llx\"",
+                static_cast<unsigned long long>(sequence),
+                static_cast<unsigned long long>(hash));
+  return buf;
+}
+
+bool RestAPIServer::etagMatches(const std::string& if_none_match, const std::string& etag) {
+  // Weak comparison (RFC 9110 Section 13.1.2): ignore W/ prefixes
+  auto opaque = [](std::string tag) {
+    tag = trim(tag);
+    if (tag.compare(0, 2, "W/") == 0) tag = tag.substr(2);
+    return tag;
+  };
+  const std::string wanted = opaque(etag);
   
+  std::istringstream iss(if_none_match);
+  std::string candidate;
+  while (std::getline(iss, candidate, ',')) {
+    candidate = trim(candidate);
+    if (candidate == "*" || opaque(candidate) == wanted) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string RestAPIServer::renderEndpoint(const HttpRequest& request, int& status_code,
+                                          std::string& status_text, std::string& content_type) {
   try {
-    if (parsed.path == "/health") {
-      body = handleHealth();
-    } else if (parsed.path == "/api/readiness") {
-      body = handleReadiness();
-    } else if (parsed.path == "/api/thermal") {
-      body = handleThermal();
-    } else if (parsed.path == "/api/history") {
-      body = handleHistory();
-    } else if (parsed.path == "/api/phase_context") {
-      body = handlePhaseContext();
-    } else if (parsed.path == "/api/diagnostics") {
-      body = handleDiagnostics();
-    } else {
-      status_code = 404;
-      status_text = "Not Found";
-      body = makeJsonError(404, "Endpoint not found");
+    if (request.path == "/health") {
+      return handleHealth();
+    } else if (request.path == "/api/readiness") {
+      return handleReadiness(state_);
+    } else if (request.path == "/api/thermal") {
+      return handleThermal(state_);
+    } else if (request.path == "/api/history") {
+      return handleHistory(state_, request.query, status_code, status_text);
+    } else if (request.path == "/api/history/rollup") {
+      return handleHistoryRollup(request.query, status_code, status_text);
+    } else if (request.path == "/api/stats") {
+      return handleStats(request.query, status_code, status_text);
+    } else if (request.path == "/api/transitions") {
+      return handleTransitions(request.query, status_code, status_text);
+    } else if (request.path == "/api/phase_context") {
+      return handlePhaseContext();
+    } else if (request.path == "/api/diagnostics") {
+      return handleDiagnostics(state_);
+    } else if (request.path == "/api/channels") {
+      return handleChannels();
+    } else if (request.path == "/api/channels/top") {
+      return handleChannelsTop(request.query, status_code, status_text);
+    } else if (request.path == "/api/summary") {
+      return handleSummary(request.query, status_code, status_text);
+    } else if (request.path.compare(0, 14, "/api/channels/") == 0) {
+      return handleChannelEndpoint(request, status_code, status_text);
+    } else if (request.path == "/metrics") {
+      content_type = "text/plain; version=0.0.4";
+      return handleMetrics();
     }
+    status_code = 404;
+    status_text = "Not Found";
+    return makeJsonError(404, "Endpoint not found");
   } catch (const std::exception& e) {
     status_code = 500;
     status_text = "Internal Server Error";
-    body = makeJsonError(500, std::string("Internal error: ") + e.what());
+    return makeJsonError(500, std::string("Internal error: ") + e.what());
   }
-  
-  std::string response = makeHttpResponse(status_code, status_text, body, "application/json");
-  sendAll(client_socket, response);
 }
 
 bool RestAPIServer::parseRequest(const std::string& request, HttpRequest& parsed) {
@@ -309,15 +789,103 @@ bool RestAPIServer::parseRequest(const std::string& request, HttpRequest& parsed
     return false;
   }
   
-  // Strip query string
+  // Split off query string
   size_t query_pos = parsed.path.find('?');
   if (query_pos != std::string::npos) {
+    parsed.query = parsed.path.substr(query_pos + 1);
     parsed.path = parsed.path.substr(0, query_pos);
   }
   
+  // Headers (only those the server acts on are kept)
+  while (std::getline(iss, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty()) {
+      break;
+    }
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    const std::string name = toLower(trim(line.substr(0, colon)));
+    if (name == "accept-encoding") {
+      parsed.accept_encoding = trim(line.substr(colon + 1));
+    } else if (name == "if-none-match") {
+      parsed.if_none_match = trim(line.substr(colon + 1));
+    }
+  }
+  
   return true;
 }
 
+RestAPIServer::ContentEncoding RestAPIServer::negotiateEncoding(const std::string& accept_encoding) {
+#ifdef HLV_WITH_ZLIB
+  double gzip_q = -1.0;
+  double deflate_q = -1.0;
+  double wildcard_q = -1.0;
+  
+  std::istringstream iss(accept_encoding);
+  std::string item;
+  while (std::getline(iss, item, ',')) {
+    double q = 1.0;
+    size_t semi = item.find(';');
+    const std::string coding = toLower(trim(item.substr(0, semi)));
+    if (semi != std::string::npos) {
+      const std::string params = toLower(trim(item.substr(semi + 1)));
+      if (params.compare(0, 2, "q=") == 0) {
+        q = std::strtod(params.c_str() + 2, nullptr);
+      }
+    }
+    if (coding == "gzip" || coding == "x-gzip") gzip_q = q;
+    else if (coding == "deflate") deflate_q = q;
+    else if (coding == "*") wildcard_q = q;
+  }
+  
+  // Codings not listed explicitly inherit the wildcard weight
+  if (gzip_q < 0.0) gzip_q = wildcard_q;
+  if (deflate_q < 0.0) deflate_q = wildcard_q;
+  
+  if (gzip_q > 0.0 && gzip_q >= deflate_q) return ContentEncoding::GZIP;
+  if (deflate_q > 0.0) return ContentEncoding::DEFLATE;
+#else
+  (void)accept_encoding;
+#endif
+  return ContentEncoding::IDENTITY;
+}
+
+bool RestAPIServer::compressBody(const std::string& body, ContentEncoding encoding, std::string& out) {
+#ifdef HLV_WITH_ZLIB
+  if (encoding == ContentEncoding::IDENTITY) {
+    return false;
+  }
+  
+  // gzip wrapper for "gzip", zlib wrapper for "deflate" (RFC 9110 Section 8.4.1)
+  const int window_bits = (encoding == ContentEncoding::GZIP) ? 15 + 16 : 15;
+  z_stream zs;
+  std::memset(&zs, 0, sizeof(zs));
+  if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+  
+  out.resize(deflateBound(&zs, static_cast<uLong>(body.size())) + 32);
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+  zs.avail_in = static_cast<uInt>(body.size());
+  zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+  zs.avail_out = static_cast<uInt>(out.size());
+  
+  const int rc = deflate(&zs, Z_FINISH);
+  out.resize(zs.total_out);
+  deflateEnd(&zs);
+  return rc == Z_STREAM_END;
+#else
+  (void)body;
+  (void)encoding;
+  (void)out;
+  return false;
+#endif
+}
+
 std::string RestAPIServer::handleHealth() {
   std::ostringstream json;
   json << "{\n";
@@ -328,8 +896,8 @@ std::string RestAPIServer::handleHealth() {
   return json.str();
 }
 
-std::string RestAPIServer::handleReadiness() {
-  auto snapshot = state_.getCurrentSnapshot();
+std::string RestAPIServer::handleReadiness(const ReadinessAPIState& state) {
+  auto snapshot = state.getCurrentSnapshot();
   
   std::ostringstream json;
   json << std::fixed << std::setprecision(6);
@@ -343,8 +911,8 @@ std::string RestAPIServer::handleReadiness() {
   return json.str();
 }
 
-std::string RestAPIServer::handleThermal() {
-  auto snapshot = state_.getCurrentSnapshot();
+std::string RestAPIServer::handleThermal(const ReadinessAPIState& state) {
+  auto snapshot = state.getCurrentSnapshot();
   
   std::ostringstream json;
   json << std::fixed << std::setprecision(6);
@@ -358,8 +926,44 @@ std::string RestAPIServer::handleThermal() {
   return json.str();
 }
 
-std::string RestAPIServer::handleHistory() {
-  auto history = state_.getHistory(100); // Last 100 samples
+std::string RestAPIServer::handleHistory(const ReadinessAPIState& state, const std::string& query,
+                                         int& status_code, std::string& status_text) {
+  // Optional time window and sample filter:
+  // /api/history?from_t=<s>&to_t=<s>&flags_all=<flags>&flags_none=<flags>&gate=<gates>
+  std::string from_param;
+  std::string to_param;
+  const bool has_from = queryParam(query, "from_t", from_param);
+  const bool has_to = queryParam(query, "to_t", to_param);
+  
+  double from_t = -std::numeric_limits<double>::infinity();
+  double to_t = std::numeric_limits<double>::infinity();
+  if ((has_from && !parseDouble(from_param, from_t)) || (has_to && !parseDouble(to_param, to_t)) ||
+      from_t > to_t) {
+    status_code = 400;
+    status_text = "Bad Request";
+    return makeJsonError(400, "Invalid from_t/to_t");
+  }
+  
+  HistoryFilter filter;
+  std::string param;
+  if ((queryParam(query, "flags_all", param) && !parseFlags(param, filter.flags_all)) ||
+      (queryParam(query, "flags_none", param) && !parseFlags(param, filter.flags_none))) {
+    status_code = 400;
+    status_text = "Bad Request";
+    return makeJsonError(400, "Invalid flags_all/flags_none");
+  }
+  if (queryParam(query, "gate", param) && !parseGates(param, filter.gate_mask)) {
+    status_code = 400;
+    status_text = "Bad Request";
+    return makeJsonError(400, "Invalid gate");
+  }
+  
+  std::vector<ReadinessSnapshot> history;
+  if (has_from || has_to || filter.active()) {
+    history = state.getHistoryRange(from_t, to_t, config_.history_max_samples, filter);
+  } else {
+    history = state.getHistory(config_.history_max_samples);
+  }
   
   std::ostringstream json;
   json << std::fixed << std::setprecision(6);
@@ -393,8 +997,248 @@ std::string RestAPIServer::handleHistory() {
   return json.str();
 }
 
+std::string RestAPIServer::handleHistoryRollup(const std::string& query, int& status_code,
+                                               std::string& status_text) {
+  // /api/history/rollup?resolution=10s[&from_t=<s>&to_t=<s>]
+  std::string param;
+  double resolution_s = 1.0;
+  if (queryParam(query, "resolution", param) && !parseDuration(param, resolution_s)) {
+    status_code = 400;
+    status_text = "Bad Request";
+    return makeJsonError(400, "Invalid resolution");
+  }
+  double from_t = -std::numeric_limits<double>::infinity();
+  double to_t = std::numeric_limits<double>::infinity();
+  if ((queryParam(query, "from_t", param) && !parseDouble(param, from_t)) ||
+      (queryParam(query, "to_t", param) && !parseDouble(param, to_t)) || from_t > to_t) {
+    status_code = 400;
+    status_text = "Bad Request";
+    return makeJsonError(400, "Invalid from_t/to_t");
+  }
+  
+  std::vector<RollupBucket> buckets;
+  if (!state_.getRollup(resolution_s, from_t, to_t, buckets)) {
+    std::ostringstream available;
+    for (double r : state_.getRollupResolutions()) {
+      available << (available.tellp() > 0 ? ", " : "") << r << "s";
+    }
+    status_code = 400;
+    status_text = "Bad Request";
+    return makeJsonError(400, "No rollup at this resolution (available: " + available.str() + ")");
+  }
+  
+  std::ostringstream json;
+  json << std::fixed << std::setprecision(6);
+  json << "{\n";
+  json << "  \"resolution_s\": " << resolution_s << ",\n";
+  json << "  \"count\": " << buckets.size() << ",\n";
+  json << "  \"buckets\": [\n";
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    const RollupBucket& b = buckets[i];
+    json << "    {\n";
+    json << "      \"start_s\": " << b.start_t_s << ",\n";
+    json << "      \"end_s\": " << b.end_t_s << ",\n";
+    json << "      \"samples\": " << b.samples << ",\n";
+    json << "      \"readiness_min\": " << b.readiness_min << ",\n";
+    json << "      \"readiness_max\": " << b.readiness_max << ",\n";
+    json << "      \"readiness_mean\": " << b.readinessMean() << ",\n";
+    json << "      \"dwell\": {\"ALLOW\": " << b.dwellFraction(Gate::ALLOW)
+         << ", \"CAUTION\": " << b.dwellFraction(Gate::CAUTION)
+         << ", \"BLOCK\": " << b.dwellFraction(Gate::BLOCK) << "},\n";
+    json << "      \"flags\": " << b.flags_union << ",\n";
+    json << "      \"partial\": " << (b.partial ? "true" : "false") << "\n";
+    json << "    }" << (i + 1 < buckets.size() ? "," : "") << "\n";
+  }
+  json << "  ]\n";
+  json << "}";
+  return json.str();
+}
+
+std::string RestAPIServer::handleStats(const std::string& query, int& status_code, std::string& status_text) {
+  // /api/stats[?from_t=<s>&to_t=<s>] aggregates the in-memory history
+  std::string param;
+  double from_t = -std::numeric_limits<double>::infinity();
+  double to_t = std::numeric_limits<double>::infinity();
+  if ((queryParam(query, "from_t", param) && !parseDouble(param, from_t)) ||
+      (queryParam(query, "to_t", param) && !parseDouble(param, to_t)) || from_t > to_t) {
+    status_code = 400;
+    status_text = "Bad Request";
+    return makeJsonError(400, "Invalid from_t/to_t");
+  }
+  
+  // Quantile windows to report: all, or the one named by ?window=
+  const WindowedQuantiles quantiles = state_.getQuantiles();
+  size_t first_window = 0;
+  size_t end_window = quantiles.windowCount();
+  if (queryParam(query, "window", param)) {
+    double window_s = 0.0;
+    const int index = parseDuration(param, window_s) ? quantiles.findWindow(window_s) : -1;
+    if (index < 0) {
+      std::ostringstream available;
+      for (size_t w = 0; w < quantiles.windowCount(); ++w) {
+        available << (w ? ", " : "") << quantiles.windowSeconds(w) << "s";
+      }
+      status_code = 400;
+      status_text = "Bad Request";
+      return makeJsonError(400, "No quantile window of this length (available: " + available.str() + ")");
+    }
+    first_window = static_cast<size_t>(index);
+    end_window = first_window + 1;
+  }
+  
+  const HistoryStats stats = state_.getHistoryStats(from_t, to_t);
+  const double n = static_cast<double>(stats.count);
+  // Empty windows and NaN-poisoned sums are reported as null
+  auto field = [&](const char* key, const FieldStats& f, bool with_max_abs) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(6);
+    auto value = [&](double v) {
+      if (stats.count > 0 && std::isfinite(v)) {
+        out << v;
+      } else {
+        out << "null";
+      }
+    };
+    out << "  \"" << key << "\": {\"min\": ";
+    value(f.min);
+    out << ", \"max\": ";
+    value(f.max);
+    out << ", \"mean\": ";
+    value(f.mean(stats.count));
+    if (with_max_abs) {
+      out << ", \"max_abs\": ";
+      value(f.max_abs);
+    }
+    out << "},\n";
+    return out.str();
+  };
+  
+  std::ostringstream json;
+  json << std::fixed << std::setprecision(6);
+  json << "{\n";
+  json << "  \"count\": " << stats.count << ",\n";
+  writeJsonDouble(json, "first_t_s", stats.count ? stats.first_t_s : std::numeric_limits<double>::quiet_NaN());
+  writeJsonDouble(json, "last_t_s", stats.count ? stats.last_t_s : std::numeric_limits<double>::quiet_NaN());
+  json << field("readiness", stats.readiness, false);
+  json << field("dTdt_C_per_s", stats.dTdt_C_per_s, true);
+  json << field("trend_C", stats.trend_C, false);
+  json << "  \"gates\": {\n";
+  const Gate gates[] = {Gate::ALLOW, Gate::CAUTION, Gate::BLOCK};
+  for (size_t i = 0; i < 3; ++i) {
+    const uint64_t samples = stats.gate_samples[static_cast<size_t>(gates[i])];
+    json << "    \"" << gateToString(gates[i]) << "\": {\"samples\": " << samples
+         << ", \"fraction\": " << (stats.count ? static_cast<double>(samples) / n : 0.0) << "}"
+         << (i + 1 < 3 ? "," : "") << "\n";
+  }
+  json << "  },\n";
+  json << "  \"flag_samples\": {\n";
+  for (size_t i = 0; i < kPhaseFlagCount; ++i) {
+    const PhaseFlagName& f = kPhaseFlagNames[i];
+    json << "    \"" << f.name << "\": " << stats.flag_samples[__builtin_ctz(f.flag)]
+         << (i + 1 < kPhaseFlagCount ? ",\n" : "\n");
+  }
+  json << "  },\n";
+  
+  // Sliding-window quantiles (independent of from_t/to_t)
+  const char* const field_names[3] = {"readiness", "dTdt_C_per_s", "trend_C"};
+  json << "  \"quantiles\": [\n";
+  for (size_t w = first_window; w < end_window; ++w) {
+    json << "    {\"window_s\": " << quantiles.windowSeconds(w);
+    for (size_t f = 0; f < 3; ++f) {
+      const KllSketch sketch = quantiles.sketch(w, f);
+      if (f == 0) {
+        json << ", \"count\": " << sketch.count() << ", \"rank_error\": " << KllSketch::rankError(quantiles.k());
+      }
+      json << ", \"" << field_names[f] << "\": {";
+      const double levels[3] = {0.05, 0.5, 0.95};
+      const char* const level_names[3] = {"p5", "p50", "p95"};
+      for (size_t q = 0; q < 3; ++q) {
+        const double v = sketch.quantile(levels[q]);
+        json << (q ? ", " : "") << "\"" << level_names[q] << "\": ";
+        if (std::isfinite(v)) {
+          json << v;
+        } else {
+          json << "null";
+        }
+      }
+      json << "}";
+    }
+    json << "}" << (w + 1 < end_window ? "," : "") << "\n";
+  }
+  json << "  ]\n";
+  json << "}";
+  return json.str();
+}
+
+std::string RestAPIServer::handleTransitions(const std::string& query, int& status_code,
+                                             std::string& status_text) {
+  // /api/transitions[?from_t=<s>&to_t=<s>&window=<duration>]
+  std::string param;
+  double from_t = -std::numeric_limits<double>::infinity();
+  double to_t = std::numeric_limits<double>::infinity();
+  if ((queryParam(query, "from_t", param) && !parseDouble(param, from_t)) ||
+      (queryParam(query, "to_t", param) && !parseDouble(param, to_t)) || from_t > to_t) {
+    status_code = 400;
+    status_text = "Bad Request";
+    return makeJsonError(400, "Invalid from_t/to_t");
+  }
+  double window_s = config_.transition_window_s;
+  if (queryParam(query, "window", param) && !parseDuration(param, window_s)) {
+    status_code = 400;
+    status_text = "Bad Request";
+    return makeJsonError(400, "Invalid window");
+  }
+  
+  const DwellState dwell = state_.getDwellState();
+  const uint64_t in_window = state_.getTransitionCount(window_s);
+  const std::vector<GateRun> runs = state_.getTransitions(from_t, to_t, config_.history_max_samples);
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  
+  std::ostringstream json;
+  json << std::fixed << std::setprecision(6);
+  json << "{\n";
+  if (dwell.valid) {
+    json << "  \"gate\": \"" << gateToString(dwell.gate) << "\",\n";
+  } else {
+    json << "  \"gate\": null,\n";
+  }
+  json << "  \"flags\": " << dwell.flags << ",\n";
+  writeJsonDouble(json, "gate_dwell_s", dwell.valid ? dwell.gateDwell() : nan);
+  writeJsonDouble(json, "run_dwell_s", dwell.valid ? dwell.runDwell() : nan);
+  json << "  \"time_since_s\": {";
+  const Gate gates[] = {Gate::ALLOW, Gate::CAUTION, Gate::BLOCK};
+  for (size_t i = 0; i < 3; ++i) {
+    const double since = dwell.valid ? dwell.timeSince(gates[i]) : nan;
+    json << "\"" << gateToString(gates[i]) << "\": ";
+    if (std::isfinite(since)) {
+      json << since;
+    } else {
+      json << "null";
+    }
+    json << (i + 1 < 3 ? ", " : "");
+  }
+  json << "},\n";
+  json << "  \"transitions_total\": " << dwell.transitions << ",\n";
+  json << "  \"window_s\": " << window_s << ",\n";
+  json << "  \"transitions_in_window\": " << in_window << ",\n";
+  json << "  \"count\": " << runs.size() << ",\n";
+  json << "  \"runs\": [\n";
+  for (size_t i = 0; i < runs.size(); ++i) {
+    const GateRun& r = runs[i];
+    json << "    {\"start_s\": " << r.start_t_s << ", \"end_s\": " << r.end_t_s
+         << ", \"duration_s\": " << (r.end_t_s - r.start_t_s)
+         << ", \"gate\": \"" << gateToString(r.gate) << "\", \"flags\": " << r.flags
+         << ", \"samples\": " << r.samples << "}" << (i + 1 < runs.size() ? "," : "") << "\n";
+  }
+  json << "  ]\n";
+  json << "}";
+  return json.str();
+}
+
 std::string RestAPIServer::handlePhaseContext() {
   auto snapshot = state_.getCurrentSnapshot();
+  const DwellState dwell = state_.getDwellState();
+  const double nan = std::numeric_limits<double>::quiet_NaN();
   
   std::ostringstream json;
   json << std::fixed << std::setprecision(6);
@@ -403,46 +1247,282 @@ std::string RestAPIServer::handlePhaseContext() {
   writeJsonDouble(json, "coherence_index", snapshot.coherence_index);
   writeJsonDouble(json, "gradient_persistence", snapshot.trend_C);
   json << "  \"gate\": \"" << gateToString(snapshot.gate) << "\",\n";
+  writeJsonDouble(json, "gate_dwell_s", dwell.valid ? dwell.gateDwell() : nan);
+  writeJsonDouble(json, "time_since_allow_s", dwell.valid ? dwell.timeSince(Gate::ALLOW) : nan);
+  writeJsonDouble(json, "transition_window_s", config_.transition_window_s);
+  json << "  \"transitions_in_window\": " << state_.getTransitionCount(config_.transition_window_s) << ",\n";
   writeJsonDouble(json, "timestamp_s", snapshot.t_s, false);
   json << "}";
   return json.str();
 }
 
-std::string RestAPIServer::handleDiagnostics() {
-  auto snapshot = state_.getCurrentSnapshot();
+std::string RestAPIServer::handleDiagnostics(const ReadinessAPIState& state) {
+  auto snapshot = state.getCurrentSnapshot();
   
   std::ostringstream json;
   json << std::fixed << std::setprecision(6);
   json << "{\n";
   json << "  \"flags\": " << snapshot.flags << ",\n";
   json << "  \"flag_meanings\": {\n";
-  json << "    \"input_invalid\": " << ((snapshot.flags & FLAG_INPUT_INVALID) ? "true" : "false") << ",\n";
-  json << "    \"stale_or_nonmono\": " << ((snapshot.flags & FLAG_STALE_OR_NONMONO) ? "true" : "false") << ",\n";
-  json << "    \"temp_out_of_range\": " << ((snapshot.flags & FLAG_TEMP_OUT_OF_RANGE) ? "true" : "false") << ",\n";
-  json << "    \"gradient_too_high\": " << ((snapshot.flags & FLAG_GRADIENT_TOO_HIGH) ? "true" : "false") << ",\n";
-  json << "    \"persistent_heating\": " << ((snapshot.flags & FLAG_PERSISTENT_HEATING) ? "true" : "false") << ",\n";
-  json << "    \"persistent_cooling\": " << ((snapshot.flags & FLAG_PERSISTENT_COOLING) ? "true" : "false") << ",\n";
-  json << "    \"hysteresis_high\": " << ((snapshot.flags & FLAG_HYSTERESIS_HIGH) ? "true" : "false") << ",\n";
-  json << "    \"coherence_low\": " << ((snapshot.flags & FLAG_COHERENCE_LOW) ? "true" : "false") << ",\n";
-  json << "    \"failsafe_default\": " << ((snapshot.flags & FLAG_FAILSAFE_DEFAULT) ? "true" : "false") << "\n";
+  for (size_t i = 0; i < kPhaseFlagCount; ++i) {
+    const PhaseFlagName& f = kPhaseFlagNames[i];
+    json << "    \"" << f.name << "\": " << ((snapshot.flags & f.flag) ? "true" : "false")
+         << (i + 1 < kPhaseFlagCount ? ",\n" : "\n");
+  }
   json << "  },\n";
   json << "  \"readiness\": " << snapshot.readiness << ",\n";
   json << "  \"gate\": \"" << gateToString(snapshot.gate) << "\",\n";
   json << "  \"stability_score\": " << snapshot.stability_score << ",\n";
-  json << "  \"timestamp_s\": " << snapshot.t_s << "\n";
+  json << "  \"timestamp_s\": " << snapshot.t_s << ",\n";
+  
+  // Compressed long-horizon history tier (all zero when disabled)
+  const CompressedHistoryStats history = state.getCompressedHistoryStats();
+  json << "  \"compressed_history\": {\n";
+  json << "    \"samples\": " << history.samples << ",\n";
+  json << "    \"blocks\": " << history.blocks << ",\n";
+  json << "    \"bytes\": " << history.bytes << ",\n";
+  json << "    \"bytes_per_sample\": " << history.bytes_per_sample << ",\n";
+  json << "    \"index_bytes\": " << history.index_bytes << "\n";
+  json << "  },\n";
+  
+  // Hot-path latency percentiles (HLV_ENABLE_INSTRUMENTATION builds only)
+  json << "  \"instrumentation\": {\n";
+  json << "    \"enabled\": " << (instrumentationEnabled() ? "true" : "false");
+  if (instrumentationEnabled()) {
+    const struct { const char* name; LatencyProbe probe; } probes[] = {
+      {"evaluate", LatencyProbe::EVALUATE},
+      {"api_update", LatencyProbe::API_UPDATE},
+      {"api_update_batch", LatencyProbe::API_UPDATE_BATCH},
+    };
+    for (const auto& p : probes) {
+      const LatencySummary summary = latencySummary(p.probe);
+      json << ",\n    \"" << p.name << "\": {\n";
+      json << "      \"count\": " << summary.count << ",\n";
+      json << "      \"p50_ns\": " << summary.p50_ns << ",\n";
+      json << "      \"p99_ns\": " << summary.p99_ns << ",\n";
+      json << "      \"p999_ns\": " << summary.p999_ns << ",\n";
+      json << "      \"max_ns\": " << summary.max_ns << "\n";
+      json << "    }";
+    }
+  }
+  json << "\n  }\n";
   json << "}";
   return json.str();
 }
 
+std::string RestAPIServer::handleChannels() {
+  if (!channels_) {
+    return "{\n  \"count\": 0,\n  \"epoch\": null,\n  \"channels\": []\n}";
+  }
+  // Producers using epochs get a consistent cut of the last committed tick;
+  // otherwise each channel is read at its own latest update
+  EpochSnapshot cut;
+  const bool consistent = channels_->committedEpoch() > 0 && channels_->snapshotEpoch(cut);
+  
+  std::ostringstream json;
+  json << std::fixed << std::setprecision(6);
+  json << "{\n";
+  json << "  \"count\": " << channels_->size() << ",\n";
+  if (consistent) {
+    json << "  \"epoch\": " << cut.epoch << ",\n";
+  } else {
+    json << "  \"epoch\": null,\n";
+  }
+  json << "  \"channels\": [";
+  for (size_t id = 0; id < channels_->size(); ++id) {
+    const ReadinessAPIState& state = *channels_->channel(id);
+    json << (id ? ",\n" : "\n");
+    json << "    {\"id\": " << id;
+    if (consistent && !cut.channels[id].reported) {
+      json << ", \"readiness\": null, \"gate\": null, \"flags\": null, \"timestamp_s\": null";
+    } else if (consistent) {
+      const EpochChannel& ch = cut.channels[id];
+      json << ", \"readiness\": " << ch.readiness
+           << ", \"gate\": \"" << gateToString(ch.gate) << "\""
+           << ", \"flags\": " << ch.flags
+           << ", \"timestamp_s\": " << ch.t_s;
+    } else {
+      const ReadinessSnapshot snapshot = state.getCurrentSnapshot();
+      json << ", \"readiness\": " << snapshot.readiness
+           << ", \"gate\": \"" << gateToString(snapshot.gate) << "\""
+           << ", \"flags\": " << snapshot.flags
+           << ", \"timestamp_s\": " << snapshot.t_s;
+    }
+    json << ", \"updates\": " << state.metrics().updatesTotal() << "}";
+  }
+  json << (channels_->size() ? "\n  ]\n" : "]\n");
+  json << "}";
+  return json.str();
+}
+
+std::string RestAPIServer::handleChannelsTop(const std::string& query, int& status_code,
+                                             std::string& status_text) {
+  size_t k = 20;
+  ChannelRankBy by = ChannelRankBy::READINESS;
+  std::string param;
+  bool valid = true;
+  if (queryParam(query, "k", param)) {
+    char* end = nullptr;
+    const unsigned long long v = std::strtoull(param.c_str(), &end, 10);
+    valid = !param.empty() && end == param.c_str() + param.size() && v > 0 && v <= 100000;
+    k = static_cast<size_t>(v);
+  }
+  if (queryParam(query, "by", param)) {
+    if (param == "readiness") {
+      by = ChannelRankBy::READINESS;
+    } else if (param == "block_dwell") {
+      by = ChannelRankBy::BLOCK_DWELL;
+    } else {
+      valid = false;
+    }
+  }
+  if (!valid) {
+    status_code = 400;
+    status_text = "Bad Request";
+    return makeJsonError(400, "Invalid k (1-100000) or by (readiness, block_dwell)");
+  }
+  
+  const std::vector<ChannelRank> ranks = channels_ ? channels_->worstChannels(k, by)
+                                                   : std::vector<ChannelRank>{};
+  std::ostringstream json;
+  json << std::fixed << std::setprecision(6);
+  json << "{\n";
+  json << "  \"by\": \"" << channelRankByToString(by) << "\",\n";
+  json << "  \"k\": " << k << ",\n";
+  json << "  \"count\": " << ranks.size() << ",\n";
+  json << "  \"channels\": [";
+  for (size_t i = 0; i < ranks.size(); ++i) {
+    const ChannelRank& r = ranks[i];
+    json << (i ? ",\n" : "\n");
+    json << "    {\"id\": " << r.id
+         << ", \"readiness\": " << r.readiness
+         << ", \"gate\": \"" << gateToString(r.gate) << "\""
+         << ", \"flags\": " << r.flags
+         << ", \"timestamp_s\": " << r.t_s
+         << ", \"block_dwell_s\": ";
+    if (std::isnan(r.block_dwell_s)) {
+      json << "null";
+    } else {
+      json << r.block_dwell_s;
+    }
+    json << "}";
+  }
+  json << (ranks.empty() ? "]\n" : "\n  ]\n");
+  json << "}";
+  return json.str();
+}
+
+std::string RestAPIServer::handleSummary(const std::string& query, int& status_code,
+                                         std::string& status_text) {
+  std::vector<ChannelGroup> groups = channels_ ? channels_->groups() : std::vector<ChannelGroup>{};
+  std::string group;
+  if (queryParam(query, "group", group)) {
+    auto it = std::find_if(groups.begin(), groups.end(),
+                           [&group](const ChannelGroup& g) { return g.name == group; });
+    if (it == groups.end()) {
+      status_code = 404;
+      status_text = "Not Found";
+      return makeJsonError(404, "Unknown channel group");
+    }
+    groups = {*it};
+  }
+  
+  std::ostringstream json;
+  json << std::fixed << std::setprecision(6);
+  json << "{\n";
+  json << "  \"channels_total\": " << (channels_ ? channels_->size() : 0) << ",\n";
+  json << "  \"array\": {";
+  writeGateSummary(json, channels_ ? channels_->summary() : GateSummary{});
+  json << "},\n";
+  json << "  \"groups\": [";
+  for (size_t i = 0; i < groups.size(); ++i) {
+    const ChannelGroup& g = groups[i];
+    json << (i ? ",\n" : "\n");
+    json << "    {\"name\": \"" << jsonEscape(g.name) << "\", \"first\": " << g.first
+         << ", \"count\": " << g.count << ", ";
+    writeGateSummary(json, channels_->summary(g.first, g.count));
+    json << "}";
+  }
+  json << (groups.empty() ? "]\n" : "\n  ]\n");
+  json << "}";
+  return json.str();
+}
+
+std::string RestAPIServer::handleChannelEndpoint(const HttpRequest& request, int& status_code,
+                                                 std::string& status_text) {
+  size_t id = 0;
+  std::string endpoint;
+  if (!parseChannelPath(request.path, id, endpoint)) {
+    status_code = 404;
+    status_text = "Not Found";
+    return makeJsonError(404, "Endpoint not found");
+  }
+  const ReadinessAPIState* state = channels_ ? channels_->channel(id) : nullptr;
+  if (!state) {
+    status_code = 404;
+    status_text = "Not Found";
+    return makeJsonError(404, "Unknown channel");
+  }
+  if (endpoint == "readiness") {
+    return handleReadiness(*state);
+  } else if (endpoint == "thermal") {
+    return handleThermal(*state);
+  } else if (endpoint == "history") {
+    return handleHistory(*state, request.query, status_code, status_text);
+  } else if (endpoint == "diagnostics") {
+    return handleDiagnostics(*state);
+  }
+  status_code = 404;
+  status_text = "Not Found";
+  return makeJsonError(404, "Endpoint not found");
+}
+
+std::string RestAPIServer::handleMetrics() {
+  auto snapshot = state_.getCurrentSnapshot();
+  
+  std::ostringstream out;
+  out << "# HELP hlv_readiness Current readiness score.\n";
+  out << "# TYPE hlv_readiness gauge\n";
+  out << "hlv_readiness " << snapshot.readiness << "\n";
+  out << "# HELP hlv_gate Current gate (0=BLOCK, 1=CAUTION, 2=ALLOW).\n";
+  out << "# TYPE hlv_gate gauge\n";
+  out << "hlv_gate " << static_cast<int>(snapshot.gate) << "\n";
+  state_.metrics().render(out);
+  metrics_.render(out);
+  if (metrics_hook_) {
+    metrics_hook_(out);
+  }
+  return out.str();
+}
+
+void RestAPIServer::setMetricsHook(std::function<void(std::ostream&)> hook) {
+  metrics_hook_ = std::move(hook);
+}
+
+void RestAPIServer::setChannelRegistry(const ChannelRegistry* registry) {
+  channels_ = registry;
+}
+
 std::string RestAPIServer::makeHttpResponse(int status_code, const std::string& status_text,
-                                            const std::string& body, const std::string& content_type) {
+                                            const std::string& body, const std::string& content_type,
+                                            const std::string& extra_headers,
+                                            const std::string& etag) {
   std::ostringstream response;
   response << "HTTP/1.1 " << status_code << " " << status_text << "\r\n";
-  response << "Content-Type: " << content_type << "\r\n";
-  response << "Content-Length: " << body.length() << "\r\n";
+  if (status_code != 304) {
+    response << "Content-Type: " << content_type << "\r\n";
+    response << "Content-Length: " << body.length() << "\r\n";
+  }
   response << "Connection: close\r\n";
   response << "X-Content-Type-Options: nosniff\r\n";
-  response << "Cache-Control: no-store\r\n";
+  if (etag.empty()) {
+    response << "Cache-Control: no-store\r\n";
+  } else {
+    // Clients may keep the body but must revalidate it on every poll
+    response << "Cache-Control: no-cache\r\n";
+    response << "ETag: " << etag << "\r\n";
+  }
+  response << extra_headers;
   response << "\r\n";
   response << body;
   return response.str();
@@ -459,6 +1539,21 @@ std::string RestAPIServer::makeJsonError(int code, const std::string& message) {
   return json.str();
 }
 
+bool RestAPIServer::queryParam(const std::string& query, const char* key, std::string& value) {
+  const size_t key_len = std::strlen(key);
+  size_t pos = 0;
+  while (pos <= query.size()) {
+    size_t end = query.find('&', pos);
+    if (end == std::string::npos) end = query.size();
+    if (end - pos > key_len && query.compare(pos, key_len, key) == 0 && query[pos + key_len] == '=') {
+      value = query.substr(pos + key_len + 1, end - pos - key_len - 1);
+      return true;
+    }
+    pos = end + 1;
+  }
+  return false;
+}
+
 std::string RestAPIServer::jsonEscape(const std::string& s) {
   std::string result;
   result.reserve(s.size());
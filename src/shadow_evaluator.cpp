@@ -0,0 +1,206 @@
+#include "hlv/shadow_evaluator.hpp"
+
+#include <cmath>
+#include <new>
+#include <vector>
+
+namespace hlv {
+
+namespace {
+
+// Single-writer counter increment: plain load/store keeps the hot path
+// free of locked read-modify-write instructions
+inline void bump(std::atomic<uint64_t>& counter) {
+  counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+bool validShadowName(const std::string& name) {
+  if (name.empty()) return false;
+  for (char c : name) {
+    const bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                    c == '_' || c == '.' || c == '-';
+    if (!ok) return false;
+  }
+  return true;
+}
+
+} // namespace
+
+ShadowEvaluator::ShadowEvaluator(const PhaseReadinessConfig& primary)
+    : primary_(CompiledPolicy::compile(primary))
+    , primary_output_()
+    , track_count_(1)
+    , shadows_(new Shadow[kMaxShadows])
+    , shadow_count_(0)
+{
+  track_policies_[0] = &primary_;
+  resetStats();
+}
+
+bool ShadowEvaluator::addShadow(const std::string& name, const PhaseReadinessConfig& config) {
+  const size_t count = shadow_count_.load(std::memory_order_relaxed);
+  if (count >= kMaxShadows || !validShadowName(name)) {
+    return false;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (shadows_[i].name == name) return false;
+  }
+  Shadow& shadow = shadows_[count];
+  shadow.name = name;
+  shadow.policy = CompiledPolicy::compile(config);
+  shadow.output = PhaseReadinessOutput{};
+  shadow.track = track_count_;
+  for (size_t t = 0; t < track_count_; ++t) {
+    if (track_policies_[t]->sameDynamics(shadow.policy)) {
+      shadow.track = t;
+      break;
+    }
+  }
+  shadow.regate_from = nullptr;
+  if (primary_.sameReadiness(shadow.policy)) {
+    shadow.regate_from = &primary_output_;
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      if (shadows_[i].policy.sameReadiness(shadow.policy)) {
+        shadow.regate_from = &shadows_[i].output;
+        break;
+      }
+    }
+  }
+  if (shadow.track == track_count_) {
+    track_policies_[track_count_] = &shadow.policy;
+    tracks_[track_count_] = TrendState();
+    ++track_count_;
+  }
+  shadow_count_.store(count + 1, std::memory_order_release);
+  return true;
+}
+
+PhaseReadinessOutput ShadowEvaluator::evaluate(const PhaseSignals& in) {
+  // Results are constructed in place: assigning a returned struct copies
+  // it from a temporary with wide loads over narrow stores, which stalls
+  // store forwarding on every call
+  for (size_t t = 0; t < track_count_; ++t) {
+    new (&steps_[t]) TrendStep(PhaseReadinessMiddleware::advance(*track_policies_[t], tracks_[t], in));
+  }
+  new (&primary_output_) PhaseReadinessOutput(PhaseReadinessMiddleware::decide(primary_, in, steps_[0]));
+
+  const size_t count = shadow_count_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < count; ++i) {
+    Shadow& shadow = shadows_[i];
+    if (shadow.regate_from != nullptr) {
+      PhaseReadinessMiddleware::regate(shadow.policy, *shadow.regate_from, shadow.output);
+    } else {
+      new (&shadow.output)
+          PhaseReadinessOutput(PhaseReadinessMiddleware::decide(shadow.policy, in, steps_[shadow.track]));
+    }
+    record(shadow, primary_output_, in.t_s);
+  }
+  return primary_output_;
+}
+
+size_t ShadowEvaluator::decideCount() const {
+  size_t n = 0;
+  for (size_t i = 0; i < shadow_count_.load(std::memory_order_relaxed); ++i) {
+    if (shadows_[i].regate_from == nullptr) ++n;
+  }
+  return n;
+}
+
+void ShadowEvaluator::record(Shadow& shadow, const PhaseReadinessOutput& primary, double t_s) {
+  const PhaseReadinessOutput& out = shadow.output;
+  bump(shadow.confusion[static_cast<size_t>(primary.gate)][static_cast<size_t>(out.gate)]);
+  const double delta = std::fabs(out.readiness - primary.readiness);
+  if (delta > shadow.max_abs_readiness_delta.load(std::memory_order_relaxed)) {
+    shadow.max_abs_readiness_delta.store(delta, std::memory_order_relaxed);
+  }
+  if (out.gate == primary.gate) {
+    return;
+  }
+  bump(shadow.disagreements);
+  if (!shadow.diverged.load(std::memory_order_relaxed)) {
+    shadow.first_divergence_t_s.store(t_s, std::memory_order_relaxed);
+    shadow.diverged.store(true, std::memory_order_release);
+  }
+  shadow.last_divergence_t_s.store(t_s, std::memory_order_relaxed);
+}
+
+ShadowStats ShadowEvaluator::stats(size_t i) const {
+  ShadowStats s;
+  if (i >= shadowCount()) {
+    return s;
+  }
+  const Shadow& shadow = shadows_[i];
+  s.name = shadow.name;
+  for (size_t p = 0; p < 3; ++p) {
+    for (size_t g = 0; g < 3; ++g) {
+      s.confusion[p][g] = shadow.confusion[p][g].load(std::memory_order_relaxed);
+      s.samples += s.confusion[p][g];
+    }
+  }
+  s.disagreements = shadow.disagreements.load(std::memory_order_relaxed);
+  s.max_abs_readiness_delta = shadow.max_abs_readiness_delta.load(std::memory_order_relaxed);
+  if (shadow.diverged.load(std::memory_order_acquire)) {
+    s.first_divergence_t_s = shadow.first_divergence_t_s.load(std::memory_order_relaxed);
+    s.last_divergence_t_s = shadow.last_divergence_t_s.load(std::memory_order_relaxed);
+  }
+  return s;
+}
+
+void ShadowEvaluator::reset() {
+  for (size_t t = 0; t < track_count_; ++t) {
+    tracks_[t] = TrendState();
+  }
+}
+
+void ShadowEvaluator::resetStats() {
+  for (size_t i = 0; i < kMaxShadows; ++i) {
+    Shadow& shadow = shadows_[i];
+    for (size_t p = 0; p < 3; ++p) {
+      for (size_t g = 0; g < 3; ++g) {
+        shadow.confusion[p][g].store(0, std::memory_order_relaxed);
+      }
+    }
+    shadow.disagreements.store(0, std::memory_order_relaxed);
+    shadow.max_abs_readiness_delta.store(0.0, std::memory_order_relaxed);
+    shadow.diverged.store(false, std::memory_order_relaxed);
+  }
+}
+
+void ShadowEvaluator::render(std::ostream& out) const {
+  static const Gate kGates[3] = {Gate::BLOCK, Gate::CAUTION, Gate::ALLOW};
+  std::vector<ShadowStats> all(shadowCount());
+  for (size_t i = 0; i < all.size(); ++i) {
+    all[i] = stats(i);
+  }
+  out << "# HELP hlv_shadow_gate_total Samples by primary gate and shadow gate.\n";
+  out << "# TYPE hlv_shadow_gate_total counter\n";
+  for (const ShadowStats& s : all) {
+    for (size_t p = 0; p < 3; ++p) {
+      for (size_t g = 0; g < 3; ++g) {
+        out << "hlv_shadow_gate_total{shadow=\"" << s.name << "\",primary=\"" << gateToString(kGates[p])
+            << "\",candidate=\"" << gateToString(kGates[g]) << "\"} " << s.confusion[p][g] << "\n";
+      }
+    }
+  }
+  out << "# HELP hlv_shadow_disagreements_total Samples whose shadow gate differs from the primary gate.\n";
+  out << "# TYPE hlv_shadow_disagreements_total counter\n";
+  for (const ShadowStats& s : all) {
+    out << "hlv_shadow_disagreements_total{shadow=\"" << s.name << "\"} " << s.disagreements << "\n";
+  }
+  out << "# HELP hlv_shadow_first_divergence_t_seconds Sample time (t_s) of the first disagreement.\n";
+  out << "# TYPE hlv_shadow_first_divergence_t_seconds gauge\n";
+  for (const ShadowStats& s : all) {
+    if (!std::isnan(s.first_divergence_t_s)) {
+      out << "hlv_shadow_first_divergence_t_seconds{shadow=\"" << s.name << "\"} "
+          << s.first_divergence_t_s << "\n";
+    }
+  }
+  out << "# HELP hlv_shadow_max_readiness_delta Largest absolute readiness difference from the primary.\n";
+  out << "# TYPE hlv_shadow_max_readiness_delta gauge\n";
+  for (const ShadowStats& s : all) {
+    out << "hlv_shadow_max_readiness_delta{shadow=\"" << s.name << "\"} " << s.max_abs_readiness_delta << "\n";
+  }
+}
+
+} // namespace hlv
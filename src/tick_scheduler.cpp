@@ -0,0 +1,356 @@
+#include "hlv/tick_scheduler.hpp"
+#include "hlv/ingest_pipeline.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace hlv {
+
+namespace {
+
+// Makespan histogram bounds: 50 us .. 100 ms
+std::vector<uint64_t> makespanBucketsNs() {
+  return {50000, 100000, 250000, 500000, 750000, 1000000, 2000000, 5000000,
+          10000000, 25000000, 100000000};
+}
+
+uint64_t elapsedNs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+std::vector<const CompiledPolicy*> internPolicies(const std::vector<PhaseReadinessConfig>& configs) {
+  std::vector<const CompiledPolicy*> policies;
+  policies.reserve(configs.size());
+  for (const PhaseReadinessConfig& cfg : configs) {
+    policies.push_back(CompiledPolicy::intern(cfg));
+  }
+  return policies;
+}
+
+} // namespace
+
+TickScheduler::TickScheduler(const PhaseReadinessConfig& readiness_config, size_t channels,
+                             ChannelRegistry* registry, const TickSchedulerConfig& config)
+    : TickScheduler(std::vector<const CompiledPolicy*>(channels, CompiledPolicy::intern(readiness_config)),
+                    registry, config) {}
+
+TickScheduler::TickScheduler(const std::vector<PhaseReadinessConfig>& channel_configs,
+                             ChannelRegistry* registry, const TickSchedulerConfig& config)
+    : TickScheduler(internPolicies(channel_configs), registry, config) {}
+
+TickScheduler::TickScheduler(std::vector<const CompiledPolicy*> policies, ChannelRegistry* registry,
+                             const TickSchedulerConfig& config)
+    : config_(config)
+    , policies_(std::move(policies))
+    , registry_(registry)
+    , channels_(policies_.size())
+    , topology_(config.topology ? *config.topology : NumaTopology::detect())
+    , outputs_(channels_)
+    , signals_(nullptr)
+    , built_(false)
+    , generation_(0)
+    , remaining_(0)
+    , should_stop_(false)
+    , running_(false)
+    , pinned_(0)
+    , registry_placed_(0)
+    , ticks_(0)
+    , misses_(0)
+    , makespan_ns_total_(0)
+    , makespan_(makespanBucketsNs())
+{
+  if (config_.workers == 0) config_.workers = 1;
+  if (config_.chunk_size == 0) config_.chunk_size = 1;
+  // Workers without a CPU (or on an unknown one) have no node; on a single
+  // node every worker is on node 0, which gives plain contiguous shares
+  std::vector<int> worker_nodes(config_.workers, 0);
+  if (topology_.isMultiNode()) {
+    for (size_t w = 0; w < config_.workers; ++w) {
+      const int cpu = w < config_.worker_cpus.size() ? config_.worker_cpus[w] : -1;
+      worker_nodes[w] = cpu >= 0 ? topology_.nodeOfCpu(cpu) : -1;
+    }
+  }
+  shard_map_ = ChannelShardMap(channels_, config_.chunk_size, worker_nodes);
+  shards_.reset(new Shard[config_.workers]);
+  queues_.reset(new WorkQueue[config_.workers]);
+  stats_.reset(new WorkerStats[config_.workers]);
+}
+
+TickScheduler::~TickScheduler() {
+  stop();
+}
+
+bool TickScheduler::start() {
+  if (running_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  if (registry_ && registry_->size() != channels_) {
+    return false;
+  }
+  uint64_t generation = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    should_stop_ = false;
+    generation = generation_;
+    remaining_ = config_.workers;
+  }
+  pinned_.store(0, std::memory_order_relaxed);
+  for (size_t w = 0; w < config_.workers; ++w) {
+    threads_.emplace_back(&TickScheduler::workerLoop, this, w, generation);
+  }
+  // Wait until every worker is pinned and has built its shard
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this]() { return remaining_ == 0; });
+  }
+  built_ = true;
+  running_.store(true, std::memory_order_release);
+  return true;
+}
+
+void TickScheduler::stop() {
+  if (!running_.load(std::memory_order_acquire)) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    should_stop_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto& t : threads_) {
+    t.join();
+  }
+  threads_.clear();
+  running_.store(false, std::memory_order_release);
+}
+
+bool TickScheduler::runTick(const std::vector<PhaseSignals>& signals) {
+  if (!running_.load(std::memory_order_acquire) || signals.size() != channels_) {
+    return false;
+  }
+  if (registry_) {
+    registry_->beginEpoch();
+  }
+
+  const size_t workers = config_.workers;
+  for (size_t w = 0; w < workers; ++w) {
+    queues_[w].next.store(shard_map_.shard(w).first_chunk, std::memory_order_relaxed);
+    queues_[w].end = shard_map_.shard(w).end_chunk;
+  }
+  uint64_t steals_before = 0;
+  for (size_t w = 0; w < workers; ++w) {
+    steals_before += stats_[w].steals.load(std::memory_order_relaxed);
+  }
+
+  const auto release = std::chrono::steady_clock::now();
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    signals_ = signals.data();
+    remaining_ = workers;
+    ++generation_;
+    start_cv_.notify_all();
+    done_cv_.wait(lock, [this]() { return remaining_ == 0; });
+    signals_ = nullptr;
+  }
+  const uint64_t makespan_ns = elapsedNs(release, std::chrono::steady_clock::now());
+
+  if (registry_) {
+    registry_->commitEpoch();
+  }
+
+  uint64_t steals_after = 0;
+  for (size_t w = 0; w < workers; ++w) {
+    steals_after += stats_[w].steals.load(std::memory_order_relaxed);
+  }
+  last_.tick = ticks_.load(std::memory_order_relaxed) + 1;
+  last_.makespan_s = static_cast<double>(makespan_ns) * 1e-9;
+  last_.missed = last_.makespan_s > config_.deadline_s;
+  last_.steals = steals_after - steals_before;
+
+  makespan_.observe(makespan_ns);
+  makespan_ns_total_.fetch_add(makespan_ns, std::memory_order_relaxed);
+  if (last_.missed) {
+    misses_.fetch_add(1, std::memory_order_relaxed);
+  }
+  ticks_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void TickScheduler::workerLoop(size_t worker, uint64_t seen) {
+  if (worker < config_.worker_cpus.size() && config_.worker_cpus[worker] >= 0 &&
+      pinCurrentThread(config_.worker_cpus[worker])) {
+    pinned_.fetch_add(1, std::memory_order_acq_rel);
+  }
+  if (!built_) {
+    buildShard(worker);
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--remaining_ == 0) {
+      done_cv_.notify_one();
+    }
+  }
+  WorkerStats& stats = stats_[worker];
+  const std::vector<size_t>& victims = shard_map_.stealOrder(worker);
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_cv_.wait(lock, [&]() { return should_stop_ || generation_ != seen; });
+      if (should_stop_) {
+        return;
+      }
+      seen = generation_;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    const int node = topology_.currentNode();
+    uint64_t evaluated = 0;
+    uint64_t stolen = 0;
+    uint64_t remote = 0;
+    size_t chunk = 0;
+    // Own share first, then steal from the same node, then from the others
+    for (size_t k = 0; k < victims.size(); ++k) {
+      const size_t victim = victims[k];
+      const bool is_remote = shards_[victim].node.load(std::memory_order_relaxed) != node;
+      while (claimChunk(victim, chunk)) {
+        runChunk(victim, chunk);
+        const uint64_t n = std::min(config_.chunk_size, channels_ - chunk * config_.chunk_size);
+        evaluated += n;
+        if (k != 0) ++stolen;
+        if (is_remote) remote += n;
+      }
+    }
+    const uint64_t busy_ns = elapsedNs(begin, std::chrono::steady_clock::now());
+    stats.channels.fetch_add(evaluated, std::memory_order_relaxed);
+    stats.steals.fetch_add(stolen, std::memory_order_relaxed);
+    stats.remote.fetch_add(remote, std::memory_order_relaxed);
+    stats.busy_ns.fetch_add(busy_ns, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--remaining_ == 0) {
+      done_cv_.notify_one();
+    }
+  }
+}
+
+bool TickScheduler::claimChunk(size_t queue, size_t& chunk) {
+  WorkQueue& q = queues_[queue];
+  if (q.next.load(std::memory_order_relaxed) >= q.end) {
+    return false;
+  }
+  chunk = q.next.fetch_add(1, std::memory_order_relaxed);
+  return chunk < q.end;
+}
+
+void TickScheduler::buildShard(size_t worker) {
+  // Allocated and written by this (pinned) thread, so first-touch places
+  // the pages on its node
+  const ChannelShard& share = shard_map_.shard(worker);
+  Shard& shard = shards_[worker];
+  shard.middlewares.clear();
+  shard.middlewares.reserve(share.channels);
+  for (size_t id = share.first_channel; id < share.first_channel + share.channels; ++id) {
+    shard.middlewares.emplace_back(policies_[id]);
+  }
+  shard.node.store(topology_.currentNode(), std::memory_order_relaxed);
+  if (registry_ && config_.place_registry && topology_.isMultiNode() &&
+      registry_->placeChannels(share.first_channel, share.channels)) {
+    registry_placed_.fetch_add(share.channels, std::memory_order_acq_rel);
+  }
+}
+
+void TickScheduler::runChunk(size_t queue, size_t chunk) {
+  const size_t first = chunk * config_.chunk_size;
+  const size_t last = std::min(first + config_.chunk_size, channels_);
+  std::vector<PhaseReadinessMiddleware>& middlewares = shards_[queue].middlewares;
+  const size_t base = shard_map_.shard(queue).first_channel;
+  for (size_t id = first; id < last; ++id) {
+    const PhaseReadinessOutput output = middlewares[id - base].evaluate(signals_[id]);
+    outputs_[id] = output;
+    if (registry_) {
+      registry_->update(id, signals_[id], output);
+    }
+  }
+}
+
+uint64_t TickScheduler::workerChannels(size_t worker) const {
+  return worker < config_.workers ? stats_[worker].channels.load(std::memory_order_relaxed) : 0;
+}
+
+uint64_t TickScheduler::workerSteals(size_t worker) const {
+  return worker < config_.workers ? stats_[worker].steals.load(std::memory_order_relaxed) : 0;
+}
+
+uint64_t TickScheduler::workerRemoteChannels(size_t worker) const {
+  return worker < config_.workers ? stats_[worker].remote.load(std::memory_order_relaxed) : 0;
+}
+
+int TickScheduler::workerNode(size_t worker) const {
+  return worker < config_.workers ? shards_[worker].node.load(std::memory_order_relaxed) : -1;
+}
+
+double TickScheduler::remoteAccessRatio() const {
+  uint64_t channels = 0;
+  uint64_t remote = 0;
+  for (size_t w = 0; w < config_.workers; ++w) {
+    channels += workerChannels(w);
+    remote += workerRemoteChannels(w);
+  }
+  return channels == 0 ? 0.0 : static_cast<double>(remote) / static_cast<double>(channels);
+}
+
+double TickScheduler::workerUtilization(size_t worker) const {
+  const uint64_t total = makespan_ns_total_.load(std::memory_order_relaxed);
+  if (worker >= config_.workers || total == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(stats_[worker].busy_ns.load(std::memory_order_relaxed)) /
+         static_cast<double>(total);
+}
+
+void TickScheduler::render(std::ostream& out) const {
+  out << "# HELP hlv_tick_total Ticks evaluated by the tick scheduler.\n";
+  out << "# TYPE hlv_tick_total counter\n";
+  out << "hlv_tick_total " << tickCount() << "\n";
+  out << "# HELP hlv_tick_deadline_misses_total Ticks whose makespan exceeded the deadline.\n";
+  out << "# TYPE hlv_tick_deadline_misses_total counter\n";
+  out << "hlv_tick_deadline_misses_total " << deadlineMissCount() << "\n";
+  out << "# HELP hlv_tick_makespan_seconds Tick release to completion barrier.\n";
+  out << "# TYPE hlv_tick_makespan_seconds histogram\n";
+  makespan_.render(out, "hlv_tick_makespan_seconds");
+  out << "# HELP hlv_tick_worker_channels_total Channels evaluated per worker.\n";
+  out << "# TYPE hlv_tick_worker_channels_total counter\n";
+  for (size_t w = 0; w < config_.workers; ++w) {
+    out << "hlv_tick_worker_channels_total{worker=\"" << w << "\"} " << workerChannels(w) << "\n";
+  }
+  out << "# HELP hlv_tick_worker_steals_total Chunks a worker stole from another worker's share.\n";
+  out << "# TYPE hlv_tick_worker_steals_total counter\n";
+  for (size_t w = 0; w < config_.workers; ++w) {
+    out << "hlv_tick_worker_steals_total{worker=\"" << w << "\"} " << workerSteals(w) << "\n";
+  }
+  out << "# HELP hlv_tick_worker_remote_channels_total Channels a worker evaluated whose state is on another NUMA node.\n";
+  out << "# TYPE hlv_tick_worker_remote_channels_total counter\n";
+  for (size_t w = 0; w < config_.workers; ++w) {
+    out << "hlv_tick_worker_remote_channels_total{worker=\"" << w << "\"} " << workerRemoteChannels(w) << "\n";
+  }
+  out << "# HELP hlv_tick_worker_node NUMA node holding a worker's channel state.\n";
+  out << "# TYPE hlv_tick_worker_node gauge\n";
+  for (size_t w = 0; w < config_.workers; ++w) {
+    out << "hlv_tick_worker_node{worker=\"" << w << "\"} " << workerNode(w) << "\n";
+  }
+  out << "# HELP hlv_tick_numa_nodes NUMA nodes in the scheduler's topology.\n";
+  out << "# TYPE hlv_tick_numa_nodes gauge\n";
+  out << "hlv_tick_numa_nodes " << topology_.nodes() << "\n";
+  out << "# HELP hlv_tick_remote_access_ratio Fraction of evaluated channels whose state is on another NUMA node.\n";
+  out << "# TYPE hlv_tick_remote_access_ratio gauge\n";
+  out << "hlv_tick_remote_access_ratio " << remoteAccessRatio() << "\n";
+  out << "# HELP hlv_tick_worker_utilization Worker busy time over total tick makespan.\n";
+  out << "# TYPE hlv_tick_worker_utilization gauge\n";
+  for (size_t w = 0; w < config_.workers; ++w) {
+    out << "hlv_tick_worker_utilization{worker=\"" << w << "\"} " << workerUtilization(w) << "\n";
+  }
+}
+
+} // namespace hlv
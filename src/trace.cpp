@@ -0,0 +1,377 @@
+#include "hlv/trace.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "hlv trace records are mapped in place and require a little-endian host"
+#endif
+
+namespace hlv {
+
+namespace {
+
+constexpr char kTraceMagic[8] = {'H', 'L', 'V', 'T', 'R', 'A', 'C', 'E'};
+constexpr size_t kHeaderCrcBytes = offsetof(TraceFileHeader, header_crc);
+
+// Slicing-by-8 tables for the reflected IEEE polynomial
+struct Crc32Tables {
+  uint32_t t[8][256];
+  Crc32Tables() {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1u) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+      }
+      t[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+      for (int s = 1; s < 8; ++s) {
+        t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFFu];
+      }
+    }
+  }
+};
+
+const Crc32Tables& crcTables() {
+  static const Crc32Tables tables;
+  return tables;
+}
+
+void configToArray(const PhaseReadinessConfig& cfg, double* out) {
+  out[0] = cfg.temp_min_C;
+  out[1] = cfg.temp_max_C;
+  out[2] = cfg.max_abs_dTdt_C_per_s;
+  out[3] = cfg.max_abs_temp_jump_C;
+  out[4] = cfg.ewma_alpha;
+  out[5] = cfg.persistence_s;
+  out[6] = cfg.hysteresis_block_threshold;
+  out[7] = cfg.coherence_allow_threshold;
+  out[8] = cfg.max_dt_s;
+  out[9] = cfg.gate_allow_threshold;
+  out[10] = cfg.gate_caution_threshold;
+}
+
+PhaseReadinessConfig configFromArray(const double* in) {
+  PhaseReadinessConfig cfg;
+  cfg.temp_min_C = in[0];
+  cfg.temp_max_C = in[1];
+  cfg.max_abs_dTdt_C_per_s = in[2];
+  cfg.max_abs_temp_jump_C = in[3];
+  cfg.ewma_alpha = in[4];
+  cfg.persistence_s = in[5];
+  cfg.hysteresis_block_threshold = in[6];
+  cfg.coherence_allow_threshold = in[7];
+  cfg.max_dt_s = in[8];
+  cfg.gate_allow_threshold = in[9];
+  cfg.gate_caution_threshold = in[10];
+  return cfg;
+}
+
+} // namespace
+
+uint32_t crc32(const void* data, size_t length, uint32_t crc) {
+  const Crc32Tables& tb = crcTables();
+  const unsigned char* p = static_cast<const unsigned char*>(data);
+  crc = ~crc;
+  while (length >= 8) {
+    uint32_t lo;
+    uint32_t hi;
+    std::memcpy(&lo, p, 4);
+    std::memcpy(&hi, p + 4, 4);
+    lo ^= crc;
+    crc = tb.t[7][lo & 0xFFu] ^ tb.t[6][(lo >> 8) & 0xFFu] ^
+          tb.t[5][(lo >> 16) & 0xFFu] ^ tb.t[4][lo >> 24] ^
+          tb.t[3][hi & 0xFFu] ^ tb.t[2][(hi >> 8) & 0xFFu] ^
+          tb.t[1][(hi >> 16) & 0xFFu] ^ tb.t[0][hi >> 24];
+    p += 8;
+    length -= 8;
+  }
+  while (length--) {
+    crc = tb.t[0][(crc ^ *p++) & 0xFFu] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+// -----------------------------------------------------------------------------
+// Record conversions
+// -----------------------------------------------------------------------------
+
+TraceSignalsRecord toTraceRecord(const PhaseSignals& in) {
+  TraceSignalsRecord rec;
+  std::memset(&rec, 0, sizeof(rec));
+  rec.t_s = in.t_s;
+  rec.temp_C = in.temp_C;
+  rec.temp_ambient_C = in.temp_ambient_C;
+  rec.hysteresis_index = in.hysteresis_index;
+  rec.coherence_index = in.coherence_index;
+  rec.valid = in.valid ? 1 : 0;
+  return rec;
+}
+
+TraceOutputRecord toTraceRecord(const PhaseReadinessOutput& out) {
+  TraceOutputRecord rec;
+  std::memset(&rec, 0, sizeof(rec));
+  rec.readiness = out.readiness;
+  rec.dTdt_C_per_s = out.dTdt_C_per_s;
+  rec.trend_C = out.trend_C;
+  rec.stability_score = out.stability_score;
+  rec.flags = out.flags;
+  rec.gate = static_cast<uint8_t>(out.gate);
+  return rec;
+}
+
+PhaseSignals fromTraceRecord(const TraceSignalsRecord& rec) {
+  PhaseSignals in;
+  in.t_s = rec.t_s;
+  in.temp_C = rec.temp_C;
+  in.temp_ambient_C = rec.temp_ambient_C;
+  in.hysteresis_index = rec.hysteresis_index;
+  in.coherence_index = rec.coherence_index;
+  in.valid = rec.valid != 0;
+  return in;
+}
+
+PhaseReadinessOutput fromTraceRecord(const TraceOutputRecord& rec) {
+  PhaseReadinessOutput out;
+  out.readiness = rec.readiness;
+  out.gate = static_cast<Gate>(rec.gate);
+  out.flags = rec.flags;
+  out.dTdt_C_per_s = rec.dTdt_C_per_s;
+  out.trend_C = rec.trend_C;
+  out.stability_score = rec.stability_score;
+  return out;
+}
+
+// -----------------------------------------------------------------------------
+// TraceWriter
+// -----------------------------------------------------------------------------
+
+TraceWriter::TraceWriter()
+    : file_(nullptr)
+    , with_outputs_(false)
+    , ok_(false)
+    , block_records_(kTraceDefaultBlockRecords)
+    , stride_(sizeof(TraceSignalsRecord))
+    , pending_(0)
+    , records_written_(0)
+    , bytes_written_(0)
+{}
+
+TraceWriter::~TraceWriter() {
+  close();
+}
+
+bool TraceWriter::open(const std::string& path, const PhaseReadinessConfig& config,
+                       bool with_outputs, uint32_t block_records) {
+  close();
+  if (block_records == 0) {
+    return false;
+  }
+
+  file_ = std::fopen(path.c_str(), "wb");
+  if (!file_) {
+    return false;
+  }
+
+  with_outputs_ = with_outputs;
+  block_records_ = block_records;
+  stride_ = static_cast<uint32_t>(sizeof(TraceSignalsRecord) +
+                                  (with_outputs ? sizeof(TraceOutputRecord) : 0));
+  pending_ = 0;
+  records_written_ = 0;
+  block_.assign(static_cast<size_t>(block_records_) * stride_, 0);
+
+  TraceFileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kTraceMagic, sizeof(kTraceMagic));
+  header.version = kTraceVersion;
+  header.flags = with_outputs ? TRACE_HAS_OUTPUTS : 0;
+  header.record_stride = stride_;
+  header.block_records = block_records_;
+  configToArray(config, header.config);
+  header.header_crc = crc32(&header, kHeaderCrcBytes);
+
+  ok_ = std::fwrite(&header, sizeof(header), 1, file_) == 1;
+  bytes_written_ = sizeof(header);
+  return ok_;
+}
+
+bool TraceWriter::append(const PhaseSignals& signals, const PhaseReadinessOutput& output) {
+  if (!file_) {
+    return false;
+  }
+
+  unsigned char* slot = block_.data() + static_cast<size_t>(pending_) * stride_;
+  const TraceSignalsRecord sig = toTraceRecord(signals);
+  std::memcpy(slot, &sig, sizeof(sig));
+  if (with_outputs_) {
+    const TraceOutputRecord out = toTraceRecord(output);
+    std::memcpy(slot + sizeof(sig), &out, sizeof(out));
+  }
+  ++records_written_;
+
+  if (++pending_ == block_records_) {
+    return flushBlock();
+  }
+  return ok_;
+}
+
+bool TraceWriter::flushBlock() {
+  if (!file_ || pending_ == 0) {
+    return ok_;
+  }
+
+  const size_t bytes = static_cast<size_t>(pending_) * stride_;
+  TraceBlockHeader header;
+  header.magic = kTraceBlockMagic;
+  header.record_count = pending_;
+  header.crc = crc32(block_.data(), bytes);
+  header.reserved = 0;
+
+  ok_ = ok_ && std::fwrite(&header, sizeof(header), 1, file_) == 1;
+  ok_ = ok_ && std::fwrite(block_.data(), 1, bytes, file_) == bytes;
+  bytes_written_ += sizeof(header) + bytes;
+  pending_ = 0;
+  return ok_;
+}
+
+bool TraceWriter::close() {
+  if (!file_) {
+    return ok_;
+  }
+  flushBlock();
+  ok_ = (std::fclose(file_) == 0) && ok_;
+  file_ = nullptr;
+  return ok_;
+}
+
+// -----------------------------------------------------------------------------
+// TraceReader
+// -----------------------------------------------------------------------------
+
+TraceReader::TraceReader()
+    : map_(nullptr)
+    , map_size_(0)
+    , has_outputs_(false)
+    , stride_(0)
+    , block_records_(0)
+    , record_count_(0)
+    , truncated_(false)
+{}
+
+TraceReader::~TraceReader() {
+  close();
+}
+
+void TraceReader::close() {
+  if (map_) {
+    munmap(map_, map_size_);
+  }
+  map_ = nullptr;
+  map_size_ = 0;
+  blocks_.clear();
+  record_count_ = 0;
+  truncated_ = false;
+}
+
+bool TraceReader::open(const std::string& path, bool verify_crc) {
+  close();
+  error_.clear();
+
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    error_ = "cannot open " + path;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(TraceFileHeader))) {
+    ::close(fd);
+    error_ = "file too small for a trace header";
+    return false;
+  }
+
+  map_size_ = static_cast<size_t>(st.st_size);
+  map_ = mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map_ == MAP_FAILED) {
+    map_ = nullptr;
+    map_size_ = 0;
+    error_ = "mmap failed";
+    return false;
+  }
+  madvise(map_, map_size_, MADV_SEQUENTIAL);
+
+  const unsigned char* base = static_cast<const unsigned char*>(map_);
+  TraceFileHeader header;
+  std::memcpy(&header, base, sizeof(header));
+  if (std::memcmp(header.magic, kTraceMagic, sizeof(kTraceMagic)) != 0) {
+    error_ = "not an HLV trace (bad magic)";
+    close();
+    return false;
+  }
+  if (header.version != kTraceVersion) {
+    error_ = "unsupported trace version";
+    close();
+    return false;
+  }
+  if (header.header_crc != crc32(&header, kHeaderCrcBytes)) {
+    error_ = "trace header checksum mismatch";
+    close();
+    return false;
+  }
+
+  has_outputs_ = (header.flags & TRACE_HAS_OUTPUTS) != 0;
+  stride_ = header.record_stride;
+  block_records_ = header.block_records;
+  const uint32_t expected_stride = static_cast<uint32_t>(
+      sizeof(TraceSignalsRecord) + (has_outputs_ ? sizeof(TraceOutputRecord) : 0));
+  if (stride_ != expected_stride || block_records_ == 0) {
+    error_ = "inconsistent record stride";
+    close();
+    return false;
+  }
+  config_ = configFromArray(header.config);
+
+  // Index blocks; stop at the first incomplete or corrupt one
+  size_t offset = sizeof(TraceFileHeader);
+  while (offset < map_size_) {
+    if (map_size_ - offset < sizeof(TraceBlockHeader)) {
+      truncated_ = true;
+      break;
+    }
+    TraceBlockHeader bh;
+    std::memcpy(&bh, base + offset, sizeof(bh));
+    const size_t bytes = static_cast<size_t>(bh.record_count) * stride_;
+    if (bh.magic != kTraceBlockMagic || bh.record_count == 0 || bh.record_count > block_records_ ||
+        map_size_ - offset - sizeof(bh) < bytes) {
+      truncated_ = true;
+      break;
+    }
+    BlockIndex idx{offset + sizeof(bh), bh.record_count, bh.crc};
+    if (verify_crc && crc32(base + idx.offset, bytes) != idx.crc) {
+      truncated_ = true;
+      break;
+    }
+    blocks_.push_back(idx);
+    record_count_ += bh.record_count;
+    offset += sizeof(bh) + bytes;
+  }
+  return true;
+}
+
+TraceBlockView TraceReader::block(size_t i) const {
+  const BlockIndex& idx = blocks_[i];
+  return TraceBlockView(static_cast<const unsigned char*>(map_) + idx.offset, idx.count, stride_, has_outputs_);
+}
+
+bool TraceReader::verifyBlock(size_t i) const {
+  const BlockIndex& idx = blocks_[i];
+  return crc32(static_cast<const unsigned char*>(map_) + idx.offset,
+               static_cast<size_t>(idx.count) * stride_) == idx.crc;
+}
+
+} // namespace hlv
@@ -0,0 +1,522 @@
+#include "hlv/columnar_history.hpp"
+#include "hlv/history_store.hpp"
+#include "hlv/phase_readiness.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+using namespace hlv;
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+static bool same_bits(double a, double b) {
+  return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+static bool same_snapshot(const ReadinessSnapshot& a, const ReadinessSnapshot& b) {
+  return a.timestamp == b.timestamp && same_bits(a.t_s, b.t_s) && same_bits(a.readiness, b.readiness) &&
+         a.gate == b.gate && a.flags == b.flags && same_bits(a.temp_C, b.temp_C) &&
+         same_bits(a.temp_ambient_C, b.temp_ambient_C) && same_bits(a.dTdt_C_per_s, b.dTdt_C_per_s) &&
+         same_bits(a.trend_C, b.trend_C) && same_bits(a.stability_score, b.stability_score) &&
+         same_bits(a.hysteresis_index, b.hysteresis_index) && same_bits(a.coherence_index, b.coherence_index);
+}
+
+// Middleware-driven stream at 1 kHz: quantized sensor held between
+// conversions, occasional invalid samples, a time step backwards and a gap
+static std::vector<ReadinessSnapshot> make_stream(size_t n,
+                                                  const PhaseReadinessConfig& config = PhaseReadinessConfig{}) {
+  PhaseReadinessMiddleware mw{config};
+  std::vector<ReadinessSnapshot> out;
+  out.reserve(n);
+  uint64_t lcg = 12345;
+  const auto t0 = std::chrono::steady_clock::time_point(std::chrono::seconds(1000));
+  for (size_t i = 0; i < n; ++i) {
+    lcg = lcg * 6364136223846793005ull + 1442695040888963407ull;
+    PhaseSignals s;
+    s.t_s = (i == 5000) ? (i - 3) * 0.001 : (i >= 7000 ? i * 0.001 + 5.0 : i * 0.001);
+    s.temp_C = std::round((25.0 + 2.0 * std::sin((i / 64) * 0.001)) * 128.0) / 128.0;
+    s.temp_ambient_C = 22.0;
+    s.coherence_index = (i / 100) % 7 == 0 ? 0.4 : 0.6 + 0.001 * ((i / 100) % 13);
+    s.valid = (i % 997 != 996);
+    const PhaseReadinessOutput o = mw.evaluate(s);
+
+    ReadinessSnapshot snap;
+    snap.timestamp = t0 + std::chrono::microseconds(1000 * i + (lcg >> 60));
+    snap.t_s = s.t_s;
+    snap.readiness = o.readiness;
+    snap.gate = o.gate;
+    snap.flags = o.flags;
+    snap.temp_C = s.temp_C;
+    snap.temp_ambient_C = s.temp_ambient_C;
+    snap.dTdt_C_per_s = o.dTdt_C_per_s;
+    snap.trend_C = o.trend_C;
+    snap.stability_score = o.stability_score;
+    snap.hysteresis_index = s.hysteresis_index;
+    snap.coherence_index = s.coherence_index;
+    out.push_back(snap);
+  }
+  return out;
+}
+
+static std::vector<ReadinessSnapshot> decode_all(const CompressedHistory& h) {
+  return CompressedHistory::decodeRange(h.blocksInRange(-1e300, 1e300), h.config(), -1e300, 1e300,
+                                        std::numeric_limits<size_t>::max());
+}
+
+// -----------------------------------------------------------------------------
+// Test 1: Lossless round trip (timestamps at the configured resolution)
+// -----------------------------------------------------------------------------
+static void test_round_trip() {
+  CompressedHistoryConfig cfg;
+  cfg.max_samples = 1000000;
+  cfg.block_samples = 1024;
+  CompressedHistory h(cfg);
+  assert(h.enabled());
+
+  const std::vector<ReadinessSnapshot> stream = make_stream(10000);
+  for (const auto& s : stream) h.append(s);
+  assert(h.size() == stream.size());
+
+  const CompressedHistoryStats stats = h.stats();
+  assert(stats.samples == 10000);
+  assert(stats.blocks == 10); // 9 sealed + open
+
+  const std::vector<ReadinessSnapshot> decoded = decode_all(h);
+  assert(decoded.size() == stream.size());
+  for (size_t i = 0; i < stream.size(); ++i) {
+    assert(same_snapshot(decoded[i], stream[i]));
+    // The readiness predictor is decide()'s own penalty table
+    assert(same_bits(PhaseReadinessMiddleware::readinessFromFlags(stream[i].flags), stream[i].readiness));
+  }
+
+  // Arbitrary (non-middleware) values still round-trip exactly
+  CompressedHistory raw(cfg);
+  ReadinessSnapshot odd;
+  odd.t_s = -1.5;
+  odd.readiness = 0.123456789;
+  odd.gate = Gate::CAUTION;
+  odd.flags = 0xFFFFFFFFu;
+  odd.temp_C = -std::numeric_limits<double>::infinity();
+  odd.dTdt_C_per_s = std::numeric_limits<double>::denorm_min();
+  odd.trend_C = -0.0;
+  odd.stability_score = 42.0;
+  raw.append(odd);
+  raw.append(ReadinessSnapshot{});
+  const std::vector<ReadinessSnapshot> back = decode_all(raw);
+  assert(back.size() == 2);
+  assert(same_snapshot(back[0], odd));
+  assert(same_snapshot(back[1], ReadinessSnapshot{}));
+}
+
+// -----------------------------------------------------------------------------
+// Test 2: Realistic streams compress far below the 100+ byte snapshot
+// -----------------------------------------------------------------------------
+static void test_compression_ratio() {
+  CompressedHistoryConfig cfg;
+  cfg.max_samples = 1000000;
+  CompressedHistory h(cfg);
+  for (const auto& s : make_stream(50000)) h.append(s);
+  const CompressedHistoryStats stats = h.stats();
+  assert(stats.bytes_per_sample < 4.0);
+  assert(stats.bytes_per_sample * 25 < sizeof(ReadinessSnapshot));
+
+  // The trend predictor takes alpha from the feeding policy: with the
+  // matching policy trend_C costs fewer bits than with the default one
+  PhaseReadinessConfig fast;
+  fast.ewma_alpha = 0.5;
+  const std::vector<ReadinessSnapshot> stream = make_stream(50000, fast);
+  CompressedHistory mismatched(cfg);
+  cfg.policy = CompiledPolicy::intern(fast);
+  CompressedHistory matched(cfg);
+  for (const auto& s : stream) {
+    mismatched.append(s);
+    matched.append(s);
+  }
+  assert(matched.stats().bytes < mismatched.stats().bytes);
+  const std::vector<ReadinessSnapshot> decoded = decode_all(matched);
+  assert(decoded.size() == stream.size());
+  for (size_t i = 0; i < stream.size(); ++i) {
+    assert(same_snapshot(decoded[i], stream[i]));
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Test 3: Range queries use the block time index
+// -----------------------------------------------------------------------------
+static void test_range_queries() {
+  CompressedHistoryConfig cfg;
+  cfg.max_samples = 1000000;
+  cfg.block_samples = 500;
+  CompressedHistory h(cfg);
+  const std::vector<ReadinessSnapshot> stream = make_stream(6000);
+  for (const auto& s : stream) h.append(s);
+
+  // [1.0, 1.999] lies within blocks 2 and 3
+  const auto blocks = h.blocksInRange(1.0, 1.999);
+  assert(blocks.size() == 2);
+
+  const auto window = CompressedHistory::decodeRange(blocks, h.config(), 1.0, 1.999, 10000);
+  assert(window.size() == 1000);
+  assert(same_snapshot(window.front(), stream[1000]));
+  assert(same_snapshot(window.back(), stream[1999]));
+
+  // max_count keeps the newest samples
+  const auto newest = CompressedHistory::decodeRange(blocks, h.config(), 1.0, 1.999, 10);
+  assert(newest.size() == 10);
+  assert(same_snapshot(newest.front(), stream[1990]));
+
+  // The open block is included and copied
+  const auto tail = h.blocksInRange(5.9, 6.0);
+  assert(tail.size() == 1);
+  h.append(stream.back());
+  assert(tail.front()->count == 500);
+  assert(h.blocksInRange(1e9, 2e9).empty());
+}
+
+// -----------------------------------------------------------------------------
+// Test 4: Retention drops whole blocks, disabled tier stores nothing
+// -----------------------------------------------------------------------------
+static void test_retention() {
+  CompressedHistoryConfig cfg;
+  cfg.max_samples = 1000;
+  cfg.block_samples = 256;
+  CompressedHistory h(cfg);
+  const std::vector<ReadinessSnapshot> stream = make_stream(5000);
+  for (const auto& s : stream) h.append(s);
+  assert(h.size() >= 1000 && h.size() < 1000 + 256);
+
+  const std::vector<ReadinessSnapshot> decoded = decode_all(h);
+  assert(decoded.size() == h.size());
+  assert(same_snapshot(decoded.back(), stream.back()));
+  assert(same_snapshot(decoded.front(), stream[stream.size() - h.size()]));
+
+  h.clear();
+  assert(h.size() == 0 && h.stats().blocks == 0);
+
+  CompressedHistory off;
+  assert(!off.enabled());
+  off.append(stream[0]);
+  assert(off.size() == 0);
+}
+
+// -----------------------------------------------------------------------------
+// Test 5: Cascaded rollups match a brute-force aggregation
+// -----------------------------------------------------------------------------
+static void test_rollups() {
+  RollupHistory rollups({{10.0, 100}, {1.0, 100}, {60.0, 100}});
+  assert(rollups.levelCount() == 3);
+  assert(rollups.findLevel(10.0) == 1);
+  assert(rollups.findLevel(5.0) == -1);
+
+  // 150 s at 100 Hz: readiness ramps within each second, gate by 7 s phase
+  std::vector<ReadinessSnapshot> samples;
+  for (int i = 0; i < 15000; ++i) {
+    ReadinessSnapshot s;
+    s.t_s = i * 0.01;
+    s.readiness = (i % 100) / 100.0;
+    s.gate = static_cast<Gate>((i / 700) % 3);
+    s.flags = (i % 1000 == 0) ? FLAG_COHERENCE_LOW : FLAG_NONE;
+    samples.push_back(s);
+    rollups.append(s);
+  }
+
+  for (size_t level = 0; level < 3; ++level) {
+    const double res = rollups.resolution(level);
+    std::vector<RollupBucket> buckets;
+    rollups.query(level, -1e300, 1e300, buckets);
+    // The 1 s ring holds 100 closed buckets plus the open one
+    const size_t expected_count = level == 0 ? 101 : static_cast<size_t>(std::ceil(150.0 / res));
+    assert(buckets.size() == expected_count);
+    uint64_t total = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+      const RollupBucket& bucket = buckets[i];
+      const size_t b = i + static_cast<size_t>(std::ceil(150.0 / res)) - expected_count;
+      assert(bucket.start_t_s == b * res && bucket.end_t_s == (b + 1) * res);
+      assert(bucket.partial == (i + 1 == buckets.size()));
+
+      RollupBucket expected;
+      for (const auto& s : samples) {
+        if (std::floor(s.t_s / res) == static_cast<double>(b)) expected.add(s);
+      }
+      assert(bucket.samples == expected.samples);
+      assert(bucket.readiness_min == expected.readiness_min);
+      assert(bucket.readiness_max == expected.readiness_max);
+      assert(std::fabs(bucket.readinessMean() - expected.readinessMean()) < 1e-12);
+      for (size_t g = 0; g < 3; ++g) assert(bucket.gate_samples[g] == expected.gate_samples[g]);
+      assert(bucket.flags_union == expected.flags_union);
+      total += bucket.samples;
+    }
+    assert(total == (level == 0 ? 10100u : samples.size()));
+  }
+
+  // Time window and ring capacity (1 s level keeps the last 100 seconds)
+  std::vector<RollupBucket> window;
+  rollups.query(1, 20.0, 39.0, window);
+  assert(window.size() == 2 && window[0].start_t_s == 20.0);
+  window.clear();
+  rollups.query(0, -1e300, 1e300, window);
+  assert(window.size() == 101 && window.front().start_t_s == 49.0);
+
+  // Non-finite time is ignored; clear() empties every level
+  ReadinessSnapshot bad;
+  bad.t_s = std::numeric_limits<double>::quiet_NaN();
+  rollups.append(bad);
+  rollups.clear();
+  window.clear();
+  rollups.query(2, -1e300, 1e300, window);
+  assert(window.empty());
+}
+
+// -----------------------------------------------------------------------------
+// Test 6: Columnar history matches a brute-force scan of the retained samples
+// -----------------------------------------------------------------------------
+static void check_columnar_stats(const ColumnarHistory& h, const std::vector<ReadinessSnapshot>& kept,
+                                 double from_t, double to_t) {
+  const HistoryStats st = h.stats(from_t, to_t);
+  HistoryStats expected;
+  double sum_readiness = 0.0;
+  double sum_dTdt = 0.0;
+  for (const auto& s : kept) {
+    if (!(s.t_s >= from_t && s.t_s <= to_t)) continue;
+    ++expected.count;
+    expected.first_t_s = std::min(expected.first_t_s, s.t_s);
+    expected.last_t_s = std::max(expected.last_t_s, s.t_s);
+    expected.readiness.min = std::min(expected.readiness.min, s.readiness);
+    expected.readiness.max = std::max(expected.readiness.max, s.readiness);
+    expected.dTdt_C_per_s.max_abs = std::max(expected.dTdt_C_per_s.max_abs, std::fabs(s.dTdt_C_per_s));
+    expected.trend_C.min = std::min(expected.trend_C.min, s.trend_C);
+    sum_readiness += s.readiness;
+    sum_dTdt += s.dTdt_C_per_s;
+    ++expected.gate_samples[static_cast<size_t>(s.gate)];
+    for (unsigned b = 0; b < 32; ++b) {
+      if (s.flags & (1u << b)) ++expected.flag_samples[b];
+    }
+  }
+  assert(st.count == expected.count);
+  assert(st.first_t_s == expected.first_t_s && st.last_t_s == expected.last_t_s);
+  assert(st.readiness.min == expected.readiness.min && st.readiness.max == expected.readiness.max);
+  assert(st.dTdt_C_per_s.max_abs == expected.dTdt_C_per_s.max_abs);
+  assert(st.trend_C.min == expected.trend_C.min);
+  assert(std::fabs(st.readiness.sum - sum_readiness) < 1e-9);
+  assert(std::fabs(st.dTdt_C_per_s.sum - sum_dTdt) < 1e-9);
+  for (size_t g = 0; g < 3; ++g) assert(st.gate_samples[g] == expected.gate_samples[g]);
+  for (size_t b = 0; b < 32; ++b) assert(st.flag_samples[b] == expected.flag_samples[b]);
+}
+
+static void test_columnar() {
+  // Capacity not a multiple of the chunk size, so the ring wraps mid-chunk
+  ColumnarHistory h(2500);
+  std::vector<ReadinessSnapshot> all;
+  uint64_t lcg = 777;
+  for (int i = 0; i < 6100; ++i) {
+    lcg = lcg * 6364136223846793005ull + 1442695040888963407ull;
+    ReadinessSnapshot s;
+    s.timestamp = std::chrono::steady_clock::time_point(std::chrono::microseconds(i * 1000));
+    // Mostly increasing time with a step backwards and one NaN
+    s.t_s = (i % 1500 == 700) ? i * 0.01 - 3.0 : i * 0.01;
+    if (i == 5000) s.t_s = std::numeric_limits<double>::quiet_NaN();
+    s.readiness = static_cast<double>(lcg >> 40) / static_cast<double>(1u << 24);
+    s.gate = static_cast<Gate>((lcg >> 20) % 3);
+    s.flags = static_cast<uint32_t>((lcg >> 8) & (FLAG_GRADIENT_TOO_HIGH | FLAG_COHERENCE_LOW)) |
+              ((i % 97 == 0) ? FLAG_FAILSAFE_DEFAULT : 0u);
+    s.dTdt_C_per_s = (static_cast<double>((lcg >> 16) & 0xFFFF) - 32768.0) / 1000.0;
+    s.trend_C = std::sin(i * 0.01);
+    all.push_back(s);
+    h.append(s);
+
+    if (i == 1800 || i == 2600 || i == 6099) {
+      const size_t keep = std::min<size_t>(all.size(), 2500);
+      const std::vector<ReadinessSnapshot> kept(all.end() - keep, all.end());
+      assert(h.size() == keep);
+      assert(same_snapshot(h.at(0), kept.front()) && same_snapshot(h.at(keep - 1), kept.back()));
+      const double newest = kept.back().t_s;
+      check_columnar_stats(h, kept, -std::numeric_limits<double>::infinity(),
+                           std::numeric_limits<double>::infinity());
+      check_columnar_stats(h, kept, newest - 12.345, newest - 3.21);
+      check_columnar_stats(h, kept, newest - 24.0, newest - 24.0 + 1e-9);
+      check_columnar_stats(h, kept, newest + 1.0, newest + 2.0);
+    }
+  }
+
+  // Range and latest return oldest-first copies
+  std::vector<ReadinessSnapshot> out;
+  h.latest(3, out);
+  assert(out.size() == 3 && same_snapshot(out[2], all.back()) && same_snapshot(out[0], all[all.size() - 3]));
+  out.clear();
+  h.range(all[5001].t_s, all[5005].t_s, 100, out);   // Sample 5000 has a NaN time
+  assert(out.size() == 5 && same_snapshot(out.front(), all[5001]) && same_snapshot(out.back(), all[5005]));
+  out.clear();
+  h.range(all[5001].t_s, all[5005].t_s, 2, out);
+  assert(out.size() == 2 && same_snapshot(out.front(), all[5004]));
+
+  // Shrinking keeps the newest samples; clear() empties the ring
+  h.setCapacity(100);
+  assert(h.size() == 100 && same_snapshot(h.at(99), all.back()));
+  check_columnar_stats(h, std::vector<ReadinessSnapshot>(all.end() - 100, all.end()), -1e300, 1e300);
+  h.clear();
+  assert(h.size() == 0 && h.stats(-1e300, 1e300).count == 0);
+}
+
+// -----------------------------------------------------------------------------
+// Test 7: Filtered queries over the per-block flag index
+// -----------------------------------------------------------------------------
+static std::vector<ReadinessSnapshot> brute_filter(const std::vector<ReadinessSnapshot>& samples,
+                                                   const HistoryFilter& filter, double from_t, double to_t,
+                                                   size_t max_count) {
+  std::vector<ReadinessSnapshot> out;
+  for (auto it = samples.rbegin(); it != samples.rend() && out.size() < max_count; ++it) {
+    if (it->t_s >= from_t && it->t_s <= to_t && filter.matches(it->flags, it->gate)) out.push_back(*it);
+  }
+  std::reverse(out.begin(), out.end());
+  return out;
+}
+
+static void test_flag_index() {
+  // Position sets: runs while clustered, a bitset once that is smaller
+  PositionSet runs;
+  for (uint32_t p = 100; p < 400; ++p) runs.add(p, 1024);
+  assert(!runs.isBitset() && runs.cardinality() == 300 && runs.bytes() == 4);
+  PositionSet scattered;
+  for (uint32_t p = 0; p < 1024; p += 3) scattered.add(p, 1024);
+  assert(scattered.isBitset() && scattered.bytes() == 128);
+  std::vector<uint64_t> words(16, 0);
+  runs.orInto(words);
+  scattered.orInto(words);
+  size_t bits = 0;
+  for (uint64_t w : words) bits += static_cast<size_t>(__builtin_popcountll(w));
+  assert(bits == 300 + 342 - 100);   // Every third position in [100, 400) overlaps
+
+  // Middleware flags plus a clustered, a sparse and a dense synthetic flag
+  std::vector<ReadinessSnapshot> stream = make_stream(20000);
+  uint64_t lcg = 99;
+  for (size_t i = 0; i < stream.size(); ++i) {
+    lcg = lcg * 6364136223846793005ull + 1442695040888963407ull;
+    if ((i / 300) % 5 == 0) stream[i].flags |= FLAG_HYSTERESIS_HIGH;
+    if ((lcg >> 50) % 500 == 0) stream[i].flags |= FLAG_TEMP_OUT_OF_RANGE;
+    if ((lcg >> 40) & 1) stream[i].flags |= FLAG_PERSISTENT_HEATING;
+  }
+
+  CompressedHistoryConfig cfg;
+  cfg.max_samples = 1000000;
+  cfg.block_samples = 1024;
+  CompressedHistory h(cfg);
+  for (const auto& s : stream) h.append(s);
+  assert(h.stats().index_bytes > 0);
+
+  HistoryFilter filters[5];
+  filters[0].flags_all = FLAG_HYSTERESIS_HIGH;
+  filters[0].flags_none = FLAG_TEMP_OUT_OF_RANGE;
+  filters[1].flags_all = FLAG_TEMP_OUT_OF_RANGE | FLAG_PERSISTENT_HEATING;
+  filters[2].gate_mask = 1u << static_cast<unsigned>(Gate::BLOCK);
+  filters[3].flags_none = FLAG_PERSISTENT_HEATING | FLAG_HYSTERESIS_HIGH;
+  filters[3].gate_mask = (1u << static_cast<unsigned>(Gate::ALLOW)) | (1u << static_cast<unsigned>(Gate::CAUTION));
+  filters[4].flags_all = FLAG_COHERENCE_LOW | FLAG_TEMP_OUT_OF_RANGE | FLAG_HYSTERESIS_HIGH;
+  for (const HistoryFilter& f : filters) {
+    assert(f.active());
+    for (size_t max_count : {size_t(5), size_t(100000)}) {
+      const auto blocks = h.blocksInRange(3.0, 16.5);
+      const auto got = CompressedHistory::decodeRange(blocks, h.config(), 3.0, 16.5, max_count, f);
+      const auto expected = brute_filter(stream, f, 3.0, 16.5, max_count);
+      assert(got.size() == expected.size());
+      for (size_t i = 0; i < got.size(); ++i) assert(same_snapshot(got[i], expected[i]));
+    }
+  }
+
+  // A flag no sample carries rejects every block without decoding
+  HistoryFilter none;
+  none.flags_all = 1u << 20;
+  for (const auto& block : h.blocksInRange(-1e300, 1e300)) {
+    std::vector<uint64_t> mask;
+    assert(!block->matchMask(none, mask));
+  }
+
+  // The recent-history ring applies the same predicate
+  ColumnarHistory recent(5000);
+  for (const auto& s : stream) recent.append(s);
+  std::vector<ReadinessSnapshot> got;
+  recent.range(-1e300, 1e300, 100000, got, filters[0]);
+  const std::vector<ReadinessSnapshot> tail(stream.end() - 5000, stream.end());
+  const auto expected = brute_filter(tail, filters[0], -1e300, 1e300, 100000);
+  assert(got.size() == expected.size() && !got.empty());
+  for (size_t i = 0; i < got.size(); ++i) assert(same_snapshot(got[i], expected[i]));
+}
+
+// -----------------------------------------------------------------------------
+// Test 8: Transition log keeps one entry per run and answers dwell queries
+// -----------------------------------------------------------------------------
+static void test_transition_log() {
+  TransitionLog log(8);
+  assert(!log.dwell().valid && log.transitionsSince(-1e300) == 0);
+
+  // ALLOW for 0..9 s, CAUTION 10..14 s (flag raised at 12 s), BLOCK 15..19 s
+  for (int i = 0; i < 200; ++i) {
+    ReadinessSnapshot s;
+    s.t_s = i * 0.1;
+    s.gate = i < 100 ? Gate::ALLOW : (i < 150 ? Gate::CAUTION : Gate::BLOCK);
+    s.flags = (i >= 120 && i < 150) ? FLAG_HYSTERESIS_HIGH : FLAG_NONE;
+    log.append(s);
+  }
+  assert(log.size() == 4);
+  const DwellState& d = log.dwell();
+  assert(d.valid && d.gate == Gate::BLOCK && d.transitions == 3);
+  assert(std::fabs(d.gateDwell() - 4.9) < 1e-9 && d.runDwell() == d.gateDwell());
+  assert(std::fabs(d.timeSince(Gate::ALLOW) - 9.9) < 1e-9);
+  assert(std::fabs(d.timeSince(Gate::CAUTION) - 4.9) < 1e-9);
+  assert(d.timeSince(Gate::BLOCK) == 0.0);
+
+  assert(log.transitionsSince(-1e300) == 3);
+  assert(log.transitionsSince(11.0) == 2);
+  assert(log.transitionsSince(15.0) == 0);
+
+  std::vector<GateRun> runs;
+  log.runs(-1e300, 1e300, 100, runs);
+  assert(runs.size() == 4 && runs[0].samples == 100 && runs[0].start_t_s == 0.0);
+  assert(runs[2].flags == FLAG_HYSTERESIS_HIGH && runs[2].start_t_s == 12.0 && runs[2].samples == 30);
+  runs.clear();
+  log.runs(12.5, 13.0, 100, runs);
+  assert(runs.size() == 1 && runs[0].gate == Gate::CAUTION);
+  runs.clear();
+  log.runs(-1e300, 1e300, 2, runs);
+  assert(runs.size() == 2 && runs.back().gate == Gate::BLOCK);
+
+  // Bounded memory: only the newest runs are kept, the totals continue
+  for (int i = 200; i < 240; ++i) {
+    ReadinessSnapshot s;
+    s.t_s = i * 0.1;
+    s.gate = (i % 2) ? Gate::ALLOW : Gate::CAUTION;
+    log.append(s);
+  }
+  assert(log.size() == 8 && log.dwell().transitions == 43);
+  assert(log.transitionsSince(-1e300) == 8);
+  assert(log.dwell().timeSince(Gate::BLOCK) > 3.9);
+
+  ReadinessSnapshot bad;
+  bad.t_s = std::numeric_limits<double>::quiet_NaN();
+  log.append(bad);
+  assert(log.dwell().transitions == 43);
+  log.clear();
+  assert(log.size() == 0 && !log.dwell().valid);
+}
+
+int main() {
+  std::cout << "Running history store tests...\n";
+
+  test_round_trip();
+  test_compression_ratio();
+  test_range_queries();
+  test_retention();
+  test_rollups();
+  test_columnar();
+  test_flag_index();
+  test_transition_log();
+
+  std::cout << "[PASS] All history store tests passed!\n";
+  return 0;
+}
@@ -0,0 +1,320 @@
+#include "hlv/ingest_pipeline.hpp"
+#include "hlv/phase_readiness.hpp"
+#include "hlv/rest_api_server.hpp"
+#include "hlv/spsc_ring.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+using namespace hlv;
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+static PhaseSignals make_signal(int i) {
+  PhaseSignals s;
+  s.t_s = i * 0.01;
+  s.temp_C = 25.0 + 0.02 * (i % 11);
+  s.temp_ambient_C = 22.0;
+  s.coherence_index = 0.6;
+  s.valid = true;
+  return s;
+}
+
+// -----------------------------------------------------------------------------
+// Test 1: Evicting ring ordering, eviction and wrap-around
+// -----------------------------------------------------------------------------
+static void test_evicting_ring() {
+  SpscEvictingRing<int> ring(4);
+  assert(ring.capacity() == 4);
+
+  int out[8];
+  for (int i = 0; i < 4; ++i) assert(ring.tryPush(i));
+  assert(!ring.tryPush(4) && ring.size() == 4);
+
+  // Evict 0 and 1 for 4 and 5
+  bool evicted = false;
+  assert(ring.tryPushEvict(4, evicted) && evicted);
+  assert(ring.tryPushEvict(5, evicted) && evicted);
+  assert(ring.size() == 4);
+  assert(ring.popBatch(out, 8) == 4);
+  assert(out[0] == 2 && out[1] == 3 && out[2] == 4 && out[3] == 5);
+  assert(ring.popBatch(out, 8) == 0);
+
+  // Wrap-around without eviction
+  for (int round = 0; round < 10; ++round) {
+    assert(ring.tryPushEvict(round, evicted) && !evicted);
+    assert(ring.tryPush(round + 100));
+    assert(ring.popBatch(out, 1) == 1 && out[0] == round);
+    assert(ring.popBatch(out, 8) == 1 && out[0] == round + 100);
+  }
+
+  // Concurrent producer evicting against a consumer: whatever arrives is
+  // strictly increasing and the counts add up
+  SpscEvictingRing<int> shared(64);
+  const int total = 200000;
+  int evictions = 0;
+  int rejected = 0;
+  std::atomic<bool> producer_done(false);
+  std::thread producer([&]() {
+    for (int i = 0; i < total; ++i) {
+      bool e = false;
+      if (!shared.tryPushEvict(i, e)) ++rejected;
+      if (e) ++evictions;
+    }
+    producer_done.store(true, std::memory_order_release);
+  });
+  int received = 0;
+  int last = -1;
+  while (true) {
+    const bool finished = producer_done.load(std::memory_order_acquire);
+    const size_t n = shared.popBatch(out, 8);
+    for (size_t k = 0; k < n; ++k) {
+      assert(out[k] > last);
+      last = out[k];
+    }
+    received += static_cast<int>(n);
+    if (n == 0 && finished) break;
+  }
+  producer.join();
+  assert(received + evictions + rejected == total);
+}
+
+// -----------------------------------------------------------------------------
+// Test 2: Every sample is evaluated and published in order
+// -----------------------------------------------------------------------------
+static void test_publish_all() {
+  ReadinessAPIState state;
+  IngestConfig cfg;
+  cfg.overflow = OverflowPolicy::BLOCK;
+  cfg.queue_capacity = 64;
+  IngestPipeline pipeline(PhaseReadinessConfig{}, &state, nullptr, cfg);
+  assert(pipeline.queueCapacity() == 64);
+  assert(pipeline.start());
+  assert(!pipeline.start());
+
+  const int n = 5000;
+  for (int i = 0; i < n; ++i) {
+    assert(pipeline.submit(make_signal(i)));
+  }
+  pipeline.stop();
+  assert(!pipeline.isRunning());
+
+  assert(pipeline.submittedCount() == static_cast<uint64_t>(n));
+  assert(pipeline.evaluatedCount() == static_cast<uint64_t>(n));
+  assert(pipeline.droppedOldestCount() == 0 && pipeline.droppedNewestCount() == 0);
+  assert(pipeline.overflowGapCount() == 0);
+  assert(state.getSequence() == static_cast<uint64_t>(n));
+  assert(state.metrics().updatesTotal() == static_cast<uint64_t>(n));
+
+  // Same outputs as evaluating inline
+  PhaseReadinessMiddleware mw(PhaseReadinessConfig{});
+  PhaseReadinessOutput expected;
+  for (int i = 0; i < n; ++i) expected = mw.evaluate(make_signal(i));
+  const ReadinessSnapshot last = state.getCurrentSnapshot();
+  assert(last.t_s == make_signal(n - 1).t_s);
+  assert(last.readiness == expected.readiness && last.flags == expected.flags);
+
+  // BLOCK never waits forever once the evaluator is gone
+  IngestPipeline idle(PhaseReadinessConfig{}, nullptr, nullptr, cfg);
+  for (int i = 0; i < 64; ++i) assert(idle.submit(make_signal(i)));
+  assert(!idle.submit(make_signal(64)));
+  assert(idle.blockedCount() == 1 && idle.droppedNewestCount() == 1);
+}
+
+// -----------------------------------------------------------------------------
+// Test 3: Drop policies count drops and flag the gap
+// -----------------------------------------------------------------------------
+static void test_overflow_policies() {
+  // Evaluator not started, so the queue fills deterministically
+  for (OverflowPolicy policy : {OverflowPolicy::DROP_OLDEST, OverflowPolicy::DROP_NEWEST}) {
+    ReadinessAPIState state;
+    IngestConfig cfg;
+    cfg.overflow = policy;
+    cfg.queue_capacity = 16;
+    IngestPipeline pipeline(PhaseReadinessConfig{}, &state, nullptr, cfg);
+
+    for (int i = 0; i < 40; ++i) {
+      const bool queued = pipeline.submit(make_signal(i));
+      assert(queued == (policy == OverflowPolicy::DROP_OLDEST || i < 16));
+    }
+    assert(pipeline.queueDepth() == 16);
+    if (policy == OverflowPolicy::DROP_OLDEST) {
+      assert(pipeline.droppedOldestCount() == 24 && pipeline.droppedNewestCount() == 0);
+    } else {
+      assert(pipeline.droppedNewestCount() == 24 && pipeline.droppedOldestCount() == 0);
+    }
+
+    assert(pipeline.start());
+    pipeline.stop();
+    assert(pipeline.evaluatedCount() == 16);
+    assert(pipeline.maxQueueDepth() == 16);
+
+    // DROP_OLDEST kept samples 24..39: the first output after the gap is
+    // flagged. DROP_NEWEST kept 0..15: no gap yet, so nothing is flagged
+    // until the next accepted sample.
+    const std::vector<ReadinessSnapshot> history = state.getHistory(100);
+    assert(history.size() == 16);
+    if (policy == OverflowPolicy::DROP_OLDEST) {
+      assert(history.front().t_s == make_signal(24).t_s);
+      assert(history.front().flags & FLAG_INGEST_OVERFLOW);
+      assert(pipeline.overflowGapCount() == 1);
+    } else {
+      assert(history.back().t_s == make_signal(15).t_s);
+      assert(pipeline.overflowGapCount() == 0);
+      assert(pipeline.start());
+      assert(pipeline.submit(make_signal(40)));
+      pipeline.stop();
+      assert(state.getCurrentSnapshot().flags & FLAG_INGEST_OVERFLOW);
+      assert(pipeline.overflowGapCount() == 1);
+    }
+    for (size_t i = 1; i < 16; ++i) {
+      assert(!(history[i].flags & FLAG_INGEST_OVERFLOW));
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Test 4: Pinning and metrics exposition
+// -----------------------------------------------------------------------------
+static void test_pinning_and_metrics() {
+  ReadinessAPIState state;
+  IngestConfig cfg;
+#if defined(__linux__)
+  cfg.evaluator_cpu = sched_getcpu();   // A CPU this process may run on
+#endif
+  IngestPipeline pipeline(PhaseReadinessConfig{}, &state, nullptr, cfg);
+  assert(pipeline.start());
+  for (int i = 0; i < 100; ++i) pipeline.submit(make_signal(i));
+  pipeline.stop();
+#if defined(__linux__)
+  assert(pipeline.isPinned());
+#endif
+
+  RestAPIServer server(state);
+  server.setMetricsHook([&pipeline](std::ostream& out) { pipeline.render(out); });
+  int status = 0;
+  const std::string body = server.renderBody("/metrics", &status);
+  assert(status == 200);
+  assert(body.find("hlv_ingest_submitted_total 100") != std::string::npos);
+  assert(body.find("hlv_ingest_evaluated_total 100") != std::string::npos);
+  assert(body.find("hlv_ingest_dropped_total{policy=\"drop_oldest\"} 0") != std::string::npos);
+  assert(body.find("hlv_ingest_queue_depth 0") != std::string::npos);
+  assert(body.find("hlv_flag_samples_total{flag=\"ingest_overflow\"} 0") != std::string::npos);
+  assert(std::string(overflowPolicyToString(OverflowPolicy::DROP_NEWEST)) == "drop_newest");
+}
+
+// -----------------------------------------------------------------------------
+// Test 5: updateBatch() matches update() sample for sample
+// -----------------------------------------------------------------------------
+static void test_update_batch() {
+  ReadinessAPIState single;
+  ReadinessAPIState batched;
+  PhaseReadinessMiddleware mw(PhaseReadinessConfig{});
+  std::vector<ReadinessUpdate> updates;
+  for (int i = 0; i < 300; ++i) {
+    const PhaseSignals s = make_signal(i);
+    const PhaseReadinessOutput out = mw.evaluate(s);
+    single.update(s, out);
+    updates.push_back(ReadinessUpdate{s, out});
+  }
+  batched.updateBatch(updates.data(), 0);
+  assert(batched.getSequence() == 0);
+  for (size_t i = 0; i < updates.size(); i += 128) {
+    batched.updateBatch(updates.data() + i, std::min<size_t>(128, updates.size() - i));
+  }
+  assert(single.getSequence() == 300 && batched.getSequence() == 3);
+  assert(batched.metrics().updatesTotal() == 300);
+
+  const std::vector<ReadinessSnapshot> a = single.getHistory(100);
+  const std::vector<ReadinessSnapshot> b = batched.getHistory(100);
+  assert(a.size() == 100 && b.size() == 100);
+  for (size_t i = 0; i < a.size(); ++i) {
+    assert(a[i].t_s == b[i].t_s && a[i].readiness == b[i].readiness);
+    assert(a[i].flags == b[i].flags && a[i].trend_C == b[i].trend_C);
+  }
+  assert(single.getTransitions(-1e9, 1e9, 100).size() == batched.getTransitions(-1e9, 1e9, 100).size());
+}
+
+// -----------------------------------------------------------------------------
+// Test 6: Publication stage applies every update in order, in batches
+// -----------------------------------------------------------------------------
+static void test_publication_stage() {
+  ReadinessAPIState state;
+  PublicationConfig cfg;
+  cfg.queue_capacity = 1024;
+  cfg.batch_size = 32;
+  PublicationStage stage(state, nullptr, cfg);
+
+  // Queued before start(): applied once the publisher runs
+  PhaseReadinessMiddleware mw(PhaseReadinessConfig{});
+  const int n = 1000;
+  for (int i = 0; i < n; ++i) {
+    const PhaseSignals s = make_signal(i);
+    assert(stage.publish(s, mw.evaluate(s)));
+  }
+  assert(stage.queueDepth() == static_cast<size_t>(n));
+  assert(stage.start());
+  stage.stop();
+  assert(stage.appliedCount() == static_cast<uint64_t>(n) && stage.droppedCount() == 0);
+  assert(stage.batchCount() >= static_cast<uint64_t>(n / 32));
+  assert(state.getSequence() == stage.batchCount());
+  assert(state.metrics().updatesTotal() == static_cast<uint64_t>(n));
+  assert(state.getCurrentSnapshot().t_s == make_signal(n - 1).t_s);
+
+  const std::vector<ReadinessSnapshot> history = state.getHistory(100);
+  for (size_t i = 0; i < history.size(); ++i) {
+    assert(history[i].t_s == make_signal(n - 100 + static_cast<int>(i)).t_s);
+  }
+
+  // Full queue: the update is dropped, never waited for
+  PublicationConfig tiny;
+  tiny.queue_capacity = 4;
+  PublicationStage idle(state, nullptr, tiny);
+  for (int i = 0; i < 4; ++i) assert(idle.publish(make_signal(i), PhaseReadinessOutput{}));
+  assert(!idle.publish(make_signal(4), PhaseReadinessOutput{}));
+  assert(idle.droppedCount() == 1 && idle.publishedCount() == 4);
+
+  // Ingest pipeline evaluating into a publication stage
+  ReadinessAPIState chained;
+  PublicationStage publication(chained);
+  IngestConfig ingest;
+  ingest.overflow = OverflowPolicy::BLOCK;
+  IngestPipeline pipeline(PhaseReadinessConfig{}, publication, ingest);
+  assert(publication.start() && pipeline.start());
+  for (int i = 0; i < n; ++i) assert(pipeline.submit(make_signal(i)));
+  pipeline.stop();
+  publication.stop();
+  assert(publication.appliedCount() == static_cast<uint64_t>(n));
+  assert(chained.getCurrentSnapshot().readiness == state.getCurrentSnapshot().readiness);
+  assert(chained.getCurrentSnapshot().t_s == make_signal(n - 1).t_s);
+
+  std::ostringstream metrics;
+  publication.render(metrics);
+  assert(metrics.str().find("hlv_publish_applied_total 1000") != std::string::npos);
+}
+
+int main() {
+  std::cout << "Running ingest pipeline tests...\n";
+
+  test_evicting_ring();
+  test_publish_all();
+  test_overflow_policies();
+  test_pinning_and_metrics();
+  test_update_batch();
+  test_publication_stage();
+
+  std::cout << "[PASS] All ingest pipeline tests passed!\n";
+  return 0;
+}
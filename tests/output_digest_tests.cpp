@@ -0,0 +1,198 @@
+#include "hlv/output_digest.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace hlv;
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+// Outputs from a 64-bit LCG: integer arithmetic and exact conversions only,
+// so the stream (and its digest) is the same on every platform
+static std::vector<PhaseReadinessOutput> make_outputs(size_t n) {
+  std::vector<PhaseReadinessOutput> out(n);
+  uint64_t x = 0x2545F4914F6CDD1DULL;
+  for (size_t i = 0; i < n; ++i) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    out[i].readiness = static_cast<double>(x >> 11) / 9007199254740992.0;
+    out[i].stability_score = out[i].readiness;
+    out[i].gate = static_cast<Gate>((x >> 7) % 3);
+    out[i].flags = static_cast<uint32_t>(x >> 40) & 0x1FF;
+    out[i].dTdt_C_per_s = static_cast<double>(static_cast<int32_t>(x >> 20)) / 1048576.0;
+    out[i].trend_C = 20.0 + static_cast<double>((x >> 3) & 0xFFFF) / 256.0;
+  }
+  return out;
+}
+
+static DigestLog make_log(const std::vector<PhaseReadinessOutput>& outputs, uint64_t block) {
+  DigestLog log(block);
+  for (const PhaseReadinessOutput& out : outputs) log.add(out);
+  return log;
+}
+
+static std::string temp_path(const char* name) {
+  return "/tmp/hlv_digest_test_" + std::to_string(getpid()) + "_" + name;
+}
+
+// -----------------------------------------------------------------------------
+// Test 1: Digest is canonical and covers every field
+// -----------------------------------------------------------------------------
+static void test_digest_value() {
+  const std::vector<PhaseReadinessOutput> outputs = make_outputs(10000);
+  OutputDigest d;
+  const uint64_t empty = d.value();
+  for (const PhaseReadinessOutput& out : outputs) d.add(out);
+  assert(d.count() == outputs.size());
+  // Pinned: a change here breaks comparisons against digests recorded by
+  // earlier builds and needs a new format version
+  assert(d.value() == 0x20581dfce9d16338ULL);
+  assert(d.value() != empty);
+
+  d.reset();
+  assert(d.value() == empty && d.count() == 0);
+
+  // stability_score is not part of the digest; every other field is
+  OutputDigest base;
+  base.add(outputs[0]);
+  PhaseReadinessOutput out = outputs[0];
+  out.stability_score += 1.0;
+  OutputDigest same;
+  same.add(out);
+  assert(same == base && same.value() == base.value());
+
+  for (int field = 0; field < 5; ++field) {
+    out = outputs[0];
+    switch (field) {
+      case 0: out.readiness = std::nextafter(out.readiness, 2.0); break;
+      case 1: out.gate = static_cast<Gate>((static_cast<int>(out.gate) + 1) % 3); break;
+      case 2: out.flags ^= FLAG_INGEST_OVERFLOW; break;
+      case 3: out.dTdt_C_per_s = -out.dTdt_C_per_s; break;
+      case 4: out.trend_C = std::nextafter(out.trend_C, 0.0); break;
+    }
+    OutputDigest changed;
+    changed.add(out);
+    assert(changed != base && changed.value() != base.value());
+  }
+
+  // Signed zeros differ, and order matters
+  PhaseReadinessOutput pz, nz;
+  pz.dTdt_C_per_s = 0.0;
+  nz.dTdt_C_per_s = -0.0;
+  OutputDigest a, b;
+  a.add(pz);
+  b.add(nz);
+  assert(a.value() != b.value());
+  a.add(nz);
+  b.add(pz);
+  assert(a.value() != b.value());
+  std::cout << "[PASS] Digest value\n";
+}
+
+// -----------------------------------------------------------------------------
+// Test 2: Checkpoints and write/read round trip
+// -----------------------------------------------------------------------------
+static void test_log_roundtrip() {
+  const std::vector<PhaseReadinessOutput> outputs = make_outputs(1000);
+  const DigestLog log = make_log(outputs, 64);
+  assert(log.count() == 1000 && log.checkpoints().size() == 1000 / 64);
+
+  OutputDigest prefix;
+  for (size_t i = 0; i < 128; ++i) prefix.add(outputs[i]);
+  assert(log.checkpoints()[1] == prefix.value());
+
+  const std::string path = temp_path("roundtrip.digest");
+  assert(log.write(path));
+  DigestLog loaded;
+  std::string error;
+  assert(loaded.read(path, &error));
+  assert(loaded.blockSamples() == 64 && loaded.count() == 1000 && loaded.value() == log.value());
+  assert(loaded.checkpoints() == log.checkpoints());
+
+  // A loaded log restarts when fed again
+  loaded.add(outputs[0]);
+  assert(loaded.count() == 1 && loaded.checkpoints().empty());
+
+  {
+    std::ofstream bad(path);
+    bad << "hlvdigest 1 block=64 samples=1000 digest=0\n0123\n";
+  }
+  assert(!loaded.read(path, &error) && !error.empty());
+  {
+    std::ofstream bad(path);
+    bad << "HLVTRACE\n";
+  }
+  assert(!loaded.read(path, &error));
+  assert(!loaded.read(temp_path("missing.digest"), &error));
+  std::remove(path.c_str());
+  std::cout << "[PASS] Digest log round trip\n";
+}
+
+// -----------------------------------------------------------------------------
+// Test 3: Bisecting finds the divergent block
+// -----------------------------------------------------------------------------
+static void test_find_divergence() {
+  const uint64_t block = 100;
+  const std::vector<PhaseReadinessOutput> base = make_outputs(100000);
+  const DigestLog a = make_log(base, block);
+
+  DigestDivergence d = findDivergence(a, make_log(base, block));
+  assert(d.comparable && d.equal && d.first_sample == base.size());
+
+  // One flipped bit in the middle
+  std::vector<PhaseReadinessOutput> other = base;
+  other[61234].flags ^= 1u;
+  d = findDivergence(a, make_log(other, block));
+  assert(d.comparable && !d.equal);
+  assert(d.first_sample == 61200 && d.end_sample == 61300);
+  // O(log n) checkpoint comparisons: 1000 checkpoints -> at most 11
+  assert(d.comparisons <= 11);
+
+  // In the final partial block
+  other = base;
+  other.resize(99950);
+  const DigestLog partial = make_log(other, block);
+  other.back().readiness = -1.0;
+  d = findDivergence(partial, make_log(other, block));
+  assert(!d.equal && d.first_sample == 99900 && d.end_sample == 99950);
+
+  // One stream is a prefix of the other
+  d = findDivergence(a, partial);
+  assert(!d.equal && d.first_sample == 99900 && d.end_sample == 99951);
+  other = base;
+  other.resize(50000);
+  d = findDivergence(make_log(other, block), a);
+  assert(!d.equal && d.first_sample == 50000 && d.end_sample == 50001);
+
+  // Logs read from disk compare like live ones
+  other = base;
+  other[7].gate = other[7].gate == Gate::ALLOW ? Gate::BLOCK : Gate::ALLOW;
+  const std::string path = temp_path("bisect.digest");
+  assert(make_log(other, block).write(path));
+  DigestLog loaded;
+  assert(loaded.read(path));
+  d = findDivergence(loaded, a);
+  assert(!d.equal && d.first_sample == 0 && d.end_sample == 100);
+  std::remove(path.c_str());
+
+  d = findDivergence(a, make_log(base, block * 2));
+  assert(!d.comparable && !d.equal);
+  std::cout << "[PASS] Divergence search\n";
+}
+
+int main() {
+  std::cout << "Running output digest tests...\n";
+
+  test_digest_value();
+  test_log_roundtrip();
+  test_find_divergence();
+
+  std::cout << "[PASS] All output digest tests passed!\n";
+  return 0;
+}
@@ -1,3 +1,4 @@
+#include "hlv/output_digest.hpp"
 #include "hlv/phase_readiness.hpp"
 
 #include <cassert>
@@ -153,6 +154,43 @@ static void test_determinism() {
   assert(out1.flags == out2.flags);
   assert(std::fabs(out1.readiness - out2.readiness) < 1e-9);
   assert(std::fabs(out1.dTdt_C_per_s - out2.dTdt_C_per_s) < 1e-9);
+
+  // Long run through every flag path, pinned by its OutputDigest. Inputs
+  // come from integer arithmetic and exact conversions only (no libm), so
+  // the expected value holds on every platform; a mismatch means
+  // evaluate() rounds differently in this build (e.g. FMA contraction
+  // under -march=native, or x87 excess precision) or its semantics
+  // changed.
+  PhaseReadinessConfig cfg;
+  cfg.max_abs_dTdt_C_per_s = 0.2;
+  PhaseReadinessMiddleware long1(cfg);
+  PhaseReadinessMiddleware long2(cfg);
+  OutputDigest d1, d2;
+  uint32_t seen_flags = 0;
+  uint64_t x = 0x9E3779B97F4A7C15ULL;
+  int64_t temp_q = 25 * 128;   // Temperature in 1/128 °C
+  for (int i = 0; i < 500000; ++i) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    // Random walk in steps of up to 3/128 °C per 0.1 s: noisy stretches
+    // alternate with steady heating and cooling runs long enough to trip
+    // the persistence flags, plus rare large jumps and range excursions
+    const int64_t phase = (i / 2000) % 4;
+    const int64_t noise = static_cast<int64_t>((x >> 33) % 3) - 1;
+    temp_q += phase == 1 ? 2 : (phase == 3 ? -2 : noise * 3);
+    if ((x >> 20) % 1009 == 0) temp_q += 4 * 128;
+    if (temp_q > 64 * 128 || temp_q < -24 * 128) temp_q = 25 * 128;
+    PhaseSignals s = make_valid_signal(i * 0.1, static_cast<double>(temp_q) / 128.0);
+    s.hysteresis_index = (x >> 40) % 211 == 0 ? 0.9 : 0.1;
+    s.coherence_index = (x >> 48) % 97 == 0 ? 0.2 : 0.9;
+    s.valid = (x >> 12) % 4999 != 0;
+    const PhaseReadinessOutput out = long1.evaluate(s);
+    seen_flags |= out.flags;
+    d1.add(out);
+    d2.add(long2.evaluate(s));
+  }
+  assert(d1 == d2);
+  assert(seen_flags == (0xFFu | FLAG_FAILSAFE_DEFAULT));   // Every flag evaluate() sets
+  assert(d1.value() == 0x5f775a905e90ab50ULL);
 }
 
 // -----------------------------------------------------------------------------
@@ -390,6 +428,71 @@ static void test_gate_threshold_configurability() {
   auto out_def = mw_def.evaluate(s);
   assert(out_def.gate == Gate::CAUTION);
 }
+
+// -----------------------------------------------------------------------------
+// Test 20: Interned compiled policies
+// -----------------------------------------------------------------------------
+static void test_compiled_policy_interning() {
+  PhaseReadinessConfig a;
+  PhaseReadinessConfig b;
+  b.gate_allow_threshold = 0.9;
+  PhaseReadinessConfig nan_cfg;
+  nan_cfg.persistence_s = std::numeric_limits<double>::quiet_NaN();
+
+  // One shared instance per distinct config, NaN fields included
+  assert(CompiledPolicy::intern(a) == CompiledPolicy::intern(PhaseReadinessConfig{}));
+  assert(CompiledPolicy::intern(a) != CompiledPolicy::intern(b));
+  assert(CompiledPolicy::intern(nan_cfg) == CompiledPolicy::intern(nan_cfg));
+  // Middlewares built from a config own their policy (shared by copies)
+  // and leave the intern table alone
+  const size_t count = CompiledPolicy::internedCount();
+  PhaseReadinessConfig c;
+  c.gate_allow_threshold = 0.95;
+  PhaseReadinessMiddleware m1(c);
+  PhaseReadinessMiddleware m2(c);
+  const PhaseReadinessMiddleware m1_copy = m1;
+  assert(&m1.policy() != &m2.policy() && &m1_copy.policy() == &m1.policy());
+  assert(m1.policy().config.gate_allow_threshold == 0.95);
+  assert(CompiledPolicy::internedCount() == count);
+
+  // Invalid configs are sanitized once, at compile time
+  const CompiledPolicy* sanitized = CompiledPolicy::intern(nan_cfg);
+  assert(!sanitized->valid && sanitized->config.persistence_s == 3.0);
+  assert(sanitized->max_trend_age_s == 6.0);
+  assert(!PhaseReadinessMiddleware(sanitized).configValid());
+
+  // Per-channel state fits one cache line
+  static_assert(sizeof(PhaseReadinessMiddleware) == 64, "middleware must be one cache line");
+
+  // Sharing a policy does not share state, and matches an owned config
+  PhaseReadinessMiddleware shared(CompiledPolicy::intern(b));
+  PhaseReadinessMiddleware owned(b);
+  PhaseReadinessMiddleware other(CompiledPolicy::intern(b));
+  other.evaluate(make_valid_signal(0.0, 30.0));
+  for (int i = 0; i < 20; ++i) {
+    const PhaseSignals s = make_valid_signal(i * 0.1, 25.0 + i * 0.01);
+    const PhaseReadinessOutput x = shared.evaluate(s);
+    const PhaseReadinessOutput y = owned.evaluate(s);
+    assert(x.readiness == y.readiness && x.gate == y.gate && x.flags == y.flags);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Test 21: Flag name table covers every flag bit once, in bit order
+// -----------------------------------------------------------------------------
+static void test_flag_names() {
+  uint32_t all = 0;
+  for (size_t i = 0; i < kPhaseFlagCount; ++i) {
+    const uint32_t flag = kPhaseFlagNames[i].flag;
+    assert(flag != 0 && (flag & (flag - 1)) == 0 && (all & flag) == 0);
+    assert(i == 0 || flag > kPhaseFlagNames[i - 1].flag);
+    all |= flag;
+  }
+  assert(all == (FLAG_INPUT_INVALID | FLAG_STALE_OR_NONMONO | FLAG_TEMP_OUT_OF_RANGE | FLAG_GRADIENT_TOO_HIGH |
+                 FLAG_PERSISTENT_HEATING | FLAG_PERSISTENT_COOLING | FLAG_HYSTERESIS_HIGH | FLAG_COHERENCE_LOW |
+                 FLAG_INGEST_OVERFLOW | FLAG_FAILSAFE_DEFAULT));
+}
+
 int main() {
   std::cout << "Running Phase Readiness Middleware tests...\n";
 
@@ -412,6 +515,8 @@ int main() {
   test_stability_score_consistency();
   test_config_validation();
   test_gate_threshold_configurability();
+  test_compiled_policy_interning();
+  test_flag_names();
 
   std::cout << "[PASS] All Phase Readiness Middleware tests passed!\n";
   return 0;
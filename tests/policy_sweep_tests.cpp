@@ -0,0 +1,182 @@
+#include "hlv/phase_readiness.hpp"
+#include "hlv/policy_sweep.hpp"
+#include "hlv/trace.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace hlv;
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+// A stream that warms up, drifts through every flag, jumps, goes stale,
+// drops out and carries non-finite indices, so every path is exercised
+static std::vector<PhaseSignals> make_stream(int n) {
+  std::vector<PhaseSignals> out;
+  for (int i = 0; i < n; ++i) {
+    PhaseSignals s;
+    s.t_s = i * 0.1 + (i % 211 == 210 ? 3.0 : 0.0) + (i / 211) * 3.0;
+    s.temp_C = 25.0 + 0.01 * i + std::sin(i * 0.03) * 2.0 + (i % 97 == 0 ? 7.0 : 0.0) +
+               (i > n / 2 ? 50.0 : 0.0) * (i % 400 < 20 ? 1.0 : 0.0);
+    s.temp_ambient_C = 22.0;
+    s.coherence_index = i % 37 == 0 ? std::numeric_limits<double>::quiet_NaN() : 0.3 + 0.2 * std::cos(i * 0.07);
+    s.hysteresis_index = i % 13 == 0 ? 0.9 : (i % 29 == 0 ? std::numeric_limits<double>::infinity() : 0.2);
+    s.valid = i % 53 != 0;
+    out.push_back(s);
+  }
+  return out;
+}
+
+static SweepAxes make_axes() {
+  SweepAxes axes;
+  axes.max_abs_dTdt_C_per_s = {0.05, 0.25, 1.0};
+  axes.persistence_s = {0.5, 3.0};
+  axes.ewma_alpha = {0.05, 0.2, 0.9, 1.5};        // 1.5 is invalid and sanitized
+  axes.gate_allow_threshold = {0.6, 0.8};
+  axes.gate_caution_threshold = {0.3, 0.75};      // 0.75 >= 0.6 is invalid
+  return axes;
+}
+
+// Reference: one scalar middleware per config
+static std::vector<SweepResult> reference(const PhaseReadinessConfig& baseline,
+                                          const std::vector<PhaseReadinessConfig>& configs,
+                                          const std::vector<PhaseSignals>& stream) {
+  PhaseReadinessMiddleware base(baseline);
+  std::vector<Gate> base_gates;
+  for (const PhaseSignals& s : stream) base_gates.push_back(base.evaluate(s).gate);
+
+  std::vector<SweepResult> out(configs.size());
+  for (size_t k = 0; k < configs.size(); ++k) {
+    PhaseReadinessMiddleware mw(configs[k]);
+    Gate prev = Gate::BLOCK;
+    for (size_t i = 0; i < stream.size(); ++i) {
+      const Gate g = mw.evaluate(stream[i]).gate;
+      ++out[k].gate_counts[static_cast<size_t>(g)];
+      out[k].transitions += g != prev;
+      out[k].disagreements += g != base_gates[i];
+      prev = g;
+    }
+  }
+  return out;
+}
+
+static void assert_same(const SweepResult& a, const SweepResult& b) {
+  for (size_t g = 0; g < 3; ++g) assert(a.gate_counts[g] == b.gate_counts[g]);
+  assert(a.transitions == b.transitions);
+  assert(a.disagreements == b.disagreements);
+}
+
+// -----------------------------------------------------------------------------
+// Test 1: Grid expansion
+// -----------------------------------------------------------------------------
+static void test_grid() {
+  PhaseReadinessConfig base;
+  base.temp_max_C = 55.0;
+  const std::vector<PhaseReadinessConfig> grid = PolicySweep::grid(base, make_axes());
+  assert(grid.size() == 3 * 2 * 4 * 2 * 2);
+  assert(grid[0].max_abs_dTdt_C_per_s == 0.05 && grid[0].gate_caution_threshold == 0.3);
+  assert(grid[1].gate_caution_threshold == 0.75 && grid[1].gate_allow_threshold == 0.6);
+  assert(grid[2].gate_allow_threshold == 0.8);
+  assert(grid.back().max_abs_dTdt_C_per_s == 1.0 && grid.back().ewma_alpha == 1.5);
+  for (const PhaseReadinessConfig& cfg : grid) assert(cfg.temp_max_C == 55.0);
+  assert(PolicySweep::grid(base, SweepAxes()).size() == 1);
+  std::cout << "[PASS] Grid expansion\n";
+}
+
+// -----------------------------------------------------------------------------
+// Test 2: Sweep results equal one scalar middleware per config
+// -----------------------------------------------------------------------------
+static void test_matches_scalar() {
+  PhaseReadinessConfig baseline;
+  std::vector<PhaseReadinessConfig> configs = PolicySweep::grid(baseline, make_axes());
+  configs.pop_back();   // Odd count: exercises the padding lane
+  const std::vector<PhaseSignals> stream = make_stream(5000);
+  const std::vector<SweepResult> want = reference(baseline, configs, stream);
+
+  PolicySweepOptions options;
+  options.threads = 1;
+  options.block_samples = 333;
+  PolicySweep sweep(baseline, configs, options);
+  assert(sweep.size() == configs.size());
+  assert(configs[12].ewma_alpha == 1.5 && sweep.config(12).ewma_alpha != 1.5);   // Sanitized
+  // Two calls continue the same stream
+  sweep.run(stream.data(), 1234);
+  sweep.run(stream.data() + 1234, stream.size() - 1234);
+  assert(sweep.samples() == stream.size());
+
+  uint64_t disagreeing_configs = 0;
+  for (size_t k = 0; k < configs.size(); ++k) {
+    assert_same(sweep.result(k), want[k]);
+    disagreeing_configs += sweep.result(k).disagreements > 0;
+  }
+  assert(disagreeing_configs > 0 && disagreeing_configs < configs.size());
+  const SweepResult r = sweep.result(0);
+  assert(std::fabs(r.occupancy(Gate::BLOCK, sweep.samples()) + r.occupancy(Gate::CAUTION, sweep.samples()) +
+                   r.occupancy(Gate::ALLOW, sweep.samples()) - 1.0) < 1e-12);
+
+  sweep.reset();
+  sweep.run(stream.data(), stream.size());
+  for (size_t k = 0; k < configs.size(); ++k) assert_same(sweep.result(k), want[k]);
+  std::cout << "[PASS] Sweep matches scalar middlewares\n";
+}
+
+// -----------------------------------------------------------------------------
+// Test 3: Worker threads and trace input
+// -----------------------------------------------------------------------------
+static void test_threads_and_trace() {
+  PhaseReadinessConfig baseline;
+  baseline.gate_allow_threshold = 0.7;
+  const std::vector<PhaseReadinessConfig> configs = PolicySweep::grid(PhaseReadinessConfig(), make_axes());
+  const std::vector<PhaseSignals> stream = make_stream(3000);
+
+  const std::string path = "/tmp/hlv_sweep_test_" + std::to_string(getpid()) + ".trace";
+  TraceWriter writer;
+  assert(writer.open(path, baseline, false, 256));
+  for (const PhaseSignals& s : stream) assert(writer.append(s));
+  assert(writer.close());
+  TraceReader reader;
+  assert(reader.open(path));
+
+  PolicySweepOptions single;
+  PolicySweep one(baseline, configs, single);
+  one.run(stream.data(), stream.size());
+
+  PolicySweepOptions parallel = single;
+  parallel.threads = 3;
+  PolicySweep many(baseline, configs, parallel);
+  many.run(reader);
+  assert(many.samples() == stream.size());
+  for (size_t k = 0; k < configs.size(); ++k) assert_same(many.result(k), one.result(k));
+
+  // The baseline state carries over between calls with several workers
+  many.reset();
+  many.run(stream.data(), 1000);
+  many.run(stream.data() + 1000, stream.size() - 1000);
+  for (size_t k = 0; k < configs.size(); ++k) assert_same(many.result(k), one.result(k));
+
+  PolicySweep empty(baseline, std::vector<PhaseReadinessConfig>(), parallel);
+  empty.run(stream.data(), stream.size());
+  assert(empty.size() == 0 && empty.samples() == stream.size());
+
+  reader.close();
+  std::remove(path.c_str());
+  std::cout << "[PASS] Worker threads and trace input\n";
+}
+
+int main() {
+  std::cout << "Running policy sweep tests...\n";
+
+  test_grid();
+  test_matches_scalar();
+  test_threads_and_trace();
+
+  std::cout << "[PASS] All policy sweep tests passed!\n";
+  return 0;
+}
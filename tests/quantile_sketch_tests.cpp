@@ -0,0 +1,141 @@
+#include "hlv/quantile_sketch.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+using namespace hlv;
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+
+// Normalized rank of `value` in sorted `data` (midpoint of ties)
+static double rank_of(const std::vector<double>& sorted, double value) {
+  const auto lo = std::lower_bound(sorted.begin(), sorted.end(), value);
+  const auto hi = std::upper_bound(sorted.begin(), sorted.end(), value);
+  const double mid = 0.5 * static_cast<double>((lo - sorted.begin()) + (hi - sorted.begin()));
+  return mid / static_cast<double>(sorted.size());
+}
+
+static std::vector<double> make_values(size_t n, uint64_t seed) {
+  std::vector<double> values;
+  values.reserve(n);
+  uint64_t lcg = seed;
+  for (size_t i = 0; i < n; ++i) {
+    lcg = lcg * 6364136223846793005ull + 1442695040888963407ull;
+    // Skewed, with a slow drift so order matters
+    const double u = static_cast<double>(lcg >> 11) / 9007199254740992.0;
+    values.push_back(u * u * 10.0 + 0.001 * static_cast<double>(i % 5000));
+  }
+  return values;
+}
+
+// -----------------------------------------------------------------------------
+// Test 1: Quantiles stay within the documented rank error
+// -----------------------------------------------------------------------------
+static void test_rank_error() {
+  const double eps = KllSketch::rankError(200);
+  assert(eps > 0.01 && eps < 0.015);
+
+  for (size_t n : {size_t(50), size_t(10000), size_t(1000000)}) {
+    const std::vector<double> values = make_values(n, 42 + n);
+    KllSketch sketch;
+    for (double v : values) sketch.add(v);
+    assert(sketch.count() == n);
+    assert(sketch.retained() <= 3 * 200 + 64);
+
+    std::vector<double> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+    assert(sketch.min() == sorted.front() && sketch.max() == sorted.back());
+    assert(sketch.quantile(0.0) == sorted.front() && sketch.quantile(1.0) == sorted.back());
+    for (double q : {0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99}) {
+      assert(std::fabs(rank_of(sorted, sketch.quantile(q)) - q) <= eps);
+    }
+  }
+
+  KllSketch empty;
+  assert(std::isnan(empty.quantile(0.5)));
+  empty.add(std::numeric_limits<double>::quiet_NaN());
+  assert(empty.count() == 0);
+}
+
+// -----------------------------------------------------------------------------
+// Test 2: Merging matches one sketch over the concatenated stream
+// -----------------------------------------------------------------------------
+static void test_merge() {
+  const std::vector<double> values = make_values(200000, 7);
+  KllSketch parts[4];
+  for (size_t i = 0; i < values.size(); ++i) parts[i % 4].add(values[i]);
+  KllSketch merged;
+  for (const auto& p : parts) merged.merge(p);
+  assert(merged.count() == values.size());
+  assert(merged.retained() <= 3 * 200 + 64);
+
+  std::vector<double> sorted = values;
+  std::sort(sorted.begin(), sorted.end());
+  const double eps = KllSketch::rankError(200);
+  for (double q : {0.05, 0.5, 0.95}) {
+    assert(std::fabs(rank_of(sorted, merged.quantile(q)) - q) <= eps);
+  }
+
+  // Same input, same sketch
+  KllSketch a, b;
+  for (double v : values) {
+    a.add(v);
+    b.add(v);
+  }
+  assert(a.quantile(0.5) == b.quantile(0.5) && a.retained() == b.retained());
+}
+
+// -----------------------------------------------------------------------------
+// Test 3: Sliding windows rotate on t_s
+// -----------------------------------------------------------------------------
+static void test_windows() {
+  WindowedQuantiles w(2, {{10.0, 5}, {60.0, 6}});
+  assert(w.windowCount() == 2 && w.fieldCount() == 2);
+  assert(w.findWindow(60.0) == 1 && w.findWindow(30.0) == -1);
+
+  // 100 Hz for 120 s; field 0 is t_s itself, field 1 a constant
+  for (int i = 0; i < 12000; ++i) {
+    const double t = i * 0.01;
+    const double values[2] = {t, 3.0};
+    w.add(t, values);
+  }
+
+  // 10 s window, 2 s panes: [110, 120) with the current pane [118, 120)
+  const KllSketch recent = w.sketch(0, 0);
+  assert(recent.count() == 1000);
+  assert(recent.min() >= 109.99 && recent.max() == 11999 * 0.01);
+  assert(std::fabs(recent.quantile(0.5) - 115.0) < 10.0 * 0.02);
+
+  const KllSketch minute = w.sketch(1, 0);
+  assert(minute.count() == 6000 && minute.min() >= 59.99);
+  assert(w.sketch(1, 1).quantile(0.95) == 3.0);
+
+  // A gap longer than the window empties it except for the new sample
+  const double late[2] = {500.0, 1.0};
+  w.add(500.0, late);
+  assert(w.sketch(0, 0).count() == 1 && w.sketch(1, 1).quantile(0.5) == 1.0);
+
+  // Non-finite time is ignored
+  w.add(std::numeric_limits<double>::quiet_NaN(), late);
+  assert(w.sketch(0, 0).count() == 1);
+  w.clear();
+  assert(w.sketch(1, 0).count() == 0);
+}
+
+int main() {
+  std::cout << "Running quantile sketch tests...\n";
+
+  test_rank_error();
+  test_merge();
+  test_windows();
+
+  std::cout << "[PASS] All quantile sketch tests passed!\n";
+  return 0;
+}
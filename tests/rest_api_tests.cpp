@@ -1,14 +1,71 @@
+#include "hlv/channel_registry.hpp"
+#include "hlv/indexed_heap.hpp"
+#include "hlv/instrumentation.hpp"
 #include "hlv/phase_readiness.hpp"
 #include "hlv/rest_api_server.hpp"
 
+#include <arpa/inet.h>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <algorithm>
 #include <thread>
+#include <unistd.h>
+#include <vector>
+
+#ifdef HLV_WITH_ZLIB
+#include <zlib.h>
+#endif
 
 using namespace hlv;
 
+// Helper: send a raw HTTP request to the loopback server, return full response
+static std::string http_request(uint16_t port, const std::string& request) {
+  int sock = socket(AF_INET, SOCK_STREAM, 0);
+  if (sock < 0) return std::string();
+  
+  struct sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+  
+  if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    close(sock);
+    return std::string();
+  }
+  send(sock, request.data(), request.size(), 0);
+  
+  std::string response;
+  char buffer[4096];
+  ssize_t n;
+  while ((n = recv(sock, buffer, sizeof(buffer), 0)) > 0) {
+    response.append(buffer, static_cast<size_t>(n));
+  }
+  close(sock);
+  return response;
+}
+
+static std::string http_get(uint16_t port, const std::string& path, const std::string& headers = "") {
+  return http_request(port, "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n" + headers + "\r\n");
+}
+
+static std::string response_headers(const std::string& response) {
+  return response.substr(0, response.find("\r\n\r\n"));
+}
+
+static std::string response_body(const std::string& response) {
+  size_t pos = response.find("\r\n\r\n");
+  return pos == std::string::npos ? std::string() : response.substr(pos + 4);
+}
+
 // Test 1: ReadinessAPIState basic functionality
 static void test_api_state_basic() {
   ReadinessAPIState state;
@@ -243,6 +300,914 @@ static void test_max_history_size_min_enforcement() {
   assert(history.back().t_s == 2.0);
 }
 
+// Test 8: gzip/deflate negotiation and per-sequence compressed body caching
+static void test_history_compression() {
+  ReadinessAPIState state;
+  state.setMaxHistorySize(500);
+  for (int i = 0; i < 500; ++i) {
+    PhaseSignals signals;
+    signals.t_s = i * 0.01;
+    signals.temp_C = 25.0;
+    signals.valid = true;
+    
+    PhaseReadinessOutput output;
+    output.readiness = 1.0;
+    output.gate = Gate::ALLOW;
+    state.update(signals, output);
+  }
+  
+  RestAPIConfig config;
+  config.port = 8082;
+  config.history_max_samples = 500;
+  RestAPIServer server(state, config);
+  if (!server.start()) {
+    return; // Port in use; nothing to verify
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  
+  const std::string plain = http_get(config.port, "/api/history");
+  const std::string gz1 = http_get(config.port, "/api/history", "Accept-Encoding: gzip, deflate\r\n");
+  const std::string gz2 = http_get(config.port, "/api/history", "Accept-Encoding: gzip, deflate\r\n");
+  const std::string small = http_get(config.port, "/health", "Accept-Encoding: gzip\r\n");
+  const std::string refused = http_get(config.port, "/api/history", "Accept-Encoding: gzip;q=0\r\n");
+  server.stop();
+  
+  assert(response_headers(plain).find("Content-Encoding") == std::string::npos);
+  assert(response_headers(small).find("Content-Encoding") == std::string::npos);
+  assert(response_headers(refused).find("Content-Encoding") == std::string::npos);
+  assert(response_body(plain).find("\"count\": 500") != std::string::npos);
+  
+#ifdef HLV_WITH_ZLIB
+  assert(response_headers(gz1).find("Content-Encoding: gzip") != std::string::npos);
+  assert(response_body(gz1) == response_body(gz2)); // Served from cache
+  
+  const std::string compressed = response_body(gz1);
+  assert(compressed.size() * 10 < response_body(plain).size());
+  
+  std::string inflated(response_body(plain).size(), '\0');
+  z_stream zs;
+  std::memset(&zs, 0, sizeof(zs));
+  assert(inflateInit2(&zs, 15 + 16) == Z_OK);
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+  zs.avail_in = static_cast<uInt>(compressed.size());
+  zs.next_out = reinterpret_cast<Bytef*>(&inflated[0]);
+  zs.avail_out = static_cast<uInt>(inflated.size());
+  assert(inflate(&zs, Z_FINISH) == Z_STREAM_END);
+  inflateEnd(&zs);
+  assert(inflated == response_body(plain));
+#else
+  assert(response_headers(gz1).find("Content-Encoding") == std::string::npos);
+  assert(response_body(gz1) == response_body(plain));
+  (void)gz2;
+#endif
+}
+
+// Helper: extract a header value from a raw response ("" if absent)
+static std::string header_value(const std::string& response, const std::string& name) {
+  const std::string headers = response_headers(response);
+  size_t pos = headers.find("\r\n" + name + ": ");
+  if (pos == std::string::npos) return std::string();
+  pos += name.size() + 4;
+  return headers.substr(pos, headers.find("\r\n", pos) - pos);
+}
+
+// Test 9: ETag / If-None-Match conditional responses
+static void test_conditional_requests() {
+  ReadinessAPIState state;
+  PhaseSignals signals;
+  signals.t_s = 1.0;
+  signals.temp_C = 25.0;
+  signals.valid = true;
+  PhaseReadinessOutput output;
+  output.readiness = 0.9;
+  output.gate = Gate::ALLOW;
+  state.update(signals, output);
+  
+  RestAPIConfig config;
+  config.port = 8083;
+  RestAPIServer server(state, config);
+  if (!server.start()) {
+    return; // Port in use; nothing to verify
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  
+  const std::string first = http_get(config.port, "/api/readiness");
+  const std::string etag = header_value(first, "ETag");
+  assert(!etag.empty());
+  assert(header_value(first, "Cache-Control") == "no-cache");
+  
+  // Different projection of the same sequence gets a different tag
+  const std::string thermal = http_get(config.port, "/api/thermal");
+  assert(header_value(thermal, "ETag") != etag);
+  
+  // Unchanged state: 304 with no body
+  const std::string revalidated = http_get(config.port, "/api/readiness", "If-None-Match: " + etag + "\r\n");
+  assert(revalidated.compare(0, 12, "HTTP/1.1 304") == 0);
+  assert(response_body(revalidated).empty());
+  assert(header_value(revalidated, "ETag") == etag);
+  
+  // State advanced: full response with a new tag
+  signals.t_s = 2.0;
+  state.update(signals, output);
+  const std::string changed = http_get(config.port, "/api/readiness", "If-None-Match: " + etag + "\r\n");
+  assert(changed.compare(0, 12, "HTTP/1.1 200") == 0);
+  assert(header_value(changed, "ETag") != etag);
+  assert(response_body(changed).find("\"timestamp_s\": 2.0") != std::string::npos);
+  
+  // Errors are never tagged
+  const std::string missing = http_get(config.port, "/api/nope", "If-None-Match: *\r\n");
+  assert(missing.compare(0, 12, "HTTP/1.1 404") == 0);
+  assert(header_value(missing, "ETag").empty());
+  assert(header_value(missing, "Cache-Control") == "no-store");
+  
+  server.stop();
+}
+
+// Test 10: Prometheus counters and /metrics exposition
+static void test_metrics_endpoint() {
+  ReadinessAPIState state;
+  PhaseSignals signals;
+  signals.t_s = 1.0;
+  signals.temp_C = 25.0;
+  signals.valid = true;
+  
+  PhaseReadinessOutput output;
+  output.gate = Gate::ALLOW;
+  output.flags = FLAG_NONE;
+  state.update(signals, output);
+  output.gate = Gate::BLOCK;
+  output.flags = FLAG_HYSTERESIS_HIGH | FLAG_FAILSAFE_DEFAULT;
+  state.update(signals, output);
+  state.update(signals, output);
+  state.metrics().recordEvaluateLatency(120);
+  
+  const ReadinessMetrics& m = state.metrics();
+  assert(m.updatesTotal() == 3);
+  assert(m.gateTotal(Gate::ALLOW) == 1);
+  assert(m.gateTotal(Gate::BLOCK) == 2);
+  assert(m.flagTotal(6) == 2);
+  assert(m.failsafeTotal() == 2);
+  
+  // The rate gauge falls to 0 once the loop stops, not stuck at its last value
+  ReadinessMetrics rate;
+  assert(rate.updateRateHz() == 0.0);
+  const auto now = std::chrono::steady_clock::now();
+  for (int i = 0; i <= 100; ++i) {
+    rate.recordUpdate(output, now - std::chrono::milliseconds(1010 - 10 * i));
+  }
+  assert(rate.updateRateHz() > 90.0 && rate.updateRateHz() < 110.0);
+  ReadinessMetrics stalled;
+  for (int i = 0; i <= 100; ++i) {
+    stalled.recordUpdate(output, now - std::chrono::milliseconds(5000 - 10 * i));
+  }
+  assert(stalled.updateRateHz() == 0.0);
+  
+  RestAPIConfig config;
+  config.port = 8084;
+  RestAPIServer server(state, config);
+  if (!server.start()) {
+    return; // Port in use; nothing to verify
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  
+  http_get(config.port, "/api/readiness");
+  const std::string scrape = http_get(config.port, "/metrics");
+  server.stop();
+  
+  assert(header_value(scrape, "Content-Type") == "text/plain; version=0.0.4");
+  assert(header_value(scrape, "ETag").empty()); // Server counters move between updates
+  const std::string body = response_body(scrape);
+  assert(body.find("hlv_updates_total 3\n") != std::string::npos);
+  assert(body.find("hlv_gate_samples_total{gate=\"BLOCK\"} 2\n") != std::string::npos);
+  assert(body.find("hlv_flag_samples_total{flag=\"hysteresis_high\"} 2\n") != std::string::npos);
+  assert(body.find("hlv_failsafe_total 2\n") != std::string::npos);
+  assert(body.find("hlv_evaluate_latency_seconds_bucket{le=\"2.5e-07\"} 1\n") != std::string::npos);
+  assert(body.find("hlv_evaluate_latency_seconds_count 1\n") != std::string::npos);
+  assert(body.find("hlv_http_requests_total{endpoint=\"/api/readiness\",code=\"2xx\"} 1\n") != std::string::npos);
+}
+
+// Test 11: Log-linear histogram accuracy and instrumentation reporting
+static void test_latency_instrumentation() {
+  // Bucket bounds are exact below 32 and within 1/32 relative error above
+  LogLinearHistogram h;
+  for (uint64_t v = 1; v <= 1000; ++v) {
+    h.record(v * 100);
+  }
+  assert(h.count() == 1000);
+  assert(h.max() == 100000);
+  const double p50 = static_cast<double>(h.valueAtQuantile(0.50));
+  const double p99 = static_cast<double>(h.valueAtQuantile(0.99));
+  assert(p50 >= 50000.0 && p50 <= 50000.0 * (1.0 + 1.0 / 32.0));
+  assert(p99 >= 99000.0 && p99 <= 99000.0 * (1.0 + 1.0 / 32.0));
+  assert(h.valueAtQuantile(1.0) == 100000);
+  for (uint64_t v : {0ull, 1ull, 31ull, 32ull, 1000ull, 123456789ull, ~0ull}) {
+    const size_t idx = LogLinearHistogram::bucketIndex(v);
+    assert(idx < LogLinearHistogram::kBucketCount);
+    assert(LogLinearHistogram::bucketUpperBound(idx) >= v);
+  }
+  
+  // Probes fire only in HLV_ENABLE_INSTRUMENTATION builds
+  resetInstrumentation();
+  PhaseReadinessMiddleware mw(PhaseReadinessConfig{});
+  ReadinessAPIState state;
+  for (int i = 0; i < 100; ++i) {
+    PhaseSignals signals;
+    signals.t_s = i * 0.1;
+    signals.temp_C = 25.0;
+    signals.valid = true;
+    state.update(signals, mw.evaluate(signals));
+  }
+  // A batch is one sample of its own probe, not of the per-update one
+  std::vector<ReadinessUpdate> batch(16);
+  for (size_t i = 0; i < batch.size(); ++i) {
+    batch[i].signals.t_s = 10.0 + i * 0.1;
+    batch[i].signals.temp_C = 25.0;
+    batch[i].signals.valid = true;
+    batch[i].output = mw.evaluate(batch[i].signals);
+  }
+  state.updateBatch(batch.data(), batch.size());
+  const LatencySummary eval = latencySummary(LatencyProbe::EVALUATE);
+  const LatencySummary upd = latencySummary(LatencyProbe::API_UPDATE);
+  const LatencySummary upd_batch = latencySummary(LatencyProbe::API_UPDATE_BATCH);
+  if (instrumentationEnabled()) {
+    assert(eval.count == 116 && upd.count == 100 && upd_batch.count == 1);
+    assert(eval.p50_ns <= eval.p99_ns && eval.p99_ns <= eval.p999_ns && eval.p999_ns <= eval.max_ns);
+  } else {
+    assert(eval.count == 0 && upd.count == 0 && upd_batch.count == 0);
+  }
+  
+  // Diagnostics carry the latency percentiles when instrumented, which
+  // change without a state update: then they are neither tagged nor served
+  // from the compressed cache, and a poller sees every new probe sample
+  RestAPIConfig config;
+  config.port = 8089;
+  config.compression_min_bytes = 0;
+  RestAPIServer server(state, config);
+  if (!server.start()) {
+    return; // Port in use; nothing to verify
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  const std::string first = http_get(config.port, "/api/diagnostics");
+  const std::string etag = header_value(first, "ETag");
+  assert(instrumentationEnabled() == etag.empty());
+  PhaseSignals signals;
+  signals.t_s = 100.0;
+  signals.temp_C = 25.0;
+  signals.valid = true;
+  mw.evaluate(signals);   // Probe sample without a state update
+  const std::string again = http_get(config.port, "/api/diagnostics", "If-None-Match: " + etag + "\r\n");
+  if (instrumentationEnabled()) {
+    assert(again.compare(0, 12, "HTTP/1.1 200") == 0 && header_value(again, "ETag").empty());
+    assert(response_body(again).find("\"count\": 117") != std::string::npos);
+    const std::string gz1 = http_get(config.port, "/api/diagnostics", "Accept-Encoding: gzip\r\n");
+    mw.evaluate(signals);
+    const std::string gz2 = http_get(config.port, "/api/diagnostics", "Accept-Encoding: gzip\r\n");
+    assert(header_value(gz1, "Content-Encoding") != "gzip" || response_body(gz1) != response_body(gz2));
+  } else {
+    assert(again.compare(0, 12, "HTTP/1.1 304") == 0);
+  }
+  server.stop();
+}
+
+// Test 12: Time-window history served from the compressed tier
+static void test_history_time_window() {
+  ReadinessAPIState state;
+  state.setMaxHistorySize(10);
+  CompressedHistoryConfig history_cfg;
+  history_cfg.max_samples = 100000;
+  history_cfg.block_samples = 64;
+  state.setCompressedHistory(history_cfg);
+  
+  PhaseReadinessMiddleware mw(PhaseReadinessConfig{});
+  for (int i = 0; i < 1000; ++i) {
+    PhaseSignals signals;
+    signals.t_s = i * 0.1;
+    signals.temp_C = 25.0 + 0.01 * (i % 3);
+    signals.valid = true;
+    state.update(signals, mw.evaluate(signals));
+  }
+  
+  // Older than the deque holds, bit-exact from the compressed tier
+  auto window = state.getHistoryRange(10.0, 19.95, 1000);
+  assert(window.size() == 100);
+  assert(window.front().t_s == 100 * 0.1);
+  assert(window.back().t_s == 199 * 0.1);
+  assert(window[1].temp_C == 25.0 + 0.01 * (101 % 3));
+  assert(state.getCompressedHistoryStats().samples == 1000);
+  
+  RestAPIConfig config;
+  config.history_max_samples = 5;
+  RestAPIServer server(state, config);
+  int status = 0;
+  std::string body = server.renderBody("/api/history?from_t=10&to_t=19.95", &status);
+  assert(status == 200);
+  assert(body.find("\"count\": 5") != std::string::npos);
+  assert(body.find("\"timestamp_s\": 19.900000") != std::string::npos);
+  assert(body.find("\"timestamp_s\": 20.000000") == std::string::npos);
+  
+  server.renderBody("/api/history?from_t=abc", &status);
+  assert(status == 400);
+  server.renderBody("/api/history?from_t=5&to_t=1", &status);
+  assert(status == 400);
+  
+  // Without the compressed tier the window comes from the deque
+  ReadinessAPIState recent;
+  PhaseReadinessOutput out;
+  for (int i = 0; i < 20; ++i) {
+    PhaseSignals signals;
+    signals.t_s = i;
+    recent.update(signals, out);
+  }
+  assert(recent.getHistoryRange(15.0, 100.0, 100).size() == 5);
+  assert(recent.getCompressedHistoryStats().samples == 0);
+}
+
+// Test 13: Rollup endpoint
+static void test_history_rollup_endpoint() {
+  ReadinessAPIState state;
+  PhaseReadinessOutput out;
+  out.readiness = 1.0;
+  out.gate = Gate::ALLOW;
+  for (int i = 0; i < 250; ++i) {
+    PhaseSignals signals;
+    signals.t_s = i * 0.1;
+    if (i >= 200) {
+      out.readiness = 0.0;
+      out.gate = Gate::BLOCK;
+      out.flags = FLAG_HYSTERESIS_HIGH;
+    }
+    state.update(signals, out);
+  }
+  
+  std::vector<RollupBucket> buckets;
+  assert(state.getRollup(10.0, 0.0, 100.0, buckets));
+  assert(buckets.size() == 3);
+  assert(buckets[0].samples == 100 && buckets[0].dwellFraction(Gate::ALLOW) == 1.0);
+  assert(buckets[2].partial && buckets[2].samples == 50);
+  assert(!state.getRollup(7.0, 0.0, 100.0, buckets));
+  
+  RestAPIServer server(state);
+  int status = 0;
+  std::string body = server.renderBody("/api/history/rollup?resolution=10s", &status);
+  assert(status == 200);
+  assert(body.find("\"count\": 3") != std::string::npos);
+  assert(body.find("\"dwell\": {\"ALLOW\": 0.000000, \"CAUTION\": 0.000000, \"BLOCK\": 1.000000}") != std::string::npos);
+  assert(body.find("\"flags\": 64") != std::string::npos);
+  
+  body = server.renderBody("/api/history/rollup?resolution=1min", &status);
+  assert(status == 200 && body.find("\"count\": 1") != std::string::npos);
+  body = server.renderBody("/api/history/rollup?resolution=1s&from_t=5&to_t=6.5", &status);
+  assert(status == 200 && body.find("\"count\": 2") != std::string::npos);
+  
+  body = server.renderBody("/api/history/rollup?resolution=7s", &status);
+  assert(status == 400 && body.find("1s, 10s, 60s") != std::string::npos);
+  server.renderBody("/api/history/rollup?resolution=abc", &status);
+  assert(status == 400);
+}
+
+static void test_stats_endpoint() {
+  ReadinessAPIState state;
+  state.setMaxHistorySize(1000);
+  for (int i = 0; i < 40; ++i) {
+    PhaseSignals signals;
+    signals.t_s = i * 0.5;
+    PhaseReadinessOutput out;
+    out.readiness = i < 30 ? 0.8 : 0.2;
+    out.gate = i < 30 ? Gate::ALLOW : Gate::BLOCK;
+    out.flags = i < 30 ? FLAG_NONE : FLAG_GRADIENT_TOO_HIGH;
+    out.dTdt_C_per_s = i < 30 ? 0.1 : -2.5;
+    state.update(signals, out);
+  }
+  
+  const HistoryStats stats = state.getHistoryStats(10.0, 19.5);
+  assert(stats.count == 20 && stats.first_t_s == 10.0 && stats.last_t_s == 19.5);
+  assert(stats.gate_samples[static_cast<size_t>(Gate::BLOCK)] == 10);
+  assert(stats.flag_samples[3] == 10);
+  
+  RestAPIServer server(state);
+  int status = 0;
+  std::string body = server.renderBody("/api/stats?from_t=10&to_t=19.5", &status);
+  assert(status == 200);
+  assert(body.find("\"count\": 20") != std::string::npos);
+  assert(body.find("\"readiness\": {\"min\": 0.200000, \"max\": 0.800000, \"mean\": 0.500000}") != std::string::npos);
+  assert(body.find("\"max_abs\": 2.500000") != std::string::npos);
+  assert(body.find("\"BLOCK\": {\"samples\": 10, \"fraction\": 0.500000}") != std::string::npos);
+  assert(body.find("\"gradient_too_high\": 10") != std::string::npos);
+  
+  body = server.renderBody("/api/stats", &status);
+  assert(status == 200 && body.find("\"count\": 40") != std::string::npos);
+  body = server.renderBody("/api/stats?from_t=100", &status);
+  assert(status == 200 && body.find("\"count\": 0") != std::string::npos);
+  assert(body.find("\"first_t_s\": null") != std::string::npos);
+  server.renderBody("/api/stats?from_t=5&to_t=1", &status);
+  assert(status == 400);
+  
+  // Sliding-window quantiles cover all 40 samples in the 1 min window
+  const WindowedQuantiles quantiles = state.getQuantiles();
+  assert(quantiles.windowCount() == 3 && quantiles.findWindow(60.0) == 1);
+  assert(quantiles.sketch(1, 0).count() == 40 && quantiles.sketch(1, 1).quantile(0.05) == -2.5);
+  body = server.renderBody("/api/stats?window=1min", &status);
+  assert(status == 200);
+  assert(body.find("{\"window_s\": 60.000000, \"count\": 40") != std::string::npos);
+  assert(body.find("\"readiness\": {\"p5\": 0.200000, \"p50\": 0.800000, \"p95\": 0.800000}") != std::string::npos);
+  assert(body.find("\"window_s\": 10.000000") == std::string::npos);
+  body = server.renderBody("/api/stats?window=30s", &status);
+  assert(status == 400 && body.find("10s, 60s, 600s") != std::string::npos);
+}
+
+static void test_history_flag_filter() {
+  ReadinessAPIState state;
+  for (int i = 0; i < 60; ++i) {
+    PhaseSignals signals;
+    signals.t_s = i * 1.0;
+    PhaseReadinessOutput out;
+    out.gate = i < 40 ? Gate::ALLOW : Gate::CAUTION;
+    out.flags = (i % 3 == 0 ? FLAG_HYSTERESIS_HIGH : FLAG_NONE) | (i % 5 == 0 ? FLAG_TEMP_OUT_OF_RANGE : FLAG_NONE);
+    state.update(signals, out);
+  }
+  
+  // Hysteresis high but temperature in range: multiples of 3, not of 15
+  HistoryFilter filter;
+  filter.flags_all = FLAG_HYSTERESIS_HIGH;
+  filter.flags_none = FLAG_TEMP_OUT_OF_RANGE;
+  std::vector<ReadinessSnapshot> hits = state.getHistoryRange(-1e300, 1e300, 1000, filter);
+  assert(hits.size() == 16);
+  for (const auto& s : hits) assert(static_cast<int>(s.t_s) % 3 == 0 && static_cast<int>(s.t_s) % 15 != 0);
+  
+  // The compressed tier answers the same query through its block index
+  CompressedHistoryConfig compressed;
+  compressed.max_samples = 100000;
+  compressed.block_samples = 16;
+  state.setCompressedHistory(compressed);
+  for (int i = 60; i < 120; ++i) {
+    PhaseSignals signals;
+    signals.t_s = i * 1.0;
+    PhaseReadinessOutput out;
+    out.gate = Gate::BLOCK;
+    out.flags = (i % 3 == 0 ? FLAG_HYSTERESIS_HIGH : FLAG_NONE) | (i % 5 == 0 ? FLAG_TEMP_OUT_OF_RANGE : FLAG_NONE);
+    state.update(signals, out);
+  }
+  hits = state.getHistoryRange(-1e300, 1e300, 1000, filter);
+  assert(hits.size() == 16 && hits.front().t_s == 63.0 && hits.back().t_s == 117.0);
+  
+  RestAPIServer server(state);
+  int status = 0;
+  std::string body = server.renderBody("/api/history?flags_all=FLAG_HYSTERESIS_HIGH&flags_none=temp_out_of_range", &status);
+  assert(status == 200 && body.find("\"count\": 16") != std::string::npos);
+  body = server.renderBody("/api/history?flags_all=0x40&from_t=100", &status);
+  assert(status == 200 && body.find("\"count\": 6") != std::string::npos);
+  body = server.renderBody("/api/history?flags_all=hysteresis_high,temp_out_of_range&gate=block", &status);
+  assert(status == 200 && body.find("\"count\": 4") != std::string::npos);
+  body = server.renderBody("/api/history?gate=ALLOW,CAUTION", &status);
+  assert(status == 200 && body.find("\"count\": 0") != std::string::npos);
+  
+  server.renderBody("/api/history?flags_all=not_a_flag", &status);
+  assert(status == 400);
+  server.renderBody("/api/history?gate=GREEN", &status);
+  assert(status == 400);
+}
+
+static void test_transitions_endpoint() {
+  ReadinessAPIState state;
+  PhaseReadinessOutput out;
+  for (int i = 0; i <= 300; ++i) {
+    PhaseSignals signals;
+    signals.t_s = i * 1.0;
+    out.gate = i < 200 ? Gate::ALLOW : (i < 250 ? Gate::BLOCK : Gate::CAUTION);
+    state.update(signals, out);
+  }
+  
+  const DwellState dwell = state.getDwellState();
+  assert(dwell.valid && dwell.gate == Gate::CAUTION && dwell.gateDwell() == 50.0);
+  assert(dwell.timeSince(Gate::ALLOW) == 100.0);
+  assert(state.getTransitionCount(60.0) == 1 && state.getTransitionCount(1000.0) == 2);
+  
+  RestAPIServer server(state);
+  int status = 0;
+  std::string body = server.renderBody("/api/phase_context", &status);
+  assert(status == 200);
+  assert(body.find("\"gate_dwell_s\": 50.000000") != std::string::npos);
+  assert(body.find("\"time_since_allow_s\": 100.000000") != std::string::npos);
+  assert(body.find("\"transitions_in_window\": 1") != std::string::npos);
+  
+  body = server.renderBody("/api/transitions?window=2min", &status);
+  assert(status == 200);
+  assert(body.find("\"transitions_total\": 2") != std::string::npos);
+  assert(body.find("\"transitions_in_window\": 2") != std::string::npos);
+  assert(body.find("\"time_since_s\": {\"ALLOW\": 100.000000, \"CAUTION\": 0.000000, \"BLOCK\": 50.000000}") != std::string::npos);
+  assert(body.find("\"count\": 3") != std::string::npos);
+  assert(body.find("{\"start_s\": 200.000000, \"end_s\": 249.000000, \"duration_s\": 49.000000, \"gate\": \"BLOCK\", \"flags\": 0, \"samples\": 50}") != std::string::npos);
+  
+  body = server.renderBody("/api/transitions?from_t=260", &status);
+  assert(status == 200 && body.find("\"count\": 1") != std::string::npos);
+  server.renderBody("/api/transitions?window=soon", &status);
+  assert(status == 400);
+}
+
+static void test_channel_registry() {
+  ChannelRegistry channels(4, 50);
+  assert(channels.size() == 4);
+  assert(channels.channel(4) == nullptr);
+  
+  // One writer thread per channel, no shared lock
+  std::vector<std::thread> writers;
+  for (size_t id = 0; id < channels.size(); ++id) {
+    writers.emplace_back([&channels, id]() {
+      PhaseReadinessOutput out;
+      out.gate = id == 2 ? Gate::BLOCK : Gate::ALLOW;
+      out.readiness = 0.1 * static_cast<double>(id + 1);
+      for (int i = 0; i < 200; ++i) {
+        PhaseSignals signals;
+        signals.t_s = i * 0.01;
+        signals.temp_C = 20.0 + static_cast<double>(id);
+        signals.valid = true;
+        channels.update(id, signals, out);
+      }
+    });
+  }
+  for (auto& w : writers) w.join();
+  PhaseSignals signals;
+  assert(!channels.update(9, signals, PhaseReadinessOutput{}));
+  
+  for (size_t id = 0; id < channels.size(); ++id) {
+    const ReadinessAPIState& state = *channels.channel(id);
+    assert(state.metrics().updatesTotal() == 200);
+    assert(state.getHistory(1000).size() == 50);
+    assert(state.getCurrentSnapshot().temp_C == 20.0 + static_cast<double>(id));
+  }
+  
+  ReadinessAPIState primary;
+  RestAPIServer server(primary);
+  int status = 0;
+  server.renderBody("/api/channels/0/readiness", &status);
+  assert(status == 404); // No registry attached
+  server.setChannelRegistry(&channels);
+  
+  std::string body = server.renderBody("/api/channels", &status);
+  assert(status == 200 && body.find("\"count\": 4") != std::string::npos);
+  assert(body.find("{\"id\": 2, \"readiness\": 0.300000, \"gate\": \"BLOCK\"") != std::string::npos);
+  
+  body = server.renderBody("/api/channels/2/readiness", &status);
+  assert(status == 200 && body.find("\"gate\": \"BLOCK\"") != std::string::npos);
+  body = server.renderBody("/api/channels/1/thermal", &status);
+  assert(status == 200 && body.find("21.0") != std::string::npos);
+  body = server.renderBody("/api/channels/3/history?limit=5", &status);
+  assert(status == 200);
+  server.renderBody("/api/channels/0/diagnostics", &status);
+  assert(status == 200);
+  
+  // The primary state is untouched
+  assert(primary.metrics().updatesTotal() == 0);
+  
+  server.renderBody("/api/channels/4/readiness", &status);
+  assert(status == 404);
+  server.renderBody("/api/channels/0/stats", &status);
+  assert(status == 404);
+  server.renderBody("/api/channels/x/readiness", &status);
+  assert(status == 404);
+  server.renderBody("/api/channels/0/readiness/extra", &status);
+  assert(status == 404);
+  
+  // Placement keeps per-channel configuration made before it
+  ChannelRegistry placed(4, 20);
+  ReadinessAPIState& configured = *placed.channel(1);
+  CompressedHistoryConfig compressed;
+  compressed.max_samples = 5000;
+  compressed.block_samples = 256;
+  configured.setCompressedHistory(compressed);
+  configured.setRollupLevels({{2.0, 30}});
+  configured.setQuantileWindows({{5.0, 5}});
+  configured.setTransitionLogSize(16);
+  assert(placed.placeChannels(0, 4));
+  const ReadinessStateConfig kept = placed.channel(1)->configuration();
+  assert(kept.max_history_size == 20 && kept.transition_log_size == 16);
+  assert(kept.compressed_history.max_samples == 5000 && kept.compressed_history.block_samples == 256);
+  assert(kept.rollup_levels.size() == 1 && kept.rollup_levels[0].resolution_s == 2.0 &&
+         kept.rollup_levels[0].capacity == 30);
+  assert(kept.quantile_windows.size() == 1 && kept.quantile_windows[0].window_s == 5.0);
+  assert(placed.channel(1)->getRollupResolutions() == std::vector<double>{2.0});
+  placed.update(1, signals, PhaseReadinessOutput{});
+  assert(placed.channel(1)->getCompressedHistoryStats().samples == 1);   // Tier still enabled
+  const ReadinessStateConfig plain = placed.channel(2)->configuration();
+  assert(plain.max_history_size == 20 && plain.compressed_history.max_samples == 0);
+  assert(plain.rollup_levels.size() == defaultRollupLevels().size());
+}
+
+static void test_gate_aggregation() {
+  // Against a brute-force scan of random updates and ranges
+  const size_t n = 37;
+  GateAggregationTree tree(n);
+  assert(tree.root().channels == 0 && !tree.root().anyBlocked());
+  std::vector<GateSummary> leaves(n);
+  std::srand(42);
+  for (int step = 0; step < 2000; ++step) {
+    const size_t id = static_cast<size_t>(std::rand()) % n;
+    const Gate gate = static_cast<Gate>(std::rand() % 3);
+    const double readiness = (std::rand() % 101) / 100.0;
+    const uint32_t flags = 1u << (std::rand() % 9);
+    tree.update(id, readiness, gate, flags);
+    leaves[id] = GateSummary::channel(id, readiness, gate, flags);
+    
+    const size_t first = static_cast<size_t>(std::rand()) % n;
+    const size_t count = 1 + static_cast<size_t>(std::rand()) % (n - first);
+    GateSummary expected;
+    for (size_t i = first; i < first + count; ++i) {
+      expected = GateSummary::combine(expected, leaves[i]);
+    }
+    const GateSummary got = tree.range(first, count);
+    assert(got.channels == expected.channels);
+    assert(got.min_channel == expected.min_channel);
+    assert(!got.hasMin() || got.min_readiness == expected.min_readiness);
+    assert(got.channels == 0 || got.worst_gate == expected.worst_gate);
+    assert(got.flags == expected.flags);
+    for (Gate g : {Gate::ALLOW, Gate::CAUTION, Gate::BLOCK}) {
+      assert(got.count(g) == expected.count(g));
+    }
+  }
+  assert(tree.range(0, n).channels == tree.root().channels);
+  assert(tree.range(n, 5).channels == 0);
+  
+  // Non-finite readiness never becomes the minimum
+  GateAggregationTree single(1);
+  single.update(0, std::nan(""), Gate::BLOCK, FLAG_INPUT_INVALID);
+  assert(single.root().channels == 1 && !single.root().hasMin());
+  assert(single.root().anyBlocked());
+}
+
+static void test_channel_summary() {
+  ChannelRegistry channels(8);
+  assert(!channels.setGroups({{"shank_a", 0, 4}, {"shank_a", 4, 4}}));
+  assert(!channels.setGroups({{"shank_a", 6, 4}}));
+  assert(channels.setGroups({{"shank_a", 0, 4}, {"shank_b", 4, 4}}));
+  
+  PhaseSignals signals;
+  PhaseReadinessOutput out;
+  for (size_t id = 0; id < channels.size(); ++id) {
+    out.readiness = 0.5 + 0.05 * static_cast<double>(id);
+    out.gate = Gate::ALLOW;
+    out.flags = FLAG_NONE;
+    channels.update(id, signals, out);
+  }
+  out.readiness = 0.1;
+  out.gate = Gate::BLOCK;
+  out.flags = FLAG_GRADIENT_TOO_HIGH;
+  channels.update(6, signals, out);
+  
+  const GateSummary all = channels.summary();
+  assert(all.channels == 8 && all.min_channel == 6 && all.min_readiness == 0.1);
+  assert(all.worst_gate == Gate::BLOCK && all.count(Gate::ALLOW) == 7);
+  assert(all.flags == FLAG_GRADIENT_TOO_HIGH);
+  GateSummary group;
+  assert(channels.groupSummary("shank_a", group) && !group.anyBlocked() && group.min_channel == 0);
+  assert(channels.groupSummary("shank_b", group) && group.anyBlocked());
+  assert(!channels.groupSummary("shank_c", group));
+  
+  // Recovery is reflected in the next update
+  out.readiness = 0.9;
+  out.gate = Gate::ALLOW;
+  out.flags = FLAG_NONE;
+  channels.update(6, signals, out);
+  assert(!channels.summary().anyBlocked() && channels.summary().min_channel == 0);
+  
+  ReadinessAPIState primary;
+  RestAPIServer server(primary);
+  int status = 0;
+  std::string body = server.renderBody("/api/summary", &status);
+  assert(status == 200 && body.find("\"channels_total\": 0") != std::string::npos);
+  server.setChannelRegistry(&channels);
+  body = server.renderBody("/api/summary", &status);
+  assert(status == 200);
+  assert(body.find("\"array\": {\"channels\": 8, \"min_readiness\": 0.500000, \"min_channel\": 0, "
+                   "\"worst_gate\": \"ALLOW\", \"any_blocked\": false") != std::string::npos);
+  assert(body.find("{\"name\": \"shank_b\", \"first\": 4, \"count\": 4, \"channels\": 4") != std::string::npos);
+  body = server.renderBody("/api/summary?group=shank_a", &status);
+  assert(status == 200 && body.find("shank_b") == std::string::npos);
+  server.renderBody("/api/summary?group=nope", &status);
+  assert(status == 404);
+  
+  // Writers of disjoint ranges update concurrently with a summary reader;
+  // every completed update is in the next summary
+  ChannelRegistry array(4 * 300);
+  std::atomic<bool> done(false);
+  std::thread reader([&]() {
+    while (!done.load(std::memory_order_acquire)) {
+      const GateSummary s = array.summary();
+      assert(s.channels <= array.size() && s.count(Gate::BLOCK) <= 4);
+    }
+  });
+  std::vector<std::thread> writers;
+  for (size_t w = 0; w < 4; ++w) {
+    writers.emplace_back([&array, w]() {
+      PhaseSignals sig;
+      PhaseReadinessOutput o;
+      for (int round = 0; round < 20; ++round) {
+        for (size_t id = w * 300; id < (w + 1) * 300; ++id) {
+          sig.t_s = round;
+          o.readiness = 0.5 + 0.001 * static_cast<double>(id % 300) - 0.01 * round;
+          o.gate = id % 300 == 7 && round == 19 ? Gate::BLOCK : Gate::ALLOW;
+          array.update(id, sig, o);
+        }
+      }
+    });
+  }
+  for (std::thread& t : writers) t.join();
+  done.store(true, std::memory_order_release);
+  reader.join();
+  const GateSummary final_summary = array.summary();
+  assert(final_summary.channels == array.size() && final_summary.count(Gate::BLOCK) == 4);
+  assert(final_summary.min_channel == 0 && final_summary.min_readiness == 0.5 - 0.01 * 19);
+  assert(array.worstChannels(4, ChannelRankBy::BLOCK_DWELL).size() == 4);
+}
+
+static void test_indexed_heap() {
+  // Against a sorted copy after random set/erase
+  const size_t n = 50;
+  IndexedMinHeap heap(n);
+  std::vector<double> keys(n, std::nan(""));
+  std::vector<std::pair<size_t, double>> top;
+  std::srand(7);
+  for (int step = 0; step < 3000; ++step) {
+    const size_t id = static_cast<size_t>(std::rand()) % n;
+    if (std::rand() % 4 == 0) {
+      heap.erase(id);
+      keys[id] = std::nan("");
+    } else {
+      keys[id] = (std::rand() % 20) * 0.05;   // Plenty of ties
+      heap.set(id, keys[id]);
+    }
+    
+    std::vector<std::pair<double, size_t>> expected;
+    for (size_t i = 0; i < n; ++i) {
+      if (!std::isnan(keys[i])) expected.emplace_back(keys[i], i);
+    }
+    std::sort(expected.begin(), expected.end());
+    assert(heap.size() == expected.size());
+    const size_t k = static_cast<size_t>(std::rand()) % 12;
+    heap.smallest(k, top);
+    assert(top.size() == std::min(k, expected.size()));
+    for (size_t i = 0; i < top.size(); ++i) {
+      assert(top[i].first == expected[i].second && top[i].second == expected[i].first);
+    }
+  }
+  assert(!heap.set(n, 0.0));   // Out of range: ignored
+  assert(!heap.contains(n));
+  
+  // NaN keys are unordered and rejected; they would hide real minima
+  IndexedMinHeap dwell(4);
+  assert(dwell.set(0, 50.0) && !dwell.set(1, std::nan("")) && dwell.set(2, 60.0) && dwell.set(3, 1.0));
+  assert(!dwell.contains(1));
+  dwell.smallest(2, top);
+  assert(top.size() == 2 && top[0].first == 3 && top[1].first == 0);
+}
+
+static void test_channel_top() {
+  ChannelRegistry channels(6);
+  PhaseSignals signals;
+  PhaseReadinessOutput out;
+  const double readiness[] = {0.9, 0.4, 0.7, 0.2, 0.8, 0.6};
+  for (int t = 0; t < 10; ++t) {
+    signals.t_s = t;
+    for (size_t id = 0; id < channels.size(); ++id) {
+      out.readiness = readiness[id];
+      // Channel 3 blocks at t=2, channel 1 at t=5, channel 4 blocks briefly
+      const bool blocked = (id == 3 && t >= 2) || (id == 1 && t >= 5) || (id == 4 && t == 3);
+      out.gate = blocked ? Gate::BLOCK : Gate::ALLOW;
+      channels.update(id, signals, out);
+    }
+  }
+  
+  std::vector<ChannelRank> top = channels.worstChannels(3, ChannelRankBy::READINESS);
+  assert(top.size() == 3 && top[0].id == 3 && top[1].id == 1 && top[2].id == 5);
+  top = channels.worstChannels(10, ChannelRankBy::BLOCK_DWELL);
+  assert(top.size() == 2 && top[0].id == 3 && top[1].id == 1);
+  assert(top[0].block_dwell_s == 7.0 && top[1].block_dwell_s == 4.0);
+  
+  // Readiness changes re-key the channel
+  out.readiness = 0.05;
+  out.gate = Gate::ALLOW;
+  signals.t_s = 10;
+  channels.update(0, signals, out);
+  out.readiness = 0.4;
+  channels.update(1, signals, out);   // Leaves BLOCK
+  top = channels.worstChannels(1, ChannelRankBy::READINESS);
+  assert(top.size() == 1 && top[0].id == 0 && std::isnan(top[0].block_dwell_s));
+  assert(channels.worstChannels(10, ChannelRankBy::BLOCK_DWELL).size() == 1);
+  
+  ReadinessAPIState primary;
+  RestAPIServer server(primary);
+  int status = 0;
+  std::string body = server.renderBody("/api/channels/top", &status);
+  assert(status == 200 && body.find("\"count\": 0") != std::string::npos);
+  server.setChannelRegistry(&channels);
+  body = server.renderBody("/api/channels/top?k=2&by=readiness", &status);
+  assert(status == 200 && body.find("\"count\": 2") != std::string::npos);
+  assert(body.find("{\"id\": 0, \"readiness\": 0.050000") < body.find("{\"id\": 3,"));
+  body = server.renderBody("/api/channels/top?by=block_dwell", &status);
+  assert(status == 200 && body.find("\"block_dwell_s\": 7.000000") != std::string::npos);
+  server.renderBody("/api/channels/top?k=0", &status);
+  assert(status == 400);
+  server.renderBody("/api/channels/top?by=temperature", &status);
+  assert(status == 400);
+  
+  // A BLOCK run that starts on an invalid sample with NaN t_s is ranked
+  // from its first finite t_s, and never with a NaN key or dwell
+  ChannelRegistry nan_channels(4);
+  out.gate = Gate::BLOCK;
+  out.readiness = 0.0;
+  const double starts[] = {50.0, std::nan(""), 60.0, 1.0};
+  for (size_t id = 0; id < 4; ++id) {
+    signals.t_s = starts[id];
+    nan_channels.update(id, signals, out);
+  }
+  top = nan_channels.worstChannels(2, ChannelRankBy::BLOCK_DWELL);
+  assert(top.size() == 2 && top[0].id == 3 && top[1].id == 0);
+  assert(nan_channels.worstChannels(4, ChannelRankBy::BLOCK_DWELL).size() == 3);
+  signals.t_s = 70.0;
+  nan_channels.update(1, signals, out);
+  signals.t_s = std::nan("");
+  nan_channels.update(3, signals, out);   // Still BLOCK; dwell keeps its last finite t_s
+  top = nan_channels.worstChannels(4, ChannelRankBy::BLOCK_DWELL);
+  assert(top.size() == 4 && top[0].id == 3 && top[3].id == 1);
+  for (const ChannelRank& r : top) assert(std::isfinite(r.block_dwell_s));
+  assert(top[0].block_dwell_s == 0.0 && top[3].block_dwell_s == 0.0);
+}
+
+static void test_channel_epochs() {
+  ChannelRegistry channels(3);
+  EpochSnapshot cut;
+  assert(channels.snapshotEpoch(cut) && cut.epoch == 0 && !cut.channels[0].reported);
+  
+  PhaseSignals signals;
+  PhaseReadinessOutput out;
+  out.gate = Gate::ALLOW;
+  assert(channels.beginEpoch() == 1);
+  for (size_t id = 0; id < 2; ++id) {
+    signals.t_s = 1.0;
+    out.readiness = 0.5;
+    channels.update(id, signals, out);
+  }
+  assert(channels.snapshotEpoch(cut) && cut.epoch == 0 && !cut.channels[0].reported);
+  assert(channels.commitEpoch() == 1);
+  
+  // Epoch 2 in progress: readers keep seeing epoch 1
+  assert(channels.beginEpoch() == 2 && channels.beginEpoch() == 2);
+  signals.t_s = 2.0;
+  out.readiness = 0.25;
+  out.gate = Gate::BLOCK;
+  channels.update(0, signals, out);
+  channels.update(0, signals, out);   // Same channel twice in one epoch
+  assert(channels.snapshotEpoch(cut) && cut.epoch == 1);
+  assert(cut.channels[0].t_s == 1.0 && cut.channels[0].gate == Gate::ALLOW);
+  assert(channels.commitEpoch() == 2 && channels.commitEpoch() == 2);
+  assert(channels.snapshotEpoch(cut) && cut.epoch == 2);
+  assert(cut.channels[0].t_s == 2.0 && cut.channels[0].readiness == 0.25 && cut.channels[0].gate == Gate::BLOCK);
+  assert(cut.channels[1].reported && cut.channels[1].t_s == 1.0);   // Carried forward
+  assert(!cut.channels[2].reported);
+  
+  // Updates outside an epoch reach the channel state but not the cut
+  signals.t_s = 3.0;
+  channels.update(1, signals, out);
+  assert(channels.snapshotEpoch(cut) && cut.channels[1].t_s == 1.0);
+  assert(channels.channel(1)->getCurrentSnapshot().t_s == 3.0);
+  
+  ReadinessAPIState primary;
+  RestAPIServer server(primary);
+  server.setChannelRegistry(&channels);
+  int status = 0;
+  const std::string body = server.renderBody("/api/channels", &status);
+  assert(status == 200 && body.find("\"epoch\": 2") != std::string::npos);
+  assert(body.find("{\"id\": 1, \"readiness\": 0.500000, \"gate\": \"ALLOW\", \"flags\": 0, \"timestamp_s\": 1.000000") != std::string::npos);
+  assert(body.find("{\"id\": 2, \"readiness\": null") != std::string::npos);
+  
+  // Concurrent reader: every cut holds one tick across all channels
+  ChannelRegistry array(32, 10);
+  std::atomic<bool> done(false);
+  std::atomic<uint64_t> cuts(0);
+  std::thread reader([&]() {
+    EpochSnapshot snap;
+    while (!done.load(std::memory_order_acquire)) {
+      if (!array.snapshotEpoch(snap) || snap.epoch == 0) continue;
+      for (const EpochChannel& ch : snap.channels) {
+        assert(ch.reported && ch.t_s == static_cast<double>(snap.epoch));
+        assert(ch.readiness == static_cast<double>(snap.epoch % 100) / 100.0);
+      }
+      cuts.fetch_add(1, std::memory_order_relaxed);
+    }
+  });
+  for (uint64_t tick = 1; tick <= 500; ++tick) {
+    assert(array.beginEpoch() == tick);
+    signals.t_s = static_cast<double>(tick);
+    out.readiness = static_cast<double>(tick % 100) / 100.0;
+    for (size_t id = 0; id < array.size(); ++id) {
+      array.update(id, signals, out);
+    }
+    array.commitEpoch();
+    if (tick % 50 == 0) std::this_thread::yield();
+  }
+  done.store(true, std::memory_order_release);
+  reader.join();
+}
+
 int main() {
   std::cout << "Running REST API tests...\n";
   
@@ -267,6 +1232,51 @@ int main() {
   test_max_history_size_min_enforcement();
   std::cout << "[PASS] setMaxHistorySize(0) minimum enforcement\n";
   
+  test_history_compression();
+  std::cout << "[PASS] Response compression negotiation\n";
+  
+  test_conditional_requests();
+  std::cout << "[PASS] ETag conditional requests\n";
+  
+  test_metrics_endpoint();
+  std::cout << "[PASS] Prometheus metrics endpoint\n";
+  
+  test_latency_instrumentation();
+  std::cout << "[PASS] Latency instrumentation\n";
+  
+  test_history_time_window();
+  std::cout << "[PASS] History time window\n";
+  
+  test_history_rollup_endpoint();
+  std::cout << "[PASS] History rollup endpoint\n";
+  
+  test_stats_endpoint();
+  std::cout << "[PASS] Stats endpoint\n";
+  
+  test_history_flag_filter();
+  std::cout << "[PASS] History flag filter\n";
+  
+  test_transitions_endpoint();
+  std::cout << "[PASS] Transitions endpoint\n";
+  
+  test_channel_registry();
+  std::cout << "[PASS] Channel registry\n";
+  
+  test_gate_aggregation();
+  std::cout << "[PASS] Gate aggregation tree\n";
+  
+  test_channel_summary();
+  std::cout << "[PASS] Channel group summary\n";
+  
+  test_indexed_heap();
+  std::cout << "[PASS] Indexed min-heap\n";
+  
+  test_channel_top();
+  std::cout << "[PASS] Top-K worst channels\n";
+  
+  test_channel_epochs();
+  std::cout << "[PASS] Consistent channel epochs\n";
+  
   std::cout << "\n[PASS] All REST API tests passed!\n";
   
   return 0;
@@ -0,0 +1,209 @@
+#include "hlv/phase_readiness.hpp"
+#include "hlv/shadow_evaluator.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace hlv;
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+// Sample `i` of a stream that warms up, oscillates around the thresholds,
+// jumps, goes stale and drops out, so every evaluation path is exercised
+static PhaseSignals make_sample(int i) {
+  PhaseSignals s;
+  s.t_s = i * 0.1 + (i % 150 == 149 ? 2.0 : 0.0);
+  s.temp_C = 25.0 + 0.02 * i + std::sin(i * 0.05) * 1.5 + (i % 97 == 0 ? 8.0 : 0.0);
+  s.temp_ambient_C = 22.0;
+  s.coherence_index = 0.3 + 0.2 * std::cos(i * 0.07);
+  s.hysteresis_index = i % 11 == 0 ? 0.9 : 0.2;
+  s.valid = i % 53 != 0;
+  return s;
+}
+
+static bool same_output(const PhaseReadinessOutput& a, const PhaseReadinessOutput& b) {
+  return std::memcmp(&a.readiness, &b.readiness, sizeof(double)) == 0 && a.gate == b.gate &&
+         a.flags == b.flags && std::memcmp(&a.dTdt_C_per_s, &b.dTdt_C_per_s, sizeof(double)) == 0 &&
+         std::memcmp(&a.trend_C, &b.trend_C, sizeof(double)) == 0 &&
+         std::memcmp(&a.stability_score, &b.stability_score, sizeof(double)) == 0;
+}
+
+// -----------------------------------------------------------------------------
+// Test 1: Primary and shadow outputs equal standalone middlewares
+// -----------------------------------------------------------------------------
+static void test_matches_standalone() {
+  PhaseReadinessConfig primary;
+  std::vector<PhaseReadinessConfig> shadows(6);
+  shadows[0].gate_allow_threshold = 0.65;            // Gate only: re-gates the primary output
+  shadows[1].max_abs_dTdt_C_per_s = 0.1;             // Thresholds only: shares the primary's track
+  shadows[2].ewma_alpha = 0.5;                       // Own dynamics
+  shadows[3].ewma_alpha = 0.5;                       // Shares shadow 2's track
+  shadows[3].coherence_allow_threshold = 0.2;
+  shadows[4] = shadows[3];                           // Gate only: re-gates shadow 3's output
+  shadows[4].gate_caution_threshold = 0.1;
+  shadows[5].gate_allow_threshold = 1.5;             // Invalid: sanitized before the re-gate
+
+  ShadowEvaluator shadow(primary);
+  const char* names[] = {"allow_065", "dtdt_01", "alpha_05", "alpha_05_coh", "alpha_05_coh_c0", "allow_bad"};
+  for (size_t i = 0; i < shadows.size(); ++i) {
+    assert(shadow.addShadow(names[i], shadows[i]));
+  }
+  assert(shadow.shadowCount() == 6);
+  assert(shadow.trackCount() == 2);
+  assert(shadow.decideCount() == 3);
+
+  PhaseReadinessMiddleware reference(primary);
+  std::vector<PhaseReadinessMiddleware> candidates;
+  for (const PhaseReadinessConfig& cfg : shadows) candidates.emplace_back(cfg);
+
+  for (int i = 0; i < 2000; ++i) {
+    const PhaseSignals s = make_sample(i);
+    if (i == 1200) {
+      shadow.reset();
+      reference.reset();
+      for (PhaseReadinessMiddleware& c : candidates) c.reset();
+    }
+    assert(same_output(shadow.evaluate(s), reference.evaluate(s)));
+    for (size_t k = 0; k < candidates.size(); ++k) {
+      assert(same_output(shadow.shadowOutput(k), candidates[k].evaluate(s)));
+    }
+  }
+  std::cout << "[PASS] Outputs match standalone middlewares\n";
+}
+
+// -----------------------------------------------------------------------------
+// Test 2: Confusion matrix, disagreements and first divergence
+// -----------------------------------------------------------------------------
+static void test_disagreement_stats() {
+  PhaseReadinessConfig primary;
+  PhaseReadinessConfig strict;
+  strict.gate_allow_threshold = 0.95;
+  strict.gate_caution_threshold = 0.75;
+
+  ShadowEvaluator shadow(primary);
+  assert(shadow.addShadow("same", primary));
+  assert(shadow.addShadow("strict", strict));
+
+  PhaseReadinessMiddleware a(primary);
+  PhaseReadinessMiddleware b(strict);
+  uint64_t expected[3][3] = {};
+  uint64_t disagreements = 0;
+  double first = std::numeric_limits<double>::quiet_NaN();
+  double last = first;
+  double max_delta = 0.0;
+  const int samples = 1500;
+  for (int i = 0; i < samples; ++i) {
+    const PhaseSignals s = make_sample(i);
+    shadow.evaluate(s);
+    const PhaseReadinessOutput x = a.evaluate(s);
+    const PhaseReadinessOutput y = b.evaluate(s);
+    ++expected[static_cast<size_t>(x.gate)][static_cast<size_t>(y.gate)];
+    max_delta = std::max(max_delta, std::fabs(x.readiness - y.readiness));
+    if (x.gate != y.gate) {
+      ++disagreements;
+      if (std::isnan(first)) first = s.t_s;
+      last = s.t_s;
+    }
+  }
+
+  const ShadowStats same = shadow.stats(0);
+  assert(same.name == "same" && same.samples == samples);
+  assert(same.disagreements == 0 && std::isnan(same.first_divergence_t_s));
+  assert(same.max_abs_readiness_delta == 0.0);
+
+  const ShadowStats st = shadow.stats(1);
+  assert(st.samples == samples && disagreements > 0);
+  assert(st.disagreements == disagreements);
+  assert(st.first_divergence_t_s == first && st.last_divergence_t_s == last);
+  assert(st.max_abs_readiness_delta == max_delta);
+  for (size_t p = 0; p < 3; ++p) {
+    for (size_t g = 0; g < 3; ++g) {
+      assert(st.confusion[p][g] == expected[p][g]);
+    }
+  }
+  assert(shadow.stats(2).name.empty() && shadow.stats(2).samples == 0);
+
+  std::ostringstream out;
+  shadow.render(out);
+  const std::string text = out.str();
+  assert(text.find("hlv_shadow_gate_total{shadow=\"strict\",primary=\"ALLOW\",candidate=\"CAUTION\"} " +
+                   std::to_string(expected[2][1]) + "\n") != std::string::npos);
+  assert(text.find("hlv_shadow_disagreements_total{shadow=\"same\"} 0\n") != std::string::npos);
+  assert(text.find("hlv_shadow_first_divergence_t_seconds{shadow=\"strict\"}") != std::string::npos);
+  assert(text.find("hlv_shadow_first_divergence_t_seconds{shadow=\"same\"}") == std::string::npos);
+
+  shadow.resetStats();
+  assert(shadow.stats(1).samples == 0 && std::isnan(shadow.stats(1).first_divergence_t_s));
+  std::cout << "[PASS] Disagreement statistics\n";
+}
+
+// -----------------------------------------------------------------------------
+// Test 3: Shadow registration rules and concurrent stats readers
+// -----------------------------------------------------------------------------
+static void test_registration() {
+  const size_t interned = CompiledPolicy::internedCount();
+  ShadowEvaluator shadow{PhaseReadinessConfig{}};
+  assert(!shadow.addShadow("", PhaseReadinessConfig{}));
+  assert(!shadow.addShadow("bad name", PhaseReadinessConfig{}));
+  assert(!shadow.addShadow("quote\"", PhaseReadinessConfig{}));
+  assert(shadow.addShadow("a", PhaseReadinessConfig{}));
+  assert(!shadow.addShadow("a", PhaseReadinessConfig{}));
+  for (size_t i = 1; i < ShadowEvaluator::kMaxShadows; ++i) {
+    PhaseReadinessConfig cfg;
+    cfg.persistence_s = 10.0 + static_cast<double>(i);   // Every shadow on its own track
+    assert(shadow.addShadow("s" + std::to_string(i), cfg));
+  }
+  assert(shadow.shadowCount() == ShadowEvaluator::kMaxShadows);
+  assert(shadow.trackCount() == ShadowEvaluator::kMaxShadows);
+  assert(!shadow.addShadow("overflow", PhaseReadinessConfig{}));
+  // Candidates are compiled privately: the intern table does not grow
+  assert(CompiledPolicy::internedCount() == interned);
+
+  // Invalid candidate configs are sanitized like a standalone middleware's
+  PhaseReadinessConfig bad;
+  bad.ewma_alpha = -1.0;
+  ShadowEvaluator sanitized{PhaseReadinessConfig{}};
+  assert(sanitized.addShadow("bad", bad));
+  PhaseReadinessMiddleware reference(bad);
+  for (int i = 0; i < 300; ++i) {
+    const PhaseSignals s = make_sample(i);
+    sanitized.evaluate(s);
+    assert(same_output(sanitized.shadowOutput(0), reference.evaluate(s)));
+  }
+
+  std::atomic<bool> done(false);
+  std::thread reader([&]() {
+    while (!done.load(std::memory_order_acquire)) {
+      const ShadowStats s = shadow.stats(3);
+      assert(s.samples <= 5000 && s.name == "s3");
+      std::ostringstream out;
+      shadow.render(out);
+    }
+  });
+  for (int i = 0; i < 5000; ++i) {
+    shadow.evaluate(make_sample(i));
+  }
+  done.store(true, std::memory_order_release);
+  reader.join();
+  assert(shadow.stats(ShadowEvaluator::kMaxShadows - 1).samples == 5000);
+  std::cout << "[PASS] Shadow registration and concurrent readers\n";
+}
+
+int main() {
+  std::cout << "Running shadow evaluator tests...\n";
+
+  test_matches_standalone();
+  test_disagreement_stats();
+  test_registration();
+
+  std::cout << "[PASS] All shadow evaluator tests passed!\n";
+  return 0;
+}
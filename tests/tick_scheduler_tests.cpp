@@ -0,0 +1,304 @@
+#include "hlv/channel_registry.hpp"
+#include "hlv/numa_topology.hpp"
+#include "hlv/phase_readiness.hpp"
+#include "hlv/tick_scheduler.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+using namespace hlv;
+
+// -----------------------------------------------------------------------------
+// Helpers
+// -----------------------------------------------------------------------------
+// Tick `tick` of channel `id`: distinct temperature paths per channel, with
+// some channels heating fast enough to leave ALLOW
+static std::vector<PhaseSignals> make_tick(size_t channels, int tick) {
+  std::vector<PhaseSignals> signals(channels);
+  for (size_t id = 0; id < channels; ++id) {
+    PhaseSignals& s = signals[id];
+    s.t_s = tick * 0.001;
+    s.temp_C = 25.0 + 0.01 * static_cast<double>(id % 13) * tick * (id % 5 == 0 ? 4.0 : 0.1);
+    s.temp_ambient_C = 22.0;
+    s.coherence_index = 0.5 + 0.01 * static_cast<double>(id % 40);
+    s.valid = (id + static_cast<size_t>(tick)) % 97 != 0;
+  }
+  return signals;
+}
+
+static bool same_output(const PhaseReadinessOutput& a, const PhaseReadinessOutput& b) {
+  return std::memcmp(&a.readiness, &b.readiness, sizeof(double)) == 0 && a.gate == b.gate &&
+         a.flags == b.flags && std::memcmp(&a.stability_score, &b.stability_score, sizeof(double)) == 0;
+}
+
+// -----------------------------------------------------------------------------
+// Test 1: Outputs are identical to sequential evaluation for any worker count
+// -----------------------------------------------------------------------------
+static void test_deterministic() {
+  const size_t channels = 1000;
+  const int ticks = 50;
+  PhaseReadinessConfig cfg;
+
+  std::vector<PhaseReadinessMiddleware> reference(channels, PhaseReadinessMiddleware(cfg));
+  std::vector<std::vector<PhaseReadinessOutput>> expected(ticks, std::vector<PhaseReadinessOutput>(channels));
+  for (int t = 0; t < ticks; ++t) {
+    const std::vector<PhaseSignals> signals = make_tick(channels, t);
+    for (size_t id = 0; id < channels; ++id) {
+      expected[t][id] = reference[id].evaluate(signals[id]);
+    }
+  }
+
+  for (size_t workers : {1, 3, 8}) {
+    TickSchedulerConfig tc;
+    tc.workers = workers;
+    tc.chunk_size = 7;   // Uneven shares, so workers finish at different times and steal
+    TickScheduler scheduler(cfg, channels, nullptr, tc);
+    assert(!scheduler.runTick(make_tick(channels, 0)));   // Not started
+    assert(scheduler.start());
+    assert(!scheduler.start());
+    assert(!scheduler.runTick(make_tick(channels - 1, 0)));
+    for (int t = 0; t < ticks; ++t) {
+      assert(scheduler.runTick(make_tick(channels, t)));
+      for (size_t id = 0; id < channels; ++id) {
+        assert(same_output(scheduler.outputs()[id], expected[t][id]));
+      }
+    }
+    scheduler.stop();
+
+    uint64_t evaluated = 0;
+    for (size_t w = 0; w < workers; ++w) evaluated += scheduler.workerChannels(w);
+    assert(evaluated == channels * ticks);
+    assert(scheduler.tickCount() == static_cast<uint64_t>(ticks));
+    assert(scheduler.lastTick().tick == static_cast<uint64_t>(ticks));
+  }
+
+  // Per-channel configs: three policies, shared by interning
+  std::vector<PhaseReadinessConfig> configs(channels);
+  for (size_t id = 0; id < channels; ++id) {
+    if (id % 3 == 1) configs[id].gate_allow_threshold = 0.6;
+    if (id % 3 == 2) configs[id].max_abs_dTdt_C_per_s = 0.05;
+  }
+  std::vector<PhaseReadinessMiddleware> mixed;
+  for (size_t id = 0; id < channels; ++id) mixed.emplace_back(configs[id]);
+  TickSchedulerConfig tc;
+  tc.workers = 3;
+  TickScheduler per_channel(configs, nullptr, tc);
+  assert(per_channel.channels() == channels);
+  assert(per_channel.start());
+  for (int t = 0; t < ticks; ++t) {
+    const std::vector<PhaseSignals> signals = make_tick(channels, t);
+    assert(per_channel.runTick(signals));
+    for (size_t id = 0; id < channels; ++id) {
+      assert(same_output(per_channel.outputs()[id], mixed[id].evaluate(signals[id])));
+    }
+  }
+  per_channel.stop();
+  std::cout << "[PASS] Deterministic across worker counts\n";
+}
+
+// -----------------------------------------------------------------------------
+// Test 2: Registry publication, one epoch per tick
+// -----------------------------------------------------------------------------
+static void test_registry_epochs() {
+  const size_t channels = 200;
+  ChannelRegistry registry(channels, 10);
+  TickSchedulerConfig tc;
+  tc.workers = 4;
+  tc.chunk_size = 16;
+  TickScheduler scheduler(PhaseReadinessConfig{}, channels, &registry, tc);
+
+  ChannelRegistry wrong_size(channels + 1, 10);
+  TickScheduler mismatched(PhaseReadinessConfig{}, channels, &wrong_size, tc);
+  assert(!mismatched.start());
+
+  assert(scheduler.start());
+  std::atomic<bool> done(false);
+  std::thread reader([&]() {
+    EpochSnapshot cut;
+    while (!done.load(std::memory_order_acquire)) {
+      if (!registry.snapshotEpoch(cut) || cut.epoch == 0) continue;
+      // Tick t is epoch t + 1 and carries t_s = t * 0.001
+      for (const EpochChannel& ch : cut.channels) {
+        assert(ch.reported && ch.t_s == static_cast<double>(cut.epoch - 1) * 0.001);
+      }
+    }
+  });
+  for (int t = 0; t < 100; ++t) {
+    assert(scheduler.runTick(make_tick(channels, t)));
+  }
+  done.store(true, std::memory_order_release);
+  reader.join();
+  scheduler.stop();
+
+  assert(registry.committedEpoch() == 100);
+  assert(registry.summary().channels == channels);
+  for (size_t id = 0; id < channels; ++id) {
+    assert(registry.channel(id)->metrics().updatesTotal() == 100);
+  }
+  std::cout << "[PASS] Registry epochs per tick\n";
+}
+
+// -----------------------------------------------------------------------------
+// Test 3: Deadline misses, utilization, pinning and metrics exposition
+// -----------------------------------------------------------------------------
+static void test_metrics() {
+  const size_t channels = 500;
+  TickSchedulerConfig tc;
+  tc.workers = 2;
+  tc.deadline_s = 0.0;   // Every tick misses
+#if defined(__linux__)
+  tc.worker_cpus = {sched_getcpu(), -1};   // A CPU this process may run on
+#endif
+  TickScheduler scheduler(PhaseReadinessConfig{}, channels, nullptr, tc);
+  assert(scheduler.workerUtilization(0) == 0.0);
+  assert(scheduler.start());
+  for (int t = 0; t < 20; ++t) {
+    assert(scheduler.runTick(make_tick(channels, t)));
+    assert(scheduler.lastTick().missed && scheduler.lastTick().makespan_s > 0.0);
+  }
+  scheduler.stop();
+#if defined(__linux__)
+  assert(scheduler.pinnedWorkers() == 1);
+#endif
+  assert(scheduler.deadlineMissCount() == 20);
+  for (size_t w = 0; w < scheduler.workers(); ++w) {
+    assert(scheduler.workerUtilization(w) >= 0.0 && scheduler.workerUtilization(w) <= 1.0);
+  }
+
+  std::ostringstream out;
+  scheduler.render(out);
+  const std::string text = out.str();
+  assert(text.find("hlv_tick_total 20\n") != std::string::npos);
+  assert(text.find("hlv_tick_deadline_misses_total 20\n") != std::string::npos);
+  assert(text.find("hlv_tick_makespan_seconds_count 20\n") != std::string::npos);
+  assert(text.find("hlv_tick_worker_channels_total{worker=\"1\"}") != std::string::npos);
+  assert(text.find("hlv_tick_worker_utilization{worker=\"0\"}") != std::string::npos);
+  assert(text.find("hlv_tick_remote_access_ratio 0\n") != std::string::npos);
+  assert(text.find("hlv_tick_worker_remote_channels_total{worker=\"1\"} 0\n") != std::string::npos);
+  std::cout << "[PASS] Deadline misses and worker metrics\n";
+}
+
+// -----------------------------------------------------------------------------
+// Test 4: CPU lists, topology queries and topology-aware shard maps
+// -----------------------------------------------------------------------------
+static void test_numa_topology() {
+  std::vector<int> cpus;
+  assert(parseCpuList("0-3,8,10-11\n", cpus));
+  assert((cpus == std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+  assert(parseCpuList("", cpus) && cpus.empty());
+  assert(!parseCpuList("3-1", cpus));
+  assert(!parseCpuList("0,x", cpus));
+
+  const NumaTopology single;
+  assert(single.nodes() == 1 && !single.isMultiNode());
+  assert(single.nodeOfCpu(5) == 0 && single.currentNode() == 0);
+
+  const NumaTopology two = NumaTopology::fromNodeCpus({{0, 1}, {2, 3}});
+  assert(two.isMultiNode() && two.nodes() == 2);
+  assert(two.nodeOfCpu(3) == 1 && two.nodeOfCpu(0) == 0 && two.nodeOfCpu(9) == -1);
+  assert(two.cpusOfNode(1).size() == 2 && two.cpusOfNode(2).empty());
+  assert(!NumaTopology::fromNodeCpus({{0, 1}, {}}).isMultiNode());   // Memory-only node
+
+  const NumaTopology detected = NumaTopology::detect();
+  assert(detected.nodes() >= 1 && detected.currentNode() >= 0);
+
+  // One node: worker w owns chunks [w * C / W, (w + 1) * C / W)
+  const ChannelShardMap flat(10, 3, {0, 0, 0});
+  assert(flat.chunks() == 4);
+  assert(flat.shard(0).first_chunk == 0 && flat.shard(0).end_chunk == 1);
+  assert(flat.shard(2).first_chunk == 2 && flat.shard(2).end_chunk == 4);
+  assert(flat.shard(2).first_channel == 6 && flat.shard(2).channels == 4);
+  assert((flat.stealOrder(1) == std::vector<size_t>{1, 2, 0}));
+
+  // Two nodes, interleaved workers: each node gets one contiguous range and
+  // thieves stay on their node first
+  const ChannelShardMap numa(80, 10, {1, 0, 1, 0});
+  assert(numa.shard(1).first_channel == 0 && numa.shard(3).first_channel == 20);
+  assert(numa.shard(0).first_channel == 40 && numa.shard(2).first_channel == 60);
+  size_t covered = 0;
+  for (size_t w = 0; w < numa.workers(); ++w) covered += numa.shard(w).channels;
+  assert(covered == 80);
+  assert((numa.stealOrder(0) == std::vector<size_t>{0, 2, 1, 3}));
+  assert((numa.stealOrder(3) == std::vector<size_t>{3, 1, 0, 2}));
+  std::cout << "[PASS] NUMA topology and shard maps\n";
+}
+
+// -----------------------------------------------------------------------------
+// Test 5: Worker-side placement of middlewares and registry channels
+// -----------------------------------------------------------------------------
+static void test_numa_placement() {
+  const size_t channels = 300;
+  int cpu = 0;
+#if defined(__linux__)
+  cpu = sched_getcpu();
+#endif
+  // Synthetic two-node machine on which this process runs on node 1
+  TickSchedulerConfig tc;
+  tc.workers = 3;
+  tc.chunk_size = 16;
+  tc.topology = std::make_shared<NumaTopology>(NumaTopology::fromNodeCpus({{cpu + 1}, {cpu}}));
+
+  ChannelRegistry registry(channels, 10);
+  TickScheduler scheduler(PhaseReadinessConfig{}, channels, &registry, tc);
+  assert(scheduler.start());
+  assert(scheduler.registryChannelsPlaced() == channels);
+  PhaseReadinessMiddleware reference_proto{PhaseReadinessConfig{}};
+  std::vector<PhaseReadinessMiddleware> reference(channels, reference_proto);
+  for (int t = 0; t < 30; ++t) {
+    const std::vector<PhaseSignals> signals = make_tick(channels, t);
+    assert(scheduler.runTick(signals));
+    for (size_t id = 0; id < channels; ++id) {
+      assert(same_output(scheduler.outputs()[id], reference[id].evaluate(signals[id])));
+    }
+  }
+  scheduler.stop();
+  for (size_t w = 0; w < scheduler.workers(); ++w) {
+    assert(scheduler.workerNode(w) == 1);
+  }
+  assert(scheduler.remoteAccessRatio() == 0.0);
+  // Re-placed channels keep the registry's history size
+  assert(registry.channel(0)->getHistory(100).size() == 10);
+  assert(registry.channel(channels - 1)->metrics().updatesTotal() == 30);
+
+  // A registry that already holds data is left in place
+  ChannelRegistry used(channels, 10);
+  used.update(0, make_tick(1, 0)[0], PhaseReadinessOutput{});
+  TickScheduler late(PhaseReadinessConfig{}, channels, &used, tc);
+  assert(late.start());
+  assert(late.registryChannelsPlaced() < channels);
+  assert(used.channel(0)->getSequence() == 1);
+  late.stop();
+
+  // Single node: no placement
+  tc.topology = std::make_shared<NumaTopology>();
+  ChannelRegistry plain(channels, 10);
+  TickScheduler flat(PhaseReadinessConfig{}, channels, &plain, tc);
+  assert(flat.start());
+  assert(flat.registryChannelsPlaced() == 0 && flat.workerNode(0) == 0);
+  flat.stop();
+  std::cout << "[PASS] NUMA placement of channel state\n";
+}
+
+int main() {
+  std::cout << "Running tick scheduler tests...\n";
+
+  test_deterministic();
+  test_registry_epochs();
+  test_metrics();
+  test_numa_topology();
+  test_numa_placement();
+
+  std::cout << "[PASS] All tick scheduler tests passed!\n";
+  return 0;
+}
@@ -0,0 +1,168 @@
+#include "hlv/phase_readiness.hpp"
+#include "hlv/trace.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+using namespace hlv;
+
+// -----------------------------------------------------------------------------
+// Helper: temporary file path unique to this process
+// -----------------------------------------------------------------------------
+static std::string temp_path(const char* name) {
+  return "/tmp/hlv_trace_test_" + std::to_string(getpid()) + "_" + name;
+}
+
+static PhaseSignals make_signal(int i) {
+  PhaseSignals s;
+  s.t_s = i * 0.1;
+  s.temp_C = 25.0 + 0.01 * (i % 7);
+  s.temp_ambient_C = 22.0;
+  s.coherence_index = (i % 5 == 0) ? 0.1 : 0.6;
+  s.valid = (i % 50 != 49);
+  return s;
+}
+
+// -----------------------------------------------------------------------------
+// Test 1: CRC-32 matches the standard check value
+// -----------------------------------------------------------------------------
+static void test_crc32_check_value() {
+  const char* check = "123456789";
+  assert(crc32(check, 9) == 0xCBF43926u);
+  // Incremental use gives the same result
+  assert(crc32(check + 4, 5, crc32(check, 4)) == 0xCBF43926u);
+  assert(crc32(nullptr, 0) == 0u);
+}
+
+// -----------------------------------------------------------------------------
+// Test 2: Round trip with outputs, partial last block, recorded config
+// -----------------------------------------------------------------------------
+static void test_round_trip_with_outputs() {
+  const std::string path = temp_path("roundtrip");
+  PhaseReadinessConfig cfg;
+  cfg.temp_max_C = 42.5;
+  cfg.persistence_s = 1.5;
+
+  PhaseReadinessMiddleware mw(cfg);
+  TraceWriter writer;
+  assert(writer.open(path, cfg, true, 64));
+  for (int i = 0; i < 1000; ++i) {
+    const PhaseSignals s = make_signal(i);
+    assert(writer.append(s, mw.evaluate(s)));
+  }
+  assert(writer.close());
+
+  TraceReader reader;
+  assert(reader.open(path));
+  assert(reader.hasOutputs());
+  assert(!reader.truncated());
+  assert(reader.recordCount() == 1000);
+  assert(reader.blockCount() == 16); // 15 full blocks of 64 + 40
+  assert(reader.block(15).size() == 40);
+  assert(reader.config().temp_max_C == 42.5);
+  assert(reader.config().persistence_s == 1.5);
+
+  // Replaying the recorded config reproduces the recorded outputs bit for bit
+  PhaseReadinessMiddleware replay(reader.config());
+  int i = 0;
+  for (size_t b = 0; b < reader.blockCount(); ++b) {
+    const TraceBlockView block = reader.block(b);
+    for (size_t k = 0; k < block.size(); ++k, ++i) {
+      const PhaseSignals s = fromTraceRecord(block.signals(k));
+      const PhaseSignals want = make_signal(i);
+      assert(s.t_s == want.t_s && s.temp_C == want.temp_C && s.valid == want.valid);
+      assert(std::isnan(s.hysteresis_index));
+      const TraceOutputRecord got = toTraceRecord(replay.evaluate(s));
+      assert(std::memcmp(&got, &block.output(k), sizeof(got)) == 0);
+    }
+  }
+  assert(i == 1000);
+  std::remove(path.c_str());
+}
+
+// -----------------------------------------------------------------------------
+// Test 3: Signals-only traces use the short stride
+// -----------------------------------------------------------------------------
+static void test_signals_only() {
+  const std::string path = temp_path("signals");
+  TraceWriter writer;
+  assert(writer.open(path, PhaseReadinessConfig{}, false, 128));
+  for (int i = 0; i < 300; ++i) {
+    writer.append(make_signal(i));
+  }
+  assert(writer.close());
+
+  TraceReader reader;
+  assert(reader.open(path));
+  assert(!reader.hasOutputs());
+  assert(reader.recordCount() == 300);
+  assert(reader.block(0).stride() == sizeof(TraceSignalsRecord));
+  assert(reader.block(2).signals(0).t_s == make_signal(256).t_s);
+  std::remove(path.c_str());
+}
+
+// -----------------------------------------------------------------------------
+// Test 4: Corrupt and truncated blocks end the readable range
+// -----------------------------------------------------------------------------
+static void test_corruption_and_truncation() {
+  const std::string path = temp_path("corrupt");
+  TraceWriter writer;
+  assert(writer.open(path, PhaseReadinessConfig{}, true, 100));
+  for (int i = 0; i < 300; ++i) {
+    writer.append(make_signal(i));
+  }
+  assert(writer.close());
+  const long block_bytes = static_cast<long>(sizeof(TraceBlockHeader) + 100 * (48 + 40));
+
+  // Flip one byte inside the second block's records
+  std::FILE* f = std::fopen(path.c_str(), "r+b");
+  assert(f);
+  std::fseek(f, static_cast<long>(sizeof(TraceFileHeader)) + block_bytes + 64, SEEK_SET);
+  std::fputc(0x5A, f);
+  std::fclose(f);
+
+  TraceReader reader;
+  assert(reader.open(path));
+  assert(reader.truncated());
+  assert(reader.blockCount() == 1);
+
+  // Without up-front verification the block is indexed but fails verifyBlock()
+  TraceReader lazy;
+  assert(lazy.open(path, false));
+  assert(lazy.blockCount() == 3);
+  assert(lazy.verifyBlock(0) && !lazy.verifyBlock(1) && lazy.verifyBlock(2));
+
+  // Cut the file mid-block: the complete blocks remain readable
+  assert(truncate(path.c_str(), static_cast<off_t>(sizeof(TraceFileHeader) + 2 * block_bytes + 10)) == 0);
+  TraceReader cut;
+  assert(cut.open(path, false));
+  assert(cut.truncated());
+  assert(cut.recordCount() == 200);
+
+  // A damaged header is rejected outright
+  f = std::fopen(path.c_str(), "r+b");
+  std::fseek(f, 20, SEEK_SET);
+  std::fputc(0x01, f);
+  std::fclose(f);
+  TraceReader bad;
+  assert(!bad.open(path));
+  assert(!bad.lastError().empty());
+  std::remove(path.c_str());
+}
+
+int main() {
+  std::cout << "Running trace format tests...\n";
+
+  test_crc32_check_value();
+  test_round_trip_with_outputs();
+  test_signals_only();
+  test_corruption_and_truncation();
+
+  std::cout << "[PASS] All trace format tests passed!\n";
+  return 0;
+}
@@ -0,0 +1,206 @@
+// hlv_bisect: locate the first sample where two output streams differ
+//
+// Usage: hlv_bisect <a> <b> [--block N] [--no-verify]
+//
+// Each input is either a trace with recorded outputs or a digest log
+// written by `hlv_replay --digest-log`. Traces are digested into a
+// DigestLog of N-sample blocks (default 4096; logs keep their own block
+// size, and both sides must match). FLAG_INGEST_OVERFLOW is masked in
+// recorded outputs, as in hlv_replay. The first divergent block is found by
+// binary search over the checkpoints; when both inputs are traces, that
+// block is then scanned for the exact sample. Prints a JSON summary on
+// stdout.
+//
+// Exit status: 0 = equal, 1 = divergent, 2 = unreadable input or bad
+// arguments
+
+#include "hlv/output_digest.hpp"
+#include "hlv/trace.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+using namespace hlv;
+
+namespace {
+
+struct Input {
+  std::string path;
+  bool is_trace = false;
+  TraceReader trace;
+  DigestLog log;
+};
+
+bool isTrace(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  char magic[8] = {};
+  return in.read(magic, sizeof(magic)) && std::memcmp(magic, "HLVTRACE", sizeof(magic)) == 0;
+}
+
+TraceOutputRecord recordedOutput(const TraceBlockView& block, size_t i) {
+  TraceOutputRecord rec = block.output(i);
+  rec.flags &= ~static_cast<uint32_t>(FLAG_INGEST_OVERFLOW);
+  return rec;
+}
+
+bool load(Input& in, uint64_t block_samples, bool verify) {
+  in.is_trace = isTrace(in.path);
+  if (!in.is_trace) {
+    std::string error;
+    if (!in.log.read(in.path, &error)) {
+      std::fprintf(stderr, "hlv_bisect: %s: %s\n", in.path.c_str(), error.c_str());
+      return false;
+    }
+    return true;
+  }
+  if (!in.trace.open(in.path, verify)) {
+    std::fprintf(stderr, "hlv_bisect: %s: %s\n", in.path.c_str(), in.trace.lastError().c_str());
+    return false;
+  }
+  if (!in.trace.hasOutputs()) {
+    std::fprintf(stderr, "hlv_bisect: %s: trace has no recorded outputs\n", in.path.c_str());
+    return false;
+  }
+  if (in.trace.truncated()) {
+    std::fprintf(stderr, "hlv_bisect: %s: trailing partial or corrupt block ignored\n", in.path.c_str());
+  }
+  in.log = DigestLog(block_samples);
+  for (size_t b = 0; b < in.trace.blockCount(); ++b) {
+    const TraceBlockView block = in.trace.block(b);
+    for (size_t i = 0; i < block.size(); ++i) {
+      in.log.add(fromTraceRecord(recordedOutput(block, i)));
+    }
+  }
+  return true;
+}
+
+// Sequential reader of a trace's recorded outputs from a given sample on
+class OutputCursor {
+public:
+  OutputCursor(const TraceReader& trace, uint64_t first) : trace_(trace), block_(0), index_(first) {
+    while (block_ < trace_.blockCount() && index_ >= trace_.block(block_).size()) {
+      index_ -= trace_.block(block_++).size();
+    }
+  }
+
+  bool next(TraceOutputRecord& out) {
+    while (block_ < trace_.blockCount()) {
+      const TraceBlockView block = trace_.block(block_);
+      if (index_ < block.size()) {
+        out = recordedOutput(block, static_cast<size_t>(index_++));
+        return true;
+      }
+      ++block_;
+      index_ = 0;
+    }
+    return false;
+  }
+
+private:
+  const TraceReader& trace_;
+  size_t block_;
+  uint64_t index_;
+};
+
+// Equal in every field the digest covers
+bool sameOutput(const TraceOutputRecord& a, const TraceOutputRecord& b) {
+  return std::memcmp(&a.readiness, &b.readiness, sizeof(a.readiness)) == 0 &&
+         std::memcmp(&a.dTdt_C_per_s, &b.dTdt_C_per_s, sizeof(a.dTdt_C_per_s)) == 0 &&
+         std::memcmp(&a.trend_C, &b.trend_C, sizeof(a.trend_C)) == 0 && a.flags == b.flags && a.gate == b.gate;
+}
+
+void printRecord(const char* key, const TraceOutputRecord* rec) {
+  if (rec == nullptr) {
+    std::printf("  \"%s\": null,\n", key);
+    return;
+  }
+  const PhaseReadinessOutput out = fromTraceRecord(*rec);
+  std::printf("  \"%s\": {\"readiness\": %.17g, \"gate\": \"%s\", \"flags\": %u, \"dTdt_C_per_s\": %.17g, "
+              "\"trend_C\": %.17g},\n",
+              key, out.readiness, gateToString(out.gate), static_cast<unsigned>(out.flags), out.dTdt_C_per_s,
+              out.trend_C);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::fprintf(stderr, "usage: %s <a> <b> [--block N] [--no-verify]\n", argv[0]);
+    return 2;
+  }
+
+  Input a, b;
+  a.path = argv[1];
+  b.path = argv[2];
+  uint64_t block_samples = DigestLog::kDefaultBlockSamples;
+  bool verify = true;
+  for (int i = 3; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--block") == 0 && i + 1 < argc) {
+      block_samples = std::strtoull(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--no-verify") == 0) {
+      verify = false;
+    } else {
+      std::fprintf(stderr, "hlv_bisect: bad argument '%s'\n", argv[i]);
+      return 2;
+    }
+  }
+  if (block_samples == 0) {
+    std::fprintf(stderr, "hlv_bisect: --block must be positive\n");
+    return 2;
+  }
+  if (!load(a, block_samples, verify) || !load(b, block_samples, verify)) {
+    return 2;
+  }
+
+  const DigestDivergence d = findDivergence(a.log, b.log);
+  if (!d.comparable) {
+    std::fprintf(stderr, "hlv_bisect: block sizes differ (%llu vs %llu)\n",
+                 static_cast<unsigned long long>(a.log.blockSamples()),
+                 static_cast<unsigned long long>(b.log.blockSamples()));
+    return 2;
+  }
+
+  // Narrow the divergent range to one sample when both outputs are at hand
+  bool exact = false;
+  uint64_t first = d.first_sample;
+  TraceOutputRecord ra{}, rb{};
+  bool has_a = false, has_b = false;
+  if (!d.equal && a.is_trace && b.is_trace) {
+    OutputCursor ca(a.trace, d.first_sample), cb(b.trace, d.first_sample);
+    for (uint64_t i = d.first_sample; i < d.end_sample; ++i) {
+      has_a = ca.next(ra);
+      has_b = cb.next(rb);
+      if (has_a != has_b || (has_a && !sameOutput(ra, rb))) {
+        exact = true;
+        first = i;
+        break;
+      }
+    }
+  }
+
+  std::printf("{\n");
+  std::printf("  \"a\": \"%s\",\n", a.path.c_str());
+  std::printf("  \"b\": \"%s\",\n", b.path.c_str());
+  std::printf("  \"samples_a\": %llu,\n", static_cast<unsigned long long>(a.log.count()));
+  std::printf("  \"samples_b\": %llu,\n", static_cast<unsigned long long>(b.log.count()));
+  std::printf("  \"digest_a\": \"%016llx\",\n", static_cast<unsigned long long>(a.log.value()));
+  std::printf("  \"digest_b\": \"%016llx\",\n", static_cast<unsigned long long>(b.log.value()));
+  std::printf("  \"block_samples\": %llu,\n", static_cast<unsigned long long>(a.log.blockSamples()));
+  std::printf("  \"checkpoint_comparisons\": %zu,\n", d.comparisons);
+  if (!d.equal) {
+    if (exact) {
+      std::printf("  \"first_divergent_sample\": %llu,\n", static_cast<unsigned long long>(first));
+      printRecord("output_a", has_a ? &ra : nullptr);
+      printRecord("output_b", has_b ? &rb : nullptr);
+    } else {
+      std::printf("  \"divergent_range\": [%llu, %llu],\n", static_cast<unsigned long long>(d.first_sample),
+                  static_cast<unsigned long long>(d.end_sample));
+    }
+  }
+  std::printf("  \"equal\": %s\n", d.equal ? "true" : "false");
+  std::printf("}\n");
+  return d.equal ? 0 : 1;
+}
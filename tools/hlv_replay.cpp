@@ -0,0 +1,130 @@
+// hlv_replay: evaluate a recorded binary trace and check it for divergence
+//
+// Usage: hlv_replay <trace> [--no-verify] [--max-report N]
+//                   [--digest-log PATH] [--digest-block N]
+//
+// Replays every PhaseSignals record through a fresh
+// PhaseReadinessMiddleware built from the trace's recorded config. If the
+// trace carries outputs, each evaluated output is compared bit-for-bit
+// with the recorded one. FLAG_INGEST_OVERFLOW is added downstream of
+// evaluate() by IngestPipeline and is ignored in the comparison. Prints a
+// JSON summary on stdout, including the OutputDigest of the evaluated
+// outputs (and of the recorded ones, if any). --digest-log writes a
+// DigestLog of the evaluated outputs for hlv_bisect.
+//
+// Exit status: 0 = replay matches (or no outputs recorded),
+//              1 = divergence found, 2 = unreadable trace
+
+#include "hlv/output_digest.hpp"
+#include "hlv/trace.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace hlv;
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s <trace> [--no-verify] [--max-report N] [--digest-log PATH] [--digest-block N]\n",
+                 argv[0]);
+    return 2;
+  }
+
+  const std::string path = argv[1];
+  bool verify = true;
+  uint64_t max_report = 10;
+  std::string digest_path;
+  uint64_t digest_block = DigestLog::kDefaultBlockSamples;
+  for (int i = 2; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--no-verify") == 0) {
+      verify = false;
+    } else if (std::strcmp(argv[i], "--max-report") == 0 && i + 1 < argc) {
+      max_report = std::strtoull(argv[++i], nullptr, 10);
+    } else if (std::strcmp(argv[i], "--digest-log") == 0 && i + 1 < argc) {
+      digest_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--digest-block") == 0 && i + 1 < argc) {
+      digest_block = std::strtoull(argv[++i], nullptr, 10);
+    }
+  }
+
+  const auto open_start = std::chrono::steady_clock::now();
+  TraceReader reader;
+  if (!reader.open(path, verify)) {
+    std::fprintf(stderr, "hlv_replay: %s\n", reader.lastError().c_str());
+    return 2;
+  }
+  const double open_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - open_start).count();
+  if (reader.truncated()) {
+    std::fprintf(stderr, "hlv_replay: trailing partial or corrupt block ignored\n");
+  }
+
+  PhaseReadinessMiddleware mw(reader.config());
+  uint64_t evaluated = 0;
+  uint64_t divergences = 0;
+  uint64_t first_divergence = 0;
+  uint64_t gate_counts[3] = {0, 0, 0};
+  DigestLog digest(digest_block);
+  OutputDigest recorded_digest;
+
+  const auto replay_start = std::chrono::steady_clock::now();
+  for (size_t b = 0; b < reader.blockCount(); ++b) {
+    const TraceBlockView block = reader.block(b);
+    for (size_t i = 0; i < block.size(); ++i, ++evaluated) {
+      const PhaseReadinessOutput out = mw.evaluate(fromTraceRecord(block.signals(i)));
+      gate_counts[static_cast<size_t>(out.gate) % 3]++;
+      digest.add(out);
+      if (!block.hasOutputs()) {
+        continue;
+      }
+      const TraceOutputRecord got = toTraceRecord(out);
+      TraceOutputRecord recorded = block.output(i);
+      recorded.flags &= ~static_cast<uint32_t>(FLAG_INGEST_OVERFLOW);
+      recorded_digest.add(fromTraceRecord(recorded));
+      if (std::memcmp(&got, &recorded, sizeof(got)) != 0) {
+        if (divergences == 0) first_divergence = evaluated;
+        if (divergences < max_report) {
+          const TraceOutputRecord& want = block.output(i);
+          std::fprintf(stderr,
+                       "divergence at sample %llu (t=%.9g): gate %s/%s flags 0x%x/0x%x readiness %.17g/%.17g\n",
+                       static_cast<unsigned long long>(evaluated), block.signals(i).t_s,
+                       gateToString(static_cast<Gate>(want.gate)), gateToString(out.gate),
+                       want.flags, out.flags, want.readiness, out.readiness);
+        }
+        ++divergences;
+      }
+    }
+  }
+  const double replay_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - replay_start).count();
+  if (!digest_path.empty() && !digest.write(digest_path)) {
+    std::fprintf(stderr, "hlv_replay: cannot write %s\n", digest_path.c_str());
+    return 2;
+  }
+
+  std::printf("{\n");
+  std::printf("  \"trace\": \"%s\",\n", path.c_str());
+  std::printf("  \"samples\": %llu,\n", static_cast<unsigned long long>(evaluated));
+  std::printf("  \"blocks\": %zu,\n", reader.blockCount());
+  std::printf("  \"has_outputs\": %s,\n", reader.hasOutputs() ? "true" : "false");
+  std::printf("  \"truncated\": %s,\n", reader.truncated() ? "true" : "false");
+  std::printf("  \"open_s\": %.6f,\n", open_s);
+  std::printf("  \"replay_s\": %.6f,\n", replay_s);
+  std::printf("  \"samples_per_s\": %.1f,\n", replay_s > 0.0 ? static_cast<double>(evaluated) / replay_s : 0.0);
+  std::printf("  \"gate_counts\": {\"BLOCK\": %llu, \"CAUTION\": %llu, \"ALLOW\": %llu},\n",
+              static_cast<unsigned long long>(gate_counts[0]),
+              static_cast<unsigned long long>(gate_counts[1]),
+              static_cast<unsigned long long>(gate_counts[2]));
+  std::printf("  \"output_digest\": \"%016llx\",\n", static_cast<unsigned long long>(digest.value()));
+  if (reader.hasOutputs()) {
+    std::printf("  \"recorded_digest\": \"%016llx\",\n", static_cast<unsigned long long>(recorded_digest.value()));
+  }
+  std::printf("  \"divergences\": %llu", static_cast<unsigned long long>(divergences));
+  if (divergences > 0) {
+    std::printf(",\n  \"first_divergence\": %llu", static_cast<unsigned long long>(first_divergence));
+  }
+  std::printf("\n}\n");
+
+  return divergences > 0 ? 1 : 0;
+}
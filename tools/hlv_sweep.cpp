@@ -0,0 +1,119 @@
+// hlv_sweep: evaluate a grid of configs over a recorded binary trace
+//
+// Usage: hlv_sweep <trace> [--dtdt V,...] [--persistence V,...]
+//                  [--alpha V,...] [--allow V,...] [--caution V,...]
+//                  [--threads N] [--no-verify]
+//
+// The grid is the Cartesian product of the given values over the trace's
+// recorded config, which is also the baseline. Every config runs through
+// PolicySweep in one pass over the trace. Prints a JSON summary on stdout
+// with, per config, the swept values (as sanitized), gate occupancy, gate
+// transitions and disagreements with the baseline.
+//
+// Exit status: 0 = success, 2 = unreadable trace or bad arguments
+
+#include "hlv/policy_sweep.hpp"
+#include "hlv/trace.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace hlv;
+
+static bool parseList(const char* text, std::vector<double>& values) {
+  std::stringstream ss(text);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    char* end = nullptr;
+    const double v = std::strtod(item.c_str(), &end);
+    if (item.empty() || *end != '\0') return false;
+    values.push_back(v);
+  }
+  return !values.empty();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::fprintf(stderr,
+                 "usage: %s <trace> [--dtdt V,...] [--persistence V,...] [--alpha V,...] "
+                 "[--allow V,...] [--caution V,...] [--threads N] [--no-verify]\n",
+                 argv[0]);
+    return 2;
+  }
+
+  const std::string path = argv[1];
+  bool verify = true;
+  SweepAxes axes;
+  PolicySweepOptions options;
+  for (int i = 2; i < argc; ++i) {
+    const bool has_value = i + 1 < argc;
+    std::vector<double>* axis = nullptr;
+    if (std::strcmp(argv[i], "--no-verify") == 0) {
+      verify = false;
+      continue;
+    } else if (std::strcmp(argv[i], "--threads") == 0 && has_value) {
+      options.threads = std::strtoull(argv[++i], nullptr, 10);
+      continue;
+    } else if (std::strcmp(argv[i], "--dtdt") == 0) {
+      axis = &axes.max_abs_dTdt_C_per_s;
+    } else if (std::strcmp(argv[i], "--persistence") == 0) {
+      axis = &axes.persistence_s;
+    } else if (std::strcmp(argv[i], "--alpha") == 0) {
+      axis = &axes.ewma_alpha;
+    } else if (std::strcmp(argv[i], "--allow") == 0) {
+      axis = &axes.gate_allow_threshold;
+    } else if (std::strcmp(argv[i], "--caution") == 0) {
+      axis = &axes.gate_caution_threshold;
+    }
+    if (axis == nullptr || !has_value || !parseList(argv[++i], *axis)) {
+      std::fprintf(stderr, "hlv_sweep: bad argument '%s'\n", argv[i]);
+      return 2;
+    }
+  }
+
+  TraceReader reader;
+  if (!reader.open(path, verify)) {
+    std::fprintf(stderr, "hlv_sweep: %s\n", reader.lastError().c_str());
+    return 2;
+  }
+  if (reader.truncated()) {
+    std::fprintf(stderr, "hlv_sweep: trailing partial or corrupt block ignored\n");
+  }
+
+  const std::vector<PhaseReadinessConfig> grid = PolicySweep::grid(reader.config(), axes);
+  PolicySweep sweep(reader.config(), grid, options);
+  const auto start = std::chrono::steady_clock::now();
+  sweep.run(reader);
+  const double sweep_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  const uint64_t samples = sweep.samples();
+  const double config_samples = static_cast<double>(samples) * static_cast<double>(sweep.size());
+
+  std::printf("{\n");
+  std::printf("  \"trace\": \"%s\",\n", path.c_str());
+  std::printf("  \"samples\": %llu,\n", static_cast<unsigned long long>(samples));
+  std::printf("  \"configs\": %zu,\n", sweep.size());
+  std::printf("  \"threads\": %zu,\n", options.threads);
+  std::printf("  \"sweep_s\": %.6f,\n", sweep_s);
+  std::printf("  \"config_samples_per_s\": %.1f,\n", sweep_s > 0.0 ? config_samples / sweep_s : 0.0);
+  std::printf("  \"results\": [\n");
+  for (size_t k = 0; k < sweep.size(); ++k) {
+    const PhaseReadinessConfig& cfg = sweep.config(k);
+    const SweepResult r = sweep.result(k);
+    std::printf("    {\"max_abs_dTdt_C_per_s\": %.9g, \"persistence_s\": %.9g, \"ewma_alpha\": %.9g, "
+                "\"gate_allow_threshold\": %.9g, \"gate_caution_threshold\": %.9g, "
+                "\"occupancy\": {\"BLOCK\": %.6f, \"CAUTION\": %.6f, \"ALLOW\": %.6f}, "
+                "\"transitions\": %llu, \"disagreements\": %llu}%s\n",
+                cfg.max_abs_dTdt_C_per_s, cfg.persistence_s, cfg.ewma_alpha, cfg.gate_allow_threshold,
+                cfg.gate_caution_threshold, r.occupancy(Gate::BLOCK, samples),
+                r.occupancy(Gate::CAUTION, samples), r.occupancy(Gate::ALLOW, samples),
+                static_cast<unsigned long long>(r.transitions), static_cast<unsigned long long>(r.disagreements),
+                k + 1 < sweep.size() ? "," : "");
+  }
+  std::printf("  ]\n}\n");
+  return 0;
+}